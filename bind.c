@@ -323,6 +323,8 @@ PGAPI_DescribeParam(HSTMT hstmt,
 	}
 	conn = SC_get_conn(stmt);
 	SC_clear_error(stmt);
+	if (SC_asynccheck(stmt, func))
+		return SQL_ERROR;
 
 	ipdopts = SC_get_IPDF(stmt);
 	/*if ((ipar < 1) || (ipar > ipdopts->allocated))*/
@@ -451,7 +453,11 @@ MYLOG(DETAIL_LOG_LEVEL, "num_params=%d,%d\n", stmt->num_params, stmt->proc_retur
 		po_ind_t multi = FALSE, proc_return = 0;
 
 		stmt->proc_return = 0;
-		SC_scanQueryAndCountParams(stmt->statement, SC_get_conn(stmt), NULL, pcpar, &multi, &proc_return);
+		if (!SC_scan_statement_tokens(stmt, NULL, pcpar, &multi, &proc_return))
+		{
+			SC_set_error(stmt, STMT_NO_MEMORY_ERROR, "Could not scan the statement.", func);
+			return SQL_ERROR;
+		}
 		stmt->num_params = *pcpar;
 		stmt->proc_return = proc_return;
 		stmt->multi_statement = multi;
@@ -464,27 +470,6 @@ MYLOG(DETAIL_LOG_LEVEL, "num_params=%d,%d\n", stmt->num_params, stmt->proc_retur
 /*
  *	 Bindings Implementation
  */
-static BindInfoClass *
-create_empty_bindings(int num_columns)
-{
-	BindInfoClass *new_bindings;
-	int			i;
-
-	new_bindings = (BindInfoClass *) malloc(num_columns * sizeof(BindInfoClass));
-	if (!new_bindings)
-		return NULL;
-
-	for (i = 0; i < num_columns; i++)
-	{
-		new_bindings[i].buflen = 0;
-		new_bindings[i].buffer = NULL;
-		new_bindings[i].used =
-		new_bindings[i].indicator = NULL;
-	}
-
-	return new_bindings;
-}
-
 void
 extend_parameter_bindings(APDFields *self, int num_params)
 {
@@ -723,7 +708,8 @@ extend_column_bindings(ARDFields *self, int num_columns)
 	 */
 	if (self->allocated < num_columns)
 	{
-		new_bindings = create_empty_bindings(num_columns);
+		/* the memory may be left by a pooled statement */
+		new_bindings = (BindInfoClass *) realloc(self->bindings, num_columns * sizeof(BindInfoClass));
 		if (!new_bindings)
 		{
 			MYLOG(0, "unable to create %d new bindings from %d old bindings\n", num_columns, self->allocated);
@@ -737,12 +723,12 @@ extend_column_bindings(ARDFields *self, int num_columns)
 			return;
 		}
 
-		if (self->bindings)
+		for (i = self->allocated; i < num_columns; i++)
 		{
-			for (i = 0; i < self->allocated; i++)
-				new_bindings[i] = self->bindings[i];
-
-			free(self->bindings);
+			new_bindings[i].buflen = 0;
+			new_bindings[i].buffer = NULL;
+			new_bindings[i].used =
+			new_bindings[i].indicator = NULL;
 		}
 
 		self->bindings = new_bindings;
@@ -1004,6 +990,7 @@ void	reset_a_putdata_info(PutDataInfo *pdata_info, int ipar)
 		pdata_info->pdata[ipar].EXEC_buffer = NULL;
 	}
 	pdata_info->pdata[ipar].lobj_oid = 0;
+	pdata_info->pdata[ipar].streamed = PUTDATA_STREAM_NONE;
 }
 
 void SC_param_next(const StatementClass *stmt, int *param_number, ParameterInfoClass **apara, ParameterImplClass **ipara)
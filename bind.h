@@ -44,8 +44,19 @@ typedef struct
 	SQLLEN	ttlbuflen;		/* the buffer length */
 	SQLLEN	ttlbufused;		/* used length of the buffer */
 	SQLLEN	data_left;		/* amount of data left to read */
+	/* for non-BLOBs which are converted piece by piece without ttlbuf */
+	SQLLEN	src_offset;		/* where the conversion resumes in the value */
+	char	piece_kind;		/* GETDATA_PIECE_xxxx */
+	char	piece_split;		/* the first half of the character at
+					   src_offset was already returned */
 }	GetDataClass;
-#define GETDATA_RESET(gdc) ((gdc).blob.data_left64 = (gdc).data_left = -1)
+#define GETDATA_RESET(gdc) ((gdc).blob.data_left64 = (gdc).data_left = -1, (gdc).piece_kind = GETDATA_PIECE_NONE)
+
+/* piece_kind values */
+#define	GETDATA_PIECE_NONE	0	/* the converted value is in ttlbuf */
+#define	GETDATA_PIECE_TEXT	1	/* as it is, or LF -> CR/LF */
+#define	GETDATA_PIECE_WCHAR	2	/* UTF-8 -> UTF-16 */
+#define	GETDATA_PIECE_HEX2BIN	3	/* bytea in hex format -> binary */
 
 /*
  * ParameterInfoClass -- stores information about a bound parameter
@@ -68,8 +79,19 @@ typedef struct
 	SQLLEN	*EXEC_used;	/* amount of data */
 	char	*EXEC_buffer; 	/* the data */
 	OID	lobj_oid;
+	/* for the data streamed to the large object lobj_oid */
+	char	streamed;	/* PUTDATA_STREAM_xxxx */
+	char	carry_len;	/* length of the data held back in carry */
+	char	carry[4];	/* the end of the last piece which may form
+				   a character or a CR/LF with the next one */
 }	PutDataClass;
 
+/* streamed values */
+#define	PUTDATA_STREAM_NONE	0
+#define	PUTDATA_STREAM_BYTEA	1	/* SQL_C_BINARY -> bytea */
+#define	PUTDATA_STREAM_TEXT	2	/* SQL_C_CHAR in UTF-8 -> text */
+#define	PUTDATA_STREAM_WTEXT	3	/* SQL_C_WCHAR -> text */
+
 /*
  * ParameterImplClass -- stores implementation information about a parameter
  */
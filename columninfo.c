@@ -112,6 +112,33 @@ CI_read_fields_from_pgres(ColumnInfoClass *self, PGresult *pgres)
 }
 
 
+/*
+ *	Copy the field descriptions of another columninfo.
+ */
+BOOL
+CI_copy_fields(ColumnInfoClass *self, const ColumnInfoClass *src)
+{
+	int		lf;
+
+	CI_set_num_fields(self, src->num_fields);
+	if (src->num_fields > 0 && NULL == self->coli_array)
+		return FALSE;
+	for (lf = 0; lf < src->num_fields; lf++)
+	{
+		self->coli_array[lf] = src->coli_array[lf];
+		self->coli_array[lf].name = NULL;
+		if (NULL != src->coli_array[lf].name &&
+		    NULL == (self->coli_array[lf].name = strdup(src->coli_array[lf].name)))
+		{
+			CI_free_memory(self);
+			return FALSE;
+		}
+	}
+
+	return TRUE;
+}
+
+
 void
 CI_free_memory(ColumnInfoClass *self)
 {
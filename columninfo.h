@@ -43,6 +43,7 @@ ColumnInfoClass *CI_Constructor(void);
 void		CI_Destructor(ColumnInfoClass *self);
 void		CI_free_memory(ColumnInfoClass *self);
 BOOL		CI_read_fields_from_pgres(ColumnInfoClass *self, PGresult *pgres);
+BOOL		CI_copy_fields(ColumnInfoClass *self, const ColumnInfoClass *src);
 
 /* functions for setting up the fields from within the program, */
 /* without reading from a socket */
@@ -294,6 +294,9 @@ CC_lockinit(ConnectionClass *self)
 	INIT_CONN_CS(self);
 }
 
+/* the last trace_id given to a connection */
+static UInt4	last_trace_id = 0;
+
 static ConnectionClass *
 CC_initialize(ConnectionClass *rv, BOOL lockinit)
 {
@@ -306,6 +309,9 @@ CC_initialize(ConnectionClass *rv, BOOL lockinit)
 #endif /* WIN_MULTITHREAD_SUPPORT */
 
 	memset(rv, 0, clear_size);
+	shortterm_common_lock();
+	rv->trace_id = ++last_trace_id;
+	shortterm_common_unlock();
 	rv->status = CONN_NOT_CONNECTED;
 	rv->transact_status = CONN_IN_AUTOCOMMIT;		/* autocommit by default */
 	rv->unnamed_prepared_stmt = NULL;
@@ -391,6 +397,7 @@ CC_Destructor(ConnectionClass *self)
 	CC_conninfo_release(&self->connInfo);
 	if (self->__error_message)
 		free(self->__error_message);
+	CC_stop_query_timer(self);
 	DELETE_CONN_CS(self);
 	DELETE_CONNLOCK(self);
 	free(self);
@@ -416,7 +423,8 @@ CC_cursor_count(ConnectionClass *self)
 	for (i = 0; i < self->num_stmts; i++)
 	{
 		stmt = self->stmts[i];
-		if (stmt && (res = SC_get_Result(stmt)) && QR_get_cursor(res))
+		if (stmt && (res = SC_get_Result(stmt)) && QR_get_cursor(res) &&
+			!QR_is_portal(res))
 			count++;
 	}
 	CONNLOCK_RELEASE(self);
@@ -575,6 +583,208 @@ CC_clear_col_info(ConnectionClass *self, BOOL destroy)
 	}
 }
 
+/*
+ *	Add the counts since 'before' to 'to'. The connection counters are
+ *	maintained by the lower layers, and a statement gets the increments
+ *	while it's using the connection. The conversion time is counted by
+ *	the statement itself (see SC_fold_convert_time()).
+ */
+void
+perf_add_delta(PerfCounters *to, const PerfCounters *now, const PerfCounters *before)
+{
+	to->round_trips += now->round_trips - before->round_trips;
+	to->bytes_sent += now->bytes_sent - before->bytes_sent;
+	to->bytes_received += now->bytes_received - before->bytes_received;
+	to->rows_fetched += now->rows_fetched - before->rows_fetched;
+	to->results += now->results - before->results;
+	to->roundtrip_usec += now->roundtrip_usec - before->roundtrip_usec;
+	to->tuple_mallocs += now->tuple_mallocs - before->tuple_mallocs;
+	to->plan_hits += now->plan_hits - before->plan_hits;
+}
+
+/*
+ *	Whether the command with the tag may have changed the catalogs, so
+ *	that the catalog snapshots and the cached descriptions are stale.
+ *	A ROLLBACK may undo the DDL of the transaction.
+ */
+BOOL
+cmdtag_invalidates_catalog(const char *cmdtag)
+{
+	return (strnicmp(cmdtag, "CREATE", 6) == 0 ||
+		strnicmp(cmdtag, "ALTER", 5) == 0 ||
+		strnicmp(cmdtag, "DROP", 4) == 0 ||
+		strnicmp(cmdtag, "ROLLBACK", 8) == 0);
+}
+
+/* Clear the catalog snapshots */
+void
+CC_clear_cat_snapshot(ConnectionClass *self)
+{
+	CAT_SNAPSHOT	*snap, *next;
+	int	i;
+
+	for (snap = self->cat_snapshot; NULL != snap; snap = next)
+	{
+		next = snap->next;
+		for (i = 0; i < NUM_OF_CATSNAP_KINDS; i++)
+			QR_Destructor(snap->result[i]);
+		NULL_THE_NAME(snap->schema_name);
+		free(snap);
+	}
+	self->cat_snapshot = NULL;
+}
+
+static void
+desc_cache_free(DESC_CACHE *desc)
+{
+	if (desc->query)
+		free(desc->query);
+	if (desc->search_path)
+		free(desc->search_path);
+	if (desc->types)
+		free(desc->types);
+	if (desc->param_types)
+		free(desc->param_types);
+	if (desc->fields)
+		CI_Destructor(desc->fields);
+	free(desc);
+}
+
+static UInt4
+desc_cache_hash(const char *query)
+{
+	const UCHAR	*p;
+	UInt4		hash = 5381;
+
+	for (p = (const UCHAR *) query; *p; p++)
+		hash = hash * 33 + *p;
+	return hash;
+}
+
+/* Clear the cached descriptions of unnamed statements */
+void
+CC_clear_desc_cache(ConnectionClass *self)
+{
+	DESC_CACHE	*desc, *next;
+
+	for (desc = self->desc_cache; NULL != desc; desc = next)
+	{
+		next = desc->next;
+		desc_cache_free(desc);
+	}
+	self->desc_cache = NULL;
+	self->num_desc_cache = 0;
+}
+
+/*
+ * Look for the description of a query parsed with the given parameter
+ * types under the current search_path. The search_path is only known
+ * when the server reports it; otherwise any SET search_path clears the
+ * cache.
+ */
+const DESC_CACHE *
+CC_lookup_desc_cache(ConnectionClass *self, const char *query,
+		     Int2 num_types, const Oid *types)
+{
+	DESC_CACHE	*desc, *prev = NULL;
+	const char	*search_path;
+	UInt4		hash;
+
+	if (NULL == self->desc_cache || NULL == self->pqconn)
+		return NULL;
+	hash = desc_cache_hash(query);
+	search_path = PQparameterStatus(self->pqconn, "search_path");
+	for (desc = self->desc_cache; NULL != desc; prev = desc, desc = desc->next)
+	{
+		if (desc->hash != hash ||
+		    desc->num_types != num_types ||
+		    strcmp(desc->query, query) != 0)
+			continue;
+		if (NULL == search_path ?
+		    NULL != desc->search_path :
+		    (NULL == desc->search_path || strcmp(desc->search_path, search_path) != 0))
+			continue;
+		if (num_types > 0 &&
+		    memcmp(desc->types, types, sizeof(Oid) * num_types) != 0)
+			continue;
+		/* keep the most recently used first */
+		if (NULL != prev)
+		{
+			prev->next = desc->next;
+			desc->next = self->desc_cache;
+			self->desc_cache = desc;
+		}
+		MYLOG(DETAIL_LOG_LEVEL, "hit %s\n", query);
+		return desc;
+	}
+
+	return NULL;
+}
+
+/*
+ * Cache the description of a query, dropping the least recently used one
+ * beyond the DescribeCache limit. The parameter types and the fields are
+ * copied.
+ */
+void
+CC_add_desc_cache(ConnectionClass *self, const char *query,
+		  Int2 num_types, const Oid *types,
+		  const PGresult *pgres, const ColumnInfoClass *fields)
+{
+	DESC_CACHE	*desc, *prev;
+	const char	*search_path;
+	int		i;
+
+	if (self->connInfo.describe_cache <= 0 || NULL == self->pqconn)
+		return;
+	while (self->num_desc_cache >= self->connInfo.describe_cache)
+	{
+		for (prev = NULL, desc = self->desc_cache; NULL != desc->next; prev = desc, desc = desc->next)
+			;
+		if (NULL == prev)
+			self->desc_cache = NULL;
+		else
+			prev->next = NULL;
+		desc_cache_free(desc);
+		self->num_desc_cache--;
+	}
+	if (NULL == (desc = (DESC_CACHE *) calloc(sizeof(DESC_CACHE), 1)))
+		return;
+	desc->hash = desc_cache_hash(query);
+	desc->query = strdup(query);
+	if (NULL != (search_path = PQparameterStatus(self->pqconn, "search_path")))
+		desc->search_path = strdup(search_path);
+	desc->num_types = num_types;
+	if (num_types > 0 &&
+	    NULL != (desc->types = (Oid *) malloc(sizeof(Oid) * num_types)))
+		memcpy(desc->types, types, sizeof(Oid) * num_types);
+	desc->num_params = PQnparams(pgres);
+	if (desc->num_params > 0 &&
+	    NULL != (desc->param_types = (Oid *) malloc(sizeof(Oid) * desc->num_params)))
+	{
+		for (i = 0; i < desc->num_params; i++)
+			desc->param_types[i] = PQparamtype(pgres, i);
+	}
+	if (NULL != (desc->fields = CI_Constructor()) &&
+	    !CI_copy_fields(desc->fields, fields))
+	{
+		CI_Destructor(desc->fields);
+		desc->fields = NULL;
+	}
+	if (NULL == desc->query ||
+	    (NULL != search_path && NULL == desc->search_path) ||
+	    (num_types > 0 && NULL == desc->types) ||
+	    (desc->num_params > 0 && NULL == desc->param_types) ||
+	    NULL == desc->fields)
+	{
+		desc_cache_free(desc);
+		return;
+	}
+	desc->next = self->desc_cache;
+	self->desc_cache = desc;
+	self->num_desc_cache++;
+}
+
 static void
 CC_set_locale_encoding(ConnectionClass *self, const char * encoding)
 {
@@ -667,6 +877,9 @@ CC_cleanup(ConnectionClass *self, BOOL keepCommunication)
 	if (self->pqconn)
 	{
 		QLOG(0, "PQfinish: %p\n", self->pqconn);
+		self->readahead_res = NULL;
+		self->portal_res = NULL;
+		self->portal_interrupted = FALSE;
 		PQfinish(self->pqconn);
 		self->pqconn = NULL;
 	}
@@ -686,6 +899,14 @@ CC_cleanup(ConnectionClass *self, BOOL keepCommunication)
 			self->stmts[i] = NULL;
 		}
 	}
+	/* Free the statements kept for reuse */
+	while (stmt = self->stmt_pool, NULL != stmt)
+	{
+		self->stmt_pool = stmt->next_pooled;
+		stmt->hdbc = NULL;
+		SC_Destructor(stmt);
+	}
+	self->num_pooled_stmts = 0;
 	/* Free all the descs on this connection */
 	for (i = 0; i < self->num_descs; i++)
 	{
@@ -736,6 +957,8 @@ CC_cleanup(ConnectionClass *self, BOOL keepCommunication)
 	}
 	/* Free cached table info */
 	CC_clear_col_info(self, TRUE);
+	CC_clear_cat_snapshot(self);
+	CC_clear_desc_cache(self);
 	if (self->num_discardp > 0 && self->discardp)
 	{
 		for (i = 0; i < self->num_discardp; i++)
@@ -1485,8 +1708,10 @@ static void CC_clear_cursors(ConnectionClass *self, BOOL on_abort)
 	for (i = 0; i < self->num_stmts; i++)
 	{
 		stmt = self->stmts[i];
+		/* portals are left until the application reads them through */
 		if (stmt && (res = SC_get_Result(stmt)) &&
-			 (NULL != QR_get_cursor(res)))
+			 (NULL != QR_get_cursor(res)) &&
+			 !QR_is_portal(res))
 		{
 			/*
 			 * non-holdable cursors are automatically closed
@@ -1598,6 +1823,8 @@ MYLOG(0, "entering opt=%x\n", opt);
 	if (0 != (opt & CONN_DEAD))
 	{
 		conn->status = CONN_DOWN;
+		conn->readahead_res = NULL;
+		conn->portal_res = NULL;
 		if (conn->pqconn)
 		{
 			CONNLOCK_RELEASE(conn);
@@ -1692,6 +1919,8 @@ CC_internal_rollback(ConnectionClass *self, int rollback_type, BOOL ignore_abort
 	char		cmd[128];
 	PGresult   *pgres = NULL;
 
+	CC_finish_readahead(self);
+	CC_finish_portal(self);
 	if (!CC_is_in_error_trans(self))
 		return 1;
 	switch (rollback_type)
@@ -1799,6 +2028,9 @@ CC_send_query_append(ConnectionClass *self, const char *query, QueryInfo *qi, UD
 	char	   *cmdbuffer;
 	PGresult   *pgres = NULL;
 	notice_receiver_arg nrarg;
+	Int8		send_time = 0;
+	BOOL		sent = FALSE, send_failed = FALSE;
+	PerfCounters	perf_before = self->perf;
 
 	if (appendq)
 	{
@@ -1826,6 +2058,8 @@ CC_send_query_append(ConnectionClass *self, const char *query, QueryInfo *qi, UD
 		CLEANUP_FUNC_CONN_CS(func_cs_count, self);
 		return rhold;
 	}
+	CC_finish_readahead(self);
+	CC_finish_portal(self);
 
 	/*
 	 *	In case the round trip time can be ignored, the query
@@ -1933,11 +2167,16 @@ CC_send_query_append(ConnectionClass *self, const char *query, QueryInfo *qi, UD
 	PQsetNoticeReceiver(self->pqconn, receive_libpq_notice, &nrarg);
 
 	QLOG(0, "PQsendQuery: %p '%s'\n", self->pqconn, query_buf.data);
+	send_time = CC_perf_clock(self);
+	sent = TRUE;
+	self->perf.round_trips++;
+	self->perf.bytes_sent += query_buf.len;
 	if (!PQsendQuery(self->pqconn, query_buf.data))
 	{
 		char *errmsg = PQerrorMessage(self->pqconn);
 		QLOG(0, "\nCommunication Error: %s\n", SAFE_STR(errmsg));
 		CC_set_error(self, CONNECTION_COMMUNICATION_ERROR, errmsg, func);
+		send_failed = TRUE;
 		goto cleanup;
 	}
 	PQsetSingleRowMode(self->pqconn);
@@ -1966,6 +2205,7 @@ CC_send_query_append(ConnectionClass *self, const char *query, QueryInfo *qi, UD
 	{
 		int status = PQresultStatus(pgres);
 
+		self->perf.results++;
 		if (discardTheRest)
 			continue;
 		switch (status)
@@ -2062,13 +2302,28 @@ MYLOG(DETAIL_LOG_LEVEL, "Discarded a RELEASE result\n");
 						res->recent_processed_row_count = atoi(ptr + 1);
 					else
 						res->recent_processed_row_count = -1;
-					if (self->current_schema_valid &&
-						strnicmp(cmdbuffer, "SET", 3) == 0)
+					if (strnicmp(cmdbuffer, "SET", 3) == 0 &&
+						(self->current_schema_valid ||
+						 NULL != self->desc_cache) &&
+						is_setting_search_path(query))
 					{
-						if (is_setting_search_path(query))
-							reset_current_schema(self);
+						reset_current_schema(self);
+						/* unless the server reports search_path */
+						if (NULL == PQparameterStatus(self->pqconn, "search_path"))
+							CC_clear_desc_cache(self);
 					}
 				}
+				/*
+				 *	Any DDL or ROLLBACK may invalidate the
+				 *	catalog snapshots. Simply discard them.
+				 */
+				if (cmdtag_invalidates_catalog(cmdbuffer))
+				{
+					if (NULL != self->cat_snapshot)
+						CC_clear_cat_snapshot(self);
+					if (NULL != self->desc_cache)
+						CC_clear_desc_cache(self);
+				}
 
 				if (QR_command_successful(res))
 					QR_set_rstatus(res, PORES_COMMAND_OK);
@@ -2230,6 +2485,15 @@ MYLOG(DETAIL_LOG_LEVEL, "Discarded a RELEASE result\n");
 	}
 
 cleanup:
+	/* failed requests are traced too */
+	if (sent)
+	{
+		if (0 != send_time)
+			self->perf.roundtrip_usec += qtrace_clock() - send_time;
+		QTRACE_EVENT(strnicmp(query, "fetch", 5) == 0 ? QTRACE_FETCH : QTRACE_EXECUTE, send_failed || aborted || (ReadyToReturn && NULL == retres), self, send_time, query, 0, self->perf.rows_fetched - perf_before.rows_fetched, self->perf.bytes_received - perf_before.bytes_received);
+	}
+	if (stmt)
+		perf_add_delta(&stmt->perf, &self->perf, &perf_before);
 	if (self->pqconn)
 		PQsetNoticeReceiver(self->pqconn, receive_libpq_notice, NULL);
 	if (pgres != NULL)
@@ -2345,6 +2609,313 @@ MYLOG(DETAIL_LOG_LEVEL, " ignored abort_on_conn\n");
 	return rhold;
 }
 
+/*
+ *	FETCH read-ahead (FetchReadAhead option).
+ *
+ *	QR_next_tuple() sends the FETCH for the next block of a cursor as
+ *	soon as it has received the current block, and reads the result only
+ *	when the application needs the block.  As libpq allows one query in
+ *	progress at a time, every other request on the connection first
+ *	calls CC_finish_readahead(), which keeps the result in the QResultClass
+ *	which sent it.
+ *
+ *	These functions can be called with only the statement lock held, e.g.
+ *	by SQLFetch() or SQLFreeStmt(SQL_CLOSE), so they take the connection
+ *	lock themselves before touching the PGconn.
+ */
+BOOL
+CC_send_readahead(ConnectionClass *self, QResultClass *res, const char *query)
+{
+	BOOL	ret = FALSE;
+	int	func_cs_count = 0;
+
+	ENTER_INNER_CONN_CS(self, func_cs_count);
+	if (NULL == self->pqconn || NULL != self->readahead_res)
+		goto cleanup;
+
+	QLOG(0, "PQsendQuery(read ahead): %p '%s'\n", self->pqconn, query);
+	self->perf.round_trips++;
+	self->perf.bytes_sent += strlen(query);
+	if (!PQsendQuery(self->pqconn, query))
+	{
+		MYLOG(0, "couldn't send the read-ahead query: %s", PQerrorMessage(self->pqconn));
+		goto cleanup;
+	}
+	self->readahead_res = res;
+	ret = TRUE;
+cleanup:
+	CLEANUP_FUNC_CONN_CS(func_cs_count, self);
+	return ret;
+}
+
+void
+CC_finish_readahead(ConnectionClass *self)
+{
+	QResultClass	*res;
+	PGresult	*pgres;
+	int		func_cs_count = 0;
+
+	ENTER_INNER_CONN_CS(self, func_cs_count);
+	if (NULL == (res = self->readahead_res))
+		goto cleanup;
+	MYLOG(0, "finishing the read-ahead of %p\n", res);
+	self->readahead_res = NULL;
+	while (self->pqconn && (pgres = PQgetResult(self->pqconn)) != NULL)
+	{
+		self->perf.results++;
+		if (NULL == res->readahead)
+			res->readahead = pgres;
+		else
+			PQclear(pgres);
+	}
+	/* the FETCH may have aborted the transaction */
+	if (PGRES_TUPLES_OK != PQresultStatus(res->readahead))
+		LIBPQ_update_transaction_status(self);
+cleanup:
+	CLEANUP_FUNC_CONN_CS(func_cs_count, self);
+}
+
+/*
+ *	Throw away the read-ahead FETCH of res, which is being closed.
+ *
+ *	If the FETCH is still running outside a transaction block, e.g. on a
+ *	WITH HOLD cursor in autocommit mode, it is cancelled rather than
+ *	waited for.  Inside a transaction block a cancel would abort the
+ *	application's transaction, so the block is read and dropped there.
+ */
+void
+CC_discard_readahead(ConnectionClass *self, QResultClass *res)
+{
+	PGresult	*pgres;
+	BOOL		cancelled = FALSE;
+	int		func_cs_count = 0;
+
+	ENTER_INNER_CONN_CS(self, func_cs_count);
+	if (res != self->readahead_res)
+		goto cleanup;
+	MYLOG(0, "discarding the read-ahead of %p\n", res);
+	self->readahead_res = NULL;
+	if (NULL == self->pqconn)
+		goto cleanup;
+	if (!CC_is_in_trans(self) &&
+	    PQconsumeInput(self->pqconn) &&
+	    PQisBusy(self->pqconn))
+		cancelled = CC_send_cancel_request(self);
+	while ((pgres = PQgetResult(self->pqconn)) != NULL)
+	{
+		self->perf.results++;
+		if (PGRES_TUPLES_OK != PQresultStatus(pgres))
+			cancelled = TRUE;
+		PQclear(pgres);
+	}
+	if (cancelled)
+		LIBPQ_update_transaction_status(self);
+cleanup:
+	CLEANUP_FUNC_CONN_CS(func_cs_count, self);
+}
+
+/*
+ *	Read the rows of the read-ahead FETCH into res, as CC_send_query()
+ *	does for the FETCH issued by QR_next_tuple().
+ */
+BOOL
+CC_get_readahead(ConnectionClass *self, QResultClass *res, StatementClass *stmt)
+{
+	PGresult	*pgres;
+	BOOL		ret = TRUE;
+
+	if (self->readahead_res == res)
+		CC_finish_readahead(self);
+	pgres = res->readahead;
+	res->readahead = NULL;
+	res->cmd_fetch_size = res->readahead_size;
+	res->readahead_size = 0;
+
+	/* PQresultStatus() returns PGRES_FATAL_ERROR for a NULL result */
+	switch (PQresultStatus(pgres))
+	{
+		case PGRES_TUPLES_OK:
+			if (!CC_from_PGresult(res, stmt, NULL, res->cursor_name, &pgres))
+				ret = FALSE;
+			else if (res->rstatus == PORES_TUPLES_OK && res->notice)
+				QR_set_rstatus(res, PORES_NONFATAL_ERROR);
+			break;
+		default:
+			handle_pgres_error(self, pgres, "send_query", res, TRUE);
+			ret = FALSE;
+			break;
+	}
+	if (pgres)
+		PQclear(pgres);
+
+	return ret;
+}
+
+/*
+ *	Portal fetch (PortalFetch option).
+ *
+ *	The rows of a forward-only cursor are read from the unnamed portal of
+ *	the extended query protocol in single row mode, a block at a time.
+ *	libpq has no API to send an Execute message with a row limit, so the
+ *	portal is suspended by leaving the rest of the rows unread on the
+ *	connection instead.
+ *
+ *	Closing the cursor early cancels the rest of the rows, see
+ *	CC_close_portal().  That is safe because portals are used only outside
+ *	a transaction block (SC_may_use_portal()); within one, the cancel would
+ *	abort the application's transaction, so DECLARE/FETCH is used there.
+ *
+ *	Every other request on the connection first calls CC_finish_portal().
+ *	The rows of the cursor are still wanted, and there is no way to pause
+ *	the Execute, so they are read into the cache; the connection then
+ *	switches to DECLARE/FETCH for its later cursors (portal_interrupted),
+ *	which can be interleaved with other requests.
+ */
+void
+CC_start_portal(ConnectionClass *self, QResultClass *res, Int4 fetch_size)
+{
+	res->portal_rows = fetch_size;
+	res->cmd_fetch_size = fetch_size;
+	QR_set_cache_size(res, fetch_size);
+	self->portal_res = res;
+}
+
+/*
+ *	Close the portal unless the last result read is a row left over by
+ *	the block limit.
+ */
+void
+CC_end_portal_block(ConnectionClass *self, const PGresult *pgres)
+{
+	QResultClass	*res = self->portal_res;
+
+	if (NULL == res)
+		return;
+	switch (PQresultStatus(pgres))
+	{
+		case PGRES_SINGLE_TUPLE:
+			return;
+		case PGRES_TUPLES_OK:
+			/* all the rows have been read */
+			QR_set_reached_eof(res);
+			if (res->cursTuple < (Int4) res->num_total_read)
+				res->cursTuple = res->num_total_read;
+			break;
+		default:
+			break;
+	}
+	CC_discard_portal(self);
+}
+
+/*
+ *	Read the next block of the portal into res, as CC_send_query() does
+ *	for the FETCH issued by QR_next_tuple().
+ */
+BOOL
+CC_fetch_portal(ConnectionClass *self, QResultClass *res, StatementClass *stmt, Int4 fetch_size)
+{
+	PGresult	*pgres;
+	BOOL		ret = TRUE;
+
+	if (self->portal_res != res)
+	{
+		/* CC_finish_portal() couldn't read all the rows */
+		pgres = res->portal_error;
+		res->portal_error = NULL;
+		if (NULL != pgres || NULL == QR_get_message(res))
+			handle_pgres_error(self, pgres, "fetch_portal", res, TRUE);
+		else
+			QR_set_rstatus(res, PORES_FATAL_ERROR);
+		if (pgres)
+			PQclear(pgres);
+		return FALSE;
+	}
+	res->portal_rows = fetch_size;
+	res->cmd_fetch_size = fetch_size;
+	pgres = PQgetResult(self->pqconn);
+	if (pgres)
+		self->perf.results++;
+	/* PQresultStatus() returns PGRES_FATAL_ERROR for a NULL result */
+	switch (PQresultStatus(pgres))
+	{
+		case PGRES_SINGLE_TUPLE:
+		case PGRES_TUPLES_OK:
+			if (!CC_from_PGresult(res, stmt, NULL, res->cursor_name, &pgres))
+				ret = FALSE;
+			else if (res->rstatus == PORES_TUPLES_OK && res->notice)
+				QR_set_rstatus(res, PORES_NONFATAL_ERROR);
+			break;
+		default:
+			handle_pgres_error(self, pgres, "fetch_portal", res, TRUE);
+			ret = FALSE;
+			break;
+	}
+	if (ret)
+		CC_end_portal_block(self, pgres);
+	else
+		CC_discard_portal(self);
+	if (pgres)
+		PQclear(pgres);
+
+	return ret;
+}
+
+void
+CC_finish_portal(ConnectionClass *self)
+{
+	QResultClass	*res = self->portal_res;
+
+	if (NULL == res)
+		return;
+	MYLOG(0, "reading the rest of the portal of %p\n", res);
+	QR_read_portal_rest(res);
+	CC_discard_portal(self);
+	self->portal_interrupted = TRUE;
+}
+
+/*
+ *	The cursor of res is closed: stop the server sending the rows left
+ *	in its portal instead of reading them through.
+ */
+void
+CC_close_portal(ConnectionClass *self, QResultClass *res)
+{
+	if (res != self->portal_res)
+		return;
+	if (NULL != self->pqconn &&
+	    !QR_once_reached_eof(res) &&
+	    !CC_is_in_trans(self))
+	{
+		MYLOG(0, "cancelling the portal of %p\n", res);
+		CC_send_cancel_request(self);
+	}
+	CC_discard_portal(self);
+}
+
+/*
+ *	Skip the rows left in the portal and get the connection ready for
+ *	the next request.
+ */
+void
+CC_discard_portal(ConnectionClass *self)
+{
+	QResultClass	*res = self->portal_res;
+	PGresult	*pgres;
+
+	if (NULL == res)
+		return;
+	MYLOG(0, "closing the portal of %p\n", res);
+	self->portal_res = NULL;
+	res->portal_rows = 0;
+	while (self->pqconn && (pgres = PQgetResult(self->pqconn)) != NULL)
+	{
+		self->perf.results++;
+		PQclear(pgres);
+	}
+	/* the portal may have aborted the transaction */
+	LIBPQ_update_transaction_status(self);
+}
+
 #define MAX_SEND_FUNC_ARGS	3
 static const char *func_param_str[MAX_SEND_FUNC_ARGS + 1] =
 {
@@ -2406,6 +2977,8 @@ CC_send_function(ConnectionClass *self, const char *fn_name, void *result_buf, i
 	/* Finish the pending extended query first */
 #define	return DONT_CALL_RETURN_FROM_HERE???
 	ENTER_INNER_CONN_CS(self, func_cs_count);
+	CC_finish_readahead(self);
+	CC_finish_portal(self);
 
 	SPRINTF_FIXED(sqlbuffer, "SELECT pg_catalog.%s%s", fn_name,
 			 func_param_str[nargs]);
@@ -2495,6 +3068,180 @@ cleanup:
 	return ret;
 }
 
+static char *
+put_uint4(char *ptr, UInt4 val)
+{
+	val = htonl(val);
+	memcpy(ptr, &val, sizeof(val));
+	return ptr + sizeof(val);
+}
+
+static char *
+put_uint2(char *ptr, UInt2 val)
+{
+	val = htons(val);
+	memcpy(ptr, &val, sizeof(val));
+	return ptr + sizeof(val);
+}
+
+/*
+ *	Execute the plan 'plan_name' with a tid[] as its only parameter,
+ *	preparing it from 'query' first if 'query' isn't NULL.  *prepared
+ *	is set once the plan exists, even if the execution fails.
+ *
+ *	The keys are sent as a binary array, so that reloading the rows of
+ *	a keyset-driven cursor needs neither a query text per window nor
+ *	a parse.  The returned result has the key columns of the statement
+ *	in its keyset, as with CC_send_query(.., CREATE_KEYSET, ..).
+ *	GO_INTO_TRANSACTION in flag issues BEGIN first, as CC_send_query()
+ *	does.
+ */
+QResultClass *
+CC_send_tid_lookup(ConnectionClass *self, StatementClass *stmt, UDWORD flag, const char *plan_name, const char *query, BOOL *prepared, const UInt4 *blocks, const UInt2 *offsets, int nkeys)
+{
+	CSTR	func = "CC_send_tid_lookup";
+	QResultClass	*res = NULL;
+	PGresult	*pgres = NULL;
+	Oid		paramType = PG_TYPE_TIDARRAY;
+	char	*param = NULL, *ptr;
+	int		paramLength, paramFormat = 1;
+	int		i, func_cs_count = 0;
+	Int8	send_time = 0;
+	BOOL	executed = FALSE,
+		issue_begin = ((flag & GO_INTO_TRANSACTION) != 0 && !CC_is_in_trans(self));
+	PerfCounters	perf_before;
+
+	MYLOG(0, "conn=%p, plan=%s nkeys=%d\n", self, plan_name, nkeys);
+	if (!self->pqconn)
+	{
+		CC_set_error(self, CONNECTION_COULD_NOT_SEND, "The connection is down", func);
+		return NULL;
+	}
+
+#define	return DONT_CALL_RETURN_FROM_HERE???
+	ENTER_INNER_CONN_CS(self, func_cs_count);
+	CC_finish_readahead(self);
+	CC_finish_portal(self);
+	if (stmt && !CC_started_rbpoint(self) &&
+	    (issue_begin || (CC_is_in_trans(self) && !CC_is_in_error_trans(self))))
+	{
+		if (SQL_ERROR == SetStatementSvp(SC_get_ancestor(stmt), SVPOPT_RDONLY))
+			goto cleanup;
+	}
+	if (issue_begin)
+	{
+		QLOG(0, "PQexec: %p '%s'\n", self->pqconn, bgncmd);
+		pgres = PQexec(self->pqconn, bgncmd);
+		self->perf.round_trips++;
+		if (pgres)
+			self->perf.results++;
+		self->perf.bytes_sent += strlen(bgncmd);
+		if (PQresultStatus(pgres) != PGRES_COMMAND_OK)
+		{
+			handle_pgres_error(self, pgres, func, NULL, TRUE);
+			LIBPQ_update_transaction_status(self);
+			goto cleanup;
+		}
+		QLOG(0, "\tok: - 'C' - %s\n", PQcmdStatus(pgres));
+		PQclear(pgres);
+		pgres = NULL;
+		LIBPQ_update_transaction_status(self);
+	}
+
+	if (query)
+	{
+		QLOG(0, "PQprepare: %p '%s' plan=%s nParams=1\n", self->pqconn, query, plan_name);
+		send_time = CC_perf_clock(self);
+		pgres = PQprepare(self->pqconn, plan_name, query, 1, &paramType);
+		self->perf.round_trips++;
+		if (pgres)
+			self->perf.results++;
+		self->perf.bytes_sent += strlen(query);
+		if (0 != send_time)
+			self->perf.roundtrip_usec += qtrace_clock() - send_time;
+		QTRACE_EVENT(QTRACE_PREPARE, PQresultStatus(pgres) != PGRES_COMMAND_OK, self, send_time, query, 1, -1, 0);
+		if (PQresultStatus(pgres) != PGRES_COMMAND_OK)
+		{
+			handle_pgres_error(self, pgres, func, NULL, TRUE);
+			LIBPQ_update_transaction_status(self);
+			goto cleanup;
+		}
+		QLOG(0, "\tok: - 'C' - %s\n", PQcmdStatus(pgres));
+		PQclear(pgres);
+		pgres = NULL;
+		*prepared = TRUE;
+	}
+
+	/* ndim, flags, element type, dimension and lower bound, then the keys */
+	paramLength = 5 * 4 + nkeys * (4 + 4 + 2);
+	if (NULL == (param = malloc(paramLength)))
+	{
+		CC_set_error(self, CONN_NO_MEMORY_ERROR, "Couldn't alloc buffer for the keys.", func);
+		goto cleanup;
+	}
+	ptr = put_uint4(param, 1);
+	ptr = put_uint4(ptr, 0);
+	ptr = put_uint4(ptr, PG_TYPE_TID);
+	ptr = put_uint4(ptr, nkeys);
+	ptr = put_uint4(ptr, 1);
+	for (i = 0; i < nkeys; i++)
+	{
+		ptr = put_uint4(ptr, 4 + 2);
+		ptr = put_uint4(ptr, blocks[i]);
+		ptr = put_uint2(ptr, offsets[i]);
+	}
+
+	QLOG(0, "PQexecPrepared: %p plan=%s nkeys=%d\n", self->pqconn, plan_name, nkeys);
+	perf_before = self->perf;
+	self->perf.round_trips++;
+	self->perf.bytes_sent += paramLength;
+	send_time = CC_perf_clock(self);
+	executed = TRUE;
+	pgres = PQexecPrepared(self->pqconn, plan_name, 1, (const char * const *) &param, &paramLength, &paramFormat, 0);
+	if (pgres)
+		self->perf.results++;
+	if (PQresultStatus(pgres) != PGRES_TUPLES_OK)
+	{
+		handle_pgres_error(self, pgres, func, NULL, TRUE);
+		LIBPQ_update_transaction_status(self);
+		goto cleanup;
+	}
+	QLOG(0, "\tok: - 'T' - %s\n", PQcmdStatus(pgres));
+	if (NULL == (res = QR_Constructor()))
+	{
+		CC_set_error(self, CONN_NO_MEMORY_ERROR, "Couldn't create result info in send_tid_lookup.", func);
+		goto cleanup;
+	}
+	QR_set_haskeyset(res);
+	if (stmt)
+	{
+		if (stmt->num_key_fields < 0) /* for safety */
+			CheckPgClassInfo(stmt);
+		res->num_key_fields = stmt->num_key_fields;
+	}
+	if (!CC_from_PGresult(res, stmt, self, NULL, &pgres))
+	{
+		QR_Destructor(res);
+		res = NULL;
+		goto cleanup;
+	}
+
+cleanup:
+#undef	return
+	if (executed)
+	{
+		if (0 != send_time)
+			self->perf.roundtrip_usec += qtrace_clock() - send_time;
+		QTRACE_EVENT(QTRACE_EXECUTE, NULL == res, self, send_time, plan_name, 1, self->perf.rows_fetched - perf_before.rows_fetched, self->perf.bytes_received - perf_before.bytes_received);
+	}
+	CLEANUP_FUNC_CONN_CS(func_cs_count, self);
+	if (param)
+		free(param);
+	if (pgres)
+		PQclear(pgres);
+	return res;
+}
+
 
 char
 CC_send_settings(ConnectionClass *self, const char *set_query)
@@ -2973,6 +3720,255 @@ CC_send_cancel_request(const ConnectionClass *conn)
 		return FALSE;
 }
 
+#ifdef	CLIENT_QUERY_TIMER
+/*
+ *	The timer of the query timeout.
+ *
+ *	The armed timers of the connections are kept in a list, and a thread
+ *	waits until the earliest deadline. When a deadline has passed, the
+ *	thread takes the timer off the list together with the cancel request
+ *	which was prepared when it was armed, so it never touches the PGconn
+ *	used by the executing thread.  PQcancel() opens a new connection to
+ *	the server, so it's called after releasing qtimer_cs, and the timers
+ *	of the other connections can be armed and disarmed meanwhile.
+ *	qtimer_sending tells the connection whose cancel request is on the
+ *	way; CC_stop_query_timer() of that connection waits for it, so that
+ *	once it returns no cancel request can arrive for the next query.  A
+ *	timer disarmed before the thread takes it is just dropped.
+ *
+ *	The deadlines are measured with CLOCK_MONOTONIC where the condition
+ *	variable can wait on it, so that a change of the system time doesn't
+ *	fire or delay them.  FinalizeQueryTimer() stops the thread when the
+ *	driver is unloaded.
+ */
+enum {
+	QTIMER_IDLE = 0
+	,QTIMER_ARMED
+	,QTIMER_FIRED
+};
+
+static pthread_mutex_t	qtimer_cs = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t	qtimer_cond;	/* initialized by qtimer_init_cond() */
+static pthread_cond_t	qtimer_sent_cond = PTHREAD_COND_INITIALIZER;
+static BOOL	qtimer_cond_ready = FALSE;
+static BOOL	qtimer_started = FALSE;
+static BOOL	qtimer_stopping = FALSE;
+static pthread_t	qtimer_thread;
+static ConnectionClass	*qtimer_list = NULL;
+static ConnectionClass	*qtimer_sending = NULL;
+
+/* The current time in microseconds, on the clock of qtimer_cond */
+static Int8
+qtimer_clock(void)
+{
+#ifdef	HAVE_PTHREAD_CONDATTR_SETCLOCK
+	struct timespec	ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (Int8) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+#else
+	return qtrace_clock();
+#endif /* HAVE_PTHREAD_CONDATTR_SETCLOCK */
+}
+
+static void
+qtimer_init_cond(void)
+{
+	pthread_condattr_t	attr;
+
+	pthread_condattr_init(&attr);
+#ifdef	HAVE_PTHREAD_CONDATTR_SETCLOCK
+	pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+#endif /* HAVE_PTHREAD_CONDATTR_SETCLOCK */
+	pthread_cond_init(&qtimer_cond, &attr);
+	pthread_condattr_destroy(&attr);
+	qtimer_cond_ready = TRUE;
+}
+
+static void *
+qtimer_main(void *arg)
+{
+	ConnectionClass	*conn, **prev;
+	PGcancel	*cancel;
+	Int8	now, next;
+	struct timespec	ts;
+	char	errbuf[256];
+
+	pthread_mutex_lock(&qtimer_cs);
+	while (!qtimer_stopping)
+	{
+		now = qtimer_clock();
+		next = 0;
+		for (prev = &qtimer_list; conn = *prev, NULL != conn;)
+		{
+			if (conn->qtimer_deadline <= now)
+				break;
+			if (0 == next || conn->qtimer_deadline < next)
+				next = conn->qtimer_deadline;
+			prev = &conn->qtimer_next;
+		}
+		if (NULL != conn)
+		{
+			/* take the expired timer and send its cancel request unlocked */
+			*prev = conn->qtimer_next;
+			conn->qtimer_state = QTIMER_FIRED;
+			cancel = (PGcancel *) conn->qtimer_cancel;
+			conn->qtimer_cancel = NULL;
+			qtimer_sending = conn;
+			pthread_mutex_unlock(&qtimer_cs);
+			MYLOG(0, "the query timeout of conn=%p expired\n", conn);
+			if (!PQcancel(cancel, errbuf, sizeof(errbuf)))
+				MYLOG(0, "PQcancel failed:%s\n", errbuf);
+			PQfreeCancel(cancel);
+			pthread_mutex_lock(&qtimer_cs);
+			qtimer_sending = NULL;
+			pthread_cond_broadcast(&qtimer_sent_cond);
+			continue;
+		}
+		if (0 == next)
+			pthread_cond_wait(&qtimer_cond, &qtimer_cs);
+		else
+		{
+			ts.tv_sec = (time_t) (next / 1000000);
+			ts.tv_nsec = (long) (next % 1000000) * 1000;
+			pthread_cond_timedwait(&qtimer_cond, &qtimer_cs, &ts);
+		}
+	}
+	pthread_mutex_unlock(&qtimer_cs);
+
+	return NULL;
+}
+
+static void
+qtimer_atfork_child(void)
+{
+	/* the thread doesn't exist in the child */
+	pthread_mutex_init(&qtimer_cs, NULL);
+	qtimer_init_cond();
+	pthread_cond_init(&qtimer_sent_cond, NULL);
+	qtimer_started = FALSE;
+	qtimer_list = NULL;
+	qtimer_sending = NULL;
+}
+#endif /* CLIENT_QUERY_TIMER */
+
+/*
+ *	Stop the timer thread and wait for it. Called when the driver is
+ *	unloaded.
+ */
+void
+FinalizeQueryTimer(void)
+{
+#ifdef	CLIENT_QUERY_TIMER
+	BOOL	started;
+
+	pthread_mutex_lock(&qtimer_cs);
+	started = qtimer_started;
+	qtimer_stopping = TRUE;
+	if (started)
+		pthread_cond_signal(&qtimer_cond);
+	pthread_mutex_unlock(&qtimer_cs);
+	if (started)
+		pthread_join(qtimer_thread, NULL);
+	qtimer_started = FALSE;
+	if (qtimer_cond_ready)
+		pthread_cond_destroy(&qtimer_cond);
+	qtimer_cond_ready = FALSE;
+#endif /* CLIENT_QUERY_TIMER */
+}
+
+/*
+ *	Arm the timer which cancels the query of the connection after
+ *	timeout seconds. Returns FALSE if there's no timer available, in
+ *	which case the caller should use statement_timeout instead.
+ */
+BOOL
+CC_start_query_timer(ConnectionClass *self, SQLULEN timeout)
+{
+#ifdef	CLIENT_QUERY_TIMER
+	static BOOL	atfork_set = FALSE;
+	BOOL	ret = FALSE;
+
+	if (!self->pqconn)
+		return FALSE;
+	if (QTIMER_IDLE != self->qtimer_state)
+		CC_stop_query_timer(self);
+	pthread_mutex_lock(&qtimer_cs);
+	if (qtimer_stopping)
+		goto cleanup;
+	if (!qtimer_started)
+	{
+		if (!atfork_set)
+		{
+			pthread_atfork(NULL, NULL, qtimer_atfork_child);
+			atfork_set = TRUE;
+		}
+		if (!qtimer_cond_ready)
+			qtimer_init_cond();
+		if (0 != pthread_create(&qtimer_thread, NULL, qtimer_main, NULL))
+			goto cleanup;
+		qtimer_started = TRUE;
+	}
+	if (self->qtimer_cancel = PQgetCancel(self->pqconn), NULL == self->qtimer_cancel)
+		goto cleanup;
+	self->qtimer_deadline = qtimer_clock() + (Int8) timeout * 1000000;
+	self->qtimer_state = QTIMER_ARMED;
+	self->qtimer_next = qtimer_list;
+	qtimer_list = self;
+	pthread_cond_signal(&qtimer_cond);
+	ret = TRUE;
+cleanup:
+	pthread_mutex_unlock(&qtimer_cs);
+
+	return ret;
+#else
+	return FALSE;
+#endif /* CLIENT_QUERY_TIMER */
+}
+
+/*
+ *	Disarm the timer of the connection. Returns TRUE if it has expired
+ *	and the query has been requested to cancel.
+ */
+BOOL
+CC_stop_query_timer(ConnectionClass *self)
+{
+#ifdef	CLIENT_QUERY_TIMER
+	ConnectionClass	**prev;
+	PGcancel	*cancel;
+	BOOL	expired;
+
+	if (QTIMER_IDLE == self->qtimer_state)
+		return FALSE;
+	pthread_mutex_lock(&qtimer_cs);
+	if (QTIMER_ARMED == self->qtimer_state)
+	{
+		for (prev = &qtimer_list; NULL != *prev; prev = &(*prev)->qtimer_next)
+		{
+			if (self == *prev)
+			{
+				*prev = self->qtimer_next;
+				break;
+			}
+		}
+	}
+	/* the cancel request may be on the way */
+	while (self == qtimer_sending)
+		pthread_cond_wait(&qtimer_sent_cond, &qtimer_cs);
+	expired = (QTIMER_FIRED == self->qtimer_state);
+	self->qtimer_state = QTIMER_IDLE;
+	cancel = (PGcancel *) self->qtimer_cancel;	/* NULL if it has been sent */
+	self->qtimer_cancel = NULL;
+	pthread_mutex_unlock(&qtimer_cs);
+	if (NULL != cancel)
+		PQfreeCancel(cancel);
+
+	return expired;
+#else
+	return FALSE;
+#endif /* CLIENT_QUERY_TIMER */
+}
+
 const char *CurrCat(const ConnectionClass *conn)
 {
 	/*
@@ -3522,16 +4518,26 @@ PgDtc_isolate(void *self, DWORD option)
 	if (0 == (useAnotherRoom & option))
 	{
 		HENV	henv = sconn->henv;
+		BOOL	registered;
 
 		CC_cleanup(sconn, TRUE);
+		/* CC_initialize() clears the links of the connection registry */
+		registered = (NULL != henv && EN_remove_connection((EnvironmentClass *) henv, sconn));
 		if (newconn = CC_Copy(sconn), NULL == newconn)
+		{
+			if (registered)
+				EN_add_connection((EnvironmentClass *) henv, sconn);
 			return newconn;
+		}
 		MYLOG(0, "newconn=%p from %p\n", newconn, sconn);
 		CC_initialize(sconn, FALSE);
 		if (!disposingConn)
 			CC_copy_conninfo(&sconn->connInfo, &newconn->connInfo);
 		CC_initialize_pg_version(sconn);
-		sconn->henv = henv;
+		if (registered)
+			EN_add_connection((EnvironmentClass *) henv, sconn);
+		else
+			sconn->henv = henv;
 		newconn->henv = NULL;
 		SYNC_AUTOCOMMIT(sconn);
 		return newconn;
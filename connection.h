@@ -71,6 +71,8 @@ typedef enum
 
 #define CONN_OPTION_NOT_FOR_THE_DRIVER					216
 #define CONN_EXEC_ERROR							217
+#define CONN_INVALID_BUFFER_LENGTH					218
+#define CONN_SEQUENCE_ERROR						219
 
 /* Conn_status defines */
 #define CONN_IN_AUTOCOMMIT		1L
@@ -199,6 +201,16 @@ do { \
 	} \
 } while (0)
 
+/*
+ *	The query timeout (SQL_ATTR_QUERY_TIMEOUT) is implemented with a
+ *	timer thread, which sends a cancel request when the timeout expires,
+ *	so that the statement_timeout of the session needn't be changed each
+ *	time statements with different timeouts are executed.
+ */
+#ifdef	POSIX_MULTITHREAD_SUPPORT
+#define	CLIENT_QUERY_TIMER
+#endif /* POSIX_MULTITHREAD_SUPPORT */
+
 /*
  *	Macros to compare the server's version with a specified version
  *		1st parameter: pointer to a ConnectionClass object
@@ -258,6 +270,36 @@ enum {
 }
 #define col_info_initialize(coli) (memset(coli, 0, sizeof(COL_INFO)))
 
+/*	This is used to store the catalog information of a whole schema */
+enum {
+	CATSNAP_COLUMNS = 0
+	,CATSNAP_RELATIONS
+	,CATSNAP_INDEXES
+	,CATSNAP_PRIMARY_KEYS
+	,CATSNAP_OLD_PRIMARY_KEYS
+	,NUM_OF_CATSNAP_KINDS
+};
+struct cat_snapshot
+{
+	CAT_SNAPSHOT	*next;
+	pgNAME		schema_name;
+	QResultClass	*result[NUM_OF_CATSNAP_KINDS];
+};
+
+/*	This is used to store the description of an unnamed statement */
+struct desc_cache
+{
+	DESC_CACHE	*next;		/* the most recently used first */
+	UInt4		hash;		/* of the query text */
+	char		*query;
+	char		*search_path;	/* as reported by the server, or NULL */
+	Int2		num_types;	/* parameter types sent with the Parse */
+	Oid		*types;
+	Int2		num_params;	/* parameter types described */
+	Oid		*param_types;
+	ColumnInfoClass	*fields;
+};
+
  /* Translation DLL entry points */
 #ifdef WIN32
 #define DLLHANDLE HINSTANCE
@@ -279,6 +321,9 @@ struct ConnectionClass_
 {
 	HENV		henv;		/* environment this connection was
 					 * created on */
+	ConnectionClass	*next_registered;	/* links in the shard of the */
+	ConnectionClass	*prev_registered;	/* connection registry */
+	int		registry_pins;	/* see EN_get_connections() */
 	SQLUINTEGER	login_timeout;
 	signed char	autocommit_public;
 	StatementOptions stmtOptions;
@@ -291,12 +336,17 @@ struct ConnectionClass_
 	ConnInfo	connInfo;
 	StatementClass	**stmts;
 	Int2		num_stmts;
+	StatementClass	*stmt_pool;	/* dropped statements kept for reuse */
+	Int4		num_pooled_stmts;
 	Int2		ncursors;
 	PGconn	   *pqconn;
 	Int4		lobj_type;
 	Int2		coli_allocated;
 	Int2		ntables;
 	COL_INFO	**col_info;
+	CAT_SNAPSHOT	*cat_snapshot;	/* catalog snapshots per schema */
+	DESC_CACHE	*desc_cache;	/* descriptions of unnamed statements */
+	Int4		num_desc_cache;
 	long		translation_option;
 	HINSTANCE	translation_handle;
 	DataSourceToDriverProc DataSourceToDriver;
@@ -342,6 +392,18 @@ struct ConnectionClass_
 	pgNAME		schemaIns;
 	pgNAME		tableIns;
 	SQLULEN		stmt_timeout_in_effect;
+	PerfCounters	perf;
+	char		perf_timing;	/* measure the conversion and round trip time ? */
+	UInt4		trace_id;	/* identifies the connection in the query trace */
+	QResultClass	*readahead_res;	/* result whose read-ahead FETCH is in progress */
+	QResultClass	*portal_res;	/* result whose portal is being read */
+	char		portal_interrupted;	/* a portal had to be read through for another request */
+#ifdef	CLIENT_QUERY_TIMER
+	char		qtimer_state;	/* QTIMER_IDLE, QTIMER_ARMED or QTIMER_FIRED */
+	Int8		qtimer_deadline;
+	void		*qtimer_cancel;	/* PGcancel to send at the deadline */
+	ConnectionClass	*qtimer_next;	/* in the list of armed timers */
+#endif /* CLIENT_QUERY_TIMER */
 #if defined(WIN_MULTITHREAD_SUPPORT)
 	CRITICAL_SECTION	cs;
 	CRITICAL_SECTION	slock;
@@ -358,6 +420,8 @@ struct ConnectionClass_
 
 /* Accessor functions */
 #define CC_get_env(x)				((x)->henv)
+/* The start time of a timed operation, 0 unless timing or tracing */
+#define CC_perf_clock(x)	(((x)->perf_timing || get_qtrace()) ? qtrace_clock() : 0)
 #define CC_get_database(x)			(x->connInfo.database)
 #define CC_get_server(x)			(x->connInfo.server)
 #define CC_get_DSN(x)				(x->connInfo.dsn)
@@ -426,15 +490,34 @@ void		handle_pgres_error(ConnectionClass *self, const PGresult *pgres,
 				   QResultClass *res, BOOL error_not_a_notice);
 void		CC_clear_error(ConnectionClass *self);
 int		CC_send_function(ConnectionClass *conn, const char *fn_name, void *result_buf, int *actual_result_len, int result_is_int, LO_ARG *argv, int nargs);
+QResultClass	*CC_send_tid_lookup(ConnectionClass *self, StatementClass *stmt, UDWORD flag, const char *plan_name, const char *query, BOOL *prepared, const UInt4 *blocks, const UInt2 *offsets, int nkeys);
 char		CC_send_settings(ConnectionClass *self, const char *set_query);
 void		CC_initialize_pg_version(ConnectionClass *conn);
 void		CC_log_error(const char *func, const char *desc, const ConnectionClass *self);
 int			CC_send_cancel_request(const ConnectionClass *conn);
+BOOL		CC_start_query_timer(ConnectionClass *self, SQLULEN timeout);
+BOOL		CC_stop_query_timer(ConnectionClass *self);
+void		FinalizeQueryTimer(void);
 void		CC_on_commit(ConnectionClass *conn);
 void		CC_on_abort(ConnectionClass *conn, unsigned int opt);
 void		CC_on_abort_partial(ConnectionClass *conn);
 void		ProcessRollback(ConnectionClass *conn, BOOL undo, BOOL partial);
 const char	*CC_get_current_schema(ConnectionClass *conn);
+void		CC_clear_cat_snapshot(ConnectionClass *self);
+void		CC_clear_desc_cache(ConnectionClass *self);
+BOOL		cmdtag_invalidates_catalog(const char *cmdtag);
+const DESC_CACHE *CC_lookup_desc_cache(ConnectionClass *self, const char *query, Int2 num_types, const Oid *types);
+void		CC_add_desc_cache(ConnectionClass *self, const char *query, Int2 num_types, const Oid *types, const PGresult *pgres, const ColumnInfoClass *fields);
+BOOL		CC_send_readahead(ConnectionClass *self, QResultClass *res, const char *query);
+void		CC_finish_readahead(ConnectionClass *self);
+void		CC_discard_readahead(ConnectionClass *self, QResultClass *res);
+BOOL		CC_get_readahead(ConnectionClass *self, QResultClass *res, StatementClass *stmt);
+void		CC_start_portal(ConnectionClass *self, QResultClass *res, Int4 fetch_size);
+void		CC_end_portal_block(ConnectionClass *self, const PGresult *pgres);
+BOOL		CC_fetch_portal(ConnectionClass *self, QResultClass *res, StatementClass *stmt, Int4 fetch_size);
+void		CC_finish_portal(ConnectionClass *self);
+void		CC_discard_portal(ConnectionClass *self);
+void		CC_close_portal(ConnectionClass *self, QResultClass *res);
 int             CC_mark_a_object_to_discard(ConnectionClass *conn, int type, const char *plan);
 int             CC_discard_marked_objects(ConnectionClass *conn);
 
@@ -516,6 +599,7 @@ enum {
 	,INTERNAL_ROLLBACK_OPERATION
 };
 int	GenerateSvpCommand(ConnectionClass *conn, int type, char *cmd, int bufsize);
+const char	*GetSvpName(const ConnectionClass *conn, char *wrk, int wrksize);
 
 /*      Operations in progress */
 enum {
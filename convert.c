@@ -913,11 +913,142 @@ get_adjust_len(SQLSMALLINT fCType, SQLLEN len)
 #define	BYTEA_PROCESS_ESCAPE	1
 #define	BYTEA_PROCESS_BINARY	2
 
+/*
+ *	Convert the next piece of a value which SQLGetData returns piece by
+ *	piece (see setup_getdataclass()) directly into the application buffer.
+ *	The conversion resumes from pgdc->src_offset in the value and fills
+ *	buflen bytes, or less at the end of the value. A CR/LF or a surrogate
+ *	pair at the end of the buffer is split, as it is when ttlbuf is used.
+ *
+ *	Returns the length of the output.
+ */
+static SQLLEN
+convert_getdata_piece(GetDataClass * const pgdc, const char * const value,
+	const BOOL lf_conv, char * const buf, const SQLLEN buflen)
+{
+	const UCHAR *src = (const UCHAR *) value + pgdc->src_offset;
+	SQLLEN	i = 0, out = 0;
+
+	if (buflen <= 0)
+		return 0;
+	switch (pgdc->piece_kind)
+	{
+		case GETDATA_PIECE_TEXT:
+			if (!lf_conv)
+			{
+				memcpy(buf, src, buflen);
+				i = out = buflen;
+				break;
+			}
+			if (pgdc->piece_split)	/* the CR was already returned */
+			{
+				buf[out++] = src[i++];
+				pgdc->piece_split = 0;
+			}
+			for (; out < buflen && src[i]; i++)
+			{
+				if (PG_LINEFEED == src[i] &&
+				    (pgdc->src_offset + i == 0 || PG_CARRIAGE_RETURN != src[i - 1]))
+				{
+					if (out + 2 > buflen)
+					{
+						/* return the LF in the next piece */
+						buf[out++] = PG_CARRIAGE_RETURN;
+						pgdc->piece_split = 1;
+						break;
+					}
+					buf[out++] = PG_CARRIAGE_RETURN;
+				}
+				buf[out++] = src[i];
+			}
+			break;
+#ifdef	UNICODE_SUPPORT
+		case GETDATA_PIECE_WCHAR:
+		{
+			SQLWCHAR   *wbuf = (SQLWCHAR *) buf;
+			SQLWCHAR	wpair[2];
+			SQLLEN		wcount = buflen / WCLEN, wc, n, clen, wlen;
+
+			if (0 == wcount)
+				break;
+			if (pgdc->piece_split)	/* the 1st half was already returned */
+			{
+				clen = (0 == (*src & 0x80)) ? 1 : 4;
+				utf8_to_ucs2_lf((const char *) src, clen, lf_conv, wpair, 2, FALSE);
+				wbuf[out++] = wpair[1];
+				i = clen;
+				pgdc->piece_split = 0;
+			}
+			/* find out how much of the input fits */
+			for (wc = out, n = i; src[n]; wc += wlen, n += clen)
+			{
+				wlen = 1;
+				if (0 == (src[n] & 0x80))
+				{
+					clen = 1;
+					if (lf_conv && PG_LINEFEED == src[n] &&
+					    (pgdc->src_offset + n == 0 || PG_CARRIAGE_RETURN != src[n - 1]))
+						wlen = 2;
+				}
+				else if (0xf0 == (src[n] & 0xf8))
+				{
+					clen = 4;
+					wlen = 2;	/* surrogate pair */
+				}
+				else if (0xe0 == (src[n] & 0xf0))
+					clen = 3;
+				else
+					clen = 2;
+				if (wc + wlen > wcount)
+					break;
+			}
+			/* utf8_to_ucs2_lf() doesn't know the character before the input */
+			if (i < n && lf_conv && PG_LINEFEED == src[i] &&
+			    pgdc->src_offset + i > 0 && PG_CARRIAGE_RETURN == src[i - 1])
+				wbuf[out++] = src[i++];
+			if (i < n)
+				out += utf8_to_ucs2_lf((const char *) src + i, n - i, lf_conv, wbuf + out, wc - out, FALSE);
+			i = n;
+			if (out < wcount && src[i])
+			{
+				/*
+				 * The surrogate pair or the CR/LF doesn't fit. Return the
+				 * 1st half now and the rest in the next piece.
+				 */
+				clen = (0 == (src[i] & 0x80)) ? 1 : 4;
+				utf8_to_ucs2_lf((const char *) src + i, clen, lf_conv, wpair, 2, FALSE);
+				wbuf[out++] = wpair[0];
+				pgdc->piece_split = 1;
+			}
+			out *= WCLEN;
+			break;
+		}
+#endif /* UNICODE_SUPPORT */
+		case GETDATA_PIECE_HEX2BIN:
+		{
+			char	lastbyte[2];
+
+			/* pg_hex2bin() appends a null terminator */
+			if (buflen > 1)
+				pg_hex2bin((const char *) src, buf, (buflen - 1) * 2);
+			pg_hex2bin((const char *) src + (buflen - 1) * 2, lastbyte, 2);
+			buf[buflen - 1] = lastbyte[0];
+			out = buflen;
+			i = 2 * buflen;
+			break;
+		}
+	}
+	pgdc->src_offset += i;
+
+	return out;
+}
+
 static int
 setup_getdataclass(SQLLEN * const length_return, const char ** const ptr_return,
 	int *needbuflen_return, GetDataClass * const pgdc, const char *neut_str,
 	const OID field_type, const SQLSMALLINT fCType,
-	const SQLLEN cbValueMax, const ConnectionClass * const conn)
+	const SQLLEN cbValueMax, const BOOL piecewise,
+	const ConnectionClass * const conn)
 {
 	SQLLEN len = (-2);
 	const char *ptr = NULL;
@@ -929,6 +1060,8 @@ setup_getdataclass(SQLLEN * const length_return, const char ** const ptr_return,
 	BOOL	already_processed = FALSE;
 	BOOL	changed = FALSE;
 	int	len_for_wcs_term = 0;
+	SQLLEN	src_offset = 0;
+	BOOL	as_it_is = TRUE;
 
 #ifdef	UNICODE_SUPPORT
 	char	*allocbuf = NULL;
@@ -937,12 +1070,17 @@ setup_getdataclass(SQLLEN * const length_return, const char ** const ptr_return,
 	BOOL	hybrid = FALSE;
 #endif /* UNICODE_SUPPORT */
 
+	pgdc->piece_kind = GETDATA_PIECE_NONE;
+	pgdc->piece_split = 0;
 	if (PG_TYPE_BYTEA == field_type)
 	{
 		if (SQL_C_BINARY == fCType)
 			bytea_process_kind = BYTEA_PROCESS_BINARY;
 		else if (0 == strnicmp(neut_str, "\\x", 2)) /* hex format */
+		{
 			neut_str += 2;
+			src_offset = 2;
+		}
 		else
 			bytea_process_kind = BYTEA_PROCESS_ESCAPE;
 	}
@@ -970,7 +1108,7 @@ setup_getdataclass(SQLLEN * const length_return, const char ** const ptr_return,
 					if (SQL_C_WCHAR == fCType)
 						hybrid = (!is_utf8 || (same_encoding && wcs_debug));
 			}
-			MYLOG(0, "localize=%d hybrid=%d is_utf8=%d same_encoding=%d wcs_debug=%d\n", localize_needed, hybrid, is_utf8, same_encoding, wcs_debug);
+			MYLOG(TUPLE_LOG_LEVEL, "localize=%d hybrid=%d is_utf8=%d same_encoding=%d wcs_debug=%d\n", localize_needed, hybrid, is_utf8, same_encoding, wcs_debug);
 		}
 	}
 	if (fCType == SQL_C_WCHAR)
@@ -979,7 +1117,7 @@ setup_getdataclass(SQLLEN * const length_return, const char ** const ptr_return,
 			unicode_count = convert_from_pgbinary(neut_str, NULL, 0) * 2;
 		else if (hybrid)
 		{
-			MYLOG(0, "hybrid estimate\n");
+			MYLOG(TUPLE_LOG_LEVEL, "hybrid estimate\n");
 			if ((unicode_count = bindcol_hybrid_estimate(neut_str, lf_conv, &allocbuf)) < 0)
 			{
 				result = COPY_INVALID_STRING_CONVERSION;
@@ -988,7 +1126,18 @@ setup_getdataclass(SQLLEN * const length_return, const char ** const ptr_return,
 		}
 		else	/* normally */
 		{
-			unicode_count = utf8_to_ucs2_lf(neut_str, SQL_NTS, lf_conv, NULL, 0, FALSE);
+			/*
+			 * The pieces converted by convert_getdata_piece() rely on
+			 * the encoding check. If the value isn't valid UTF-8,
+			 * measure it as the whole value conversion does and take
+			 * that path.
+			 */
+			unicode_count = utf8_to_ucs2_lf(neut_str, SQL_NTS, lf_conv, NULL, 0, piecewise);
+			if (unicode_count < 0)
+			{
+				unicode_count = utf8_to_ucs2_lf(neut_str, SQL_NTS, lf_conv, NULL, 0, FALSE);
+				as_it_is = FALSE;
+			}
 		}
 		len = WCLEN * unicode_count;
 		already_processed = changed = TRUE;
@@ -1027,6 +1176,38 @@ setup_getdataclass(SQLLEN * const length_return, const char ** const ptr_return,
 	if (!pgdc->ttlbuf)
 		pgdc->ttlbuflen = 0;
 	needbuflen = len + get_terminator_len(fCType);
+#ifdef	UNICODE_SUPPORT
+	if (localize_needed || hybrid)
+		as_it_is = FALSE;
+#endif /* UNICODE_SUPPORT */
+	if (piecewise && as_it_is && needbuflen > cbValueMax)
+	{
+		/*
+		 * SQLGetData returns the value piece by piece. Rather than
+		 * converting the whole value into ttlbuf, convert each piece
+		 * directly into the application buffer when the conversion can
+		 * resume from an offset in the value.
+		 */
+#ifdef	UNICODE_SUPPORT
+		if (SQL_C_WCHAR == fCType)
+		{
+			if (0 == bytea_process_kind)
+				pgdc->piece_kind = GETDATA_PIECE_WCHAR;
+		}
+		else
+#endif /* UNICODE_SUPPORT */
+		if (BYTEA_PROCESS_BINARY == bytea_process_kind)
+		{
+			if (0 == strnicmp(neut_str, "\\x", 2)) /* hex format */
+			{
+				pgdc->piece_kind = GETDATA_PIECE_HEX2BIN;
+				src_offset = 2;
+			}
+		}
+		else if (0 == bytea_process_kind)
+			pgdc->piece_kind = GETDATA_PIECE_TEXT;
+		pgdc->src_offset = src_offset;
+	}
 	if (SQL_C_BINARY == fCType)
 	{
 		/*
@@ -1036,7 +1217,8 @@ setup_getdataclass(SQLLEN * const length_return, const char ** const ptr_return,
 		 */
 		len_for_wcs_term = 1;
 	}
-	if (changed || needbuflen > cbValueMax)
+	if (GETDATA_PIECE_NONE == pgdc->piece_kind &&
+	    (changed || needbuflen > cbValueMax))
 	{
 		if (needbuflen > (SQLLEN) pgdc->ttlbuflen)
 		{
@@ -1059,7 +1241,7 @@ setup_getdataclass(SQLLEN * const length_return, const char ** const ptr_return,
 					utf8_to_ucs2_lf(neut_str, SQL_NTS, lf_conv, (SQLWCHAR *) pgdc->ttlbuf, unicode_count, FALSE);
 				else /* hybrid */
 				{
-					MYLOG(0, "hybrid convert\n");
+					MYLOG(TUPLE_LOG_LEVEL, "hybrid convert\n");
 					if (bindcol_hybrid_exec((SQLWCHAR *) pgdc->ttlbuf, neut_str, unicode_count + 1, lf_conv, &allocbuf) < 0)
 					{
 						result = COPY_INVALID_STRING_CONVERSION;
@@ -1138,7 +1320,7 @@ convert_text_field_to_sql_c(GetDataInfo * const gdata, const int current_col,
 	int	copy_len = 0, needbuflen = 0, i;
 	const char	*ptr;
 
-	MYLOG(0, "field_type=%u type=%d\n", field_type, fCType);
+	MYLOG(TUPLE_LOG_LEVEL, "field_type=%u type=%d\n", field_type, fCType);
 
 	switch (field_type)
 	{
@@ -1160,20 +1342,36 @@ convert_text_field_to_sql_c(GetDataInfo * const gdata, const int current_col,
 	{
 		if (COPY_OK != (result = setup_getdataclass(&len, &ptr,
 				&needbuflen, pgdc, neut_str, field_type,
-				fCType, cbValueMax, conn)))
+				fCType, cbValueMax, current_col >= 0, conn)))
 			goto cleanup;
 	}
+	else if (GETDATA_PIECE_NONE != pgdc->piece_kind)
+	{
+		ptr = NULL;
+		len = pgdc->data_left;
+	}
 	else
 	{
 		ptr = pgdc->ttlbuf;
 		len = pgdc->ttlbufused;
 	}
 
-	MYLOG(0, "DEFAULT: len = " FORMAT_LEN ", ptr = '%.*s'\n", len, (int) len, ptr);
+	if (GETDATA_PIECE_NONE != pgdc->piece_kind)
+		MYLOG(TUPLE_LOG_LEVEL, "DEFAULT: len = " FORMAT_LEN ", converted piecewise from offset " FORMAT_LEN "\n", len, pgdc->src_offset);
+	else
+		MYLOG(TUPLE_LOG_LEVEL, "DEFAULT: len = " FORMAT_LEN ", ptr = '%.*s'\n", len, (int) len, ptr);
 
 	if (current_col >= 0)
 	{
-		if (pgdc->data_left > 0)
+		if (GETDATA_PIECE_NONE != pgdc->piece_kind)
+		{
+			if (pgdc->data_left > 0)
+				len = pgdc->data_left;
+			else
+				pgdc->data_left = len;
+			needbuflen = len + get_terminator_len(fCType);
+		}
+		else if (pgdc->data_left > 0)
 		{
 			ptr += (len - pgdc->data_left);
 			len = pgdc->data_left;
@@ -1199,7 +1397,9 @@ convert_text_field_to_sql_c(GetDataInfo * const gdata, const int current_col,
 		if (!already_copied)
 		{
 			/* Copy the data */
-			if (copy_len > 0)
+			if (GETDATA_PIECE_NONE != pgdc->piece_kind)
+				copy_len = convert_getdata_piece(pgdc, neut_str, conn->connInfo.lf_conversion, rgbValueBindRow, copy_len);
+			else if (copy_len > 0)
 				memcpy(rgbValueBindRow, ptr, copy_len);
 			/* Add null terminator */
 			for (i = 0; i < terminatorlen && copy_len + i < cbValueMax; i++)
@@ -1227,13 +1427,13 @@ convert_text_field_to_sql_c(GetDataInfo * const gdata, const int current_col,
 
 #ifdef	UNICODE_SUPPORT
 	if (SQL_C_WCHAR == fCType)
-		MYLOG(0, "    SQL_C_WCHAR, default: len = " FORMAT_LEN ", cbValueMax = " FORMAT_LEN ", rgbValueBindRow = '%s'\n", len, cbValueMax, rgbValueBindRow);
+		MYLOG(TUPLE_LOG_LEVEL, "    SQL_C_WCHAR, default: len = " FORMAT_LEN ", cbValueMax = " FORMAT_LEN ", rgbValueBindRow = '%s'\n", len, cbValueMax, rgbValueBindRow);
 	else
 #endif /* UNICODE_SUPPORT */
 	if (SQL_C_BINARY == fCType)
-		MYLOG(0, "    SQL_C_BINARY, default: len = " FORMAT_LEN ", cbValueMax = " FORMAT_LEN ", rgbValueBindRow = '%.*s'\n", len, cbValueMax, copy_len, rgbValueBindRow);
+		MYLOG(TUPLE_LOG_LEVEL, "    SQL_C_BINARY, default: len = " FORMAT_LEN ", cbValueMax = " FORMAT_LEN ", rgbValueBindRow = '%.*s'\n", len, cbValueMax, copy_len, rgbValueBindRow);
 	else
-		MYLOG(0, "    SQL_C_CHAR, default: len = " FORMAT_LEN ", cbValueMax = " FORMAT_LEN ", rgbValueBindRow = '%s'\n", len, cbValueMax, rgbValueBindRow);
+		MYLOG(TUPLE_LOG_LEVEL, "    SQL_C_CHAR, default: len = " FORMAT_LEN ", cbValueMax = " FORMAT_LEN ", rgbValueBindRow = '%s'\n", len, cbValueMax, rgbValueBindRow);
 
 cleanup:
 	*length_return = len;
@@ -1241,9 +1441,8 @@ cleanup:
 	return result;
 }
 
-/*	This is called by SQLGetData() */
-int
-copy_and_convert_field(StatementClass *stmt,
+static int
+convert_field_value(StatementClass *stmt,
 		OID field_type, int atttypmod,
 		void *valuei,
 		SQLSMALLINT fCType, int precision,
@@ -1326,11 +1525,11 @@ copy_and_convert_field(StatementClass *stmt,
 
 	memset(&std_time, 0, sizeof(SIMPLE_TIME));
 
-	MYLOG(0, "field_type = %d, fctype = %d, value = '%s', cbValueMax=" FORMAT_LEN "\n", field_type, fCType, (value == NULL) ? "<NULL>" : value, cbValueMax);
+	MYLOG(TUPLE_LOG_LEVEL, "field_type = %d, fctype = %d, value = '%s', cbValueMax=" FORMAT_LEN "\n", field_type, fCType, (value == NULL) ? "<NULL>" : value, cbValueMax);
 
 	if (!value)
 	{
-MYLOG(0, "null_cvt_date_string=%d\n", conn->connInfo.cvt_null_date_string);
+MYLOG(TUPLE_LOG_LEVEL, "null_cvt_date_string=%d\n", conn->connInfo.cvt_null_date_string);
 		/* a speicial handling for FOXPRO NULL -> NULL_STRING */
 		if (conn->connInfo.cvt_null_date_string > 0 &&
 		    (PG_TYPE_DATE == field_type ||
@@ -1527,12 +1726,12 @@ MYLOG(DETAIL_LOG_LEVEL, "2stime fr=%d\n", std_time.fr);
 					maxc = (int) cbValueMax / sizeof(short);
 				vp = value;
 				nval = 0;
-				MYLOG(0, "index=(");
+				MYLOG(TUPLE_LOG_LEVEL, "index=(");
 				for (i = 0;; i++)
 				{
 					if (sscanf(vp, "%hi", &shortv) != 1)
 						break;
-					MYPRINTF(0, " %hi", shortv);
+					MYPRINTF(TUPLE_LOG_LEVEL, " %hi", shortv);
 					nval++;
 					if (nval < maxc)
 						short_array[i + 1] = shortv;
@@ -1546,7 +1745,7 @@ MYLOG(DETAIL_LOG_LEVEL, "2stime fr=%d\n", std_time.fr);
 					if (*vp == '\0')
 						break;
 				}
-				MYPRINTF(0, ") nval = %i\n", nval);
+				MYPRINTF(TUPLE_LOG_LEVEL, ") nval = %i\n", nval);
 				if (maxc > 0)
 					short_array[0] = nval;
 
@@ -1592,7 +1791,7 @@ MYLOG(DETAIL_LOG_LEVEL, "2stime fr=%d\n", std_time.fr);
 			fCType = SQL_C_CHAR;
 #endif
 
-		MYLOG(0, ", SQL_C_DEFAULT: fCType = %d\n", fCType);
+		MYLOG(TUPLE_LOG_LEVEL, ", SQL_C_DEFAULT: fCType = %d\n", fCType);
 	}
 
 	text_bin_handling = FALSE;
@@ -1666,7 +1865,7 @@ MYLOG(DETAIL_LOG_LEVEL, "2stime fr=%d\n", std_time.fr);
 				for (i = 0; i < len && i < midsize - 2; i++)
 					midtemp[i] = toupper((UCHAR) neut_str[i]);
 				midtemp[i] = '\0';
-				MYLOG(0, "PG_TYPE_UUID: rgbValueBindRow = '%s'\n", rgbValueBindRow);
+				MYLOG(TUPLE_LOG_LEVEL, "PG_TYPE_UUID: rgbValueBindRow = '%s'\n", rgbValueBindRow);
 				break;
 
 				/*
@@ -1997,6 +2196,31 @@ MYLOG(DETAIL_LOG_LEVEL, "SQL_C_VARBOOKMARK value=%d\n", ival);
 
 }
 
+/*	This is called by SQLGetData() */
+int
+copy_and_convert_field(StatementClass *stmt,
+		OID field_type, int atttypmod,
+		void *valuei,
+		SQLSMALLINT fCType, int precision,
+		PTR rgbValue, SQLLEN cbValueMax,
+		SQLLEN *pcbValue, SQLLEN *pIndicator)
+{
+	ConnectionClass	*conn = SC_get_conn(stmt);
+	Int8	start, elapsed;
+	int	result;
+
+	if (!conn->perf_timing)
+		return convert_field_value(stmt, field_type, atttypmod, valuei, fCType, precision, rgbValue, cbValueMax, pcbValue, pIndicator);
+	start = qtrace_clock();
+	result = convert_field_value(stmt, field_type, atttypmod, valuei, fCType, precision, rgbValue, cbValueMax, pcbValue, pIndicator);
+	elapsed = qtrace_clock() - start;
+	/* added to conn->perf later, see SC_fold_convert_time() */
+	stmt->perf.convert_usec += elapsed;
+	stmt->convert_usec_unfolded += elapsed;
+
+	return result;
+}
+
 
 /*--------------------------------------------------------------------
  *	Functions/Macros to get rid of query size limit.
@@ -2028,6 +2252,9 @@ typedef struct _QueryParse {
 	size_t		declare_pos;
 	UInt4		flags, comment_level;
 	encoded_str	encstr;
+	const QueryToken	*tokens;	/* stmt->tokens if lexed already */
+	Int4		num_tokens, tidx;
+	ssize_t		span_start;	/* where the current comment or dollar quote began */
 }	QueryParse;
 
 static void
@@ -2050,6 +2277,65 @@ QP_initialize(QueryParse *q, const StatementClass *stmt)
 	q->flags = 0;
 	q->comment_level = 0;
 	make_encoded_str(&q->encstr, SC_get_conn(stmt), q->statement);
+	q->tokens = stmt->tokens;
+	q->num_tokens = stmt->num_tokens;
+	q->tidx = 0;
+	q->span_start = -1;
+}
+
+/*
+ *	The comments and dollar quotes need no conversion. Look up the token of
+ *	the one which began at qp->span_start and return the position just past
+ *	it, so that the rest of it can be copied at once. Returns -1 if the
+ *	statement wasn't lexed or the lexer saw it differently.
+ */
+static ssize_t
+QP_span_end(QueryParse *qp, char type)
+{
+	const QueryToken	*tok;
+	ssize_t	span_start = qp->span_start, end;
+
+	/* wait for the opening chars to be processed */
+	if (span_start < 0 || (ssize_t) qp->opos < span_start + 2)
+		return -1;
+	qp->span_start = -1;	/* try only once per span */
+	if (NULL == qp->tokens)
+		return -1;
+	for (; qp->tidx < qp->num_tokens; qp->tidx++)
+	{
+		if (qp->tokens[qp->tidx].pos >= span_start)
+			break;
+	}
+	if (qp->tidx >= qp->num_tokens)
+		return -1;
+	tok = qp->tokens + qp->tidx;
+	if (tok->pos != span_start || tok->type != type)
+		return -1;
+	end = tok->pos + tok->len;
+	if (end <= (ssize_t) qp->opos || end > qp->stmt_len)
+		return -1;
+	/* the unterminated ones are left to the char by char handling */
+	switch (type)
+	{
+		case QTOKEN_DOLLAR_QUOTED:
+			if (tok->len < 2 * qp->taglen ||
+			    strncmp(qp->statement + end - qp->taglen, qp->dollar_tag, qp->taglen) != 0)
+				return -1;
+			break;
+		case QTOKEN_COMMENT:
+			if ('-' == qp->statement[span_start])
+			{
+				if (PG_LINEFEED != qp->statement[end - 1])
+					return -1;
+				break;
+			}
+			if (tok->len < 4 ||
+			    '*' != qp->statement[end - 2] ||
+			    '/' != qp->statement[end - 1])
+				return -1;
+			break;
+	}
+	return end;
 }
 
 enum {
@@ -2105,6 +2391,7 @@ typedef enum
 #define	FLGB_LITERAL_EXTENSION	(1L << 10)
 #define	FLGB_HEX_BIN_FORMAT	(1L << 11)
 #define	FLGB_PARAM_CAST		(1L << 12)
+#define	FLGB_NESTED_BUILD	(1L << 13)
 typedef struct _QueryBuild {
 	char   *query_statement;
 	size_t	str_alsize;
@@ -2131,6 +2418,7 @@ typedef struct _QueryBuild {
 
 	ConnectionClass	*conn; /* mainly needed for LO handling */
 	StatementClass	*stmt; /* needed to set error info in ENLARGE_.. */
+	QueryTemplate	*tmpl; /* the template being built if any */
 }	QueryBuild;
 
 #define INIT_MIN_ALLOC	4096
@@ -2153,6 +2441,7 @@ QB_initialize(QueryBuild *qb, size_t size, StatementClass *stmt, ResolveParamMod
 	qb->num_discard_params = 0;
 	qb->brace_level = 0;
 	qb->parenthesize_the_first = FALSE;
+	qb->tmpl = NULL;
 
 	/* Copy options from statement */
 	qb->apdopts = SC_get_APDF(stmt);
@@ -2203,6 +2492,8 @@ static int
 QB_initialize_copy(QueryBuild *qb_to, const QueryBuild *qb_from, UInt4 size)
 {
 	memcpy(qb_to, qb_from, sizeof(QueryBuild));
+	/* the parameters resolved here don't go to the template directly */
+	qb_to->flags |= FLGB_NESTED_BUILD;
 
 	if ((qb_to->query_statement = malloc(size)) == NULL)
 	{
@@ -2722,8 +3013,9 @@ prepareParametersNoDesc(StatementClass *stmt, BOOL fake_params, BOOL param_cast)
 	ConnectionClass *conn = SC_get_conn(stmt);
 	char		plan_name[32];
 	po_ind_t	multi;
-	const char	*orgquery = NULL, *srvquery = NULL;
-	ssize_t		endp1, endp2;
+	const char	*srvquery = NULL;
+	Int4		tidx = 0;
+	ssize_t		endp2;
 	SQLSMALLINT	num_pa = 0, num_p1, num_p2;
 	ProcessedStmt *pstmt;
 	ProcessedStmt *last_pstmt;
@@ -2731,6 +3023,11 @@ prepareParametersNoDesc(StatementClass *stmt, BOOL fake_params, BOOL param_cast)
 	QueryBuild	query_crt, *qb;
 
 MYLOG(DETAIL_LOG_LEVEL, "entering\n");
+	if (!SC_lex_statement(stmt))
+	{
+		SC_set_errornumber(stmt, STMT_NO_MEMORY_ERROR);
+		return SQL_ERROR;
+	}
 	qp = &query_org;
 	QP_initialize(qp, stmt);
 	qb = &query_crt;
@@ -2764,12 +3061,12 @@ MYLOG(DETAIL_LOG_LEVEL, "entering\n");
 
 	stmt->current_exec_param = 0;
 	multi = stmt->multi_statement;
-	orgquery = stmt->statement;
 	srvquery = qb->query_statement;
 
-	SC_scanQueryAndCountParams(orgquery, conn, &endp1, &num_p1, &multi, NULL);
+	/* the original statement has been lexed already */
+	SC_scan_statement_tokens(stmt, &tidx, &num_p1, &multi, NULL);
 	SC_scanQueryAndCountParams(srvquery, conn, &endp2, NULL, NULL, NULL);
-	MYLOG(0, "parsed for the first command length=" FORMAT_SSIZE_T "(" FORMAT_SSIZE_T ") num_p=%d\n", endp2, endp1, num_p1);
+	MYLOG(0, "parsed for the first command length=" FORMAT_SSIZE_T "(token %d) num_p=%d\n", endp2, tidx, num_p1);
 	pstmt = buildProcessedStmt(srvquery,
 							   endp2 < 0 ? SQL_NTS : endp2,
 							   fake_params ? 0 : num_p1);
@@ -2781,12 +3078,11 @@ MYLOG(DETAIL_LOG_LEVEL, "entering\n");
 	stmt->processed_statements = last_pstmt = pstmt;
 	while (multi > 0)
 	{
-		orgquery += (endp1 + 1);
 		srvquery += (endp2 + 1);
 		num_pa += num_p1;
-		SC_scanQueryAndCountParams(orgquery, conn, &endp1, &num_p1, &multi, NULL);
+		SC_scan_statement_tokens(stmt, &tidx, &num_p1, &multi, NULL);
 		SC_scanQueryAndCountParams(srvquery, conn, &endp2, &num_p2, NULL, NULL);
-		MYLOG(0, "parsed for the subsequent command length=" FORMAT_SSIZE_T "(" FORMAT_SSIZE_T ") num_p=%d\n", endp2, endp1, num_p1);
+		MYLOG(0, "parsed for the subsequent command length=" FORMAT_SSIZE_T "(token %d) num_p=%d\n", endp2, tidx, num_p1);
 		pstmt = buildProcessedStmt(srvquery,
 								   endp2 < 0 ? SQL_NTS : endp2,
 								   fake_params ? 0 : num_p1);
@@ -2899,6 +3195,159 @@ MYLOG(DETAIL_LOG_LEVEL, "calling prepareParameters\n");
 	return desc_params_and_sync(stmt);
 }
 
+/*
+ *	QueryTemplate functions
+ *
+ *	The first conversion of a statement records where the parameter values
+ *	went (QT_add_slot) and keeps the rest of the text (QT_finish). The next
+ *	executions only resolve the parameters and put them between the pieces
+ *	(QT_build_query), as long as the statement is converted in the same
+ *	state.
+ */
+static QueryTemplate *
+QT_create(UInt4 qb_flags)
+{
+	QueryTemplate	*tmpl;
+
+	if (NULL == (tmpl = (QueryTemplate *) calloc(1, sizeof(QueryTemplate))))
+		return NULL;
+	tmpl->valid = TRUE;
+	tmpl->qb_flags = qb_flags;
+
+	return tmpl;
+}
+
+/*
+ * Record the value of a parameter just resolved from npos in the buffer.
+ * The text isn't reusable if resolving it changed the text before it or
+ * skipped the original statement.
+ */
+static void
+QT_add_slot(QueryTemplate *tmpl, const QueryBuild *qb, const QueryParse *qp,
+			RETCODE ret, size_t npos, size_t opos)
+{
+	QueryTemplateSlot	*slot;
+
+	if (!tmpl->valid)
+		return;
+	if (SQL_SUCCESS != ret ||
+	    0 != (qb->flags & FLGB_NESTED_BUILD) ||
+	    qb->npos < npos ||
+	    qp->opos != opos)
+	{
+		tmpl->valid = FALSE;
+		return;
+	}
+	if (tmpl->num_slots >= tmpl->alloc_slots)
+	{
+		Int2	alloc_slots = tmpl->alloc_slots > 0 ? tmpl->alloc_slots * 2 : 8;
+
+		if (alloc_slots <= tmpl->alloc_slots ||
+		    NULL == (slot = (QueryTemplateSlot *) realloc(tmpl->slots, sizeof(QueryTemplateSlot) * alloc_slots)))
+		{
+			tmpl->valid = FALSE;
+			return;
+		}
+		tmpl->slots = slot;
+		tmpl->alloc_slots = alloc_slots;
+	}
+	slot = tmpl->slots + tmpl->num_slots++;
+	slot->pos = npos;
+	slot->opos = opos;
+	slot->len = qb->npos - npos;
+}
+
+/*
+ * Cut the parameter values out of the converted statement.
+ */
+static BOOL
+QT_finish(QueryTemplate *tmpl, const QueryBuild *qb)
+{
+	size_t	prev = 0, textlen = 0, len;
+	Int2	i;
+
+	for (i = 0; i < tmpl->num_slots; i++)
+		textlen += tmpl->slots[i].len;
+	textlen = qb->npos - textlen;
+	if (NULL == (tmpl->text = malloc(textlen + 1)))
+		return FALSE;
+	for (i = 0; i < tmpl->num_slots; i++)
+	{
+		QueryTemplateSlot	*slot = tmpl->slots + i;
+
+		len = slot->pos - prev;
+		memcpy(tmpl->text + tmpl->textlen, qb->query_statement + prev, len);
+		prev = slot->pos + slot->len;
+		slot->pos = (tmpl->textlen += len);
+	}
+	memcpy(tmpl->text + tmpl->textlen, qb->query_statement + prev, qb->npos - prev);
+	tmpl->textlen += (qb->npos - prev);
+	tmpl->text[tmpl->textlen] = '\0';
+
+	return TRUE;
+}
+
+/*
+ * The size of the statement built from the template if the parameter
+ * values are as long as the last time.
+ */
+static size_t
+QT_expected_size(const QueryTemplate *tmpl)
+{
+	size_t	size = tmpl->textlen;
+	Int2	i;
+
+	for (i = 0; i < tmpl->num_slots; i++)
+		size += tmpl->slots[i].len;
+
+	return size;
+}
+
+/*
+ * Build the statement from the template. Returns SQL_NO_DATA if resolving
+ * a parameter now requires a different text.
+ */
+static RETCODE
+QT_build_query(QueryTemplate *tmpl, QueryBuild *qb, QueryParse *qp)
+{
+	RETCODE	retval;
+	size_t	prev = 0, npos;
+	Int2	i;
+	BOOL	isnull;
+	BOOL	isbinary;
+	Oid		dummy;
+
+	for (i = 0; i < tmpl->num_slots; i++)
+	{
+		QueryTemplateSlot	*slot = tmpl->slots + i;
+
+		CVT_APPEND_DATA(qb, tmpl->text + prev, slot->pos - prev);
+		prev = slot->pos;
+		qp->opos = slot->opos;
+		npos = qb->npos;
+		retval = ResolveOneParam(qb, qp, &isnull, &isbinary, &dummy);
+		if (retval < 0)
+			goto cleanup;
+		if (SQL_SUCCESS != retval ||
+		    qb->npos < npos ||
+		    qp->opos != slot->opos)
+		{
+			retval = SQL_NO_DATA;
+			goto cleanup;
+		}
+		slot->len = qb->npos - npos;
+	}
+	CVT_APPEND_DATA(qb, tmpl->text + prev, tmpl->textlen - prev);
+	CVT_TERMINATE(qb);
+	qp->opos = qp->stmt_len;
+	qp->flags = tmpl->qp_flags;
+	qp->statement_type = tmpl->statement_type;
+
+	retval = SQL_SUCCESS;
+cleanup:
+	return retval;
+}
+
 /*
  *	This function inserts parameters into an SQL statements.
  *	It will also modify a SELECT statement for use with declare/fetch cursors.
@@ -2917,6 +3366,7 @@ copy_statement_with_parameters(StatementClass *stmt, BOOL buildPrepareStatement)
 	ConnectionClass *conn = SC_get_conn(stmt);
 	ConnInfo   *ci = &(conn->connInfo);
 	const		char *bestitem = NULL;
+	size_t		init_size, tmpl_size;
 
 MYLOG(DETAIL_LOG_LEVEL, "entering prepared=%d\n", stmt->prepared);
 	if (!stmt->statement)
@@ -2925,6 +3375,8 @@ MYLOG(DETAIL_LOG_LEVEL, "entering prepared=%d\n", stmt->prepared);
 		return SQL_ERROR;
 	}
 
+	/* the tokens are kept for the re-executions */
+	SC_lex_statement(stmt);
 	qp = &query_org;
 	QP_initialize(qp, stmt);
 
@@ -3000,6 +3452,19 @@ MYLOG(DETAIL_LOG_LEVEL, "type=" FORMAT_UINTEGER " concur=" FORMAT_UINTEGER "\n",
 	SC_no_fetchcursor(stmt);
 	qb = &query_crt;
 	qb->query_statement = NULL;
+	qb->tmpl = NULL;
+	/*
+	 * A statement executed with the extended query protocol can be read
+	 * from its portal rather than via DECLARE/FETCH.
+	 */
+	if ((PREPARED_PERMANENTLY == stmt->prepared ||
+		 (buildPrepareStatement &&
+		  SQL_CONCUR_READ_ONLY == stmt->options.scroll_concurrency)) &&
+		SC_may_use_portal(stmt))
+	{
+		SC_set_fetchcursor(stmt);
+		SC_set_portalfetch(stmt);
+	}
 	if (PREPARED_PERMANENTLY == stmt->prepared)
 	{
 		/* already prepared */
@@ -3030,7 +3495,11 @@ MYLOG(DETAIL_LOG_LEVEL, "type=" FORMAT_UINTEGER " concur=" FORMAT_UINTEGER "\n",
 	}
 
 	/* Otherwise... */
-	if (QB_initialize(qb, qp->stmt_len, stmt, RPM_REPLACE_PARAMS) < 0)
+	init_size = qp->stmt_len;
+	if (stmt->query_template &&
+	    (tmpl_size = QT_expected_size(stmt->query_template)) > init_size)
+		init_size = tmpl_size;
+	if (QB_initialize(qb, init_size, stmt, RPM_REPLACE_PARAMS) < 0)
 	{
 		retval = SQL_ERROR;
 		goto cleanup;
@@ -3071,11 +3540,54 @@ MYLOG(DETAIL_LOG_LEVEL, "type=" FORMAT_UINTEGER " concur=" FORMAT_UINTEGER "\n",
 		}
 	}
 
+	/*
+	 * The statement converted in the same state as the last time needs
+	 * only the parameters resolved.
+	 */
+	if (stmt->query_template &&
+	    0 == qb->npos &&
+	    qp->from_pos < 0 &&
+	    stmt->query_template->qb_flags == qb->flags)
+	{
+		UInt4	qb_flags = qb->flags;
+
+		retval = QT_build_query(stmt->query_template, qb, qp);
+		if (SQL_ERROR == retval)
+		{
+			QB_replace_SC_error(stmt, qb, func);
+			QB_Destructor(qb);
+			return retval;
+		}
+		if (SQL_SUCCESS == retval)
+		{
+			MYLOG(DETAIL_LOG_LEVEL, "built from the template\n");
+			goto converted;
+		}
+		/* start over */
+		MYLOG(0, "the template isn't usable for the parameters\n");
+		SC_forget_query_template(stmt);
+		QB_Destructor(qb);
+		QP_initialize(qp, stmt);
+		if (QB_initialize(qb, init_size, stmt, RPM_REPLACE_PARAMS) < 0)
+		{
+			retval = SQL_ERROR;
+			goto cleanup;
+		}
+		qb->flags = qb_flags;
+	}
+	else if (NULL == stmt->query_template &&
+		 0 == qb->npos &&
+		 qp->from_pos < 0 &&
+		 0 == (qb->flags & FLGB_CREATE_KEYSET))
+		qb->tmpl = QT_create(qb->flags);
+
 	for (qp->opos = 0; qp->opos < qp->stmt_len; qp->opos++)
 	{
 		retval = inner_process_tokens(qp, qb);
 		if (SQL_ERROR == retval)
 		{
+			if (qb->tmpl)
+				QT_free(qb->tmpl);
 			QB_replace_SC_error(stmt, qb, func);
 			QB_Destructor(qb);
 			return retval;
@@ -3084,6 +3596,26 @@ MYLOG(DETAIL_LOG_LEVEL, "type=" FORMAT_UINTEGER " concur=" FORMAT_UINTEGER "\n",
 	/* make sure new_statement is always null-terminated */
 	CVT_TERMINATE(qb);
 
+	if (qb->tmpl)
+	{
+		QueryTemplate	*tmpl = qb->tmpl;
+
+		qb->tmpl = NULL;
+		if (tmpl->valid &&
+		    0 == (qp->flags & FLGP_USING_CURSOR) &&
+		    qp->statement_type == stmt->statement_type &&
+		    QT_finish(tmpl, qb))
+		{
+			tmpl->qp_flags = qp->flags;
+			tmpl->statement_type = qp->statement_type;
+			stmt->query_template = tmpl;
+			MYLOG(DETAIL_LOG_LEVEL, "template of %d parameters\n", tmpl->num_slots);
+		}
+		else
+			QT_free(tmpl);
+	}
+
+converted:
 	new_statement = qb->query_statement;
 	stmt->statement_type = qp->statement_type;
 	if (0 == (qp->flags & FLGP_USING_CURSOR))
@@ -3177,6 +3709,8 @@ MYLOG(DETAIL_LOG_LEVEL, "type=" FORMAT_UINTEGER " concur=" FORMAT_UINTEGER "\n",
 	stmt->stmt_with_params = qb->query_statement;
 	retval = SQL_SUCCESS;
 cleanup:
+	if (qb->tmpl)
+		QT_free(qb->tmpl);
 	return retval;
 }
 
@@ -3499,6 +4033,8 @@ inner_process_tokens(QueryParse *qp, QueryBuild *qb)
 	BOOL		isbinary;
 	Oid			dummy;
 	ParseToken	pts, *pt = &pts;
+	ssize_t		span_end;
+	size_t		param_npos;
 
 	PT_initialize(pt, qp);
 
@@ -3583,6 +4119,15 @@ inner_process_tokens(QueryParse *qp, QueryBuild *qb)
 	}
 	else if (QP_is_in(qp, QP_IN_DOLLAR_QUOTE)) /* dollar quote check */
 	{
+		if ((span_end = QP_span_end(qp, QTOKEN_DOLLAR_QUOTED)) > 0)
+		{
+			CVT_APPEND_DATA(qb, F_OldPtr(qp), span_end - qp->opos);
+			qp->opos = span_end - 1;
+			QP_exit(qp, QP_IN_DOLLAR_QUOTE);
+			qp->dollar_tag = NULL;
+			qp->taglen = -1;
+			return SQL_SUCCESS;
+		}
 		if (oldchar == DOLLAR_QUOTE)
 		{
 			if (strncmp(F_OldPtr(qp), qp->dollar_tag, qp->taglen) == 0)
@@ -3628,6 +4173,14 @@ inner_process_tokens(QueryParse *qp, QueryBuild *qb)
 	}
 	else if (QP_is_in(qp, QP_IN_COMMENT_BLOCK)) /* comment_level check */
 	{
+		if ((span_end = QP_span_end(qp, QTOKEN_COMMENT)) > 0)
+		{
+			CVT_APPEND_DATA(qb, F_OldPtr(qp), span_end - qp->opos);
+			qp->opos = span_end - 1;
+			qp->comment_level = 0;
+			QP_exit(qp, QP_IN_COMMENT_BLOCK);
+			return SQL_SUCCESS;
+		}
 		if ('/' == oldchar &&
 		    '*' == F_OldPtr(qp)[1])
 		{
@@ -3651,6 +4204,13 @@ inner_process_tokens(QueryParse *qp, QueryBuild *qb)
 	}
 	else if (QP_is_in(qp, QP_IN_LINE_COMMENT)) /* line comment check */
 	{
+		if ((span_end = QP_span_end(qp, QTOKEN_COMMENT)) > 0)
+		{
+			CVT_APPEND_DATA(qb, F_OldPtr(qp), span_end - qp->opos);
+			qp->opos = span_end - 1;
+			QP_exit(qp, QP_IN_LINE_COMMENT);
+			return SQL_SUCCESS;
+		}
 		if (PG_LINEFEED == oldchar)
 			QP_exit(qp, QP_IN_LINE_COMMENT);
 		CVT_APPEND_CHAR(qb, oldchar);
@@ -3709,6 +4269,10 @@ inner_process_tokens(QueryParse *qp, QueryBuild *qb)
 		BOOL		converted = FALSE;
 		COL_INFO	*coli;
 
+		/* the table inserted last may change */
+		if (qb->tmpl)
+			qb->tmpl->valid = FALSE;
+
 #ifdef	NOT_USED  /* lastval() isn't always appropriate */
 		if (PG_VERSION_GE(conn, 8.1))
 		{
@@ -3791,6 +4355,7 @@ inner_process_tokens(QueryParse *qp, QueryBuild *qb)
 			if (qp->taglen > 0)
 			{
 				QP_enter(qp, QP_IN_DOLLAR_QUOTE);
+				qp->span_start = qp->opos;
 				qp->dollar_tag = F_OldPtr(qp);
 				CVT_APPEND_DATA(qb, F_OldPtr(qp), qp->taglen);
 				qp->opos += (qp->taglen - 1);
@@ -3819,6 +4384,7 @@ inner_process_tokens(QueryParse *qp, QueryBuild *qb)
 			qp->comment_level++;
 			PT_token_finish(pt, 0); /* comments are excluded */
 			QP_enter(qp, QP_IN_COMMENT_BLOCK);
+			qp->span_start = qp->opos;
 			PT_TOKEN_IGNORE(pt);
 		}
 		else if ('-' == oldchar &&
@@ -3826,6 +4392,7 @@ inner_process_tokens(QueryParse *qp, QueryBuild *qb)
 		{
 			PT_token_finish(pt, 0); /* comments are excluded */
 			QP_enter(qp, QP_IN_LINE_COMMENT);
+			qp->span_start = qp->opos;
 			PT_TOKEN_IGNORE(pt);
 		}
 		else if (oldchar == ';')
@@ -3991,9 +4558,12 @@ inner_process_tokens(QueryParse *qp, QueryBuild *qb)
 	/*
 	 * It's a '?' parameter alright
 	 */
+	param_npos = qb->npos;
 	retval = ResolveOneParam(qb, qp, &isnull, &isbinary, &dummy);
 	if (retval < 0)
 		return retval;
+	if (qb->tmpl)
+		QT_add_slot(qb->tmpl, qb, qp, retval, param_npos, opos);
 
 	if (SQL_SUCCESS_WITH_INFO == retval) /* means discarding output parameter */
 	{
@@ -4684,6 +5254,24 @@ MYLOG(DETAIL_LOG_LEVEL, "ipara=%p paramName=%s paramType=%d %d proc_return=%d\n"
 		return SQL_SUCCESS;
 	}
 
+	/* The data streamed to a large object by SQLPutData */
+	if (apara->data_at_exec &&
+	    PUTDATA_STREAM_NONE != pdata->pdata[param_number].streamed)
+	{
+		if (req_bind)
+		{
+			qb->errormsg = "The streamed parameter data can't be bound";
+			qb->errornumber = STMT_EXEC_ERROR;
+			return SQL_ERROR;
+		}
+		if (PUTDATA_STREAM_BYTEA == pdata->pdata[param_number].streamed)
+			SPRINTF_FIXED(param_string, "pg_catalog.lo_get(%u)", pdata->pdata[param_number].lobj_oid);
+		else
+			SPRINTF_FIXED(param_string, "pg_catalog.convert_from(pg_catalog.lo_get(%u), 'UTF8')", pdata->pdata[param_number].lobj_oid);
+		CVT_APPEND_STR(qb, param_string);
+		return SQL_SUCCESS;
+	}
+
 	/*
 	 * If no buffer, and it's not null, then what the hell is it? Just
 	 * leave it alone then.
@@ -6439,6 +7027,8 @@ convert_lo(StatementClass *stmt, const void *value, SQLSMALLINT fCType, PTR rgbV
 			SC_set_error(stmt, STMT_EXEC_ERROR, "Could not convert lo to the c-type", func);
 			return COPY_GENERAL_ERROR;
 	}
+	/* see DiscardStatementSvpOnRead() */
+	stmt->accessed_db_on_read = TRUE;
 	/* If using SQLGetData, then current_col will be set */
 	if (stmt->current_col >= 0)
 	{
@@ -703,6 +703,30 @@ copyConnAttributes(ConnInfo *ci, const char *attribute, const char *value)
 		ci->optional_errors = atoi(value);
 	else if (stricmp(attribute, INI_IGNORETIMEOUT) == 0 || stricmp(attribute, ABBR_IGNORETIMEOUT) == 0)
 		ci->ignore_timeout = atoi(value);
+	else if (stricmp(attribute, INI_PREFETCHCATALOG) == 0 || stricmp(attribute, ABBR_PREFETCHCATALOG) == 0)
+		ci->prefetch_catalog = atoi(value);
+	else if (stricmp(attribute, INI_FETCHREADAHEAD) == 0 || stricmp(attribute, ABBR_FETCHREADAHEAD) == 0)
+		ci->fetch_readahead = atoi(value);
+	else if (stricmp(attribute, INI_FETCHBYTES) == 0 || stricmp(attribute, ABBR_FETCHBYTES) == 0)
+		ci->fetch_bytes = atoi(value);
+	else if (stricmp(attribute, INI_FETCHLATENCY) == 0 || stricmp(attribute, ABBR_FETCHLATENCY) == 0)
+		ci->fetch_latency = atoi(value);
+	else if (stricmp(attribute, INI_FETCHMAXROWS) == 0 || stricmp(attribute, ABBR_FETCHMAXROWS) == 0)
+		ci->fetch_max_rows = atoi(value);
+	else if (stricmp(attribute, INI_PORTALFETCH) == 0 || stricmp(attribute, ABBR_PORTALFETCH) == 0)
+		ci->portal_fetch = atoi(value);
+	else if (stricmp(attribute, INI_TUPLECACHELIMIT) == 0 || stricmp(attribute, ABBR_TUPLECACHELIMIT) == 0)
+		ci->tuple_cache_limit = atoi(value);
+	else if (stricmp(attribute, INI_DESCRIBECACHE) == 0 || stricmp(attribute, ABBR_DESCRIBECACHE) == 0)
+		ci->describe_cache = atoi(value);
+	else if (stricmp(attribute, INI_MULTIROWINSERT) == 0 || stricmp(attribute, ABBR_MULTIROWINSERT) == 0)
+		ci->multirow_insert = atoi(value);
+	else if (stricmp(attribute, INI_STREAMPUTDATASIZE) == 0 || stricmp(attribute, ABBR_STREAMPUTDATASIZE) == 0)
+		ci->stream_putdata_size = atoi(value);
+	else if (stricmp(attribute, INI_STMTPOOLSIZE) == 0 || stricmp(attribute, ABBR_STMTPOOLSIZE) == 0)
+		ci->stmt_pool_size = atoi(value);
+	else if (stricmp(attribute, INI_PIPELINESAVEPOINT) == 0 || stricmp(attribute, ABBR_PIPELINESAVEPOINT) == 0)
+		ci->pipeline_savepoint = atoi(value);
 	else if (stricmp(attribute, INI_SSLMODE) == 0 || stricmp(attribute, ABBR_SSLMODE) == 0)
 	{
 		switch (value[0])
@@ -1086,6 +1110,30 @@ MYLOG(0, "drivername=%s\n", drivername);
 			ci->batch_size = DEFAULT_BATCH_SIZE;
 	if (SQLGetPrivateProfileString(DSN, INI_IGNORETIMEOUT, NULL_STRING, temp, sizeof(temp), ODBC_INI) > 0)
 		ci->ignore_timeout = atoi(temp);
+	if (SQLGetPrivateProfileString(DSN, INI_PREFETCHCATALOG, NULL_STRING, temp, sizeof(temp), ODBC_INI) > 0)
+		ci->prefetch_catalog = atoi(temp);
+	if (SQLGetPrivateProfileString(DSN, INI_FETCHREADAHEAD, NULL_STRING, temp, sizeof(temp), ODBC_INI) > 0)
+		ci->fetch_readahead = atoi(temp);
+	if (SQLGetPrivateProfileString(DSN, INI_FETCHBYTES, NULL_STRING, temp, sizeof(temp), ODBC_INI) > 0)
+		ci->fetch_bytes = atoi(temp);
+	if (SQLGetPrivateProfileString(DSN, INI_FETCHLATENCY, NULL_STRING, temp, sizeof(temp), ODBC_INI) > 0)
+		ci->fetch_latency = atoi(temp);
+	if (SQLGetPrivateProfileString(DSN, INI_FETCHMAXROWS, NULL_STRING, temp, sizeof(temp), ODBC_INI) > 0)
+		ci->fetch_max_rows = atoi(temp);
+	if (SQLGetPrivateProfileString(DSN, INI_PORTALFETCH, NULL_STRING, temp, sizeof(temp), ODBC_INI) > 0)
+		ci->portal_fetch = atoi(temp);
+	if (SQLGetPrivateProfileString(DSN, INI_TUPLECACHELIMIT, NULL_STRING, temp, sizeof(temp), ODBC_INI) > 0)
+		ci->tuple_cache_limit = atoi(temp);
+	if (SQLGetPrivateProfileString(DSN, INI_DESCRIBECACHE, NULL_STRING, temp, sizeof(temp), ODBC_INI) > 0)
+		ci->describe_cache = atoi(temp);
+	if (SQLGetPrivateProfileString(DSN, INI_MULTIROWINSERT, NULL_STRING, temp, sizeof(temp), ODBC_INI) > 0)
+		ci->multirow_insert = atoi(temp);
+	if (SQLGetPrivateProfileString(DSN, INI_STREAMPUTDATASIZE, NULL_STRING, temp, sizeof(temp), ODBC_INI) > 0)
+		ci->stream_putdata_size = atoi(temp);
+	if (SQLGetPrivateProfileString(DSN, INI_STMTPOOLSIZE, NULL_STRING, temp, sizeof(temp), ODBC_INI) > 0)
+		ci->stmt_pool_size = atoi(temp);
+	if (SQLGetPrivateProfileString(DSN, INI_PIPELINESAVEPOINT, NULL_STRING, temp, sizeof(temp), ODBC_INI) > 0)
+		ci->pipeline_savepoint = atoi(temp);
 
 	if (SQLGetPrivateProfileString(DSN, INI_SSLMODE, NULL_STRING, temp, sizeof(temp), ODBC_INI) > 0)
 		STRCPY_FIXED(ci->sslmode, temp);
@@ -1385,6 +1433,66 @@ writeDSNinfo(const ConnInfo *ci)
 								 INI_IGNORETIMEOUT,
 								 temp,
 								 ODBC_INI);
+	ITOA_FIXED(temp, ci->prefetch_catalog);
+	SQLWritePrivateProfileString(DSN,
+								 INI_PREFETCHCATALOG,
+								 temp,
+								 ODBC_INI);
+	ITOA_FIXED(temp, ci->fetch_readahead);
+	SQLWritePrivateProfileString(DSN,
+								 INI_FETCHREADAHEAD,
+								 temp,
+								 ODBC_INI);
+	ITOA_FIXED(temp, ci->fetch_bytes);
+	SQLWritePrivateProfileString(DSN,
+								 INI_FETCHBYTES,
+								 temp,
+								 ODBC_INI);
+	ITOA_FIXED(temp, ci->fetch_latency);
+	SQLWritePrivateProfileString(DSN,
+								 INI_FETCHLATENCY,
+								 temp,
+								 ODBC_INI);
+	ITOA_FIXED(temp, ci->fetch_max_rows);
+	SQLWritePrivateProfileString(DSN,
+								 INI_FETCHMAXROWS,
+								 temp,
+								 ODBC_INI);
+	ITOA_FIXED(temp, ci->portal_fetch);
+	SQLWritePrivateProfileString(DSN,
+								 INI_PORTALFETCH,
+								 temp,
+								 ODBC_INI);
+	ITOA_FIXED(temp, ci->tuple_cache_limit);
+	SQLWritePrivateProfileString(DSN,
+								 INI_TUPLECACHELIMIT,
+								 temp,
+								 ODBC_INI);
+	ITOA_FIXED(temp, ci->describe_cache);
+	SQLWritePrivateProfileString(DSN,
+								 INI_DESCRIBECACHE,
+								 temp,
+								 ODBC_INI);
+	ITOA_FIXED(temp, ci->multirow_insert);
+	SQLWritePrivateProfileString(DSN,
+								 INI_MULTIROWINSERT,
+								 temp,
+								 ODBC_INI);
+	ITOA_FIXED(temp, ci->stream_putdata_size);
+	SQLWritePrivateProfileString(DSN,
+								 INI_STREAMPUTDATASIZE,
+								 temp,
+								 ODBC_INI);
+	ITOA_FIXED(temp, ci->stmt_pool_size);
+	SQLWritePrivateProfileString(DSN,
+								 INI_STMTPOOLSIZE,
+								 temp,
+								 ODBC_INI);
+	ITOA_FIXED(temp, ci->pipeline_savepoint);
+	SQLWritePrivateProfileString(DSN,
+								 INI_PIPELINESAVEPOINT,
+								 temp,
+								 ODBC_INI);
 	ITOA_FIXED(temp, ci->fetch_refcursors);
 	SQLWritePrivateProfileString(DSN,
 								 INI_FETCHREFCURSORS,
@@ -1804,6 +1912,18 @@ CC_conninfo_init(ConnInfo *conninfo, UInt4 option)
 	conninfo->disable_convert_func = -1;
 	conninfo->batch_size = DEFAULT_BATCH_SIZE;
 	conninfo->ignore_timeout = DEFAULT_IGNORETIMEOUT;
+	conninfo->prefetch_catalog = DEFAULT_PREFETCHCATALOG;
+	conninfo->fetch_readahead = DEFAULT_FETCHREADAHEAD;
+	conninfo->fetch_bytes = DEFAULT_FETCHBYTES;
+	conninfo->fetch_latency = DEFAULT_FETCHLATENCY;
+	conninfo->fetch_max_rows = DEFAULT_FETCHMAXROWS;
+	conninfo->portal_fetch = DEFAULT_PORTALFETCH;
+	conninfo->tuple_cache_limit = DEFAULT_TUPLECACHELIMIT;
+	conninfo->describe_cache = DEFAULT_DESCRIBECACHE;
+	conninfo->multirow_insert = DEFAULT_MULTIROWINSERT;
+	conninfo->stream_putdata_size = DEFAULT_STREAMPUTDATASIZE;
+	conninfo->stmt_pool_size = DEFAULT_STMTPOOLSIZE;
+	conninfo->pipeline_savepoint = DEFAULT_PIPELINESAVEPOINT;
 	conninfo->wcs_debug = -1;
 	conninfo->fetch_refcursors = -1;
 #ifdef	_HANDLE_ENLIST_IN_DTC_
@@ -1907,6 +2027,18 @@ CC_copy_conninfo(ConnInfo *ci, const ConnInfo *sci)
 	CORR_VALCPY(keepalive_interval);
 	CORR_VALCPY(batch_size);
 	CORR_VALCPY(ignore_timeout);
+	CORR_VALCPY(prefetch_catalog);
+	CORR_VALCPY(fetch_readahead);
+	CORR_VALCPY(fetch_bytes);
+	CORR_VALCPY(fetch_latency);
+	CORR_VALCPY(fetch_max_rows);
+	CORR_VALCPY(portal_fetch);
+	CORR_VALCPY(tuple_cache_limit);
+	CORR_VALCPY(describe_cache);
+	CORR_VALCPY(multirow_insert);
+	CORR_VALCPY(stream_putdata_size);
+	CORR_VALCPY(stmt_pool_size);
+	CORR_VALCPY(pipeline_savepoint);
 	CORR_VALCPY(fetch_refcursors);
 #ifdef	_HANDLE_ENLIST_IN_DTC_
 	CORR_VALCPY(xa_opt);
@@ -160,6 +160,9 @@ extern "C" {
 #define ABBR_SSLMODE			"CA"
 #define INI_EXTRAOPTIONS		"AB"
 #define INI_LOGDIR			"Logdir"
+#define INI_LOGBUFFERSIZE		"LogBufferSize"	/* KB of asynchronous
+							 * logging buffer */
+#define INI_QUERYTRACE			"QueryTrace"	/* binary query trace */
 #define INI_KEEPALIVETIME		"KeepaliveTime"
 #define ABBR_KEEPALIVETIME		"D1"
 #define INI_KEEPALIVEINTERVAL		"KeepaliveInterval"
@@ -175,6 +178,30 @@ extern "C" {
 #define INI_DTCLOG			"Dtclog"
 #define INI_FETCHREFCURSORS		"FetchRefcursors"
 #define ABBR_FETCHREFCURSORS		"DA"
+#define INI_PREFETCHCATALOG		"PrefetchCatalog"
+#define ABBR_PREFETCHCATALOG		"DB"
+#define INI_FETCHREADAHEAD		"FetchReadAhead"
+#define ABBR_FETCHREADAHEAD		"DC"
+#define INI_FETCHBYTES			"FetchBytes"
+#define ABBR_FETCHBYTES			"DD"
+#define INI_FETCHLATENCY		"FetchLatency"
+#define ABBR_FETCHLATENCY		"DE"
+#define INI_FETCHMAXROWS		"FetchMaxRows"
+#define ABBR_FETCHMAXROWS		"DF"
+#define INI_PORTALFETCH			"PortalFetch"
+#define ABBR_PORTALFETCH		"DG"
+#define INI_TUPLECACHELIMIT		"TupleCacheLimit"
+#define ABBR_TUPLECACHELIMIT		"DH"
+#define INI_DESCRIBECACHE		"DescribeCache"
+#define ABBR_DESCRIBECACHE		"DI"
+#define INI_MULTIROWINSERT		"MultiRowInsert"
+#define ABBR_MULTIROWINSERT		"DJ"
+#define INI_STREAMPUTDATASIZE		"StreamPutDataSize"
+#define ABBR_STREAMPUTDATASIZE		"DK"
+#define INI_STMTPOOLSIZE		"StatementPoolSize"
+#define ABBR_STMTPOOLSIZE		"DL"
+#define INI_PIPELINESAVEPOINT		"PipelineSavepoint"
+#define ABBR_PIPELINESAVEPOINT		"DM"
 /* "PreferLibpq", abbreviated "D4", used to mean whether to prefer libpq.
  * libpq is now required
 #define INI_PREFERLIBPQ			"PreferLibpq"
@@ -247,6 +274,8 @@ extern "C" {
 #define DEFAULT_UNIQUEINDEX			1		/* dont recognize */
 #define DEFAULT_COMMLOG				0		/* dont log */
 #define DEFAULT_DEBUG				0
+#define DEFAULT_LOGBUFFERSIZE			0		/* synchronous logging */
+#define DEFAULT_QUERYTRACE			0
 #define DEFAULT_UNKNOWNSIZES			UNKNOWNS_AS_MAX
 
 
@@ -278,6 +307,18 @@ extern "C" {
 #define DEFAULT_BATCH_SIZE		100
 #define DEFAULT_IGNORETIMEOUT		0
 #define DEFAULT_FETCHREFCURSORS		0
+#define DEFAULT_PREFETCHCATALOG		0
+#define DEFAULT_FETCHREADAHEAD		0
+#define DEFAULT_FETCHBYTES		0
+#define DEFAULT_FETCHLATENCY		0
+#define DEFAULT_FETCHMAXROWS		10000
+#define DEFAULT_PORTALFETCH		0
+#define DEFAULT_TUPLECACHELIMIT		0
+#define DEFAULT_DESCRIBECACHE		0
+#define DEFAULT_MULTIROWINSERT		0
+#define DEFAULT_STREAMPUTDATASIZE	0
+#define DEFAULT_STMTPOOLSIZE		0
+#define DEFAULT_PIPELINESAVEPOINT	0
 
 #ifdef	_HANDLE_ENLIST_IN_DTC_
 #define DEFAULT_XAOPT			1
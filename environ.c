@@ -28,16 +28,32 @@
 #include "loadlib.h"
 
 
-/* The one instance of the handles */
-static int conns_count = 0;
-static ConnectionClass **conns = NULL;
+/*
+ *	The registry of all the connections. It's split into shards, each
+ *	with its own lock and a doubly linked list of the connections, so
+ *	that connections allocated and freed in different threads seldom
+ *	wait for each other, and adding or removing one doesn't scan the
+ *	others.
+ */
+#define	CONN_SHARD_COUNT	16
+
+typedef struct
+{
+#if defined(WIN_MULTITHREAD_SUPPORT)
+	CRITICAL_SECTION	cs;
+#elif defined(POSIX_MULTITHREAD_SUPPORT)
+	pthread_mutex_t		cs;
+#endif /* WIN_MULTITHREAD_SUPPORT */
+	ConnectionClass	*head;
+	int		count;
+} ConnShard;
+
+static ConnShard conn_shards[CONN_SHARD_COUNT];
 
 #if defined(WIN_MULTITHREAD_SUPPORT)
-CRITICAL_SECTION	conns_cs;
 CRITICAL_SECTION	common_cs; /* commonly used for short term blocking */
 CRITICAL_SECTION	common_lcs; /* commonly used for not necessarily short term blocking */
 #elif defined(POSIX_MULTITHREAD_SUPPORT)
-pthread_mutex_t     conns_cs;
 pthread_mutex_t     common_cs;
 pthread_mutex_t     common_lcs;
 #endif /* WIN_MULTITHREAD_SUPPORT */
@@ -51,13 +67,130 @@ void	shortterm_common_unlock(void)
 	LEAVE_COMMON_CS;
 }
 
-int	getConnCount(void)
+void	EN_init_registry(void)
 {
-	return conns_count;
+	int	i;
+
+	for (i = 0; i < CONN_SHARD_COUNT; i++)
+	{
+		INIT_SHARD_CS(&conn_shards[i]);
+		conn_shards[i].head = NULL;
+		conn_shards[i].count = 0;
+	}
+}
+void	EN_delete_registry(void)
+{
+	int	i;
+
+	for (i = 0; i < CONN_SHARD_COUNT; i++)
+		DELETE_SHARD_CS(&conn_shards[i]);
+}
+
+/* The shard of a connection is given by its address */
+static ConnShard *
+conn_shard(const ConnectionClass *conn)
+{
+	size_t	h = (size_t) conn >> 4;
+
+	h ^= (h >> 7) ^ (h >> 13);
+	return &conn_shards[h % CONN_SHARD_COUNT];
+}
+
+/* These are called with the shard locked */
+static void
+shard_link(ConnShard *shard, ConnectionClass *conn)
+{
+	conn->prev_registered = NULL;
+	conn->next_registered = shard->head;
+	if (shard->head)
+		shard->head->prev_registered = conn;
+	shard->head = conn;
+	shard->count++;
+}
+
+static void
+shard_unlink(ConnShard *shard, ConnectionClass *conn)
+{
+	if (conn->prev_registered)
+		conn->prev_registered->next_registered = conn->next_registered;
+	else
+		shard->head = conn->next_registered;
+	if (conn->next_registered)
+		conn->next_registered->prev_registered = conn->prev_registered;
+	conn->next_registered = conn->prev_registered = NULL;
+	shard->count--;
+}
+
+static BOOL
+shard_has(const ConnShard *shard, const ConnectionClass *conn)
+{
+	return NULL != conn->prev_registered || shard->head == conn;
+}
+
+/*
+ *	Returns a malloc'ed copy of the list of the connections on the
+ *	environment, so that the caller can work on them without holding
+ *	any lock of the registry. The connections are pinned: until the
+ *	caller passes the list to EN_release_connections(),
+ *	EN_remove_connection() refuses them, so SQLFreeHandle can't free
+ *	them meanwhile. *count is set to -1 on an allocation failure.
+ */
+ConnectionClass **
+EN_get_connections(EnvironmentClass *self, int *count)
+{
+	ConnectionClass	**list = NULL, **newl, *conn;
+	ConnShard	*shard;
+	int		i, cnt = 0, alloc = 0;
+
+	for (i = 0; i < CONN_SHARD_COUNT; i++)
+	{
+		shard = &conn_shards[i];
+		ENTER_SHARD_CS(shard);
+		if (cnt + shard->count > alloc)
+		{
+			alloc = cnt + shard->count;
+			if (newl = (ConnectionClass **) realloc(list, alloc * sizeof(ConnectionClass *)), NULL == newl)
+			{
+				LEAVE_SHARD_CS(shard);
+				free(list);
+				*count = -1;
+				return NULL;
+			}
+			list = newl;
+		}
+		for (conn = shard->head; conn; conn = conn->next_registered)
+		{
+			if (conn->henv == self)
+			{
+				conn->registry_pins++;
+				list[cnt++] = conn;
+			}
+		}
+		LEAVE_SHARD_CS(shard);
+	}
+	*count = cnt;
+
+	return list;
 }
-ConnectionClass * const *getConnList(void)
+
+/*
+ *	Unpin the connections got by EN_get_connections() and free the list.
+ */
+void
+EN_release_connections(ConnectionClass **list, int count)
 {
-	return conns;
+	ConnShard	*shard;
+	int		i;
+
+	for (i = 0; i < count; i++)
+	{
+		shard = conn_shard(list[i]);
+		ENTER_SHARD_CS(shard);
+		list[i]->registry_pins--;
+		LEAVE_SHARD_CS(shard);
+	}
+	if (list)
+		free(list);
 }
 
 RETCODE		SQL_API
@@ -373,6 +506,13 @@ PGAPI_ConnectError(HDBC hdbc,
 			case CONN_VALUE_OUT_OF_RANGE:
 				pg_sqlstate_set(env, szSqlState, "HY019", "22003");
 				break;
+			case CONN_INVALID_BUFFER_LENGTH:
+				pg_sqlstate_set(env, szSqlState, "HY090", "S1090");
+				break;
+			case CONN_SEQUENCE_ERROR:
+				pg_sqlstate_set(env, szSqlState, "HY010", "S1010");
+				/* function sequence error */
+				break;
 			case CONNECTION_COULD_NOT_SEND:
 			case CONNECTION_COULD_NOT_RECEIVE:
 			case CONNECTION_COMMUNICATION_ERROR:
@@ -514,7 +654,7 @@ cleanup:
 char
 EN_Destructor(EnvironmentClass *self)
 {
-	int		lf, nullcnt;
+	int		i;
 	char		rv = 1;
 
 	MYLOG(0, "entering self=%p\n", self);
@@ -526,29 +666,40 @@ EN_Destructor(EnvironmentClass *self)
 	 * source--they should not be freed
 	 */
 
-	/* Free any connections belonging to this environment */
-	ENTER_CONNS_CS;
-	for (lf = 0, nullcnt = 0; lf < conns_count; lf++)
+	/*
+	 * Free any connections belonging to this environment. They are
+	 * taken out of each shard first, and destroyed with no lock held.
+	 */
+	for (i = 0; i < CONN_SHARD_COUNT; i++)
 	{
-		if (NULL == conns[lf])
-			nullcnt++;
-		else if (conns[lf]->henv == self)
+		ConnShard	*shard = &conn_shards[i];
+		ConnectionClass	*conn, *next, *owned = NULL;
+
+		ENTER_SHARD_CS(shard);
+		for (conn = shard->head; conn; conn = next)
 		{
-			if (CC_Destructor(conns[lf]))
-				conns[lf] = NULL;
-			else
+			next = conn->next_registered;
+			if (conn->henv == self)
+			{
+				shard_unlink(shard, conn);
+				conn->next_registered = owned;
+				owned = conn;
+			}
+		}
+		LEAVE_SHARD_CS(shard);
+		for (conn = owned; conn; conn = next)
+		{
+			next = conn->next_registered;
+			conn->next_registered = NULL;
+			if (!CC_Destructor(conn))
+			{
+				ENTER_SHARD_CS(shard);
+				shard_link(shard, conn);
+				LEAVE_SHARD_CS(shard);
 				rv = 0;
-			nullcnt++;
+			}
 		}
 	}
-	if (conns && nullcnt >= conns_count)
-	{
-		MYLOG(0, "clearing conns count=%d\n", conns_count);
-		free(conns);
-		conns = NULL;
-		conns_count = 0;
-	}
-	LEAVE_CONNS_CS;
 	DELETE_ENV_CS(self);
 	free(self);
 
@@ -578,64 +729,40 @@ EN_get_error(EnvironmentClass *self, int *number, char **message)
 		return 0;
 }
 
-#define	INIT_CONN_COUNT	128
-
 char
 EN_add_connection(EnvironmentClass *self, ConnectionClass *conn)
 {
-	int	i, alloc;
-	ConnectionClass	**newa;
-	char	ret = FALSE;
+	ConnShard	*shard = conn_shard(conn);
 
 	MYLOG(0, "entering self = %p, conn = %p\n", self, conn);
 
-	ENTER_CONNS_CS;
-	for (i = 0; i < conns_count; i++)
-	{
-		if (!conns[i])
-		{
-			conn->henv = self;
-			conns[i] = conn;
-			ret = TRUE;
-			MYLOG(0, "       added at i=%d, conn->henv = %p, conns[i]->henv = %p\n", i, conn->henv, conns[i]->henv);
-			goto cleanup;
-		}
-	}
-	if (conns_count > 0)
-		alloc = 2 * conns_count;
-	else
-		alloc = INIT_CONN_COUNT;
-	if (newa = (ConnectionClass **) realloc(conns, alloc * sizeof(ConnectionClass *)), NULL == newa)
-		goto cleanup;
 	conn->henv = self;
-	newa[conns_count] = conn;
-	conns = newa;
-	ret = TRUE;
-	MYLOG(0, "       added at %d, conn->henv = %p, conns[%d]->henv = %p\n", conns_count, conn->henv, conns_count, conns[conns_count]->henv);
-	for (i = conns_count + 1; i < alloc; i++)
-		conns[i] = NULL;
-	conns_count = alloc;
-cleanup:
-	LEAVE_CONNS_CS;
-	return ret;
+	ENTER_SHARD_CS(shard);
+	shard_link(shard, conn);
+	LEAVE_SHARD_CS(shard);
+	MYLOG(0, "       added to shard %d\n", (int) (shard - conn_shards));
+
+	return TRUE;
 }
 
 
 char
 EN_remove_connection(EnvironmentClass *self, ConnectionClass *conn)
 {
-	int			i;
+	ConnShard	*shard = conn_shard(conn);
+	char		ret = FALSE;
 
-	for (i = 0; i < conns_count; i++)
-		if (conns[i] == conn && conns[i]->status != CONN_EXECUTING)
-		{
-			ENTER_CONNS_CS;
-			conns[i] = NULL;
-			LEAVE_CONNS_CS;
-			return TRUE;
-		}
+	ENTER_SHARD_CS(shard);
+	if (shard_has(shard, conn) &&
+	    conn->status != CONN_EXECUTING &&
+	    0 == conn->registry_pins)
+	{
+		shard_unlink(shard, conn);
+		ret = TRUE;
+	}
+	LEAVE_SHARD_CS(shard);
 
-	return FALSE;
+	return ret;
 }
 
 
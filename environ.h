@@ -41,8 +41,10 @@ char		EN_get_error(EnvironmentClass *self, int *number, char **message);
 char		EN_add_connection(EnvironmentClass *self, ConnectionClass *conn);
 char		EN_remove_connection(EnvironmentClass *self, ConnectionClass *conn);
 void		EN_log_error(const char *func, char *desc, EnvironmentClass *self);
-int	getConnCount(void);
-ConnectionClass * const *getConnList(void);
+ConnectionClass	**EN_get_connections(EnvironmentClass *self, int *count);
+void		EN_release_connections(ConnectionClass **list, int count);
+void		EN_init_registry(void);
+void		EN_delete_registry(void);
 
 #define	EN_OV_ODBC2	1L
 #define	EN_CONN_POOLING	(1L<<1)
@@ -56,10 +58,10 @@ ConnectionClass * const *getConnList(void);
 
 /* For Multi-thread */
 #if defined( WIN_MULTITHREAD_SUPPORT)
-#define	INIT_CONNS_CS	InitializeCriticalSection(&conns_cs)
-#define	ENTER_CONNS_CS	EnterCriticalSection(&conns_cs)
-#define	LEAVE_CONNS_CS	LeaveCriticalSection(&conns_cs)
-#define	DELETE_CONNS_CS	DeleteCriticalSection(&conns_cs)
+#define	INIT_SHARD_CS(x)	InitializeCriticalSection(&((x)->cs))
+#define	ENTER_SHARD_CS(x)	EnterCriticalSection(&((x)->cs))
+#define	LEAVE_SHARD_CS(x)	LeaveCriticalSection(&((x)->cs))
+#define	DELETE_SHARD_CS(x)	DeleteCriticalSection(&((x)->cs))
 #define INIT_ENV_CS(x)		InitializeCriticalSection(&((x)->cs))
 #define ENTER_ENV_CS(x)	EnterCriticalSection(&((x)->cs))
 #define LEAVE_ENV_CS(x)		LeaveCriticalSection(&((x)->cs))
@@ -69,10 +71,10 @@ ConnectionClass * const *getConnList(void);
 #define LEAVE_COMMON_CS		LeaveCriticalSection(&common_cs)
 #define DELETE_COMMON_CS	DeleteCriticalSection(&common_cs)
 #elif defined(POSIX_MULTITHREAD_SUPPORT)
-#define	INIT_CONNS_CS	pthread_mutex_init(&conns_cs,0)
-#define	ENTER_CONNS_CS	pthread_mutex_lock(&conns_cs)
-#define	LEAVE_CONNS_CS	pthread_mutex_unlock(&conns_cs)
-#define	DELETE_CONNS_CS	pthread_mutex_destroy(&conns_cs)
+#define	INIT_SHARD_CS(x)	pthread_mutex_init(&((x)->cs),0)
+#define	ENTER_SHARD_CS(x)	pthread_mutex_lock(&((x)->cs))
+#define	LEAVE_SHARD_CS(x)	pthread_mutex_unlock(&((x)->cs))
+#define	DELETE_SHARD_CS(x)	pthread_mutex_destroy(&((x)->cs))
 #define INIT_ENV_CS(x)		pthread_mutex_init(&((x)->cs),0)
 #define ENTER_ENV_CS(x)		pthread_mutex_lock(&((x)->cs))
 #define LEAVE_ENV_CS(x)		pthread_mutex_unlock(&((x)->cs))
@@ -82,10 +84,10 @@ ConnectionClass * const *getConnList(void);
 #define LEAVE_COMMON_CS		pthread_mutex_unlock(&common_cs)
 #define DELETE_COMMON_CS	pthread_mutex_destroy(&common_cs)
 #else
-#define	INIT_CONNS_CS
-#define	ENTER_CONNS_CS
-#define	LEAVE_CONNS_CS
-#define	DELETE_CONNS_CS
+#define	INIT_SHARD_CS(x)
+#define	ENTER_SHARD_CS(x)
+#define	LEAVE_SHARD_CS(x)
+#define	DELETE_SHARD_CS(x)
 #define INIT_ENV_CS(x)
 #define ENTER_ENV_CS(x)
 #define LEAVE_ENV_CS(x)
@@ -96,6 +98,9 @@ ConnectionClass * const *getConnList(void);
 #define DELETE_COMMON_CS
 #endif /* WIN_MULTITHREAD_SUPPORT */
 
+#define	INIT_CONNS_CS	EN_init_registry()
+#define	DELETE_CONNS_CS	EN_delete_registry()
+
 void shortterm_common_lock(void);
 void shortterm_common_unlock(void);
 #ifdef	__cplusplus
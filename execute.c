@@ -31,6 +31,8 @@
 #include "bind.h"
 #include "pgtypes.h"
 #include "lobj.h"
+#include "multibyte.h"
+#include "unicode_support.h"
 #include "pgapifunc.h"
 
 /*		Perform a Prepare on the SQL statement */
@@ -231,7 +233,8 @@ inquireHowToPrepare(const StatementClass *stmt)
 		{
 			if (SC_may_use_cursor(stmt))
 			{
-				if (ci->drivers.use_declarefetch)
+				if (ci->drivers.use_declarefetch &&
+					!SC_may_use_portal(stmt))
 					return PARSE_REQ_FOR_INFO;
 				else if (SQL_CURSOR_FORWARD_ONLY != stmt->options.cursor_type)
 					ret = PARSE_REQ_FOR_INFO;
@@ -311,7 +314,8 @@ int HowToPrepareBeforeExec(StatementClass *stmt, BOOL checkOnly)
 						nCallParse = preferParse;
 						break;
 					default:
-						if (num_params <= 0)
+						/* the portal needs the extended query protocol */
+						if (num_params <= 0 && !SC_may_use_portal(stmt))
 							nCallParse = NOPARAM_ONESHOT_CALL_PARSE;
 						else
 							nCallParse = ONESHOT_CALL_PARSE;
@@ -393,7 +397,6 @@ int HowToPrepareBeforeExec(StatementClass *stmt, BOOL checkOnly)
 	return nCallParse;
 }
 
-static
 const char *GetSvpName(const ConnectionClass *conn, char *wrk, int wrksize)
 {
 	snprintf(wrk, wrksize, "_EXEC_SVP_%p", conn);
@@ -424,6 +427,34 @@ void param_status_batch_update(IPDFields *ipdopts, RETCODE retval, SQLLEN target
 	}
 }
 
+/*
+ *	Add a row to the multi-row INSERT being deferred (MultiRowInsert).
+ *	The statement of the first row is taken as is and the VALUES of the
+ *	other rows are appended to its VALUES list.
+ */
+static void
+append_deferred_insert(StatementClass *stmt, const char *stmt_with_params)
+{
+	PQExpBuffer	buf = &stmt->stmt_deffered;
+	ssize_t		vstart, vend;
+
+	if (!SC_find_insert_values(stmt_with_params, SC_get_conn(stmt), &vstart, &vend))
+	{
+		/* send the rest of the rows as separate statements */
+		MYLOG(0, "no VALUES list found in the converted statement\n");
+		stmt->multirow_insert = FALSE;
+		appendPQExpBuffer(buf, buf->data[0] ? ";%s" : "%s", stmt_with_params);
+		return;
+	}
+	if (buf->data[0])
+	{
+		appendPQExpBufferChar(buf, ',');
+		appendBinaryPQExpBuffer(buf, stmt_with_params + vstart, vend - vstart);
+	}
+	else
+		appendBinaryPQExpBuffer(buf, stmt_with_params, vend);
+}
+
 static
 RETCODE	Exec_with_parameters_resolved(StatementClass *stmt, EXEC_TYPE exec_type, BOOL *exec_end)
 {
@@ -451,13 +482,17 @@ RETCODE	Exec_with_parameters_resolved(StatementClass *stmt, EXEC_TYPE exec_type,
 	cursor_type = stmt->options.cursor_type;
 	scroll_concurrency = stmt->options.scroll_concurrency;
 	/* Prepare the statement if possible at backend side */
-	if (HowToPrepareBeforeExec(stmt, FALSE) >= allowParse)
+	if (SC_is_async_executing(stmt))
+		;	/* the parameters were resolved before SQL_STILL_EXECUTING */
+	else if (HowToPrepareBeforeExec(stmt, FALSE) >= allowParse)
 		prepare_before_exec = TRUE;
 
 MYLOG(DETAIL_LOG_LEVEL, "prepare_before_exec=%d srv=%d\n", prepare_before_exec, stmt->use_server_side_prepare);
 	/* Create the statement with parameters substituted. */
 	stmt_with_params = stmt->stmt_with_params;
-	if (LAST_EXEC == exec_type)
+	if (SC_is_async_executing(stmt))
+		exec_type = DIRECT_EXEC;
+	else if (LAST_EXEC == exec_type)
 	{
 		if (NULL != stmt_with_params)
 		{
@@ -516,6 +551,8 @@ MYLOG(0, "about to begin SC_execute exec_type=%d\n", exec_type);
 	if (DIRECT_EXEC == exec_type)
 	{
 		retval = SC_execute(stmt);
+		if (SQL_STILL_EXECUTING == retval)
+			RETURN(retval)
 		stmt->count_of_deffered = 0;
 	}
 	else if (DEFFERED_EXEC == exec_type &&
@@ -531,13 +568,14 @@ MYLOG(0, "about to begin SC_execute exec_type=%d\n", exec_type);
 		}
 		else
 		{
-			if (NULL != stmt_with_params)
-			{
-				if (stmt->stmt_deffered.data[0])
-					appendPQExpBuffer(&stmt->stmt_deffered, ";%s", stmt_with_params);
-				else
-					printfPQExpBuffer(&stmt->stmt_deffered, "%s", stmt_with_params);
-			}
+			if (NULL == stmt_with_params)
+				;
+			else if (stmt->multirow_insert)
+				append_deferred_insert(stmt, stmt_with_params);
+			else if (stmt->stmt_deffered.data[0])
+				appendPQExpBuffer(&stmt->stmt_deffered, ";%s", stmt_with_params);
+			else
+				printfPQExpBuffer(&stmt->stmt_deffered, "%s", stmt_with_params);
 			if (NULL != ipdopts->param_status_ptr)
 				ipdopts->param_status_ptr[stmt->exec_current_row] = SQL_PARAM_SUCCESS; // set without exec
 			stmt->count_of_deffered++;
@@ -549,7 +587,11 @@ MYLOG(0, "about to begin SC_execute exec_type=%d\n", exec_type);
 	{
 		if (VALID_EXPBUFFER)
 		{
-			if (NULL != stmt_with_params)
+			if (NULL == stmt_with_params)
+				;
+			else if (stmt->multirow_insert)
+				append_deferred_insert(stmt, stmt_with_params);
+			else
 				appendPQExpBuffer(&stmt->stmt_deffered, ";%s", stmt_with_params);
 			stmt->stmt_with_params = stmt->stmt_deffered.data;
 		}
@@ -805,6 +847,21 @@ CC_is_in_trans(conn), SC_is_rb_stmt(stmt), SC_is_tc_stmt(stmt));
 	{
 		case SQL_NEED_DATA:
 			break;
+		case SQL_STILL_EXECUTING:
+			/*
+			 *	Don't keep the connection locked until the application
+			 *	polls again. CONN_EXECUTING keeps the other statements
+			 *	off the connection meanwhile, and the rollback state
+			 *	stays as it is until ResumeStatementSvp().
+			 */
+			if (stmt->lock_CC_for_rb)
+			{
+				stmt->lock_CC_for_rb = FALSE;
+				stmt->relock_CC_for_rb = TRUE;
+				LEAVE_CONN_CS(conn);
+				MYLOG(DETAIL_LOG_LEVEL, " release conn_lock while executing\n");
+			}
+			return ret;
 		case SQL_ERROR:
 			start_stmt = TRUE;
 			break;
@@ -819,7 +876,12 @@ CC_is_in_trans(conn), SC_is_rb_stmt(stmt), SC_is_tc_stmt(stmt));
 		goto cleanup;
 	if (SQL_ERROR == ret)
 	{
-		if (CC_started_rbpoint(conn) && conn->internal_svp)
+		if (PREPEND_IN_PROGRESS == conn->internal_op)
+		{
+			/* the statement failed before the savepoint was sent with it */
+			conn->internal_op = 0;
+		}
+		else if (CC_started_rbpoint(conn) && conn->internal_svp)
 		{
 			int	cmd_success = CC_internal_rollback(conn, PER_STATEMENT_ROLLBACK, FALSE);
 
@@ -846,6 +908,7 @@ cleanup:
 	if (start_stmt || SQL_ERROR == ret)
 	{
 		stmt->execinfo = 0;
+		stmt->accessed_db_on_read = FALSE;
 		if (SQL_ERROR != ret && CC_accessed_db(conn))
 		{
 			conn->opt_previous = conn->opt_in_progress;
@@ -863,6 +926,55 @@ cleanup:
 	return ret;
 }
 
+/*
+ *	Take the connection lock for the rollback again, when an execution
+ *	which returned SQL_STILL_EXECUTING is polled.
+ */
+void
+ResumeStatementSvp(StatementClass *stmt)
+{
+	if (!stmt->relock_CC_for_rb)
+		return;
+	ENTER_CONN_CS(SC_get_conn(stmt));
+	stmt->lock_CC_for_rb = TRUE;
+	stmt->relock_CC_for_rb = FALSE;
+	MYLOG(DETAIL_LOG_LEVEL, " retake conn_lock\n");
+}
+
+/*
+ *	DiscardStatementSvp() for the functions which read the result of a
+ *	statement, e.g. SQLGetData, SQLDescribeCol and SQLColAttribute.
+ *
+ *	They run with only the statement lock held. If they have accessed
+ *	the server (e.g. convert_lo() or a describe), the rollback state is
+ *	handled as by the other functions, under the connection lock;
+ *	SetStatementSvp() may hold it for the statement already. Otherwise
+ *	the rollback state of the connection belongs to the other statements,
+ *	and is left alone.
+ */
+RETCODE
+DiscardStatementSvpOnRead(StatementClass *stmt, RETCODE ret)
+{
+	if (stmt->accessed_db_on_read && !stmt->lock_CC_for_rb)
+	{
+		ENTER_CONN_CS(SC_get_conn(stmt));
+		stmt->lock_CC_for_rb = TRUE;
+	}
+	if (stmt->lock_CC_for_rb)
+		return DiscardStatementSvp(stmt, ret, FALSE);
+	switch (ret)
+	{
+		case SQL_NEED_DATA:
+		case SQL_STILL_EXECUTING:
+			break;
+		default:
+			stmt->execinfo = 0;
+			break;
+	}
+
+	return ret;
+}
+
 /*
  * Given a SQL statement, see if it is an INSERT INTO statement and extract
  * the name of the table (with schema) of the table that was inserted to.
@@ -940,6 +1052,14 @@ PGAPI_Execute(HSTMT hstmt, UWORD flag)
 	conn = SC_get_conn(stmt);
 	apdopts = SC_get_APDF(stmt);
 
+	if (SC_is_async_executing(stmt))
+	{
+		/* poll the execution which returned SQL_STILL_EXECUTING */
+		ResumeStatementSvp(stmt);
+		retval = Exec_with_parameters_resolved(stmt, DIRECT_EXEC, &exec_end);
+		goto cleanup;
+	}
+
 	/*
 	 * If the statement was previously described, just recycle the old result
 	 * set that contained just the column information.
@@ -1057,6 +1177,14 @@ MYLOG(0, "prepareParameters was %s called, prepare state:%d\n", shouldParse == n
 			stmt->exec_type = DEFFERED_EXEC;
 		else
 			stmt->exec_type = DIRECT_EXEC;
+		stmt->multirow_insert = FALSE;
+		if (DEFFERED_EXEC == stmt->exec_type &&
+		    conn->connInfo.multirow_insert)
+		{
+			ssize_t	vstart, vend;
+
+			stmt->multirow_insert = SC_find_insert_values(stmt->statement, conn, &vstart, &vend);
+		}
 
 MYLOG(0, "prepare=%d maybeBatch=%d exec_type=%d\n", stmt->prepare, maybeBatch, stmt->exec_type);
 		if (ipdopts->param_processed_ptr)
@@ -1180,6 +1308,8 @@ next_param_row:
 	if (0 != (flag & PODBC_WITH_HOLD))
 		SC_set_with_hold(stmt);
 	retval = Exec_with_parameters_resolved(stmt, stmt->exec_type, &exec_end);
+	if (SQL_STILL_EXECUTING == retval)
+		goto cleanup;
 	if (!exec_end)
 	{
 		goto next_param_row;
@@ -1219,17 +1349,22 @@ PGAPI_Transact(HENV henv,
 	 */
 	if (hdbc == SQL_NULL_HDBC && henv != SQL_NULL_HENV)
 	{
-		ConnectionClass * const *conns = getConnList();
-		const int	conn_count = getConnCount();
+		ConnectionClass	**conns;
+		int		conn_count;
+		RETCODE		ret = SQL_SUCCESS;
+
+		if (conns = EN_get_connections((EnvironmentClass *) henv, &conn_count), conn_count < 0)
+			return SQL_ERROR;
 		for (lf = 0; lf < conn_count; lf++)
 		{
-			conn = conns[lf];
-
-			if (conn && CC_get_env(conn) == henv)
-				if (PGAPI_Transact(henv, (HDBC) conn, fType) != SQL_SUCCESS)
-					return SQL_ERROR;
+			if (PGAPI_Transact(henv, (HDBC) conns[lf], fType) != SQL_SUCCESS)
+			{
+				ret = SQL_ERROR;
+				break;
+			}
 		}
-		return SQL_SUCCESS;
+		EN_release_connections(conns, conn_count);
+		return ret;
 	}
 
 	conn = (ConnectionClass *) hdbc;
@@ -1240,7 +1375,19 @@ PGAPI_Transact(HENV henv,
 		CC_set_error(conn, CONN_INVALID_ARGUMENT_NO, "PGAPI_Transact can only be called with SQL_COMMIT or SQL_ROLLBACK as parameter", func);
 		return SQL_ERROR;
 	}
+	/* an execution in SQL_ASYNC_ENABLE_ON mode is still in progress */
+	if (CONN_EXECUTING == conn->status)
+	{
+		CC_set_error(conn, CONN_SEQUENCE_ERROR, "A statement is still executing on the connection", func);
+		return SQL_ERROR;
+	}
 
+	/*
+	 * Other sessions may have changed the catalogs meanwhile, so the
+	 * catalog snapshots don't outlive the transaction.
+	 */
+	if (NULL != conn->cat_snapshot)
+		CC_clear_cat_snapshot(conn);
 	/* If manual commit and in transaction, then proceed. */
 	if (CC_loves_visible_trans(conn) && CC_is_in_trans(conn))
 	{
@@ -1259,6 +1406,243 @@ PGAPI_Transact(HENV henv,
 }
 
 
+/*
+ *	Streaming of SQLPutData data (the StreamPutDataSize option).
+ *
+ *	When the data of a long text or bytea parameter gets larger than
+ *	StreamPutDataSize, it's written to a new large object as it
+ *	arrives rather than kept in EXEC_buffer, and the statement reads
+ *	it with lo_get() (see ResolveOneParam()). This requires that the
+ *	parameters are substituted into the statement by the driver.
+ *	A large object is an ordinary one, so the driver removes it with
+ *	lo_unlink() after the execution, or when the data put is abandoned.
+ */
+static char
+putdata_stream_kind(const StatementClass *stmt, const ConnectionClass *conn,
+		    const ParameterImplClass *iparam, Int2 ctype)
+{
+	if (conn->connInfo.stream_putdata_size <= 0 ||
+	    PREPARE_BY_THE_DRIVER != SC_get_prepare_method(stmt) ||
+	    PG_VERSION_LT(conn, 9.4))	/* lo_get() */
+		return PUTDATA_STREAM_NONE;
+	if (PG_TYPE_BYTEA == PIC_dsp_pgtype(conn, *iparam))
+		return (SQL_C_BINARY == ctype) ? PUTDATA_STREAM_BYTEA : PUTDATA_STREAM_NONE;
+	switch (iparam->SQLType)
+	{
+		case SQL_LONGVARCHAR:
+#ifdef	UNICODE_SUPPORT
+		case SQL_WLONGVARCHAR:
+#endif /* UNICODE_SUPPORT */
+			break;
+		default:
+			return PUTDATA_STREAM_NONE;
+	}
+	if (UTF8 != conn->ccsc)
+		return PUTDATA_STREAM_NONE;
+#ifdef	UNICODE_SUPPORT
+	/* the conversions from the current locale aren't streamed */
+	if (get_convtype() > 0 &&
+	    (conn->ccsc != pg_CS_code(conn->locale_encoding) ||
+	     conn->connInfo.wcs_debug))
+		return PUTDATA_STREAM_NONE;
+	if (SQL_C_WCHAR == ctype)
+		return PUTDATA_STREAM_WTEXT;
+#endif /* UNICODE_SUPPORT */
+	if (SQL_C_CHAR == ctype)
+		return PUTDATA_STREAM_TEXT;
+
+	return PUTDATA_STREAM_NONE;
+}
+
+/*
+ *	Write a piece of the data to the large object, converted as
+ *	ResolveOneParam() would convert the whole value. The end of the
+ *	piece which may form a character or a CR/LF with the next piece
+ *	is held back until the next call, or the last one (buf == NULL).
+ */
+static BOOL
+write_putdata_stream(ConnectionClass *conn, StatementClass *estmt,
+		     PutDataClass *pdata, const char *buf, SQLLEN len)
+{
+	BOOL	last = (NULL == buf);
+	BOOL	ret = FALSE;
+	char	*allocbuf = NULL, *outbuf = NULL;
+	const char	*data;
+	SQLLEN	keep = 0, i, olen;
+
+	if (pdata->carry_len > 0)
+	{
+		if (allocbuf = malloc(pdata->carry_len + len), NULL == allocbuf)
+			goto cleanup;
+		memcpy(allocbuf, pdata->carry, pdata->carry_len);
+		if (len > 0)
+			memcpy(allocbuf + pdata->carry_len, buf, len);
+		len += pdata->carry_len;
+		buf = allocbuf;
+		pdata->carry_len = 0;
+	}
+	if (len <= 0)
+		return TRUE;
+	data = buf;
+	olen = len;
+	switch (pdata->streamed)
+	{
+#ifdef	UNICODE_SUPPORT
+		case PUTDATA_STREAM_WTEXT:
+		{
+			const SQLWCHAR	*wstr = (const SQLWCHAR *) buf;
+			SQLLEN	wcount = len / WCLEN;
+
+			if (!last)
+			{
+				keep = len % WCLEN;
+				/* a high surrogate or a CR */
+				if (wcount > 0 &&
+				    (0xd800 == (wstr[wcount - 1] & 0xfc00) ||
+				     PG_CARRIAGE_RETURN == wstr[wcount - 1]))
+				{
+					wcount--;
+					keep += WCLEN;
+				}
+			}
+			if (0 == wcount)
+			{
+				olen = 0;
+				break;
+			}
+			if (outbuf = ucs2_to_utf8(wstr, wcount, &olen, FALSE), NULL == outbuf)
+				goto cleanup;
+			data = outbuf;
+			break;
+		}
+#endif /* UNICODE_SUPPORT */
+		case PUTDATA_STREAM_TEXT:
+			if (!last && PG_CARRIAGE_RETURN == buf[len - 1])
+			{
+				keep = 1;
+				olen--;
+			}
+			break;
+	}
+	if (keep > 0)
+	{
+		memcpy(pdata->carry, buf + len - keep, keep);
+		pdata->carry_len = (char) keep;
+	}
+	if (olen <= 0)
+	{
+		ret = TRUE;
+		goto cleanup;
+	}
+	if (PUTDATA_STREAM_BYTEA != pdata->streamed &&
+	    conn->connInfo.lf_conversion)
+	{
+		SQLLEN	o;
+
+		/* CR/LF -> LF */
+		if (data != outbuf)
+		{
+			if (outbuf = malloc(olen), NULL == outbuf)
+				goto cleanup;
+			memcpy(outbuf, data, olen);
+			data = outbuf;
+		}
+		for (i = o = 0; i < olen; i++)
+		{
+			if (PG_CARRIAGE_RETURN == outbuf[i] &&
+			    i + 1 < olen && PG_LINEFEED == outbuf[i + 1])
+				continue;
+			outbuf[o++] = outbuf[i];
+		}
+		olen = o;
+	}
+	if (odbc_lo_write(conn, estmt->lobj_fd, (char *) data, (Int4) olen) < 0)
+		goto cleanup;
+	MYLOG(0, "lo_write(stream): " FORMAT_LEN " bytes, " FORMAT_LEN " held back\n", olen, keep);
+	ret = TRUE;
+cleanup:
+	if (allocbuf)
+		free(allocbuf);
+	if (outbuf)
+		free(outbuf);
+
+	return ret;
+}
+
+/*
+ *	Switch the current parameter to streaming. The data put so far is
+ *	written to a new large object and EXEC_buffer is released.
+ */
+static BOOL
+start_putdata_stream(ConnectionClass *conn, StatementClass *estmt,
+		     PutDataClass *pdata, char kind)
+{
+	/* begin transaction if needed */
+	if (!CC_is_in_trans(conn) && !CC_begin(conn))
+		return FALSE;
+	if (pdata->lobj_oid = odbc_lo_creat(conn, INV_READ | INV_WRITE), 0 == pdata->lobj_oid)
+		return FALSE;
+	/* from now on drop_putdata_streams() removes the large object */
+	pdata->streamed = kind;
+	if (estmt->lobj_fd = odbc_lo_open(conn, pdata->lobj_oid, INV_WRITE), estmt->lobj_fd < 0)
+		return FALSE;
+	pdata->carry_len = 0;
+	MYLOG(0, "streaming the data to the large object %u\n", pdata->lobj_oid);
+	if (pdata->EXEC_buffer)
+	{
+		if (!write_putdata_stream(conn, estmt, pdata, pdata->EXEC_buffer, *pdata->EXEC_used))
+			return FALSE;
+		free(pdata->EXEC_buffer);
+		pdata->EXEC_buffer = NULL;
+	}
+
+	return TRUE;
+}
+
+/*
+ *	Remove the large objects of the streamed parameters after the
+ *	execution, or when the data put is abandoned (see SC_free_params()).
+ *	A large object still being written is closed first.
+ */
+void
+drop_putdata_streams(StatementClass *estmt)
+{
+	ConnectionClass	*conn = SC_get_conn(estmt);
+	PutDataInfo	*pdata = SC_get_PDTI(estmt);
+	BOOL		connected, abandoned = FALSE;
+	int		i;
+
+	/* without the connection the large objects can't be removed */
+	connected = (NULL != conn && NULL != conn->pqconn);
+	for (i = 0; i < pdata->allocated; i++)
+	{
+		PutDataClass	*current_pdata = &(pdata->pdata[i]);
+
+		if (PUTDATA_STREAM_NONE == current_pdata->streamed)
+			continue;
+		if (connected && estmt->lobj_fd >= 0)
+		{
+			odbc_lo_close(conn, estmt->lobj_fd);
+			estmt->lobj_fd = -1;
+			abandoned = TRUE;
+		}
+		/* an aborted transaction discards the large object anyway */
+		if (connected &&
+		    !CC_is_in_error_trans(conn) &&
+		    odbc_lo_unlink(conn, current_pdata->lobj_oid) < 0)
+			MYLOG(0, "couldn't remove the large object %u\n", current_pdata->lobj_oid);
+		current_pdata->streamed = PUTDATA_STREAM_NONE;
+		current_pdata->carry_len = 0;
+		current_pdata->lobj_oid = 0;
+	}
+	/* end the transaction begun for the stream */
+	if (abandoned &&
+	    !CC_cursor_count(conn) && CC_does_autocommit(conn) &&
+	    !CC_commit(conn))
+		MYLOG(0, "couldn't commit after removing the large objects\n");
+}
+
+
 RETCODE		SQL_API
 PGAPI_Cancel(HSTMT hstmt)		/* Statement to cancel. */
 {
@@ -1289,8 +1673,9 @@ PGAPI_Cancel(HSTMT hstmt)		/* Statement to cancel. */
 	 * 1. In the middle of SQLParamData / SQLPutData
 	 *    -> cancel the statement
 	 *
-	 * 2. Running a query asynchronously. (asynchronous mode is not supported
-	 *    by psqlODBC)
+	 * 2. Running a query asynchronously.
+	 *    -> Send a query cancel request to the server, and report the
+	 *       cancel when the application polls the execution next time
 	 *
 	 * 3. Busy running a function in another thread.
 	 *    -> Send a query cancel request to the server
@@ -1319,9 +1704,22 @@ PGAPI_Cancel(HSTMT hstmt)		/* Statement to cancel. */
 		estmt->current_exec_param = -1;
 		estmt->put_data = FALSE;
 		cancelNeedDataState(estmt);
+		drop_putdata_streams(estmt);
+		if (estmt->lobj_fd >= 0)
+		{
+			odbc_lo_close(conn, estmt->lobj_fd);
+			estmt->lobj_fd = -1;
+		}
 		LEAVE_STMT_CS(stmt);
 		return ret;
 	}
+	else if (SC_is_async_executing(estmt))
+	{
+		if (!SC_async_cancel(estmt))
+			return SQL_ERROR;
+		else
+			return SQL_SUCCESS;
+	}
 	else if (estmt->status == STMT_EXECUTING)
 	{
 		/*
@@ -1445,6 +1843,16 @@ PGAPI_ParamData(HSTMT hstmt,
 	/* close the large object */
 	if (estmt->lobj_fd >= 0)
 	{
+		/* write what was held back of the streamed data */
+		if (estmt->current_exec_param >= 0 &&
+		    PUTDATA_STREAM_NONE != SC_get_PDTI(estmt)->pdata[estmt->current_exec_param].streamed &&
+		    !write_putdata_stream(conn, estmt, &(SC_get_PDTI(estmt)->pdata[estmt->current_exec_param]), NULL, 0))
+		{
+			SC_set_error(stmt, STMT_EXEC_ERROR, "Couldn't stream the data to a large object", func);
+			drop_putdata_streams(estmt);
+			retval = SQL_ERROR;
+			goto cleanup;
+		}
 		odbc_lo_close(conn, estmt->lobj_fd);
 
 		/* commit transaction if needed */
@@ -1469,6 +1877,7 @@ MYLOG(DETAIL_LOG_LEVEL, "ipdopts=%p\n", ipdopts);
 		UWORD	flag = SC_is_with_hold(stmt) ? PODBC_WITH_HOLD : 0;
 
 		retval = Exec_with_parameters_resolved(estmt, stmt->exec_type, &exec_end);
+		drop_putdata_streams(estmt);
 		if (exec_end)
 		{
 			/**SC_reset_delegate(retval, stmt);**/
@@ -1557,6 +1966,7 @@ PGAPI_PutData(HSTMT hstmt,
 	Int2		ctype;
 	SQLLEN		putlen;
 	BOOL		lenset = FALSE, handling_lo = FALSE;
+	char		stream_kind = PUTDATA_STREAM_NONE;
 
 	MYLOG(0, "entering...\n");
 
@@ -1636,6 +2046,8 @@ PGAPI_PutData(HSTMT hstmt,
 			putlen /= 2;
 		}
 	}
+	else if (!handling_lo)
+		stream_kind = putdata_stream_kind(estmt, conn, current_iparam, ctype);
 
 	if (!estmt->put_data)
 	{							/* first call */
@@ -1652,6 +2064,7 @@ PGAPI_PutData(HSTMT hstmt,
 		}
 
 		*current_pdata->EXEC_used = putlen;
+		current_pdata->streamed = PUTDATA_STREAM_NONE;
 
 		if (cbValue == SQL_NULL_DATA)
 		{
@@ -1701,6 +2114,17 @@ PGAPI_PutData(HSTMT hstmt,
 			retval = odbc_lo_write(conn, estmt->lobj_fd, putbuf, (Int4) putlen);
 			MYLOG(0, "lo_write: cbValue=" FORMAT_LEN ", wrote %d bytes\n", putlen, retval);
 		}
+		else if (PUTDATA_STREAM_NONE != stream_kind &&
+			 putlen > conn->connInfo.stream_putdata_size)
+		{
+			if (!start_putdata_stream(conn, estmt, current_pdata, stream_kind) ||
+			    !write_putdata_stream(conn, estmt, current_pdata, putbuf, putlen))
+			{
+				SC_set_error(stmt, STMT_EXEC_ERROR, "Couldn't stream the data to a large object", func);
+				retval = SQL_ERROR;
+				goto cleanup;
+			}
+		}
 		else
 		{
 			current_pdata->EXEC_buffer = malloc(putlen + 1);
@@ -1728,10 +2152,34 @@ PGAPI_PutData(HSTMT hstmt,
 
 			*current_pdata->EXEC_used += putlen;
 		}
+		else if (PUTDATA_STREAM_NONE != current_pdata->streamed)
+		{
+			if (!write_putdata_stream(conn, estmt, current_pdata, putbuf, putlen))
+			{
+				SC_set_error(stmt, STMT_EXEC_ERROR, "Couldn't stream the data to a large object", func);
+				retval = SQL_ERROR;
+				goto cleanup;
+			}
+			*current_pdata->EXEC_used += putlen;
+		}
 		else
 		{
 			old_pos = *current_pdata->EXEC_used;
-			if (putlen > 0)
+			if (putlen > 0 &&
+			    PUTDATA_STREAM_NONE != stream_kind &&
+			    old_pos + putlen > conn->connInfo.stream_putdata_size)
+			{
+				/* the data gets too large to keep in memory */
+				if (!start_putdata_stream(conn, estmt, current_pdata, stream_kind) ||
+				    !write_putdata_stream(conn, estmt, current_pdata, putbuf, putlen))
+				{
+					SC_set_error(stmt, STMT_EXEC_ERROR, "Couldn't stream the data to a large object", func);
+					retval = SQL_ERROR;
+					goto cleanup;
+				}
+				*current_pdata->EXEC_used += putlen;
+			}
+			else if (putlen > 0)
 			{
 				SQLLEN	used = *current_pdata->EXEC_used + putlen;
 				SQLLEN allocsize;
@@ -854,7 +854,7 @@ MYLOG(0, "CONVERT_FUNCTIONS=" FORMAT_ULEN "\n", value);
 			break;
 		case SQL_ASYNC_MODE:
 			len = 4;
-			value = SQL_AM_NONE;
+			value = SQL_AM_STATEMENT;
 			break;
 		case SQL_BATCH_ROW_COUNT:
 			len = 4;
@@ -1051,6 +1051,19 @@ MYLOG(0, "CONVERT_FUNCTIONS=" FORMAT_ULEN "\n", value);
 #endif
 			len = 4;
 			break;
+		case SQL_MAX_ASYNC_CONCURRENT_STATEMENTS:
+			/* the connection runs one statement at a time */
+			len = 4;
+			value = 1;
+			break;
+		case SQL_ASYNC_NOTIFICATION:
+			len = 4;
+#ifdef	ASYNC_NOTIFICATION
+			value = SQL_ASYNC_NOTIFICATION_CAPABLE;
+#else
+			value = SQL_ASYNC_NOTIFICATION_NOT_CAPABLE;
+#endif /* ASYNC_NOTIFICATION */
+			break;
 		/* The followings aren't implemented yet */
 		case SQL_DATETIME_LITERALS:
 			len = 4;
@@ -1058,8 +1071,6 @@ MYLOG(0, "CONVERT_FUNCTIONS=" FORMAT_ULEN "\n", value);
 			len = 0;
 		case SQL_DRIVER_HDESC:
 			len = 4;
-		case SQL_MAX_ASYNC_CONCURRENT_STATEMENTS:
-			len = 4;
 		case SQL_STANDARD_CLI_CONFORMANCE:
 			len = 4;
 		case SQL_XOPEN_CLI_YEAR:
@@ -1769,6 +1780,391 @@ allow_public_schema(ConnectionClass *conn, const SQLCHAR *szSchemaName, SQLSMALL
 	return stricmp(curschema, (const char *) pubstr) == 0;
 }
 
+/*
+ *	The catalog queries shared by the catalog functions and
+ *	the catalog snapshot.
+ */
+static void
+columns_query_head(PQExpBufferData *query, ConnectionClass *conn)
+{
+	appendPQExpBuffer(query,
+		"select n.nspname, c.relname, a.attname, a.atttypid, "
+		"t.typname, a.attnum, a.attlen, a.atttypmod, a.attnotnull, "
+		"c.relhasrules, c.relkind, c.oid, pg_get_expr(d.adbin, d.adrelid), "
+        "case t.typtype when 'd' then t.typbasetype else 0 end, t.typtypmod, "
+        "%s, %s, c.relhassubclass "
+		"from (((pg_catalog.pg_class c "
+		"inner join pg_catalog.pg_namespace n on n.oid = c.relnamespace",
+            PG_VERSION_GE(conn, 12.0) ? "0" : "c.relhasoids",
+            PG_VERSION_GE(conn, 10.0) ? "attidentity" : "''");
+}
+#define	COLUMNS_QUERY_JOIN_ATTRIBUTE \
+	") inner join pg_catalog.pg_attribute a" \
+	" on (not a.attisdropped)"
+#define	COLUMNS_QUERY_TAIL \
+	" and a.attrelid = c.oid) inner join pg_catalog.pg_type t" \
+	" on t.oid = a.atttypid) left outer join pg_attrdef d" \
+	" on a.atthasdef and d.adrelid = a.attrelid and d.adnum = a.attnum"
+
+static void
+relations_query_head(PQExpBufferData *query, ConnectionClass *conn)
+{
+	appendPQExpBufferStr(query, "select c.relhasrules, c.relkind");
+	if (PG_VERSION_LT(conn, 12.0))
+		appendPQExpBufferStr(query, ", c.relhasoids");
+	else
+		appendPQExpBufferStr(query, ", 0 as relhasoids");
+	appendPQExpBufferStr(query, ", c.relname from pg_catalog.pg_namespace u,"
+					" pg_catalog.pg_class c where "
+					"u.oid = c.relnamespace");
+}
+
+static void
+indexes_query_head(PQExpBufferData *query, ConnectionClass *conn)
+{
+	appendPQExpBuffer(query, "select c.relname, i.indkey, i.indisunique"
+		", i.indisclustered, a.amname, c.relhasrules, n.nspname"
+		", c.oid, %s, %s, d.relname"
+		" from pg_catalog.pg_index i, pg_catalog.pg_class c,"
+		" pg_catalog.pg_class d, pg_catalog.pg_am a,"
+		" pg_catalog.pg_namespace n"
+		" where n.oid = d.relnamespace"
+		" and d.oid = i.indrelid"
+		" and i.indexrelid = c.oid"
+		" and c.relam = a.oid"
+        , PG_VERSION_LT(conn, 12.0) ? "d.relhasoids" : "0"
+		, PG_VERSION_GE(conn, 8.3) ? "i.indoption" : "0");
+}
+#define	INDEXES_QUERY_ORDER \
+	" i.indisprimary desc, i.indisunique, n.nspname, c.relname"
+
+/*
+ * Simplified query to remove assumptions about number of
+ * possible index columns. Courtesy of Tom Lane - thomas
+ * 2000-03-21
+ */
+#define	PKEYS_QUERY_HEAD \
+	"select ta.attname, ia.attnum, ic.relname, n.nspname, tc.relname" \
+	" from pg_catalog.pg_attribute ta," \
+	" pg_catalog.pg_attribute ia, pg_catalog.pg_class tc," \
+	" pg_catalog.pg_index i, pg_catalog.pg_namespace n" \
+	", pg_catalog.pg_class ic"
+#define	PKEYS_QUERY_JOIN \
+	" AND tc.oid = i.indrelid" \
+	" AND n.oid = tc.relnamespace" \
+	" AND i.indisprimary = 't'" \
+	" AND ia.attrelid = i.indexrelid" \
+	" AND ta.attrelid = i.indrelid" \
+	" AND ta.attnum = i.indkey[ia.attnum-1]" \
+	" AND (NOT ta.attisdropped)" \
+	" AND (NOT ia.attisdropped)" \
+	" AND ic.oid = i.indexrelid"
+
+/*
+ * Simplified query to search old fashoned primary key
+ */
+#define	OLD_PKEYS_QUERY_HEAD \
+	"select ta.attname, ia.attnum, ic.relname, n.nspname, NULL" \
+	" from pg_catalog.pg_attribute ta," \
+	" pg_catalog.pg_attribute ia, pg_catalog.pg_class ic," \
+	" pg_catalog.pg_index i, pg_catalog.pg_namespace n" \
+	" where ic.oid = i.indexrelid" \
+	" AND n.oid = ic.relnamespace" \
+	" AND ia.attrelid = i.indexrelid" \
+	" AND ta.attrelid = i.indrelid" \
+	" AND ta.attnum = i.indkey[ia.attnum-1]" \
+	" AND (NOT ta.attisdropped)" \
+	" AND (NOT ia.attisdropped)"
+
+/*
+ *	Catalog snapshot.
+ *
+ *	When the PrefetchCatalog option is on, the first catalog call for
+ *	a schema loads the columns, relations, indexes and primary keys of
+ *	the whole schema in one round trip. SQLColumns, SQLSpecialColumns,
+ *	SQLStatistics and SQLPrimaryKeys then pick their rows from the
+ *	snapshot instead of querying the server each time.
+ *	The snapshots are discarded by DDL commands, ROLLBACK, SQLEndTran or
+ *	SQL_ATTR_PGOPT_PREFETCHCATALOG.
+ */
+static size_t
+catsnap_charlen(int ccsc, const char *str)
+{
+	encoded_str	encstr;
+	size_t	len = 0;
+
+	encoded_str_constr(&encstr, ccsc, str);
+	do
+	{
+		encoded_nextchar(&encstr);
+		len++;
+	} while (str[len] && ENCODE_STATUS(encstr) > 1);
+
+	return len;
+}
+
+/*
+ *	Match a catalog name against an ODBC search pattern as the LIKE
+ *	operator does with the pattern adjustLikePattern() makes.
+ */
+static BOOL
+catsnap_like(int ccsc, const char *name, const char *pattern)
+{
+	const char	*star_p = NULL, *star_n = NULL, *lit;
+	size_t	nlen, plen, pskip;
+
+	while (*name)
+	{
+		nlen = catsnap_charlen(ccsc, name);
+		if ('%' == *pattern)
+		{
+			star_p = ++pattern;
+			star_n = name;
+			continue;
+		}
+		if ('_' == *pattern)
+		{
+			pattern++;
+			name += nlen;
+			continue;
+		}
+		if (SEARCH_PATTERN_ESCAPE == *pattern &&
+		    ('%' == pattern[1] || '_' == pattern[1]))
+		{
+			lit = pattern + 1;
+			plen = 1;
+			pskip = 2;
+		}
+		else
+		{
+			lit = pattern;
+			plen = *pattern ? catsnap_charlen(ccsc, pattern) : 0;
+			pskip = plen;
+		}
+		if (plen > 0 && plen == nlen && strncmp(lit, name, nlen) == 0)
+		{
+			pattern += pskip;
+			name += nlen;
+			continue;
+		}
+		if (NULL == star_p)
+			return FALSE;
+		/* let the last % eat one more character */
+		pattern = star_p;
+		star_n += catsnap_charlen(ccsc, star_n);
+		name = star_n;
+	}
+	while ('%' == *pattern)
+		pattern++;
+
+	return '\0' == *pattern;
+}
+
+/*
+ *	Returns the (malloc'ed) name of the schema the catalog snapshot
+ *	is taken for or NULL if the schema isn't a single one.
+ */
+static char *
+catsnap_schema_name(ConnectionClass *conn, const SQLCHAR *szSchemaName, SQLSMALLINT cbSchemaName, BOOL table_is_valid, BOOL search_pattern)
+{
+	char	*schema, *src, *dest;
+	size_t	len;
+
+	if (!conn->connInfo.prefetch_catalog)
+		return NULL;
+	schema = make_string(szSchemaName, cbSchemaName, NULL, 0);
+	if (NULL == schema || '\0' == schema[0])
+	{
+		const char *curschema;
+
+		if (schema)
+			free(schema);
+		if (!table_is_valid ||
+		    NULL == (curschema = CC_get_current_schema(conn)))
+			return NULL;
+		return strdup(curschema);
+	}
+	if (!search_pattern)
+		return schema;
+	/* unescape the pattern, or give up if it has any wildcard */
+	for (src = dest = schema; *src; src += len)
+	{
+		if ('%' == *src || '_' == *src)
+		{
+			free(schema);
+			return NULL;
+		}
+		if (SEARCH_PATTERN_ESCAPE == *src &&
+		    ('%' == src[1] || '_' == src[1]))
+			src++;
+		len = catsnap_charlen(conn->ccsc, src);
+		memmove(dest, src, len);
+		dest += len;
+	}
+	*dest = '\0';
+
+	return schema;
+}
+
+static CAT_SNAPSHOT *
+catsnap_load(ConnectionClass *conn, const char *schema)
+{
+	CAT_SNAPSHOT	*snap;
+	QResultClass	*res, *qres;
+	PQExpBufferData		query = {0};
+	char		*escSchemaName;
+	const char	*eq_string;
+	int		i;
+
+	for (snap = conn->cat_snapshot; NULL != snap; snap = snap->next)
+	{
+		if (strcmp(SAFE_NAME(snap->schema_name), schema) == 0)
+			return snap;
+	}
+	if (NULL == (escSchemaName = simpleCatalogEscape((const SQLCHAR *) schema, SQL_NTS, conn)))
+		return NULL;
+	eq_string = gen_opestr(eqop, conn);
+	initPQExpBuffer(&query);
+	/* CATSNAP_COLUMNS */
+	columns_query_head(&query, conn);
+	appendPQExpBuffer(&query, " and n.nspname %s'%s'", eq_string, escSchemaName);
+	appendPQExpBufferStr(&query, COLUMNS_QUERY_JOIN_ATTRIBUTE " and a.attnum > 0");
+	appendPQExpBufferStr(&query, COLUMNS_QUERY_TAIL " order by c.relname, attnum;");
+	/* CATSNAP_RELATIONS */
+	relations_query_head(&query, conn);
+	appendPQExpBuffer(&query, " and u.nspname %s'%s' order by c.relname;", eq_string, escSchemaName);
+	/* CATSNAP_INDEXES */
+	indexes_query_head(&query, conn);
+	appendPQExpBuffer(&query, " and n.nspname %s'%s' order by d.relname,", eq_string, escSchemaName);
+	appendPQExpBufferStr(&query, INDEXES_QUERY_ORDER ";");
+	/* CATSNAP_PRIMARY_KEYS */
+	appendPQExpBuffer(&query, PKEYS_QUERY_HEAD " where n.nspname %s'%s'", eq_string, escSchemaName);
+	appendPQExpBufferStr(&query, PKEYS_QUERY_JOIN " order by tc.relname, ia.attnum;");
+	/* CATSNAP_OLD_PRIMARY_KEYS */
+	appendPQExpBuffer(&query, OLD_PKEYS_QUERY_HEAD " AND ic.relname ~ '_pkey$' AND n.nspname %s'%s'", eq_string, escSchemaName);
+	appendPQExpBufferStr(&query, " order by ic.relname, ia.attnum");
+	free(escSchemaName);
+	if (PQExpBufferDataBroken(query))
+		return NULL;
+
+	res = CC_send_query(conn, query.data, NULL, READ_ONLY_QUERY, NULL);
+	termPQExpBuffer(&query);
+	for (i = 0, qres = res; i < NUM_OF_CATSNAP_KINDS; i++, qres = QR_nextr(qres))
+	{
+		if (!QR_command_maybe_successful(qres) ||
+		    PORES_COMMAND_OK == QR_get_rstatus(qres))
+		{
+			MYLOG(0, "couldn't take the snapshot of schema %s\n", schema);
+			QR_Destructor(res);
+			return NULL;
+		}
+	}
+	if (NULL == (snap = (CAT_SNAPSHOT *) calloc(sizeof(CAT_SNAPSHOT), 1)))
+	{
+		QR_Destructor(res);
+		return NULL;
+	}
+	for (i = 0; i < NUM_OF_CATSNAP_KINDS; i++)
+	{
+		snap->result[i] = res;
+		res = QR_nextr(res);
+		QR_nextr(snap->result[i]) = NULL;
+	}
+	QR_Destructor(res);
+	STR_TO_NAME(snap->schema_name, schema);
+	snap->next = conn->cat_snapshot;
+	conn->cat_snapshot = snap;
+	MYLOG(0, "took the snapshot of schema %s\n", schema);
+
+	return snap;
+}
+
+/*
+ *	Let the internal statement return the rows of the catalog snapshot
+ *	whose keycol (and subcol) match the key (and subkey) instead of
+ *	executing the catalog query. A NULL key matches any row.
+ *	Returns FALSE if the snapshot isn't available.
+ */
+static BOOL
+catsnap_set_result(StatementClass *stmt, int kind, const char *schema,
+		   int keycol, const char *key, int subcol, const char *subkey,
+		   BOOL search_pattern)
+{
+	ConnectionClass	*conn = SC_get_conn(stmt);
+	CAT_SNAPSHOT	*snap;
+	QResultClass	*snapres, *res = NULL;
+	TupleField	*tuple, *snaptuple;
+	const char	*value;
+	SQLLEN		i;
+	int		j, num_fields;
+	int		func_cs_count = 0;
+	BOOL		match, ret = FALSE;
+
+	if (NULL == schema)
+		return ret;
+	ENTER_INNER_CONN_CS(conn, func_cs_count);
+	if (NULL == (snap = catsnap_load(conn, schema)))
+		goto cleanup;
+	snapres = snap->result[kind];
+	if (NULL == (res = QR_Constructor()))
+		goto cleanup;
+	QR_set_fields(res, QR_get_fields(snapres));
+	num_fields = QR_NumResultCols(snapres);
+	/*
+	 *	As QR_AddNew() does for the first row, so that the result is
+	 *	complete even if no row matches. QR_set_num_fields() would
+	 *	reset the column info shared with the snapshot.
+	 */
+	res->num_fields = num_fields;
+	QR_set_reached_eof(res);
+	for (i = 0; i < QR_get_num_cached_tuples(snapres); i++)
+	{
+		snaptuple = snapres->backend_tuples + i * num_fields;
+		match = TRUE;
+		if (NULL != key)
+		{
+			value = snaptuple[keycol].value;
+			match = (NULL != value &&
+				(search_pattern ? catsnap_like(conn->ccsc, value, key) : strcmp(value, key) == 0));
+		}
+		if (match && NULL != subkey)
+		{
+			value = snaptuple[subcol].value;
+			match = (NULL != value &&
+				(search_pattern ? catsnap_like(conn->ccsc, value, subkey) : strcmp(value, subkey) == 0));
+		}
+		if (!match)
+			continue;
+		if (NULL == (tuple = QR_AddNew(res)))
+			goto cleanup;
+		for (j = 0; j < num_fields; j++)
+		{
+			if (NULL == snaptuple[j].value)
+				set_tuplefield_null(&tuple[j]);
+			else
+			{
+				tuple[j].len = snaptuple[j].len;
+				if (NULL == (tuple[j].value = strdup(snaptuple[j].value)))
+					goto cleanup;
+			}
+		}
+	}
+	QR_set_rstatus(res, PORES_TUPLES_OK);
+	SC_set_Result(stmt, res);
+	res = NULL;
+	stmt->status = STMT_FINISHED;
+	stmt->currTuple = -1;
+	SC_set_rowset_start(stmt, -1, FALSE);
+	SC_set_current_col(stmt, -1);
+	ret = TRUE;
+cleanup:
+	CLEANUP_FUNC_CONN_CS(func_cs_count, conn);
+	QR_Destructor(res);
+	MYLOG(0, "kind=%d schema=%s key=%s ret=%d\n", kind, schema, key ? key : PRINT_NULL, ret);
+
+	return ret;
+}
+
 #define TABLE_IN_RELKIND	"('r', 'v', 'm', 'f', 'p')"
 
 RETCODE		SQL_API
@@ -2334,6 +2730,7 @@ PGAPI_Columns(HSTMT hstmt,
 	char		not_null[MAX_INFO_STRING],
 				relhasrules[MAX_INFO_STRING], relkind[8], attidentity[2];
 	char	*escSchemaName = NULL, *escTableName = NULL, *escColumnName = NULL;
+	char	*snapSchemaName = NULL, *tableName = NULL, *columnName = NULL;
 	BOOL	search_pattern = TRUE, search_by_ids, relisaview, show_oid_column, row_versioning;
 	ConnInfo   *ci;
 	ConnectionClass *conn;
@@ -2419,6 +2816,8 @@ PGAPI_Columns(HSTMT hstmt,
 			escTableName = simpleCatalogEscape(szTableName, cbTableName, conn);
 			escColumnName = simpleCatalogEscape(szColumnName, cbColumnName, conn);
 		}
+		tableName = make_string(szTableName, cbTableName, NULL, 0);
+		columnName = make_string(szColumnName, cbColumnName, NULL, 0);
 	}
 retry_public_schema:
 	if (!search_by_ids)
@@ -2429,6 +2828,12 @@ retry_public_schema:
 			escSchemaName = adjustLikePattern(szSchemaName, cbSchemaName, conn);
 		else
 			escSchemaName = simpleCatalogEscape(szSchemaName, cbSchemaName, conn);
+		if (snapSchemaName)
+			free(snapSchemaName);
+		snapSchemaName = NULL;
+		/* the catalog snapshot doesn't have system columns */
+		if (NULL == escColumnName || search_pattern)
+			snapSchemaName = catsnap_schema_name(conn, szSchemaName, cbSchemaName, TABLE_IS_VALID(szTableName, cbTableName), search_pattern);
 	}
 	initPQExpBuffer(&columns_query);
 #define	return	DONT_CALL_RETURN_FROM_HERE???
@@ -2437,16 +2842,7 @@ retry_public_schema:
 	 * have the atttypmod field)
 	 */
 	op_string = gen_opestr(like_or_eq, conn);
-	printfPQExpBuffer(&columns_query,
-		"select n.nspname, c.relname, a.attname, a.atttypid, "
-		"t.typname, a.attnum, a.attlen, a.atttypmod, a.attnotnull, "
-		"c.relhasrules, c.relkind, c.oid, pg_get_expr(d.adbin, d.adrelid), "
-        "case t.typtype when 'd' then t.typbasetype else 0 end, t.typtypmod, "
-        "%s, %s, c.relhassubclass "
-		"from (((pg_catalog.pg_class c "
-		"inner join pg_catalog.pg_namespace n on n.oid = c.relnamespace",
-            PG_VERSION_GE(conn, 12.0) ? "0" : "c.relhasoids",
-            PG_VERSION_GE(conn, 10.0) ? "attidentity" : "''");
+	columns_query_head(&columns_query, conn);
 	if (search_by_ids)
 		appendPQExpBuffer(&columns_query, " and c.oid = %u", reloid);
 	else
@@ -2455,8 +2851,7 @@ retry_public_schema:
 			appendPQExpBuffer(&columns_query, " and c.relname %s'%s'", op_string, escTableName);
 		schema_appendPQExpBuffer1(&columns_query, " and n.nspname %s'%.*s'", op_string, escSchemaName, TABLE_IS_VALID(szTableName, cbTableName), conn);
 	}
-	appendPQExpBufferStr(&columns_query, ") inner join pg_catalog.pg_attribute a"
-		" on (not a.attisdropped)");
+	appendPQExpBufferStr(&columns_query, COLUMNS_QUERY_JOIN_ATTRIBUTE);
 	if (0 == attnum && (NULL == escColumnName || like_or_eq != eqop))
 		appendPQExpBufferStr(&columns_query, " and a.attnum > 0");
 	if (search_by_ids)
@@ -2466,10 +2861,7 @@ retry_public_schema:
 	}
 	else if (escColumnName)
 		appendPQExpBuffer(&columns_query, " and a.attname %s'%s'", op_string, escColumnName);
-	appendPQExpBufferStr(&columns_query,
-		" and a.attrelid = c.oid) inner join pg_catalog.pg_type t"
-		" on t.oid = a.atttypid) left outer join pg_attrdef d"
-		" on a.atthasdef and d.adrelid = a.attrelid and d.adnum = a.attnum");
+	appendPQExpBufferStr(&columns_query, COLUMNS_QUERY_TAIL);
 	appendPQExpBufferStr(&columns_query, " order by n.nspname, c.relname, attnum");
 	if (PQExpBufferDataBroken(columns_query))
 	{
@@ -2485,7 +2877,12 @@ retry_public_schema:
 
 	MYLOG(0, "col_stmt = %p\n", col_stmt);
 
-	result = PGAPI_ExecDirect(col_stmt, (SQLCHAR *) columns_query.data, SQL_NTS, PODBC_RDONLY);
+	if (catsnap_set_result(col_stmt, CATSNAP_COLUMNS, snapSchemaName,
+			1, escTableName ? tableName : NULL,
+			2, escColumnName ? columnName : NULL, search_pattern))
+		result = SQL_SUCCESS;
+	else
+		result = PGAPI_ExecDirect(col_stmt, (SQLCHAR *) columns_query.data, SQL_NTS, PODBC_RDONLY);
 	if (!SQL_SUCCEEDED(result))
 	{
 		SC_full_error_copy(stmt, col_stmt, FALSE);
@@ -2894,6 +3291,12 @@ cleanup:
 		free(escTableName);
 	if (escColumnName)
 		free(escColumnName);
+	if (snapSchemaName)
+		free(snapSchemaName);
+	if (tableName)
+		free(tableName);
+	if (columnName)
+		free(columnName);
 	if (col_stmt)
 		PGAPI_FreeStmt(col_stmt, SQL_DROP);
 	MYLOG(0, "leaving stmt=%p\n", stmt);
@@ -2921,6 +3324,7 @@ PGAPI_SpecialColumns(HSTMT hstmt,
 	StatementClass *col_stmt = NULL;
 	PQExpBufferData		columns_query = {0};
 	char		*escSchemaName = NULL, *escTableName = NULL;
+	char		*snapSchemaName = NULL, *tableName = NULL;
 	RETCODE		ret = SQL_ERROR, result;
 	char		relhasrules[MAX_INFO_STRING], relkind[8], relhasoids[8];
 	BOOL		relisaview;
@@ -2963,25 +3367,22 @@ PGAPI_SpecialColumns(HSTMT hstmt,
 		return SQL_ERROR;
 	}
 #define	return	DONT_CALL_RETURN_FROM_HERE???
+	tableName = make_string(szTableName, cbTableName, NULL, 0);
 
 retry_public_schema:
 	if (escSchemaName)
 		free(escSchemaName);
 	escSchemaName = simpleCatalogEscape(szSchemaName, cbSchemaName, conn);
+	if (snapSchemaName)
+		free(snapSchemaName);
+	snapSchemaName = catsnap_schema_name(conn, szSchemaName, cbSchemaName, TABLE_IS_VALID(szTableName, cbTableName), FALSE);
 	eq_string = gen_opestr(eqop, conn);
 	initPQExpBuffer(&columns_query);
 #define	return	DONT_CALL_RETURN_FROM_HERE???
 	/*
 	 * Create the query to find out if this is a view or not...
 	 */
-	appendPQExpBufferStr(&columns_query, "select c.relhasrules, c.relkind");
-   if (PG_VERSION_LT(conn, 12.0))
-       appendPQExpBufferStr(&columns_query, ", c.relhasoids");
-   else
-       appendPQExpBufferStr(&columns_query, ", 0 as relhasoids");
-	appendPQExpBufferStr(&columns_query, " from pg_catalog.pg_namespace u,"
-					" pg_catalog.pg_class c where "
-					"u.oid = c.relnamespace");
+	relations_query_head(&columns_query, conn);
 
 	/* TableName cannot contain a string search pattern */
 	if (escTableName)
@@ -3004,7 +3405,11 @@ retry_public_schema:
 		SC_set_error(stmt, STMT_NO_MEMORY_ERROR, "Out of memory in PGAPI_SpecialColumns()", func);
 		goto cleanup;
 	}
-	result = PGAPI_ExecDirect(col_stmt, (SQLCHAR *) columns_query.data, SQL_NTS, PODBC_RDONLY);
+	if (catsnap_set_result(col_stmt, CATSNAP_RELATIONS, snapSchemaName,
+			3, tableName, -1, NULL, FALSE))
+		result = SQL_SUCCESS;
+	else
+		result = PGAPI_ExecDirect(col_stmt, (SQLCHAR *) columns_query.data, SQL_NTS, PODBC_RDONLY);
 	if (!SQL_SUCCEEDED(result))
 	{
 		SC_full_error_copy(stmt, col_stmt, FALSE);
@@ -3154,6 +3559,10 @@ cleanup:
 		free(escSchemaName);
 	if (escTableName)
 		free(escTableName);
+	if (snapSchemaName)
+		free(snapSchemaName);
+	if (tableName)
+		free(tableName);
 	stmt->status = STMT_FINISHED;
 	stmt->currTuple = -1;
 	SC_set_rowset_start(stmt, -1, FALSE);
@@ -3184,6 +3593,7 @@ PGAPI_Statistics(HSTMT hstmt,
 	PQExpBufferData		index_query = {0};
 	RETCODE		ret = SQL_ERROR, result;
 	char		*escSchemaName = NULL, *table_name = NULL, *escTableName = NULL;
+	char		*snapSchemaName = NULL;
 	char		index_name[MAX_INFO_STRING];
 	short		fields_vector[INDEX_KEYS_STORAGE_COUNT + 1];
 	short		indopt_vector[INDEX_KEYS_STORAGE_COUNT + 1];
@@ -3385,30 +3795,23 @@ PGAPI_Statistics(HSTMT hstmt,
 	eq_string = gen_opestr(eqop, conn);
 	escSchemaName = simpleCatalogEscape((SQLCHAR *) table_schemaname, SQL_NTS, conn);
 	initPQExpBuffer(&index_query);
-	printfPQExpBuffer(&index_query, "select c.relname, i.indkey, i.indisunique"
-		", i.indisclustered, a.amname, c.relhasrules, n.nspname"
-		", c.oid, %s, %s"
-		" from pg_catalog.pg_index i, pg_catalog.pg_class c,"
-		" pg_catalog.pg_class d, pg_catalog.pg_am a,"
-		" pg_catalog.pg_namespace n"
-		" where d.relname %s'%s'"
-		" and n.nspname %s'%s'"
-		" and n.oid = d.relnamespace"
-		" and d.oid = i.indrelid"
-		" and i.indexrelid = c.oid"
-		" and c.relam = a.oid order by"
-        , PG_VERSION_LT(conn, 12.0) ? "d.relhasoids" : "0"
-		, PG_VERSION_GE(conn, 8.3) ? "i.indoption" : "0"
+	indexes_query_head(&index_query, conn);
+	appendPQExpBuffer(&index_query, " and d.relname %s'%s'"
+		" and n.nspname %s'%s' order by"
 		, eq_string, escTableName, eq_string, escSchemaName);
-	appendPQExpBufferStr(&index_query, " i.indisprimary desc,");
-	appendPQExpBufferStr(&index_query, " i.indisunique, n.nspname, c.relname");
+	appendPQExpBufferStr(&index_query, INDEXES_QUERY_ORDER);
 	if (PQExpBufferDataBroken(index_query))
 	{
 		SC_set_error(stmt, STMT_NO_MEMORY_ERROR, "Out of memory in PGAPI_Columns()", func);
 		goto cleanup;
 	}
 
-	result = PGAPI_ExecDirect(indx_stmt, (SQLCHAR *) index_query.data, SQL_NTS, PODBC_RDONLY);
+	snapSchemaName = catsnap_schema_name(conn, (SQLCHAR *) table_schemaname, SQL_NTS, TRUE, FALSE);
+	if (catsnap_set_result(indx_stmt, CATSNAP_INDEXES, snapSchemaName,
+			10, table_name, -1, NULL, FALSE))
+		result = SQL_SUCCESS;
+	else
+		result = PGAPI_ExecDirect(indx_stmt, (SQLCHAR *) index_query.data, SQL_NTS, PODBC_RDONLY);
 	if (!SQL_SUCCEEDED(result))
 	{
 		/*
@@ -3660,6 +4063,8 @@ cleanup:
 		free(escTableName);
 	if (escSchemaName)
 		free(escSchemaName);
+	if (snapSchemaName)
+		free(snapSchemaName);
 	if (column_names)
 	{
 		for (i = 0; i < total_columns; i++)
@@ -3815,6 +4220,8 @@ PGAPI_PrimaryKeys(HSTMT hstmt,
 	const SQLCHAR *szSchemaName;
 	const char *eq_string;
 	char	*escSchemaName = NULL, *escTableName = NULL;
+	char	*snapSchemaName = NULL, *oldPkeyName = NULL;
+	BOOL	snapped = FALSE;
 	static const char *catcn[][2] = {
 		{"TABLE_CAT", "TABLE_QUALIFIER"},
 		{"TABLE_SCHEM", "TABLE_OWNER"},
@@ -3887,6 +4294,8 @@ PGAPI_PrimaryKeys(HSTMT hstmt,
 		szSchemaName = szTableOwner;
 		cbSchemaName = cbTableOwner;
 		escTableName = simpleCatalogEscape(szTableName, cbTableName, conn);
+		if (NULL != (oldPkeyName = malloc(strlen(pktab) + 6)))
+			sprintf(oldPkeyName, "%s_pkey", pktab);
 	}
 	eq_string = gen_opestr(eqop, conn);
 
@@ -3898,6 +4307,9 @@ retry_public_schema:
 			free(escSchemaName);
 		escSchemaName = simpleCatalogEscape(szSchemaName, cbSchemaName, conn);
 		schema_str(pkscm, sizeof(pkscm), (SQLCHAR *) escSchemaName, SQL_NTS, TABLE_IS_VALID(szTableName, cbTableName), conn);
+		if (snapSchemaName)
+			free(snapSchemaName);
+		snapSchemaName = catsnap_schema_name(conn, szSchemaName, cbSchemaName, TABLE_IS_VALID(szTableName, cbTableName), FALSE);
 	}
 
 	result = PGAPI_BindCol(tbl_stmt, 1, internal_asis_type,
@@ -3937,18 +4349,7 @@ retry_public_schema:
 		switch (qno)
 		{
 			case 1:
-
-				/*
-				 * Simplified query to remove assumptions about number of
-				 * possible index columns. Courtesy of Tom Lane - thomas
-				 * 2000-03-21
-				 */
-				appendPQExpBufferStr(&tables_query,
-					"select ta.attname, ia.attnum, ic.relname, n.nspname, tc.relname"
-					" from pg_catalog.pg_attribute ta,"
-					" pg_catalog.pg_attribute ia, pg_catalog.pg_class tc,"
-					" pg_catalog.pg_index i, pg_catalog.pg_namespace n"
-					", pg_catalog.pg_class ic");
+				appendPQExpBufferStr(&tables_query, PKEYS_QUERY_HEAD);
 				if (0 == reloid)
 					appendPQExpBuffer(&tables_query,
 					" where tc.relname %s'%s'"
@@ -3957,37 +4358,17 @@ retry_public_schema:
 				else
 					appendPQExpBuffer(&tables_query, " where tc.oid = %u", reloid);
 
-				appendPQExpBufferStr(&tables_query,
-					" AND tc.oid = i.indrelid"
-					" AND n.oid = tc.relnamespace"
-					" AND i.indisprimary = 't'"
-					" AND ia.attrelid = i.indexrelid"
-					" AND ta.attrelid = i.indrelid"
-					" AND ta.attnum = i.indkey[ia.attnum-1]"
-					" AND (NOT ta.attisdropped)"
-					" AND (NOT ia.attisdropped)"
-					" AND ic.oid = i.indexrelid"
+				appendPQExpBufferStr(&tables_query, PKEYS_QUERY_JOIN
 					" order by ia.attnum");
+				snapped = catsnap_set_result(tbl_stmt, CATSNAP_PRIMARY_KEYS, snapSchemaName, 4, pktab, -1, NULL, FALSE);
 				break;
 			case 2:
-
-				/*
-				 * Simplified query to search old fashoned primary key
-				 */
-				appendPQExpBuffer(&tables_query, "select ta.attname, ia.attnum, ic.relname, n.nspname, NULL"
-					" from pg_catalog.pg_attribute ta,"
-					" pg_catalog.pg_attribute ia, pg_catalog.pg_class ic,"
-					" pg_catalog.pg_index i, pg_catalog.pg_namespace n"
-					" where ic.relname %s'%s_pkey'"
+				appendPQExpBuffer(&tables_query, OLD_PKEYS_QUERY_HEAD
+					" AND ic.relname %s'%s_pkey'"
 					" AND n.nspname %s'%s'"
-					" AND ic.oid = i.indexrelid"
-					" AND n.oid = ic.relnamespace"
-					" AND ia.attrelid = i.indexrelid"
-					" AND ta.attrelid = i.indrelid"
-					" AND ta.attnum = i.indkey[ia.attnum-1]"
-					" AND (NOT ta.attisdropped)"
-					" AND (NOT ia.attisdropped)"
 					" order by ia.attnum", eq_string, escTableName, eq_string, pkscm);
+				snapped = (NULL != oldPkeyName &&
+					   catsnap_set_result(tbl_stmt, CATSNAP_OLD_PRIMARY_KEYS, snapSchemaName, 2, oldPkeyName, -1, NULL, FALSE));
 				break;
 		}
 		if (PQExpBufferDataBroken(tables_query))
@@ -3997,7 +4378,10 @@ retry_public_schema:
 		}
 		MYLOG(0, "tables_query='%s'\n", tables_query.data);
 
-		result = PGAPI_ExecDirect(tbl_stmt, (SQLCHAR *) tables_query.data, SQL_NTS, PODBC_RDONLY);
+		if (snapped)
+			result = SQL_SUCCESS;
+		else
+			result = PGAPI_ExecDirect(tbl_stmt, (SQLCHAR *) tables_query.data, SQL_NTS, PODBC_RDONLY);
 		if (!SQL_SUCCEEDED(result))
 		{
 			SC_full_error_copy(stmt, tbl_stmt, FALSE);
@@ -4078,6 +4462,10 @@ cleanup:
 		free(escSchemaName);
 	if (escTableName)
 		free(escTableName);
+	if (snapSchemaName)
+		free(snapSchemaName);
+	if (oldPkeyName)
+		free(oldPkeyName);
 	/* set up the current tuple pointer for SQLFetch */
 	stmt->currTuple = -1;
 	SC_set_rowset_start(stmt, -1, FALSE);
@@ -167,6 +167,24 @@ odbc_lo_tell(ConnectionClass *conn, int fd)
 		return retval;
 }
 
+
+int
+odbc_lo_unlink(ConnectionClass *conn, OID lobjId)
+{
+	LO_ARG		argv[1];
+	int			retval,
+				result_len;
+
+	argv[0].isint = 1;
+	argv[0].len = 4;
+	argv[0].u.integer = lobjId;
+
+	if (!CC_send_function(conn, "lo_unlink", &retval, &result_len, 1, argv, 1))
+		return -1;
+	else
+		return retval;
+}
+
 Int8
 odbc_lo_lseek64(ConnectionClass *conn, int fd, Int8 offset, Int4 whence)
 {
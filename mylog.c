@@ -27,6 +27,7 @@
 #ifndef WIN32
 #include <pwd.h>
 #include <sys/types.h>
+#include <sys/time.h>
 #include <unistd.h>
 #include <errno.h>
 #define	GENERAL_ERRNO		(errno)
@@ -160,11 +161,11 @@ const char *GetExeProgramName()
 }
 
 #if defined(WIN_MULTITHREAD_SUPPORT)
-static	CRITICAL_SECTION	qlog_cs, mylog_cs;
+static	CRITICAL_SECTION	qlog_cs, mylog_cs, qtrace_cs;
 #elif defined(POSIX_MULTITHREAD_SUPPORT)
-static	pthread_mutex_t	qlog_cs, mylog_cs;
+static	pthread_mutex_t	qlog_cs, mylog_cs, qtrace_cs;
 #endif /* WIN_MULTITHREAD_SUPPORT */
-static int	mylog_on = 0, qlog_on = 0;
+static int	mylog_on = 0, qlog_on = 0, qtrace_on = 0;
 
 #if defined(WIN_MULTITHREAD_SUPPORT)
 #define	INIT_QLOG_CS	InitializeCriticalSection(&qlog_cs)
@@ -175,6 +176,10 @@ static int	mylog_on = 0, qlog_on = 0;
 #define	ENTER_MYLOG_CS	EnterCriticalSection(&mylog_cs)
 #define	LEAVE_MYLOG_CS	LeaveCriticalSection(&mylog_cs)
 #define	DELETE_MYLOG_CS	DeleteCriticalSection(&mylog_cs)
+#define	INIT_QTRACE_CS	InitializeCriticalSection(&qtrace_cs)
+#define	ENTER_QTRACE_CS	EnterCriticalSection(&qtrace_cs)
+#define	LEAVE_QTRACE_CS	LeaveCriticalSection(&qtrace_cs)
+#define	DELETE_QTRACE_CS	DeleteCriticalSection(&qtrace_cs)
 #elif defined(POSIX_MULTITHREAD_SUPPORT)
 #define	INIT_QLOG_CS	pthread_mutex_init(&qlog_cs,0)
 #define	ENTER_QLOG_CS	pthread_mutex_lock(&qlog_cs)
@@ -184,6 +189,10 @@ static int	mylog_on = 0, qlog_on = 0;
 #define	ENTER_MYLOG_CS	pthread_mutex_lock(&mylog_cs)
 #define	LEAVE_MYLOG_CS	pthread_mutex_unlock(&mylog_cs)
 #define	DELETE_MYLOG_CS	pthread_mutex_destroy(&mylog_cs)
+#define	INIT_QTRACE_CS	pthread_mutex_init(&qtrace_cs,0)
+#define	ENTER_QTRACE_CS	pthread_mutex_lock(&qtrace_cs)
+#define	LEAVE_QTRACE_CS	pthread_mutex_unlock(&qtrace_cs)
+#define	DELETE_QTRACE_CS	pthread_mutex_destroy(&qtrace_cs)
 #else
 #define	INIT_QLOG_CS
 #define	ENTER_QLOG_CS
@@ -193,6 +202,10 @@ static int	mylog_on = 0, qlog_on = 0;
 #define	ENTER_MYLOG_CS
 #define	LEAVE_MYLOG_CS
 #define	DELETE_MYLOG_CS
+#define	INIT_QTRACE_CS
+#define	ENTER_QTRACE_CS
+#define	LEAVE_QTRACE_CS
+#define	DELETE_QTRACE_CS
 #endif /* WIN_MULTITHREAD_SUPPORT */
 
 #define MYLOGFILE			"mylog_"
@@ -209,6 +222,8 @@ static int	mylog_on = 0, qlog_on = 0;
 #define QLOGDIR				"c:"
 #endif /* WIN32 */
 
+#define QTRACEFILE			"pgtrace_"
+
 
 int	get_mylog(void)
 {
@@ -218,6 +233,10 @@ int	get_qlog(void)
 {
 	return qlog_on;
 }
+int	get_qtrace(void)
+{
+	return qtrace_on;
+}
 
 const char *po_basename(const char *path)
 {
@@ -309,6 +328,353 @@ static void MLOG_open()
 	}
 }
 
+static FILE *QLOGFP = NULL;
+
+static void QLOG_open()
+{
+	char		filebuf[80];
+
+	if (QLOGFP) return;
+
+	generate_filename(logdir ? logdir : QLOGDIR, QLOGFILE, filebuf, sizeof(filebuf));
+	QLOGFP = fopen(filebuf, PG_BINARY_A);
+	if (!QLOGFP)
+	{
+		generate_homefile(QLOGFILE, filebuf, sizeof(filebuf));
+		QLOGFP = fopen(filebuf, PG_BINARY_A);
+	}
+}
+
+/*
+ *	Format the prefix of a log line, the thread id and/or the elapsed
+ *	time of the process. Used by both the synchronous and the
+ *	asynchronous logging.
+ */
+static int
+log_prefix(char *buf, size_t size, BOOL log_threadid, BOOL log_time)
+{
+	int	len = 0;
+#ifdef	LOGGING_PROCESS_TIME
+	DWORD	proc_time = timeGetTime() - start_time;
+#endif /* LOGGING_PROCESS_TIME */
+
+	buf[0] = '\0';
+	if (log_threadid)
+	{
+#ifdef	WIN_MULTITHREAD_SUPPORT
+#ifdef	LOGGING_PROCESS_TIME
+		len = snprintf(buf, size, "[%u-%d.%03d]", GetCurrentThreadId(), proc_time / 1000, proc_time % 1000);
+#else
+		len = snprintf(buf, size, "[%u]", GetCurrentThreadId());
+#endif /* LOGGING_PROCESS_TIME */
+#endif /* WIN_MULTITHREAD_SUPPORT */
+#if defined(POSIX_MULTITHREAD_SUPPORT)
+		len = snprintf(buf, size, "[%lx]", (unsigned long int) pthread_self());
+#endif /* POSIX_MULTITHREAD_SUPPORT */
+	}
+#ifdef	LOGGING_PROCESS_TIME
+	else if (log_time)
+		len = snprintf(buf, size, "[%d.%03d]", proc_time / 1000, proc_time % 1000);
+#endif /* LOGGING_PROCESS_TIME */
+
+	return len < 0 ? 0 : len;
+}
+
+#define	LOG_PREFIX_SIZE	64
+
+static int
+getLogBufferSize(void)
+{
+	char	temp[16];
+
+	/* LogBufferSize is stored in the driver section */
+	SQLGetPrivateProfileString(DBMS_NAME, INI_LOGBUFFERSIZE, "", temp, sizeof(temp), ODBCINST_INI);
+	if (temp[0])
+		return atoi(temp);
+	return DEFAULT_LOGBUFFERSIZE;
+}
+
+#ifdef	POSIX_MULTITHREAD_SUPPORT
+#define	ASYNC_LOGGING
+#endif /* POSIX_MULTITHREAD_SUPPORT */
+
+#ifdef	ASYNC_LOGGING
+/*
+ *	Asynchronous logging.
+ *
+ *	When LogBufferSize(KB) is set in the driver section, mylog and qlog
+ *	don't touch the log files. The calling thread formats the line in
+ *	its own stack buffer and only copies it into the bounded buffer of
+ *	the log under alog_cs. The writer thread swaps the filled buffer
+ *	with its spare one and writes it out in one batch, so the memory
+ *	used is 2 * LogBufferSize per log. Lines which don't fit in the
+ *	buffer are discarded and counted, and the count is written to the
+ *	log by the writer.
+ */
+#define	ALOG_MYLOG	0
+#define	ALOG_QLOG	1
+#define	ALOG_COUNT	2
+#define	ALOG_LINE_SIZE	1024
+
+typedef struct
+{
+	char	*buf;
+	size_t	used;
+	UInt4	dropped;
+} ALOG_BUFFER;
+
+static	ALOG_BUFFER	alog_buf[ALOG_COUNT];
+static	char	*alog_spare[ALOG_COUNT];	/* owned by the writer */
+static	char	*alog_area = NULL;
+static	BOOL	alog_requested = FALSE;	/* set only by alog_initialize() */
+static	size_t	alog_size = 0;	/* 0 means synchronous logging */
+static	BOOL	alog_started = FALSE, alog_stopping = FALSE;
+static	pthread_t	alog_thread;
+static	pthread_mutex_t	alog_cs;
+static	pthread_cond_t	alog_cond;
+
+/*
+ *	Write out a batch to the log file. The file is opened by the writer
+ *	thread (or by the caller in case of the fallback) if necessary.
+ */
+static void
+alog_write(int which, const char *str, size_t len, UInt4 dropped)
+{
+	if (ALOG_MYLOG == which)
+	{
+		ENTER_MYLOG_CS;
+		if (!MLOGFP)
+		{
+			MLOG_open();
+			if (!MLOGFP)
+				mylog_on = 0;
+		}
+		if (MLOGFP)
+		{
+			if (len > 0)
+				fwrite(str, len, 1, MLOGFP);
+			if (dropped > 0)
+				fprintf(MLOGFP, "[async log]%u lines dropped\n", dropped);
+			fflush(MLOGFP);
+		}
+		LEAVE_MYLOG_CS;
+	}
+	else
+	{
+		ENTER_QLOG_CS;
+		if (!QLOGFP)
+		{
+			QLOG_open();
+			if (!QLOGFP)
+				qlog_on = 0;
+		}
+		if (QLOGFP)
+		{
+			if (len > 0)
+				fwrite(str, len, 1, QLOGFP);
+			if (dropped > 0)
+				fprintf(QLOGFP, "[async log]%u lines dropped\n", dropped);
+			fflush(QLOGFP);
+		}
+		LEAVE_QLOG_CS;
+	}
+}
+
+static void *
+alog_writer(void *arg)
+{
+	char	*buf[ALOG_COUNT];
+	size_t	used[ALOG_COUNT];
+	UInt4	dropped[ALOG_COUNT];
+	int	i;
+	BOOL	empty;
+
+	pthread_mutex_lock(&alog_cs);
+	for (;;)
+	{
+		empty = TRUE;
+		for (i = 0; i < ALOG_COUNT; i++)
+		{
+			if (alog_buf[i].used > 0 || alog_buf[i].dropped > 0)
+				empty = FALSE;
+		}
+		if (empty)
+		{
+			if (alog_stopping)
+				break;
+			pthread_cond_wait(&alog_cond, &alog_cs);
+			continue;
+		}
+		/* swap the buffers and write them out without holding alog_cs */
+		for (i = 0; i < ALOG_COUNT; i++)
+		{
+			buf[i] = alog_buf[i].buf;
+			used[i] = alog_buf[i].used;
+			dropped[i] = alog_buf[i].dropped;
+			alog_buf[i].buf = alog_spare[i];
+			alog_buf[i].used = 0;
+			alog_buf[i].dropped = 0;
+			alog_spare[i] = buf[i];
+		}
+		pthread_mutex_unlock(&alog_cs);
+		for (i = 0; i < ALOG_COUNT; i++)
+		{
+			if (used[i] > 0 || dropped[i] > 0)
+				alog_write(i, buf[i], used[i], dropped[i]);
+		}
+		pthread_mutex_lock(&alog_cs);
+	}
+	pthread_mutex_unlock(&alog_cs);
+
+	return NULL;
+}
+
+/*
+ *	Start the writer thread. alog_cs must be held.
+ *	The spare buffers of the writer are allocated along with the
+ *	buffers of the logs and freed in alog_finalize().
+ */
+static BOOL
+alog_start(void)
+{
+	int	i;
+
+	if (alog_area = malloc(2 * ALOG_COUNT * alog_size), NULL == alog_area)
+		return FALSE;
+	for (i = 0; i < ALOG_COUNT; i++)
+	{
+		alog_buf[i].buf = alog_area + i * alog_size;
+		alog_buf[i].used = 0;
+		alog_buf[i].dropped = 0;
+		alog_spare[i] = alog_area + (ALOG_COUNT + i) * alog_size;
+	}
+	if (0 != pthread_create(&alog_thread, NULL, alog_writer, NULL))
+	{
+		free(alog_area);
+		alog_area = NULL;
+		return FALSE;
+	}
+	alog_started = TRUE;
+
+	return TRUE;
+}
+
+static void
+alog_append(int which, const char *str, size_t len)
+{
+	ALOG_BUFFER	*ab = alog_buf + which;
+
+	pthread_mutex_lock(&alog_cs);
+	if (0 != alog_size && !alog_started && !alog_start())
+		alog_size = 0;	/* fall back to the synchronous logging */
+	if (0 == alog_size)
+	{
+		pthread_mutex_unlock(&alog_cs);
+		alog_write(which, str, len, 0);
+		return;
+	}
+	if (0 == ab->used && 0 == ab->dropped)
+		pthread_cond_signal(&alog_cond);
+	if (ab->used + len > alog_size)
+		ab->dropped++;
+	else
+	{
+		memcpy(ab->buf + ab->used, str, len);
+		ab->used += len;
+	}
+	pthread_mutex_unlock(&alog_cs);
+}
+
+/*
+ *	Format a line outside of any lock and pass it to the writer thread.
+ */
+static void
+alog_vprintf(int which, BOOL log_threadid, BOOL log_time, const char *fmt, va_list args)
+{
+	char	linebuf[ALOG_LINE_SIZE], *line = linebuf;
+	int	plen, len;
+	va_list	cargs;
+
+	plen = log_prefix(linebuf, LOG_PREFIX_SIZE, log_threadid, log_time);
+	va_copy(cargs, args);
+	len = vsnprintf(linebuf + plen, sizeof(linebuf) - plen, fmt, cargs);
+	va_end(cargs);
+	if (len < 0)
+		return;
+	if (plen + len >= sizeof(linebuf))
+	{
+		if (line = malloc(plen + len + 1), NULL != line)
+		{
+			memcpy(line, linebuf, plen);
+			vsnprintf(line + plen, len + 1, fmt, args);
+		}
+		else
+		{
+			line = linebuf;
+			len = sizeof(linebuf) - plen - 1;
+		}
+	}
+	alog_append(which, line, plen + len);
+	if (line != linebuf)
+		free(line);
+}
+
+static void
+alog_atfork_child(void)
+{
+	/* the writer thread doesn't exist in the child */
+	pthread_mutex_init(&alog_cs, NULL);
+	pthread_cond_init(&alog_cond, NULL);
+	if (alog_started)
+	{
+		alog_started = FALSE;
+		free(alog_area);
+		alog_area = NULL;
+	}
+}
+
+static void
+alog_initialize(void)
+{
+	int	size = getLogBufferSize();
+
+	pthread_mutex_init(&alog_cs, NULL);
+	pthread_cond_init(&alog_cond, NULL);
+	if (size > 0)
+	{
+		alog_requested = TRUE;
+		alog_size = (size_t) size * 1024;
+		pthread_atfork(NULL, NULL, alog_atfork_child);
+	}
+}
+
+/*
+ *	Stop the writer thread after it writes out the remaining lines.
+ *	The lines logged later are written synchronously by alog_append().
+ */
+static void
+alog_finalize(void)
+{
+	BOOL	started;
+
+	pthread_mutex_lock(&alog_cs);
+	alog_size = 0;
+	started = alog_started;
+	alog_started = FALSE;
+	alog_stopping = TRUE;
+	pthread_cond_signal(&alog_cond);
+	pthread_mutex_unlock(&alog_cs);
+	if (started)
+	{
+		pthread_join(alog_thread, NULL);
+		free(alog_area);
+		alog_area = NULL;
+	}
+	pthread_cond_destroy(&alog_cond);
+	pthread_mutex_destroy(&alog_cs);
+}
+#endif /* ASYNC_LOGGING */
+
 static int
 mylog_misc(unsigned int option, const char *fmt, va_list args)
 {
@@ -317,11 +683,15 @@ mylog_misc(unsigned int option, const char *fmt, va_list args)
 	BOOL	log_threadid = option;
 
 	gerrno = GENERAL_ERRNO;
+#ifdef	ASYNC_LOGGING
+	if (alog_requested)
+	{
+		alog_vprintf(ALOG_MYLOG, log_threadid, FALSE, fmt, args);
+		GENERAL_ERRNO_SET(gerrno);
+		return 1;
+	}
+#endif /* ASYNC_LOGGING */
 	ENTER_MYLOG_CS;
-#ifdef	LOGGING_PROCESS_TIME
-	if (!start_time)
-		start_time = timeGetTime();
-#endif /* LOGGING_PROCESS_TIME */
 	// va_start(args, fmt);
 
 	if (!MLOGFP)
@@ -333,20 +703,10 @@ mylog_misc(unsigned int option, const char *fmt, va_list args)
 
 	if (MLOGFP)
 	{
-		if (log_threadid)
-		{
-#ifdef	WIN_MULTITHREAD_SUPPORT
-#ifdef	LOGGING_PROCESS_TIME
-		DWORD	proc_time = timeGetTime() - start_time;
-		fprintf(MLOGFP, "[%u-%d.%03d]", GetCurrentThreadId(), proc_time / 1000, proc_time % 1000);
-#else
-		fprintf(MLOGFP, "[%u]", GetCurrentThreadId());
-#endif /* LOGGING_PROCESS_TIME */
-#endif /* WIN_MULTITHREAD_SUPPORT */
-#if defined(POSIX_MULTITHREAD_SUPPORT)
-		fprintf(MLOGFP, "[%lx]", (unsigned long int) pthread_self());
-#endif /* POSIX_MULTITHREAD_SUPPORT */
-		}
+		char	prefix[LOG_PREFIX_SIZE];
+
+		if (log_prefix(prefix, sizeof(prefix), log_threadid, FALSE) > 0)
+			fputs(prefix, MLOGFP);
 		vfprintf(MLOGFP, fmt, args);
 		fflush(MLOGFP);
 	}
@@ -401,45 +761,37 @@ static void mylog_finalize(void)
 }
 
 
-static FILE *QLOGFP = NULL;
-
 static int
 qlog_misc(unsigned int option, const char *fmt, va_list args)
 {
-	char		filebuf[80];
 	int		gerrno;
 
 	if (!qlog_on)	return 0;
 
 	gerrno = GENERAL_ERRNO;
+#ifdef	ASYNC_LOGGING
+	if (alog_requested)
+	{
+		alog_vprintf(ALOG_QLOG, FALSE, 0 != option, fmt, args);
+		GENERAL_ERRNO_SET(gerrno);
+		return 1;
+	}
+#endif /* ASYNC_LOGGING */
 	ENTER_QLOG_CS;
-#ifdef	LOGGING_PROCESS_TIME
-	if (!start_time)
-		start_time = timeGetTime();
-#endif /* LOGGING_PROCESS_TIME */
 
 	if (!QLOGFP)
 	{
-		generate_filename(logdir ? logdir : QLOGDIR, QLOGFILE, filebuf, sizeof(filebuf));
-		QLOGFP = fopen(filebuf, PG_BINARY_A);
-		if (!QLOGFP)
-		{
-			generate_homefile(QLOGFILE, filebuf, sizeof(filebuf));
-			QLOGFP = fopen(filebuf, PG_BINARY_A);
-		}
+		QLOG_open();
 		if (!QLOGFP)
 			qlog_on = 0;
 	}
 
 	if (QLOGFP)
 	{
-		if (option)
-		{
-#ifdef	LOGGING_PROCESS_TIME
-		DWORD	proc_time = timeGetTime() - start_time;
-		fprintf(QLOGFP, "[%d.%03d]", proc_time / 1000, proc_time % 1000);
-#endif /* LOGGING_PROCESS_TIME */
-		}
+		char	prefix[LOG_PREFIX_SIZE];
+
+		if (log_prefix(prefix, sizeof(prefix), FALSE, 0 != option) > 0)
+			fputs(prefix, QLOGFP);
 		vfprintf(QLOGFP, fmt, args);
 		fflush(QLOGFP);
 	}
@@ -490,6 +842,180 @@ static void qlog_finalize(void)
 	DELETE_QLOG_CS;
 }
 
+/*
+ *	Binary query trace.
+ *
+ *	If QueryTrace is set in the driver section, the time spent in each
+ *	prepare/describe/execute/fetch request to the server is recorded in
+ *	pgtrace_xxxx.log (in the Logdir) as fixed-size binary records, which
+ *	are much cheaper to produce than the commlog text and can be decoded
+ *	by test/trace-decode. The records are accumulated in a buffer and
+ *	written out when the buffer is full or at the end of the process.
+ *
+ *	The file starts with QTRACE_MAGIC followed by the records. All the
+ *	integers are in little-endian byte order.
+ *
+ *	offset	size
+ *	0	1	event type(QTRACE_PREPARE etc)
+ *	1	1	status(0: succeeded, 1: failed)
+ *	2	2	length of the query text which follows the record
+ *	4	4	number of parameters
+ *	8	8	connection id(numbered from 1 in the process)
+ *	16	8	start time in microseconds since the epoch
+ *	24	8	elapsed time in microseconds
+ *	32	8	number of rows received(-1 if unknown)
+ *	40	8	bytes of field values received
+ *
+ *	The files of the first version(PGQTRC01) had the elapsed time in
+ *	4 bytes at offset 24 followed by 4 reserved bytes.
+ */
+#define	QTRACE_MAGIC		"PGQTRC02"
+#define	QTRACE_RECORD_SIZE	48
+#define	QTRACE_MAX_QUERY	1024
+#define	QTRACE_BUFSIZE		65536
+
+static FILE *QTRACEFP = NULL;
+static char *qtrace_buf = NULL;
+static size_t	qtrace_used = 0;
+
+Int8
+qtrace_clock(void)
+{
+#ifdef	WIN32
+	FILETIME	ft;
+	ULARGE_INTEGER	ul;
+
+	GetSystemTimeAsFileTime(&ft);
+	ul.LowPart = ft.dwLowDateTime;
+	ul.HighPart = ft.dwHighDateTime;
+	/* 100-nanosecond intervals since 1601-01-01 */
+	return (Int8) ((ul.QuadPart - 116444736000000000ULL) / 10);
+#else
+	struct timeval	tv;
+
+	gettimeofday(&tv, NULL);
+	return (Int8) tv.tv_sec * 1000000 + tv.tv_usec;
+#endif /* WIN32 */
+}
+
+static char *
+qtrace_put(char *p, Int8 val, int len)
+{
+	int	i;
+
+	for (i = 0; i < len; i++, val >>= 8)
+		*p++ = (char) (val & 0xff);
+	return p;
+}
+
+/* qtrace_cs must be held */
+static void
+qtrace_flush(void)
+{
+	if (!QTRACEFP)
+	{
+		char	filebuf[80];
+
+		generate_filename(logdir ? logdir : QLOGDIR, QTRACEFILE, filebuf, sizeof(filebuf));
+		QTRACEFP = fopen(filebuf, PG_BINARY_A);
+		if (!QTRACEFP)
+		{
+			generate_homefile(QTRACEFILE, filebuf, sizeof(filebuf));
+			QTRACEFP = fopen(filebuf, PG_BINARY_A);
+		}
+		if (!QTRACEFP)
+		{
+			qtrace_on = 0;
+			qtrace_used = 0;
+			return;
+		}
+		fseek(QTRACEFP, 0, SEEK_END);
+		if (0 == ftell(QTRACEFP))
+			fwrite(QTRACE_MAGIC, strlen(QTRACE_MAGIC), 1, QTRACEFP);
+	}
+	if (qtrace_used > 0)
+		fwrite(qtrace_buf, qtrace_used, 1, QTRACEFP);
+	fflush(QTRACEFP);
+	qtrace_used = 0;
+}
+
+/*
+ *	Record an event which started at 'start'(the value of qtrace_clock())
+ *	and ends now.
+ */
+void
+qtrace_event(int type, BOOL failed, UInt4 conn_id, Int8 start, const char *query, Int4 num_params, Int8 rows, Int8 bytes)
+{
+	char	*p;
+	size_t	qlen;
+	Int8	elapsed;
+	int	gerrno;
+
+	if (!qtrace_on)	return;
+
+	elapsed = qtrace_clock() - start;
+	qlen = query ? strlen(query) : 0;
+	if (qlen > QTRACE_MAX_QUERY)
+		qlen = QTRACE_MAX_QUERY;
+	gerrno = GENERAL_ERRNO;
+	ENTER_QTRACE_CS;
+	if (NULL == qtrace_buf &&
+	    NULL == (qtrace_buf = malloc(QTRACE_BUFSIZE)))
+		qtrace_on = 0;
+	else
+	{
+		if (qtrace_used + QTRACE_RECORD_SIZE + qlen > QTRACE_BUFSIZE)
+			qtrace_flush();
+		p = qtrace_buf + qtrace_used;
+		p = qtrace_put(p, type, 1);
+		p = qtrace_put(p, failed ? 1 : 0, 1);
+		p = qtrace_put(p, qlen, 2);
+		p = qtrace_put(p, num_params, 4);
+		p = qtrace_put(p, conn_id, 8);
+		p = qtrace_put(p, start, 8);
+		p = qtrace_put(p, elapsed, 8);
+		p = qtrace_put(p, rows, 8);
+		p = qtrace_put(p, bytes, 8);
+		if (qlen > 0)
+			memcpy(p, query, qlen);
+		qtrace_used += QTRACE_RECORD_SIZE + qlen;
+	}
+	LEAVE_QTRACE_CS;
+	GENERAL_ERRNO_SET(gerrno);
+}
+
+static void qtrace_initialize(void)
+{
+	char	temp[16];
+
+	INIT_QTRACE_CS;
+	/* QueryTrace is stored in the driver section */
+	SQLGetPrivateProfileString(DBMS_NAME, INI_QUERYTRACE, "", temp, sizeof(temp), ODBCINST_INI);
+	if (temp[0])
+		qtrace_on = atoi(temp);
+	else
+		qtrace_on = DEFAULT_QUERYTRACE;
+}
+static void qtrace_finalize(void)
+{
+	ENTER_QTRACE_CS;
+	if (qtrace_on && qtrace_used > 0)
+		qtrace_flush();
+	qtrace_on = 0;
+	if (QTRACEFP)
+	{
+		fclose(QTRACEFP);
+		QTRACEFP = NULL;
+	}
+	if (qtrace_buf)
+	{
+		free(qtrace_buf);
+		qtrace_buf = NULL;
+	}
+	LEAVE_QTRACE_CS;
+	DELETE_QTRACE_CS;
+}
+
 static int	globalDebug = -1;
 int
 getGlobalDebug()
@@ -585,15 +1111,30 @@ void InitializeLogging(void)
 	getLogDir(dir, sizeof(dir));
 	if (dir[0])
 		logdir = strdup(dir);
+#ifdef	LOGGING_PROCESS_TIME
+	start_time = timeGetTime();
+#endif /* LOGGING_PROCESS_TIME */
 	mylog_initialize();
 	qlog_initialize();
+	qtrace_initialize();
+#ifdef	ASYNC_LOGGING
+	alog_initialize();
+#endif /* ASYNC_LOGGING */
 	start_logging();
+#ifndef	ASYNC_LOGGING
+	if (getLogBufferSize() > 0)
+		MYLOG(0, "LogBufferSize is ignored, the asynchronous logging isn't available on this platform\n");
+#endif /* ASYNC_LOGGING */
 }
 
 void FinalizeLogging(void)
 {
+#ifdef	ASYNC_LOGGING
+	alog_finalize();
+#endif /* ASYNC_LOGGING */
 	mylog_finalize();
 	qlog_finalize();
+	qtrace_finalize();
 	if (logdir)
 	{
 		free(logdir);
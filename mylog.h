@@ -49,27 +49,37 @@ const char *po_basename(const char *path);
 #define	PREPEND_ITEMS	,po_basename(__FILE__), __FUNCTION__, __LINE__
 #define	QLOG_MARK	"[QLOG]"
 
+#define	MIN_LOG_LEVEL	0
+#define	TUPLE_LOG_LEVEL	1
+#define	DETAIL_LOG_LEVEL	2
+
+/*
+ *	The MYLOG/QLOG calls of a level above MAX_LOG_LEVEL are compiled out
+ *	(see --with-max-log-level).  -1 removes all of them.
+ */
+#ifdef	MAX_LOG_LEVEL
+#define	LOG_LEVEL_ON(level, current)	((level) <= MAX_LOG_LEVEL && (level) < (current))
+#else
+#define	LOG_LEVEL_ON(level, current)	((level) < (current))
+#endif /* MAX_LOG_LEVEL */
+
 #ifdef	__GNUC__
-#define	MYLOG(level, fmt, ...) (level < get_mylog() ? mylog(PREPEND_FMT fmt PREPEND_ITEMS, ##__VA_ARGS__) : 0)
-#define	MYPRINTF(level, fmt, ...) (level < get_mylog() ? myprintf((fmt), ##__VA_ARGS__) : 0)
-#define	QLOG(level, fmt, ...) ((level < get_qlog() ? qlog((fmt), ##__VA_ARGS__) : 0), MYLOG(level, QLOG_MARK fmt, ##__VA_ARGS__))
-#define	QPRINTF(level, fmt, ...) ((level < get_qlog() ? qprintf((fmt), ##__VA_ARGS__) : 0), MYPRINTF(level, (fmt), ##__VA_ARGS__))
+#define	MYLOG(level, fmt, ...) ((void) (LOG_LEVEL_ON(level, get_mylog()) ? mylog(PREPEND_FMT fmt PREPEND_ITEMS, ##__VA_ARGS__) : 0))
+#define	MYPRINTF(level, fmt, ...) ((void) (LOG_LEVEL_ON(level, get_mylog()) ? myprintf((fmt), ##__VA_ARGS__) : 0))
+#define	QLOG(level, fmt, ...) ((void) (LOG_LEVEL_ON(level, get_qlog()) ? qlog((fmt), ##__VA_ARGS__) : 0), MYLOG(level, QLOG_MARK fmt, ##__VA_ARGS__))
+#define	QPRINTF(level, fmt, ...) ((void) (LOG_LEVEL_ON(level, get_qlog()) ? qprintf((fmt), ##__VA_ARGS__) : 0), MYPRINTF(level, (fmt), ##__VA_ARGS__))
 #elif	defined WIN32 /* && _MSC_VER > 1800 */
-#define	MYLOG(level, fmt, ...) (level < get_mylog() ? mylog(PREPEND_FMT fmt PREPEND_ITEMS, __VA_ARGS__) : (printf || printf((fmt), __VA_ARGS__)))
-#define	MYPRINTF(level, fmt, ...) (level < get_mylog() ? myprintf(fmt, __VA_ARGS__) : (printf || printf((fmt), __VA_ARGS__)))
-#define	QLOG(level, fmt, ...) ((level < get_qlog() ? qlog((fmt), __VA_ARGS__) : (printf || printf(fmt, __VA_ARGS__))), MYLOG(level, QLOG_MARK fmt, __VA_ARGS__))
-#define	QPRINTF(level, fmt, ...) ((level < get_qlog() ? qprintf(fmt, __VA_ARGS__) : (printf || printf((fmt), __VA_ARGS__))), MYPRINTF(level, (fmt), __VA_ARGS__))
+#define	MYLOG(level, fmt, ...) ((void) (LOG_LEVEL_ON(level, get_mylog()) ? mylog(PREPEND_FMT fmt PREPEND_ITEMS, __VA_ARGS__) : (printf || printf((fmt), __VA_ARGS__))))
+#define	MYPRINTF(level, fmt, ...) ((void) (LOG_LEVEL_ON(level, get_mylog()) ? myprintf(fmt, __VA_ARGS__) : (printf || printf((fmt), __VA_ARGS__))))
+#define	QLOG(level, fmt, ...) ((void) (LOG_LEVEL_ON(level, get_qlog()) ? qlog((fmt), __VA_ARGS__) : (printf || printf(fmt, __VA_ARGS__))), MYLOG(level, QLOG_MARK fmt, __VA_ARGS__))
+#define	QPRINTF(level, fmt, ...) ((void) (LOG_LEVEL_ON(level, get_qlog()) ? qprintf(fmt, __VA_ARGS__) : (printf || printf((fmt), __VA_ARGS__))), MYPRINTF(level, (fmt), __VA_ARGS__))
 #else
-#define	MYLOG(level, ...) (level < get_mylog() ? (mylog(PREPEND_FMT PREPEND_ITEMS), myprintf(__VA_ARGS__)) : 0)
-#define	MYPRINTF(level, ...) (level < get_mylog() ? myprintf(__VA_ARGS__) : 0)
-#define	QLOG(level, ...) ((level < get_qlog() ? qlog(__VA_ARGS__) : 0), MYLOG(level, QLOG_MARK), MYPRINTF(level, __VA_ARGS__))
-#define	QPRINTF(level, ...) ((level < get_qlog() ? qprintf(__VA_ARGS__) : 0), MYPRINTF(level, __VA_ARGS__))
+#define	MYLOG(level, ...) ((void) (LOG_LEVEL_ON(level, get_mylog()) ? (mylog(PREPEND_FMT PREPEND_ITEMS), myprintf(__VA_ARGS__)) : 0))
+#define	MYPRINTF(level, ...) ((void) (LOG_LEVEL_ON(level, get_mylog()) ? myprintf(__VA_ARGS__) : 0))
+#define	QLOG(level, ...) ((void) (LOG_LEVEL_ON(level, get_qlog()) ? qlog(__VA_ARGS__) : 0), MYLOG(level, QLOG_MARK), MYPRINTF(level, __VA_ARGS__))
+#define	QPRINTF(level, ...) ((void) (LOG_LEVEL_ON(level, get_qlog()) ? qprintf(__VA_ARGS__) : 0), MYPRINTF(level, __VA_ARGS__))
 #endif /* __GNUC__ */
 
-#define	MIN_LOG_LEVEL	0
-#define	TUPLE_LOG_LEVEL	1
-#define	DETAIL_LOG_LEVEL	2
-
 int	get_qlog(void);
 int	get_mylog(void);
 
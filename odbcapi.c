@@ -273,7 +273,7 @@ SQLDescribeCol(HSTMT StatementHandle,
 	ret = PGAPI_DescribeCol(StatementHandle, ColumnNumber,
 							 ColumnName, BufferLength, NameLength,
 						  DataType, ColumnSize, DecimalDigits, Nullable);
-	ret = DiscardStatementSvp(stmt, ret, FALSE);
+	ret = DiscardStatementSvpOnRead(stmt, ret);
 	LEAVE_STMT_CS(stmt);
 	return ret;
 }
@@ -314,7 +314,13 @@ SQLExecDirect(HSTMT StatementHandle,
 	ENTER_STMT_CS(stmt);
 	SC_clear_error(stmt);
 	flag |= PODBC_WITH_HOLD;
-	if (SC_opencheck(stmt, func))
+	if (SC_is_async_executing(stmt))
+	{
+		/* poll the execution which returned SQL_STILL_EXECUTING */
+		ret = PGAPI_Execute(StatementHandle, flag);
+		ret = DiscardStatementSvp(stmt, ret, FALSE);
+	}
+	else if (SC_opencheck(stmt, func))
 		ret = SQL_ERROR;
 	else
 	{
@@ -342,7 +348,13 @@ SQLExecute(HSTMT StatementHandle)
 	ENTER_STMT_CS(stmt);
 	SC_clear_error(stmt);
 	flag |= (PODBC_RECYCLE_STATEMENT | PODBC_WITH_HOLD);
-	if (SC_opencheck(stmt, func))
+	if (SC_is_async_executing(stmt))
+	{
+		/* poll the execution which returned SQL_STILL_EXECUTING */
+		ret = PGAPI_Execute(StatementHandle, flag);
+		ret = DiscardStatementSvp(stmt, ret, FALSE);
+	}
+	else if (SC_opencheck(stmt, func))
 		ret = SQL_ERROR;
 	else
 	{
@@ -462,7 +474,7 @@ SQLGetData(HSTMT StatementHandle,
 	StartRollbackState(stmt);
 	ret = PGAPI_GetData(StatementHandle, ColumnNumber, TargetType,
 						 TargetValue, BufferLength, StrLen_or_Ind);
-	ret = DiscardStatementSvp(stmt, ret, FALSE);
+	ret = DiscardStatementSvpOnRead(stmt, ret);
 	LEAVE_STMT_CS(stmt);
 	return ret;
 }
@@ -550,7 +562,7 @@ SQLNumResultCols(HSTMT StatementHandle,
 	SC_clear_error(stmt);
 	StartRollbackState(stmt);
 	ret = PGAPI_NumResultCols(StatementHandle, ColumnCount);
-	ret = DiscardStatementSvp(stmt, ret, FALSE);
+	ret = DiscardStatementSvpOnRead(stmt, ret);
 	LEAVE_STMT_CS(stmt);
 	return ret;
 }
@@ -143,7 +143,7 @@ SQLColAttribute(SQLHSTMT StatementHandle,
 	ret = PGAPI_ColAttributes(StatementHandle, ColumnNumber,
 					   FieldIdentifier, CharacterAttribute, BufferLength,
 							   StringLength, NumericAttribute);
-	ret = DiscardStatementSvp(stmt,ret, FALSE);
+	ret = DiscardStatementSvpOnRead(stmt, ret);
 	LEAVE_STMT_CS(stmt);
 	return ret;
 }
@@ -341,7 +341,7 @@ SQLColAttributeW(SQLHSTMT	hstmt,
 					bMax, rgbL, pNumAttr);
 			break;
 	}
-	ret = DiscardStatementSvp(stmt, ret, FALSE);
+	ret = DiscardStatementSvpOnRead(stmt, ret);
 	LEAVE_STMT_CS(stmt);
 
 	return ret;
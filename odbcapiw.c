@@ -310,7 +310,7 @@ SQLDescribeColW(HSTMT StatementHandle,
 		if (NameLength)
 			*NameLength = (SQLSMALLINT) nmcount;
 	}
-	ret = DiscardStatementSvp(stmt, ret, FALSE);
+	ret = DiscardStatementSvpOnRead(stmt, ret);
 	LEAVE_STMT_CS(stmt);
 	if (clName)
 		free(clName);
@@ -336,12 +336,18 @@ SQLExecDirectW(HSTMT StatementHandle,
 	ENTER_STMT_CS(stmt);
 	SC_clear_error(stmt);
 	flag |= PODBC_WITH_HOLD;
-	StartRollbackState(stmt);
-	if (SC_opencheck(stmt, func))
-		ret = SQL_ERROR;
+	if (SC_is_async_executing(stmt))
+		/* poll the execution which returned SQL_STILL_EXECUTING */
+		ret = PGAPI_Execute(StatementHandle, flag);
 	else
-		ret = PGAPI_ExecDirect(StatementHandle,
-							   (SQLCHAR *) stxt, (SQLINTEGER) slen, flag);
+	{
+		StartRollbackState(stmt);
+		if (SC_opencheck(stmt, func))
+			ret = SQL_ERROR;
+		else
+			ret = PGAPI_ExecDirect(StatementHandle,
+								   (SQLCHAR *) stxt, (SQLINTEGER) slen, flag);
+	}
 	ret = DiscardStatementSvp(stmt, ret, FALSE);
 	LEAVE_STMT_CS(stmt);
 	if (stxt)
@@ -41,7 +41,15 @@ set_statement_option(ConnectionClass *conn,
 		ci = &(SC_get_conn(stmt)->connInfo);
 	switch (fOption)
 	{
-		case SQL_ASYNC_ENABLE:	/* ignored */
+		case SQL_ASYNC_ENABLE:
+			MYLOG(0, "SQL_ASYNC_ENABLE, vParam = " FORMAT_LEN "\n", vParam);
+			setval = (SQL_ASYNC_ENABLE_ON == vParam) ? SQL_ASYNC_ENABLE_ON : SQL_ASYNC_ENABLE_OFF;
+			if (conn)
+				conn->stmtOptions.async_enable = (SQLUINTEGER) setval;
+			if (stmt)
+				stmt->options.async_enable = (SQLUINTEGER) setval;
+			if (setval != vParam)
+				changed = TRUE;
 			break;
 
 		case SQL_BIND_TYPE:
@@ -367,6 +375,11 @@ PGAPI_SetConnectOption(HDBC hdbc,
 				break;
 			else if (!autocomm_on && SQL_AUTOCOMMIT_OFF == conn->autocommit_public)
 				break;
+			if (CONN_EXECUTING == conn->status)
+			{
+				CC_set_error(conn, CONN_SEQUENCE_ERROR, "A statement is still executing on the connection", func);
+				return SQL_ERROR;
+			}
 			conn->autocommit_public = (autocomm_on ? SQL_AUTOCOMMIT_ON : SQL_AUTOCOMMIT_OFF);
 			MYLOG(0, "AUTOCOMMIT: transact_status=%d, vparam=" FORMAT_LEN "\n", conn->transact_status, vParam);
 
@@ -405,6 +418,11 @@ PGAPI_SetConnectOption(HDBC hdbc,
 				conn->isolation = (UInt4) vParam;
 				break;
 			}
+			if (CONN_EXECUTING == conn->status)
+			{
+				CC_set_error(conn, CONN_SEQUENCE_ERROR, "A statement is still executing on the connection", func);
+				return SQL_ERROR;
+			}
 
 			/* The ODBC spec prohibits changing the isolation level while in manual transaction. */
 			if (CC_is_in_trans(conn))
@@ -704,8 +722,8 @@ PGAPI_GetStmtOption(HSTMT hstmt,
 
 			break;
 
-		case SQL_ASYNC_ENABLE:	/* NOT SUPPORTED */
-			*((SQLINTEGER *) pvParam) = SQL_ASYNC_ENABLE_OFF;
+		case SQL_ASYNC_ENABLE:
+			*((SQLINTEGER *) pvParam) = stmt->options.async_enable;
 			break;
 
 		case SQL_BIND_TYPE:
@@ -283,6 +283,36 @@ getNextToken(
 	return (const char *) tstr;
 }
 
+/*
+ *	getNextToken() doesn't know about comments. Skip the ones at ptr using
+ *	the tokens of the statement (see SC_lex_statement()).
+ */
+static const char *
+skipCommentTokens(const StatementClass *stmt, const char *ptr, Int4 *tidx)
+{
+	const QueryToken	*tok;
+	Int4		pos, i;
+
+	if (NULL == stmt->tokens || NULL == ptr)
+		return ptr;
+	pos = (Int4) (ptr - stmt->statement);
+	for (; *tidx < stmt->num_tokens; (*tidx)++)
+	{
+		tok = stmt->tokens + *tidx;
+		if (tok->pos + tok->len <= pos)
+			continue;
+		if (tok->pos < pos || QTOKEN_COMMENT != tok->type)
+			break;
+		for (i = pos; i < tok->pos && isspace((UCHAR) stmt->statement[i]); i++)
+			;
+		if (i < tok->pos)
+			break;
+		pos = tok->pos + tok->len;
+	}
+
+	return stmt->statement + pos;
+}
+
 static void
 getColInfo(COL_INFO *col_info, FIELD_INFO *fi, int k)
 {
@@ -1270,6 +1300,7 @@ parse_the_statement(StatementClass *stmt, BOOL check_hasoids, BOOL sqlsvr_check)
 	ConnectionClass *conn = SC_get_conn(stmt);
 	IRDFields	*irdflds;
 	BOOL		updatable = TRUE, column_has_alias = FALSE, fupdatable;
+	Int4		tidx = 0;
 
 	MYLOG(0, "entering...\n");
 
@@ -1303,9 +1334,10 @@ parse_the_statement(StatementClass *stmt, BOOL check_hasoids, BOOL sqlsvr_check)
 	}
 #define	return	DONT_CALL_RETURN_FROM_HERE???
 
+	SC_lex_statement(stmt);
 	delim = '\0';
 	token[0] = '\0';
-	while (pptr = (const char *) ptr, (delim != ',') ? STRCPY_FIXED(btoken, token) : (btoken[0] = '\0', 0), (ptr = getNextToken(conn->ccsc, CC_get_escape(conn), pptr, token, sizeof(token), &delim, &quote, &dquote, &numeric)) != NULL)
+	while (pptr = skipCommentTokens(stmt, ptr, &tidx), (delim != ',') ? STRCPY_FIXED(btoken, token) : (btoken[0] = '\0', 0), (ptr = getNextToken(conn->ccsc, CC_get_escape(conn), pptr, token, sizeof(token), &delim, &quote, &dquote, &numeric)) != NULL)
 	{
 		unquoted = !(quote || dquote);
 
@@ -1453,6 +1485,9 @@ MYLOG(0, "blevel=%d btoken=%s in_dot=%d in_field=%d tbname=%s\n", blevel, btoken
 					{
 						free(stmt->statement);
 						stmt->statement = news;
+						/* the tokens are no longer valid */
+						SC_forget_tokens(stmt);
+						SC_forget_query_template(stmt);
 					}
 				}
 			}
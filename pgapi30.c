@@ -404,6 +404,7 @@ PGAPI_GetConnectAttr(HDBC ConnectionHandle,
 					 SQLINTEGER Attribute, PTR Value,
 					 SQLINTEGER BufferLength, SQLINTEGER *StringLength)
 {
+	CSTR func = "PGAPI_GetConnectAttr";
 	ConnectionClass *conn = (ConnectionClass *) ConnectionHandle;
 	RETCODE	ret = SQL_SUCCESS;
 	SQLINTEGER	len = 4;
@@ -412,7 +413,7 @@ PGAPI_GetConnectAttr(HDBC ConnectionHandle,
 	switch (Attribute)
 	{
 		case SQL_ATTR_ASYNC_ENABLE:
-			*((SQLINTEGER *) Value) = SQL_ASYNC_ENABLE_OFF;
+			*((SQLINTEGER *) Value) = conn->stmtOptions.async_enable;
 			break;
 		case SQL_ATTR_AUTO_IPD:
 			*((SQLINTEGER *) Value) = SQL_FALSE;
@@ -471,6 +472,59 @@ PGAPI_GetConnectAttr(HDBC ConnectionHandle,
 		case SQL_ATTR_PGOPT_IGNORETIMEOUT:
 			*((SQLINTEGER *) Value) = conn->connInfo.ignore_timeout;
 			break;
+		case SQL_ATTR_PGOPT_PREFETCHCATALOG:
+			*((SQLINTEGER *) Value) = conn->connInfo.prefetch_catalog;
+			break;
+		case SQL_ATTR_PGOPT_PERFCOUNTERS:
+			len = sizeof(conn->perf);
+			if (BufferLength <= 0)
+			{
+				CC_set_error(conn, CONN_INVALID_BUFFER_LENGTH, "Invalid buffer length for the performance counters", func);
+				return SQL_ERROR;
+			}
+			memcpy(Value, &conn->perf, BufferLength < len ? BufferLength : len);
+			if (BufferLength < len)
+			{
+				CC_set_error(conn, CONN_TRUNCATED, "The buffer was too small for the performance counters.", func);
+				ret = SQL_SUCCESS_WITH_INFO;
+			}
+			break;
+		case SQL_ATTR_PGOPT_PERFTIMING:
+			*((SQLINTEGER *) Value) = conn->perf_timing;
+			break;
+		case SQL_ATTR_PGOPT_FETCHREADAHEAD:
+			*((SQLINTEGER *) Value) = conn->connInfo.fetch_readahead;
+			break;
+		case SQL_ATTR_PGOPT_FETCHBYTES:
+			*((SQLINTEGER *) Value) = conn->connInfo.fetch_bytes;
+			break;
+		case SQL_ATTR_PGOPT_FETCHLATENCY:
+			*((SQLINTEGER *) Value) = conn->connInfo.fetch_latency;
+			break;
+		case SQL_ATTR_PGOPT_FETCHMAXROWS:
+			*((SQLINTEGER *) Value) = conn->connInfo.fetch_max_rows;
+			break;
+		case SQL_ATTR_PGOPT_PORTALFETCH:
+			*((SQLINTEGER *) Value) = conn->connInfo.portal_fetch;
+			break;
+		case SQL_ATTR_PGOPT_TUPLECACHELIMIT:
+			*((SQLINTEGER *) Value) = conn->connInfo.tuple_cache_limit;
+			break;
+		case SQL_ATTR_PGOPT_DESCRIBECACHE:
+			*((SQLINTEGER *) Value) = conn->connInfo.describe_cache;
+			break;
+		case SQL_ATTR_PGOPT_MULTIROWINSERT:
+			*((SQLINTEGER *) Value) = conn->connInfo.multirow_insert;
+			break;
+		case SQL_ATTR_PGOPT_STREAMPUTDATASIZE:
+			*((SQLINTEGER *) Value) = conn->connInfo.stream_putdata_size;
+			break;
+		case SQL_ATTR_PGOPT_STMTPOOLSIZE:
+			*((SQLINTEGER *) Value) = conn->connInfo.stmt_pool_size;
+			break;
+		case SQL_ATTR_PGOPT_PIPELINESAVEPOINT:
+			*((SQLINTEGER *) Value) = conn->connInfo.pipeline_savepoint;
+			break;
 		default:
 			ret = PGAPI_GetConnectOption(ConnectionHandle, (UWORD) Attribute, Value, &len, BufferLength);
 	}
@@ -1648,10 +1702,38 @@ PGAPI_GetStmtAttr(HSTMT StatementHandle,
 			/* case SQL_ATTR_ROW_BIND_TYPE: ** == SQL_BIND_TYPE(ODBC2.0) */
 			SC_set_error(stmt, DESC_INVALID_OPTION_IDENTIFIER, "Unsupported statement option (Get)", func);
 			return SQL_ERROR;
+		case SQL_ATTR_PGOPT_PERFCOUNTERS:
+			len = sizeof(stmt->perf);
+			if (BufferLength <= 0)
+			{
+				SC_set_error(stmt, STMT_INVALID_BUFFER_LENGTH, "Invalid buffer length for the performance counters", func);
+				return SQL_ERROR;
+			}
+			memcpy(Value, &stmt->perf, BufferLength < len ? BufferLength : len);
+			if (BufferLength < len)
+			{
+				SC_set_error(stmt, STMT_TRUNCATED, "The buffer was too small for the performance counters.", func);
+				ret = SQL_SUCCESS_WITH_INFO;
+			}
+			break;
+#ifdef	ASYNC_NOTIFICATION
+		case SQL_ATTR_ASYNC_STMT_EVENT:	/* 29 */
+			*((SQLPOINTER *) Value) = stmt->async_event;
+			len = sizeof(SQLPOINTER);
+			break;
+		case SQL_ATTR_ASYNC_STMT_NOTIFICATION_CALLBACK:	/* 30 */
+			*((PG_ASYNC_NOTIFICATION_CALLBACK *) Value) = stmt->async_callback;
+			len = sizeof(SQLPOINTER);
+			break;
+		case SQL_ATTR_ASYNC_STMT_NOTIFICATION_CONTEXT:	/* 31 */
+			*((SQLPOINTER *) Value) = stmt->async_context;
+			len = sizeof(SQLPOINTER);
+			break;
+#endif /* ASYNC_NOTIFICATION */
 		default:
 			ret = PGAPI_GetStmtOption(StatementHandle, (SQLSMALLINT) Attribute, Value, &len, BufferLength);
 	}
-	if (ret == SQL_SUCCESS && StringLength)
+	if (SQL_SUCCEEDED(ret) && StringLength)
 		*StringLength = len;
 	return ret;
 }
@@ -1711,6 +1793,11 @@ PGAPI_SetConnectAttr(HDBC ConnectionHandle,
 				unsupported = TRUE;
 			break;
 		case SQL_ATTR_ASYNC_ENABLE:
+			if (SQL_ASYNC_ENABLE_ON == CAST_UPTR(SQLUINTEGER, Value))
+				conn->stmtOptions.async_enable = SQL_ASYNC_ENABLE_ON;
+			else
+				conn->stmtOptions.async_enable = SQL_ASYNC_ENABLE_OFF;
+			break;
 		case SQL_ATTR_CONNECTION_DEAD:
 		case SQL_ATTR_CONNECTION_TIMEOUT:
 			unsupported = TRUE;
@@ -1806,6 +1893,66 @@ PGAPI_SetConnectAttr(HDBC ConnectionHandle,
 			conn->connInfo.ignore_timeout = CAST_PTR(SQLINTEGER, Value);
 			MYLOG(0, "ignore_timeout => %d\n", conn->connInfo.ignore_timeout);
 			break;
+		case SQL_ATTR_PGOPT_PREFETCHCATALOG:
+			/* setting the option also discards the snapshots taken so far */
+			CC_clear_cat_snapshot(conn);
+			conn->connInfo.prefetch_catalog = CAST_PTR(SQLINTEGER, Value);
+			MYLOG(0, "prefetch_catalog => %d\n", conn->connInfo.prefetch_catalog);
+			break;
+		case SQL_ATTR_PGOPT_PERFCOUNTERS:
+			/* any value resets the counters */
+			memset(&conn->perf, 0, sizeof(conn->perf));
+			break;
+		case SQL_ATTR_PGOPT_PERFTIMING:
+			conn->perf_timing = (0 != CAST_PTR(SQLINTEGER, Value));
+			MYLOG(0, "perf_timing => %d\n", conn->perf_timing);
+			break;
+		case SQL_ATTR_PGOPT_FETCHREADAHEAD:
+			conn->connInfo.fetch_readahead = CAST_PTR(SQLINTEGER, Value);
+			MYLOG(0, "fetch_readahead => %d\n", conn->connInfo.fetch_readahead);
+			break;
+		case SQL_ATTR_PGOPT_FETCHBYTES:
+			conn->connInfo.fetch_bytes = CAST_PTR(SQLINTEGER, Value);
+			MYLOG(0, "fetch_bytes => %d\n", conn->connInfo.fetch_bytes);
+			break;
+		case SQL_ATTR_PGOPT_FETCHLATENCY:
+			conn->connInfo.fetch_latency = CAST_PTR(SQLINTEGER, Value);
+			MYLOG(0, "fetch_latency => %d\n", conn->connInfo.fetch_latency);
+			break;
+		case SQL_ATTR_PGOPT_FETCHMAXROWS:
+			conn->connInfo.fetch_max_rows = CAST_PTR(SQLINTEGER, Value);
+			MYLOG(0, "fetch_max_rows => %d\n", conn->connInfo.fetch_max_rows);
+			break;
+		case SQL_ATTR_PGOPT_PORTALFETCH:
+			conn->connInfo.portal_fetch = CAST_PTR(SQLINTEGER, Value);
+			MYLOG(0, "portal_fetch => %d\n", conn->connInfo.portal_fetch);
+			break;
+		case SQL_ATTR_PGOPT_TUPLECACHELIMIT:
+			conn->connInfo.tuple_cache_limit = CAST_PTR(SQLINTEGER, Value);
+			MYLOG(0, "tuple_cache_limit => %d\n", conn->connInfo.tuple_cache_limit);
+			break;
+		case SQL_ATTR_PGOPT_DESCRIBECACHE:
+			/* setting the option also discards the cached descriptions */
+			CC_clear_desc_cache(conn);
+			conn->connInfo.describe_cache = CAST_PTR(SQLINTEGER, Value);
+			MYLOG(0, "describe_cache => %d\n", conn->connInfo.describe_cache);
+			break;
+		case SQL_ATTR_PGOPT_MULTIROWINSERT:
+			conn->connInfo.multirow_insert = CAST_PTR(SQLINTEGER, Value);
+			MYLOG(0, "multirow_insert => %d\n", conn->connInfo.multirow_insert);
+			break;
+		case SQL_ATTR_PGOPT_STREAMPUTDATASIZE:
+			conn->connInfo.stream_putdata_size = CAST_PTR(SQLINTEGER, Value);
+			MYLOG(0, "stream_putdata_size => %d\n", conn->connInfo.stream_putdata_size);
+			break;
+		case SQL_ATTR_PGOPT_STMTPOOLSIZE:
+			conn->connInfo.stmt_pool_size = CAST_PTR(SQLINTEGER, Value);
+			MYLOG(0, "stmt_pool_size => %d\n", conn->connInfo.stmt_pool_size);
+			break;
+		case SQL_ATTR_PGOPT_PIPELINESAVEPOINT:
+			conn->connInfo.pipeline_savepoint = CAST_PTR(SQLINTEGER, Value);
+			MYLOG(0, "pipeline_savepoint => %d\n", conn->connInfo.pipeline_savepoint);
+			break;
 		default:
 			if (Attribute < 65536)
 				ret = PGAPI_SetConnectOption(ConnectionHandle, (SQLUSMALLINT) Attribute, (SQLLEN) Value);
@@ -2016,6 +2163,21 @@ MYLOG(DETAIL_LOG_LEVEL, "set ard=%p\n", stmt->ard);
 		case SQL_ATTR_ROW_ARRAY_SIZE:	/* 27 */
 			SC_get_ARDF(stmt)->size_of_rowset = CAST_UPTR(SQLULEN, Value);
 			break;
+		case SQL_ATTR_PGOPT_PERFCOUNTERS:
+			/* any value resets the counters */
+			memset(&stmt->perf, 0, sizeof(stmt->perf));
+			break;
+#ifdef	ASYNC_NOTIFICATION
+		case SQL_ATTR_ASYNC_STMT_EVENT:	/* 29 */
+			stmt->async_event = Value;
+			break;
+		case SQL_ATTR_ASYNC_STMT_NOTIFICATION_CALLBACK:	/* 30 */
+			stmt->async_callback = (PG_ASYNC_NOTIFICATION_CALLBACK) Value;
+			break;
+		case SQL_ATTR_ASYNC_STMT_NOTIFICATION_CONTEXT:	/* 31 */
+			stmt->async_context = Value;
+			break;
+#endif /* ASYNC_NOTIFICATION */
 		default:
 			return PGAPI_SetStmtOption(StatementHandle, (SQLUSMALLINT) Attribute, (SQLULEN) Value);
 	}
@@ -2033,6 +2195,56 @@ typedef struct
 	int		idx, processed;
 }	bop_cdata;
 
+/*
+ *	Delete all the bookmarked rows with one statement, see
+ *	SC_pos_delete_rows().  Leaves s->idx at 0 if they are to be deleted
+ *	one by one.
+ */
+static
+RETCODE	bulk_delete_rows(bop_cdata *s, QResultClass *res)
+{
+	CSTR func = "bulk_delete_rows";
+	RETCODE	ret;
+	SQLLEN	nrows = s->opts->size_of_rowset, i;
+	SQLSETPOSIROW	*irows;
+	SQLULEN		*global_ridxs;
+	KeySet		*keysets;
+	PG_BM		pg_bm;
+
+	if (nrows < 2 || !res)
+		return SQL_SUCCESS;
+	irows = malloc(sizeof(SQLSETPOSIROW) * nrows);
+	global_ridxs = malloc(sizeof(SQLULEN) * nrows);
+	keysets = malloc(sizeof(KeySet) * nrows);
+	if (!irows || !global_ridxs || !keysets)
+	{
+		ret = SQL_ERROR;
+		SC_set_error(s->stmt, STMT_NO_MEMORY_ERROR, "Couldn't allocate memory for the rows to delete.", func);
+		goto cleanup;
+	}
+	for (i = 0; i < nrows; i++)
+	{
+		pg_bm = SC_Resolve_bookmark(s->opts, i);
+		QR_get_last_bookmark(res, i, &pg_bm.keys);
+		irows[i] = i;
+		global_ridxs[i] = pg_bm.index;
+		keysets[i] = pg_bm.keys;
+	}
+	ret = SC_pos_delete_rows(s->stmt, nrows, irows, global_ridxs, keysets);
+	if (SQL_NO_DATA_FOUND == ret)
+		ret = SQL_SUCCESS;
+	else
+		s->idx = s->processed = nrows;
+cleanup:
+	if (irows)
+		free(irows);
+	if (global_ridxs)
+		free(global_ridxs);
+	if (keysets)
+		free(keysets);
+	return ret;
+}
+
 static
 RETCODE	bulk_ope_callback(RETCODE retcode, void *para)
 {
@@ -2057,6 +2269,8 @@ RETCODE	bulk_ope_callback(RETCODE retcode, void *para)
 	}
 	s->need_data_callback = FALSE;
 	res = SC_get_Curres(s->stmt);
+	if (SQL_DELETE_BY_BOOKMARK == s->operation && 0 == s->idx)
+		ret = bulk_delete_rows(s, res);
 	for (; SQL_ERROR != ret && s->idx < s->opts->size_of_rowset; s->idx++)
 	{
 		if (SQL_ADD != s->operation)
@@ -2119,6 +2333,8 @@ PGAPI_BulkOperations(HSTMT hstmt, SQLSMALLINT operationX)
 	s.stmt = (StatementClass *) hstmt;
 	s.operation = operationX;
 	SC_clear_error(s.stmt);
+	if (SC_asynccheck(s.stmt, func))
+		return SQL_ERROR;
 	s.opts = SC_get_ARDF(s.stmt);
 
 	s.auto_commit_needed = FALSE;
@@ -317,6 +317,20 @@ enum {
 	,SQL_ATTR_PGOPT_MSJET = 65549
 	,SQL_ATTR_PGOPT_BATCHSIZE = 65550
 	,SQL_ATTR_PGOPT_IGNORETIMEOUT = 65551
+	,SQL_ATTR_PGOPT_PREFETCHCATALOG = 65552
+	,SQL_ATTR_PGOPT_PERFCOUNTERS = 65553	/* also for SQLGet/SetStmtAttr() */
+	,SQL_ATTR_PGOPT_PERFTIMING = 65554
+	,SQL_ATTR_PGOPT_FETCHREADAHEAD = 65555
+	,SQL_ATTR_PGOPT_FETCHBYTES = 65556
+	,SQL_ATTR_PGOPT_FETCHLATENCY = 65557
+	,SQL_ATTR_PGOPT_FETCHMAXROWS = 65558
+	,SQL_ATTR_PGOPT_PORTALFETCH = 65559
+	,SQL_ATTR_PGOPT_TUPLECACHELIMIT = 65560
+	,SQL_ATTR_PGOPT_DESCRIBECACHE = 65561
+	,SQL_ATTR_PGOPT_MULTIROWINSERT = 65562
+	,SQL_ATTR_PGOPT_STREAMPUTDATASIZE = 65563
+	,SQL_ATTR_PGOPT_STMTPOOLSIZE = 65564
+	,SQL_ATTR_PGOPT_PIPELINESAVEPOINT = 65565
 };
 RETCODE SQL_API PGAPI_SetConnectAttr(HDBC ConnectionHandle,
 			SQLINTEGER Attribute, PTR Value,
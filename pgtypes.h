@@ -46,6 +46,7 @@
 #define PG_TYPE_MACADDR			829
 #define PG_TYPE_INET			869
 #define PG_TYPE_TEXTARRAY		1009
+#define PG_TYPE_TIDARRAY		1010
 #define PG_TYPE_BPCHARARRAY		1014
 #define PG_TYPE_VARCHARARRAY		1015
 #define PG_TYPE_BPCHAR			1042
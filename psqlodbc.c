@@ -21,6 +21,8 @@
 #include "psqlodbc.h"
 #include "dlg_specific.h"
 #include "environ.h"
+#include "connection.h"
+#include "statement.h"
 #include "misc.h"
 #include <string.h>
 
@@ -39,9 +41,9 @@ BOOL isSqlServr(void) {return 3 == exepgm;}
 RETCODE SQL_API SQLDummyOrdinal(void);
 
 #if defined(WIN_MULTITHREAD_SUPPORT)
-extern	CRITICAL_SECTION	conns_cs, common_cs;
+extern	CRITICAL_SECTION	common_cs;
 #elif defined(POSIX_MULTITHREAD_SUPPORT)
-extern	pthread_mutex_t 	conns_cs, common_cs;
+extern	pthread_mutex_t 	common_cs;
 
 #ifdef	POSIX_THREADMUTEX_SUPPORT
 #ifdef	PG_RECURSIVE_MUTEXATTR
@@ -96,6 +98,10 @@ int	initialize_global_cs(void)
 
 static void finalize_global_cs(void)
 {
+#ifdef	ASYNC_NOTIFICATION
+	FinalizeAsyncNotification();
+#endif /* ASYNC_NOTIFICATION */
+	FinalizeQueryTimer();
 	DELETE_COMMON_CS;
 	DELETE_CONNS_CS;
 	FinalizeLogging();
@@ -349,6 +349,20 @@ extern int posix_snprintf(char *buf, size_t size, const char *format, ...);
 #ifndef	SQL_ATTR_IMP_PARAM_DESC
 #define	SQL_ATTR_IMP_PARAM_DESC	10013
 #endif
+/* ODBC 3.8 notification of asynchronous completion (sqlext.h, sqlspi.h) */
+#ifndef	SQL_ATTR_ASYNC_STMT_EVENT
+#define	SQL_ATTR_ASYNC_STMT_EVENT	29
+#endif
+#ifndef	SQL_ATTR_ASYNC_STMT_NOTIFICATION_CALLBACK
+#define	SQL_ATTR_ASYNC_STMT_NOTIFICATION_CALLBACK	30
+#define	SQL_ATTR_ASYNC_STMT_NOTIFICATION_CONTEXT	31
+#endif
+#ifndef	SQL_ASYNC_NOTIFICATION
+#define	SQL_ASYNC_NOTIFICATION	10025
+#define	SQL_ASYNC_NOTIFICATION_NOT_CAPABLE	0x00000000L
+#define	SQL_ASYNC_NOTIFICATION_CAPABLE	0x00000001L
+#endif
+typedef SQLRETURN (SQL_API *PG_ASYNC_NOTIFICATION_CALLBACK)(SQLPOINTER pContext, BOOL fLast);
 
 /* Driver stuff */
 
@@ -489,6 +503,8 @@ typedef struct IRDFields_ IRDFields;
 typedef struct IPDFields_ IPDFields;
 
 typedef struct col_info COL_INFO;
+typedef struct cat_snapshot CAT_SNAPSHOT;
+typedef struct desc_cache DESC_CACHE;
 typedef struct lo_arg LO_ARG;
 
 typedef struct QResultHold_struct {
@@ -599,6 +615,7 @@ typedef struct StatementOptions_
 	void			*bookmark_ptr;
 	SQLUINTEGER		metadata_id;
 	SQLULEN			stmt_timeout;
+	SQLUINTEGER		async_enable;
 } StatementOptions;
 
 /*	Used to pass extra query info to send_query */
@@ -705,10 +722,22 @@ typedef struct
 	signed char	optional_errors;
 	signed char	ignore_timeout;
 	signed char	fetch_refcursors;
+	signed char	prefetch_catalog;
+	signed char	fetch_readahead;
 	UInt4		extra_opts;
 	Int4		keepalive_idle;
 	Int4		keepalive_interval;
 	Int4		batch_size;
+	Int4		fetch_bytes;	/* adaptive fetch: bytes per block */
+	Int4		fetch_latency;	/* adaptive fetch: msec per block */
+	Int4		fetch_max_rows;	/* adaptive fetch: upper bound of rows */
+	signed char	portal_fetch;
+	Int4		tuple_cache_limit;	/* MB of row values before spilling to a file */
+	Int4		describe_cache;	/* max number of cached query descriptions */
+	signed char	multirow_insert;	/* batch INSERTs into one multi-row INSERT */
+	Int4		stream_putdata_size;	/* bytes of SQLPutData data kept in memory */
+	Int4		stmt_pool_size;	/* max number of dropped statements kept for reuse */
+	signed char	pipeline_savepoint;	/* pipeline the internal savepoint with executions */
 #ifdef	_HANDLE_ENLIST_IN_DTC_
 	signed char	xa_opt;
 #endif /* _HANDLE_ENLIST_IN_DTC_ */
@@ -726,6 +755,42 @@ void	CC_conninfo_init(ConnInfo *conninfo, UInt4 option);
 void	CC_conninfo_release(ConnInfo *conninfo);
 void	CC_copy_conninfo(ConnInfo *ci, const ConnInfo *sci);
 const char *GetExeProgramName();
+
+/* binary query trace(see mylog.c) */
+enum {
+	QTRACE_PREPARE = 1
+	,QTRACE_DESCRIBE
+	,QTRACE_EXECUTE
+	,QTRACE_FETCH
+};
+int	get_qtrace(void);
+Int8	qtrace_clock(void);
+void	qtrace_event(int type, BOOL failed, UInt4 conn_id, Int8 start, const char *query, Int4 num_params, Int8 rows, Int8 bytes);
+#define	QTRACE_START(start)	((start) = (get_qtrace() ? qtrace_clock() : 0))
+#define	QTRACE_EVENT(type, failed, conn, start, query, num_params, rows, bytes) \
+	(get_qtrace() ? qtrace_event(type, failed, (conn)->trace_id, start, query, num_params, rows, bytes) : (void) 0)
+
+/*
+ *	Performance counters of a connection or a statement.
+ *	SQLGetConnectAttr/SQLGetStmtAttr(SQL_ATTR_PGOPT_PERFCOUNTERS) returns
+ *	this as an array of SQLBIGINT in this order.
+ */
+typedef struct
+{
+	Int8	round_trips;	/* requests which waited for the server */
+	Int8	bytes_sent;	/* query text and parameter values sent */
+	Int8	bytes_received;	/* field values received */
+	Int8	rows_fetched;	/* rows received */
+	Int8	results;	/* PGresults processed */
+	Int8	roundtrip_usec;	/* from sending requests until their results are read(*) */
+	Int8	convert_usec;	/* time in copy_and_convert_field()(*) */
+	Int8	tuple_mallocs;	/* allocations for the tuple cache */
+	Int8	plan_hits;	/* executions of already prepared plans */
+} PerfCounters;
+/* (*) measured only with SQL_ATTR_PGOPT_PERFTIMING or QueryTrace on */
+/* The conversion time of a statement is added to the connection's when
+ * the statement is executed again, closed or freed. */
+void	perf_add_delta(PerfCounters *to, const PerfCounters *now, const PerfCounters *before);
 #ifdef	POSIX_MULTITHREAD_SUPPORT
 #if	!defined(HAVE_ECO_THREAD_LOCKS)
 #define	POSIX_THREADMUTEX_SUPPORT
@@ -25,9 +25,15 @@
 #include <stdio.h>
 #include <string.h>
 #include <limits.h>
+#ifndef	WIN32
+#include <sys/mman.h>
+#include <unistd.h>
+#endif /* WIN32 */
 
 static BOOL QR_prepare_for_tupledata(QResultClass *self);
 static BOOL QR_read_tuples_from_pgres(QResultClass *, PGresult **pgres);
+static void QR_start_spill(QResultClass *self, Int4 limit_mb);
+static void QR_free_spill(QResultClass *self);
 
 /*
  *	Used for building a Manual Result only
@@ -48,7 +54,7 @@ QR_set_num_fields(QResultClass *self, int new_num_fields)
 void
 QR_set_position(QResultClass *self, SQLLEN pos)
 {
-	self->tupleField = self->backend_tuples + ((QR_get_rowstart_in_cache(self) + pos) * self->num_fields);
+	self->tupleField = QR_get_tuple_row(self, QR_get_rowstart_in_cache(self) + pos);
 }
 
 
@@ -226,6 +232,13 @@ QR_Constructor(void)
 
 		rv->cache_size = 0;
 		rv->cmd_fetch_size = 0;
+		rv->readahead_size = 0;
+		rv->readahead = NULL;
+		rv->adapt_fetch_size = 0;
+		rv->row_bytes = 0;
+		rv->portal_rows = 0;
+		rv->portal_error = NULL;
+		rv->spill = NULL;
 		rv->rowset_size_include_ommitted = 1;
 		rv->move_direction = 0;
 		rv->keyset = NULL;
@@ -488,6 +501,24 @@ QR_free_memory(QResultClass *self)
 
 	MYLOG(0, "entering fcount=" FORMAT_LEN "\n", num_backend_rows);
 
+	/* discard the block read ahead */
+	if (NULL != self->conn)
+		CC_discard_readahead(self->conn, self);
+	if (NULL != self->readahead)
+	{
+		PQclear(self->readahead);
+		self->readahead = NULL;
+	}
+	self->readahead_size = 0;
+	/* skip the rows left in the portal */
+	if (NULL != self->conn)
+		CC_close_portal(self->conn, self);
+	if (NULL != self->portal_error)
+	{
+		PQclear(self->portal_error);
+		self->portal_error = NULL;
+	}
+
 	if (self->backend_tuples)
 	{
 		ClearCachedRows(self->backend_tuples, num_fields, num_backend_rows);
@@ -497,6 +528,7 @@ QR_free_memory(QResultClass *self)
 		self->dataFilled = FALSE;
 		self->tupleField = NULL;
 	}
+	QR_free_spill(self);
 	if (self->keyset)
 	{
 		ConnectionClass	*conn = QR_get_conn(self);
@@ -678,6 +710,12 @@ MYLOG(DETAIL_LOG_LEVEL, "[%d].PGType %u->%u\n", i, PIC_get_pgtype(ipdopts->param
 
 	/* Then, get the data itself */
 	num_cached_rows = self->num_cached_rows;
+	/* spill the rows of a big result read at once */
+	if (NULL == cursor && NULL != stmt && stmt->external &&
+	    NULL != conn && conn->connInfo.tuple_cache_limit > 0 &&
+	    !QR_haskeyset(self) && NULL == self->spill &&
+	    0 == num_cached_rows)
+		QR_start_spill(self, conn->connInfo.tuple_cache_limit);
 	if (!QR_read_tuples_from_pgres(self, pgres))
 		return FALSE;
 
@@ -737,7 +775,12 @@ QR_close(QResultClass *self)
 	conn = QR_get_conn(self);
 	if (self && QR_get_cursor(self))
 	{
-		if (CC_is_in_error_trans(conn))
+		if (QR_is_portal(self))
+		{
+			/* there's no cursor to close, just stop the rest of the rows */
+			CC_close_portal(conn, self);
+		}
+		else if (CC_is_in_error_trans(conn))
 		{
 			if (QR_is_withhold(self))
 				CC_mark_a_object_to_discard(conn, 'p', QR_get_cursor(self));
@@ -941,6 +984,164 @@ SQLLEN	QR_move_cursor_to_last(QResultClass *self, StatementClass *stmt)
 	return	moved;
 }
 
+/*
+ *	The number of rows to FETCH for the next block of a cursor.
+ */
+static Int4
+QR_fetch_size(const QResultClass *self)
+{
+	Int4		fetch_size;
+
+	if (0 < self->adapt_fetch_size)
+		fetch_size = self->adapt_fetch_size;
+	else
+		fetch_size = QR_get_conn(self)->connInfo.drivers.fetch_max;
+	if ((Int4) QR_get_reqsize(self) > fetch_size)
+		fetch_size = QR_get_reqsize(self);
+
+	return fetch_size;
+}
+
+/*
+ *	Size the next FETCH from the memory per row learned so far
+ *	(FetchBytes) and the time the last FETCH took (FetchLatency).
+ *	The size changes at most twice or half per block and is kept
+ *	between the rowset size and FetchMaxRows.
+ */
+static void
+QR_adapt_fetch_size(QResultClass *self, Int4 fetch_size, Int8 elapsed)
+{
+	const ConnInfo	*ci = &(QR_get_conn(self)->connInfo);
+	Int4		new_size = 0, min_size, max_size;
+
+	if (0 < ci->fetch_bytes && 0 < self->row_bytes)
+		new_size = ci->fetch_bytes / self->row_bytes;
+	if (0 < ci->fetch_latency && 0 < elapsed)
+	{
+		Int8	by_latency = (Int8) fetch_size * ci->fetch_latency * 1000 / elapsed;
+
+		if (0 == new_size || by_latency < new_size)
+			new_size = (Int4) (by_latency < INT_MAX ? by_latency : INT_MAX);
+	}
+	if (0 == new_size)
+		return;
+	if (new_size > fetch_size * 2)
+		new_size = fetch_size * 2;
+	else if (new_size < fetch_size / 2)
+		new_size = fetch_size / 2;
+	min_size = (Int4) QR_get_reqsize(self);
+	if (min_size < 1)
+		min_size = 1;
+	max_size = ci->fetch_max_rows > min_size ? ci->fetch_max_rows : min_size;
+	if (new_size < min_size)
+		new_size = min_size;
+	else if (new_size > max_size)
+		new_size = max_size;
+	if (new_size != fetch_size)
+		MYLOG(0, "fetch size %d -> %d row_bytes=%d elapsed=" FORMATI64 "\n", fetch_size, new_size, self->row_bytes, elapsed);
+	self->adapt_fetch_size = new_size;
+}
+
+/*
+ *	Send the FETCH for the next block so that it's transferred while
+ *	the application is processing the current block (FetchReadAhead).
+ *	Other cursor types may move the cursor and can't be read ahead.
+ */
+static void
+QR_start_readahead(QResultClass *self, StatementClass *stmt)
+{
+	ConnectionClass	*conn = QR_get_conn(self);
+	Int4		readahead_size;
+	char		fetch[128];
+
+	if (!conn->connInfo.fetch_readahead ||
+	    0 < self->readahead_size ||
+	    QR_is_portal(self) ||
+	    NULL == QR_get_cursor(self) ||
+	    QR_once_reached_eof(self) ||
+	    QR_haskeyset(self) ||
+	    SQL_CURSOR_FORWARD_ONLY != stmt->options.cursor_type ||
+	    SQL_CONCUR_READ_ONLY != stmt->options.scroll_concurrency)
+		return;
+
+	readahead_size = QR_fetch_size(self);
+	SPRINTF_FIXED(fetch,
+			 "fetch %d in \"%s\"",
+			 readahead_size, QR_get_cursor(self));
+	if (CC_send_readahead(conn, self, fetch))
+		self->readahead_size = readahead_size;
+}
+
+/*
+ *	Wait for the read-ahead FETCH of the result, if any, before the
+ *	rowset is repositioned, so that the connection is idle meanwhile.
+ *	The block received is kept for QR_next_tuple().
+ */
+void
+QR_finish_readahead(QResultClass *self)
+{
+	ConnectionClass	*conn = QR_get_conn(self);
+
+	if (0 < self->readahead_size && NULL != conn)
+		CC_finish_readahead(conn);
+}
+
+/*
+ *	Read all the rows left in the portal into the cache, after those of
+ *	the current block, because the connection is needed for another
+ *	command (PortalFetch).  An error is kept until the application
+ *	reaches it.
+ */
+void
+QR_read_portal_rest(QResultClass *self)
+{
+	ConnectionClass	*conn = QR_get_conn(self);
+	PGresult	*pgres;
+	BOOL		reached_eof = FALSE, failed = FALSE;
+	SQLLEN		tuple_idx = self->tupleField ? self->tupleField - self->backend_tuples : -1;
+
+	/* one row per result, so that any error comes back here */
+	self->portal_rows = 1;
+	while (NULL != conn->pqconn &&
+		   (pgres = PQgetResult(conn->pqconn)) != NULL)
+	{
+		conn->perf.results++;
+		switch (PQresultStatus(pgres))
+		{
+			case PGRES_TUPLES_OK:
+			case PGRES_SINGLE_TUPLE:
+				if (failed)
+					break;
+				if (enlargeKeyCache(self, 1, "Out of memory while reading the portal") < 0 ||
+					!QR_read_tuples_from_pgres(self, &pgres))
+					failed = TRUE;
+				else if (PGRES_TUPLES_OK == PQresultStatus(pgres))
+					reached_eof = TRUE;
+				break;
+			default:
+				failed = TRUE;
+				if (NULL == self->portal_error)
+				{
+					self->portal_error = pgres;
+					pgres = NULL;
+				}
+				break;
+		}
+		if (pgres)
+			PQclear(pgres);
+	}
+	self->portal_rows = 0;
+	/* the cache may have moved, keep the current row */
+	self->tupleField = tuple_idx >= 0 ? self->backend_tuples + tuple_idx : NULL;
+	MYLOG(0, "read the rest of the portal up to " FORMAT_ULEN " eof=%d\n", self->num_total_read, reached_eof);
+	if (reached_eof && !failed)
+	{
+		QR_set_reached_eof(self);
+		if (self->cursTuple < (Int4) self->num_total_read)
+			self->cursTuple = self->num_total_read;
+	}
+}
+
 /*	This function is called by fetch_tuples() AND SQLFetch() */
 int
 QR_next_tuple(QResultClass *self, StatementClass *stmt)
@@ -964,6 +1165,8 @@ QR_next_tuple(QResultClass *self, StatementClass *stmt)
 	ConnectionClass	*conn;
 	ConnInfo   *ci;
 	BOOL		reached_eof_now = FALSE, curr_eof; /* detecting EOF is pretty important */
+	BOOL		adapt_size;
+	Int8		fetch_start = 0;
 
 MYLOG(DETAIL_LOG_LEVEL, "Oh %p->fetch_number=" FORMAT_LEN "\n", self, self->fetch_number);
 MYLOG(DETAIL_LOG_LEVEL, "in total_read=" FORMAT_ULEN " cursT=" FORMAT_LEN " currT=" FORMAT_LEN " ad=%d total=" FORMAT_ULEN " rowsetSize=%d\n", self->num_total_read, self->cursTuple, stmt->currTuple, self->ad_count, QR_get_num_total_tuples(self), self->rowset_size_include_ommitted);
@@ -974,9 +1177,7 @@ MYLOG(DETAIL_LOG_LEVEL, "in total_read=" FORMAT_ULEN " cursT=" FORMAT_LEN " curr
 	req_size = QR_get_reqsize(self);
 	/* Determine the optimum cache size.  */
 	ci = &(conn->connInfo);
-	fetch_size = ci->drivers.fetch_max;
-	if ((Int4)req_size > fetch_size)
-		fetch_size = req_size;
+	fetch_size = QR_fetch_size(self);
 	if (QR_once_reached_eof(self) && self->cursTuple >= (Int4) QR_get_num_total_read(self))
 		curr_eof = TRUE;
 #define	return	DONT_CALL_RETURN_FROM_HERE???
@@ -988,6 +1189,12 @@ MYLOG(DETAIL_LOG_LEVEL, "in total_read=" FORMAT_ULEN " cursT=" FORMAT_LEN " curr
 		QResultClass	*mres = NULL;
 		SQLULEN		movement, moved;
 
+		/* read-ahead and portals are only used for forward-only cursors */
+		if (0 < self->readahead_size || QR_is_portal(self))
+		{
+			SC_set_error(stmt, STMT_EXEC_ERROR, "can't move the cursor which is read ahead", func);
+			RETURN(-1)
+		}
 		movement = self->move_offset;
 		if (QR_is_moving_backward(self))
 		{
@@ -1077,6 +1284,14 @@ MYLOG(DETAIL_LOG_LEVEL, "moved=" FORMAT_ULEN " ? " FORMAT_ULEN "\n", moved, move
 		MYLOG(0, "fetch_number < fcount: returning tuple " FORMAT_LEN ", fcount = " FORMAT_LEN "\n", fetch_number, num_backend_rows);
 		self->tupleField = the_tuples + (fetch_number * num_fields);
 MYLOG(DETAIL_LOG_LEVEL, "tupleField=%p\n", self->tupleField);
+		if (0 < self->readahead_size)
+		{
+			/* let libpq receive the read-ahead block meanwhile */
+			if (0 == (fetch_number & 0x3f))
+				PQconsumeInput(conn->pqconn);
+		}
+		else
+			QR_start_readahead(self, stmt);
 		/* move to next row */
 		QR_inc_next_in_cache(self);
 		RETURN(TRUE)
@@ -1148,6 +1363,16 @@ MYLOG(DETAIL_LOG_LEVEL, "clear obsolete " FORMAT_LEN " tuples\n", num_backend_ro
 		boundary_adjusted = TRUE;
 	}
 
+	if (0 < self->readahead_size)
+	{
+		/* the next block has already been requested by the read-ahead */
+		if (boundary_adjusted)
+			self->cache_size += self->readahead_size - fetch_size;
+		else
+			self->cache_size = self->readahead_size;
+		fetch_size = self->readahead_size;
+	}
+
 	if (enlargeKeyCache(self, self->cache_size - num_backend_rows, "Out of memory while reading tuples") < 0)
 		RETURN(FALSE)
 
@@ -1169,7 +1394,19 @@ MYLOG(DETAIL_LOG_LEVEL, "clear obsolete " FORMAT_LEN " tuples\n", num_backend_ro
 	qi.fetch_size = fetch_size;
 	qi.result_in = self;
 	qi.cursor = NULL;
-	res = CC_send_query(conn, fetch, &qi, READ_ONLY_QUERY, stmt);
+	adapt_size = (!boundary_adjusted &&
+				  (0 < ci->fetch_bytes || 0 < ci->fetch_latency));
+	if (0 < self->readahead_size)
+		res = CC_get_readahead(conn, self, stmt) ? self : NULL;
+	else
+	{
+		if (adapt_size && 0 < ci->fetch_latency)
+			fetch_start = qtrace_clock();
+		if (QR_is_portal(self))
+			res = CC_fetch_portal(conn, self, stmt, fetch_size) ? self : NULL;
+		else
+			res = CC_send_query(conn, fetch, &qi, READ_ONLY_QUERY, stmt);
+	}
 	if (!QR_command_maybe_successful(res))
 	{
 		if (!QR_get_message(self))
@@ -1189,6 +1426,9 @@ MYLOG(DETAIL_LOG_LEVEL, "reached_eof_now=%d\n", reached_eof_now);
 	cur_fetch = self->num_cached_rows - num_rows_in;
 	if (!ret)
 		RETURN(ret)
+	/* the time waited for a block read ahead isn't that of the FETCH */
+	if (adapt_size && cur_fetch >= fetch_size)
+		QR_adapt_fetch_size(self, fetch_size, 0 < fetch_start ? qtrace_clock() - fetch_start : 0);
 
 	{
 		SQLLEN	start_idx = 0;
@@ -1252,6 +1492,9 @@ MYLOG(DETAIL_LOG_LEVEL, "will add " FORMAT_LEN " added_tuples from " FORMAT_LEN
 		}
 	}
 
+	if (TRUE == ret)
+		QR_start_readahead(self, stmt);
+
 	/*
 	 If the cursor operation was invoked inside this function,
 	 we have to set the status bits here.
@@ -1314,6 +1557,346 @@ MYLOG(DETAIL_LOG_LEVEL, "returning %d offset=" FORMAT_LEN "\n", ret, offset);
 	return ret;
 }
 
+/*
+ *	Spilling the tuple cache to a temporary file.
+ *
+ *	With TupleCacheLimit, the rows of a result set which an application
+ *	statement reads at once (not by a cursor) and without a keyset are
+ *	divided into segments of about an eighth of the limit.  When the
+ *	values in memory exceed the limit, complete segments chosen by the
+ *	clock algorithm are written to a temporary file and their values are
+ *	freed, leaving the TupleFields with NULL values.  The rows of such
+ *	result sets never change, so a segment is written only once; keyset
+ *	results, whose rows SQLSetPos replaces in place, are never spilled.
+ *	QR_page_in() maps the part of the file of a segment and reads its
+ *	values back when one of its rows is accessed.  If that fails the
+ *	callers of QR_get_tuple_row() get NULL and report the error.
+ *
+ *	In the file each value is a flag byte (0 for NULL) followed by the
+ *	nul-terminated value.
+ */
+typedef struct
+{
+	SQLLEN	first_row;
+	SQLLEN	num_rows;
+	size_t	bytes;		/* memory of the values */
+	Int8	file_offset;	/* -1 if not written yet */
+	size_t	file_bytes;
+	char	complete;	/* no more rows are added */
+	char	resident;	/* the values are in memory */
+	char	referenced;	/* accessed since the clock hand passed */
+} TupleSegment;
+
+struct TupleSpill_
+{
+	FILE	*file;
+	Int8	file_size;
+	size_t	limit;
+	size_t	resident_bytes;
+	SQLLEN	resident_complete;	/* complete segments in memory */
+	TupleSegment	*segments;
+	SQLLEN	num_segments;
+	SQLLEN	alloc_segments;
+	SQLLEN	hand;		/* of the clock */
+	SQLLEN	last;		/* the segment accessed last */
+};
+
+#ifdef	WIN32
+#define	spill_seek(fp, offset)	_fseeki64(fp, offset, SEEK_SET)
+#else
+#define	spill_seek(fp, offset)	fseeko(fp, (off_t) (offset), SEEK_SET)
+#endif /* WIN32 */
+
+static void
+QR_start_spill(QResultClass *self, Int4 limit_mb)
+{
+	TupleSpill	*spill;
+
+	if (NULL == (spill = calloc(1, sizeof(TupleSpill))))
+		return;
+	spill->limit = (size_t) limit_mb * 1024 * 1024;
+	spill->last = -1;
+	self->spill = spill;
+	MYLOG(0, "%p spills the values over " FORMAT_SIZE_T " bytes\n", self, spill->limit);
+}
+
+static void
+QR_free_spill(QResultClass *self)
+{
+	TupleSpill	*spill = self->spill;
+
+	if (NULL == spill)
+		return;
+	if (spill->file)
+		fclose(spill->file);
+	if (spill->segments)
+		free(spill->segments);
+	free(spill);
+	self->spill = NULL;
+}
+
+/* write the values of a segment to the file, if not yet, and free them */
+static BOOL
+spill_write_out(QResultClass *self, SQLLEN idx)
+{
+	TupleSpill	*spill = self->spill;
+	TupleSegment	*seg = spill->segments + idx;
+	TupleField	*tuple = self->backend_tuples + seg->first_row * self->num_fields;
+	SQLLEN		i, count = seg->num_rows * self->num_fields;
+	size_t		len, written = 0;
+
+	if (seg->file_offset < 0)
+	{
+		if (NULL == spill->file &&
+		    NULL == (spill->file = tmpfile()))
+		{
+			MYLOG(0, "could not create the spill file, keeping the rows in memory\n");
+			spill->limit = (size_t) -1;
+			return FALSE;
+		}
+		if (0 != spill_seek(spill->file, spill->file_size))
+			goto write_error;
+		for (i = 0; i < count; i++)
+		{
+			if (NULL == tuple[i].value)
+			{
+				if (EOF == fputc(0, spill->file))
+					goto write_error;
+				written++;
+				continue;
+			}
+			len = strlen(tuple[i].value) + 1;
+			if (EOF == fputc(1, spill->file) ||
+			    fwrite(tuple[i].value, len, 1, spill->file) != 1)
+				goto write_error;
+			written += 1 + len;
+		}
+		seg->file_offset = spill->file_size;
+		seg->file_bytes = written;
+		spill->file_size += written;
+	}
+	for (i = 0; i < count; i++)
+	{
+		if (tuple[i].value)
+		{
+			free(tuple[i].value);
+			tuple[i].value = NULL;
+		}
+	}
+	seg->resident = FALSE;
+	spill->resident_bytes -= seg->bytes;
+	spill->resident_complete--;
+	MYLOG(DETAIL_LOG_LEVEL, "spilled segment " FORMAT_LEN " rows " FORMAT_LEN "-" FORMAT_LEN "\n", idx, seg->first_row, seg->first_row + seg->num_rows - 1);
+	return TRUE;
+
+write_error:
+	MYLOG(0, "could not write the spill file, keeping the rows in memory\n");
+	spill->limit = (size_t) -1;
+	return FALSE;
+}
+
+/* spill a segment chosen by the clock, other than keep */
+static BOOL
+spill_evict(QResultClass *self, SQLLEN keep)
+{
+	TupleSpill	*spill = self->spill;
+	TupleSegment	*seg;
+	SQLLEN		i, idx;
+
+	for (i = 0; i < 2 * spill->num_segments && spill->resident_complete > 0; i++)
+	{
+		idx = spill->hand;
+		seg = spill->segments + idx;
+		if (++spill->hand >= spill->num_segments)
+			spill->hand = 0;
+		if (!seg->complete || !seg->resident || idx == keep)
+			continue;
+		if (seg->referenced)
+		{
+			seg->referenced = FALSE;
+			continue;
+		}
+		return spill_write_out(self, idx);
+	}
+	return FALSE;
+}
+
+/* account the row just added to the cache */
+static void
+QR_spill_add_row(QResultClass *self, size_t bytes)
+{
+	TupleSpill	*spill = self->spill;
+	TupleSegment	*seg;
+
+	if (0 == spill->num_segments ||
+	    spill->segments[spill->num_segments - 1].complete)
+	{
+		if (spill->num_segments >= spill->alloc_segments)
+		{
+			SQLLEN	new_alloc = spill->alloc_segments > 0 ? spill->alloc_segments * 2 : 64;
+			TupleSegment	*segments = realloc(spill->segments, sizeof(TupleSegment) * new_alloc);
+
+			if (NULL == segments)
+				return;
+			spill->segments = segments;
+			spill->alloc_segments = new_alloc;
+		}
+		seg = spill->segments + spill->num_segments++;
+		memset(seg, 0, sizeof(TupleSegment));
+		seg->first_row = self->num_cached_rows - 1;
+		seg->file_offset = -1;
+		seg->resident = TRUE;
+	}
+	seg = spill->segments + spill->num_segments - 1;
+	seg->num_rows++;
+	seg->bytes += bytes;
+	spill->resident_bytes += bytes;
+	if (seg->bytes >= spill->limit / 8)
+	{
+		seg->complete = TRUE;
+		spill->resident_complete++;
+	}
+	while (spill->resident_bytes > spill->limit &&
+	       spill_evict(self, -1))
+		;
+}
+
+/* read the values of a spilled segment back */
+static BOOL
+spill_read_in(QResultClass *self, SQLLEN idx)
+{
+	TupleSpill	*spill = self->spill;
+	TupleSegment	*seg = spill->segments + idx;
+	TupleField	*tuple = self->backend_tuples + seg->first_row * self->num_fields;
+	SQLLEN		i, count = seg->num_rows * self->num_fields;
+	const char	*data, *ptr;
+	char		*value;
+	size_t		len;
+	BOOL		ret = TRUE;
+#ifdef	WIN32
+	char		*buf;
+
+	if (NULL == (buf = malloc(seg->file_bytes)))
+		return FALSE;
+	if (0 != spill_seek(spill->file, seg->file_offset) ||
+	    fread(buf, seg->file_bytes, 1, spill->file) != 1)
+	{
+		free(buf);
+		return FALSE;
+	}
+	data = buf;
+#else
+	void		*map;
+	Int8		delta = seg->file_offset % sysconf(_SC_PAGESIZE);
+
+	fflush(spill->file);
+	map = mmap(NULL, seg->file_bytes + delta, PROT_READ, MAP_PRIVATE, fileno(spill->file), (off_t) (seg->file_offset - delta));
+	if (MAP_FAILED == map)
+		return FALSE;
+	data = (const char *) map + delta;
+#endif /* WIN32 */
+	for (i = 0, ptr = data; i < count; i++)
+	{
+		if (0 == *ptr++)
+			continue;
+		len = strlen(ptr) + 1;
+		if (NULL == (value = malloc(len)))
+		{
+			ret = FALSE;
+			break;
+		}
+		memcpy(value, ptr, len);
+		tuple[i].value = value;
+		ptr += len;
+	}
+#ifdef	WIN32
+	free(buf);
+#else
+	munmap(map, seg->file_bytes + delta);
+#endif /* WIN32 */
+	seg->resident = TRUE;
+	spill->resident_bytes += seg->bytes;
+	spill->resident_complete++;
+	if (!ret)
+	{
+		/* drop what was read, the segment stays in the file */
+		spill_write_out(self, idx);
+		return FALSE;
+	}
+	MYLOG(DETAIL_LOG_LEVEL, "paged in segment " FORMAT_LEN " rows " FORMAT_LEN "-" FORMAT_LEN "\n", idx, seg->first_row, seg->first_row + seg->num_rows - 1);
+	while (spill->resident_bytes > spill->limit &&
+	       spill_evict(self, idx))
+		;
+	return TRUE;
+}
+
+/*
+ *	Get the cached row, reading it back from the spill file if needed.
+ *	Use QR_get_tuple_row(), which calls this only for spilling results.
+ *	Returns NULL, with the error set in the result, if the row couldn't
+ *	be read back.
+ */
+TupleField *
+QR_page_in(QResultClass *self, SQLLEN row)
+{
+	TupleSpill	*spill = self->spill;
+	TupleSegment	*seg;
+	SQLLEN		idx = spill->last, low, high, mid;
+
+	if (idx < 0 ||
+	    row < spill->segments[idx].first_row ||
+	    row >= spill->segments[idx].first_row + spill->segments[idx].num_rows)
+	{
+		if (row < 0 || spill->num_segments <= 0)
+			return self->backend_tuples + row * self->num_fields;
+		low = 0;
+		high = spill->num_segments - 1;
+		while (low < high)
+		{
+			mid = (low + high + 1) / 2;
+			if (spill->segments[mid].first_row <= row)
+				low = mid;
+			else
+				high = mid - 1;
+		}
+		if (row < spill->segments[low].first_row ||
+		    row >= spill->segments[low].first_row + spill->segments[low].num_rows)
+			return self->backend_tuples + row * self->num_fields;
+		spill->last = idx = low;
+	}
+	seg = spill->segments + idx;
+	if (!seg->resident &&
+	    !spill_read_in(self, idx))
+	{
+		QR_set_rstatus(self, PORES_NO_MEMORY_ERROR);
+		QR_set_messageref(self, "Could not read the rows back from the spill file.");
+		return NULL;
+	}
+	seg->referenced = TRUE;
+	return self->backend_tuples + row * self->num_fields;
+}
+
+/*
+ * Write a row of a PGresult to the logs.  QR_read_tuples_from_pgres()
+ * calls this once per row only when tuple logging is on, so that the
+ * per-field loop doesn't have to check the log levels.
+ */
+static void
+QR_log_tuple(const PGresult *pgres, int rowno, int num_fields)
+{
+	int		i;
+
+	QLOG(TUPLE_LOG_LEVEL, "\t");
+	for (i = 0; i < num_fields; i++)
+	{
+		if (PQgetisnull(pgres, rowno, i))
+			QPRINTF(TUPLE_LOG_LEVEL, " (null)");
+		else
+			QPRINTF(TUPLE_LOG_LEVEL, " '%s'(%d)", PQgetvalue(pgres, rowno, i), PQgetlength(pgres, rowno, i));
+	}
+	QPRINTF(TUPLE_LOG_LEVEL, "\n");
+}
+
 /*
  * Read tuples from a libpq PGresult object into QResultClass.
  *
@@ -1337,6 +1920,14 @@ QR_read_tuples_from_pgres(QResultClass *self, PGresult **pgres)
 	int			nrows;
 	int			resStatus;
 	int		numTotalRows = 0;
+	Int8		numTotalBytes = 0;
+	int		numMallocs = 0;
+	BOOL		log_tuples;
+	size_t		rowBytes;
+
+	/* check the log levels once per result rather than once per field */
+	log_tuples = (LOG_LEVEL_ON(TUPLE_LOG_LEVEL, get_qlog()) ||
+				  LOG_LEVEL_ON(TUPLE_LOG_LEVEL, get_mylog()));
 
 	/* set the current row to read the fields into */
 	effective_cols = QR_NumPublicResultCols(self);
@@ -1381,7 +1972,9 @@ nextrow:
 			this_keyset->status = 0;
 		}
 
-		QLOG(TUPLE_LOG_LEVEL, "\t");
+		if (log_tuples)
+			QR_log_tuple(*pgres, rowno, ci_num_fields);
+		rowBytes = 0;
 		for (field_lf = 0; field_lf < ci_num_fields; field_lf++)
 		{
 			BOOL isnull = FALSE;
@@ -1392,24 +1985,23 @@ nextrow:
 			{
 				this_tuplefield[field_lf].len = 0;
 				this_tuplefield[field_lf].value = 0;
-				QPRINTF(TUPLE_LOG_LEVEL, " (null)");
 				continue;
 			}
 			else
 			{
 				len = PQgetlength(*pgres, rowno, field_lf);
 				value = PQgetvalue(*pgres, rowno, field_lf);
+				numTotalBytes += len;
 				if (field_lf >= effective_cols)
 					buffer = tidoidbuf;
 				else
 				{
 					QR_MALLOC_return_with_error(buffer, char, len + 1, self, "Out of memory in allocating item buffer.", FALSE);
+					numMallocs++;
 				}
 				memcpy(buffer, value, len);
 				buffer[len] = '\0';
 
-				QPRINTF(TUPLE_LOG_LEVEL, " '%s'(%d)", buffer, len);
-
 				if (field_lf >= effective_cols)
 				{
 					if (NULL == this_keyset)
@@ -1431,6 +2023,7 @@ nextrow:
 				{
 					this_tuplefield[field_lf].len = len;
 					this_tuplefield[field_lf].value = buffer;
+					rowBytes += len + 1;
 
 					/*
 					 * This can be used to set the longest length of the column
@@ -1446,11 +2039,12 @@ nextrow:
 				}
 			}
 		}
-		QPRINTF(TUPLE_LOG_LEVEL, "\n");
 		self->cursTuple++;
 		if (self->num_fields > 0)
 		{
 			QR_inc_num_cache(self);
+			if (NULL != self->spill)
+				QR_spill_add_row(self, rowBytes);
 		}
 		else if (QR_haskeyset(self))
 			self->num_cached_keys++;
@@ -1459,18 +2053,34 @@ nextrow:
 			self->num_total_read = self->cursTuple + 1;
 	}
 
-	if (resStatus == PGRES_SINGLE_TUPLE)
+	if (resStatus == PGRES_SINGLE_TUPLE &&
+		(0 == self->portal_rows || numTotalRows < self->portal_rows))
 	{
-		/* Process next row */
+		/* Process next row, the rest of a portal is left unread */
 		PQclear(*pgres);
 
 		*pgres = PQgetResult(self->conn->pqconn);
+		if (*pgres)
+			self->conn->perf.results++;
 		goto nextrow;
 	}
 
 	self->dataFilled = TRUE;
-	self->tupleField = self->backend_tuples + (self->fetch_number * self->num_fields);
+	self->tupleField = QR_get_tuple_row(self, self->fetch_number);
 MYLOG(DETAIL_LOG_LEVEL, "tupleField=%p\n", self->tupleField);
+	if (NULL == self->tupleField && NULL != self->spill &&
+	    self->fetch_number < self->num_cached_rows)
+		return FALSE;	/* QR_page_in() set the error */
+	self->conn->perf.rows_fetched += numTotalRows;
+	self->conn->perf.bytes_received += numTotalBytes;
+	self->conn->perf.tuple_mallocs += numMallocs;
+	/* learn the memory per row for the adaptive fetch size */
+	if (numTotalRows > 0)
+	{
+		Int4	row_bytes = (Int4) (numTotalBytes / numTotalRows) + num_fields * (Int4) sizeof(TupleField);
+
+		self->row_bytes = 0 < self->row_bytes ? (3 * self->row_bytes + row_bytes) / 4 : row_bytes;
+	}
 
 	QR_set_rstatus(self, PORES_TUPLES_OK);
 
@@ -21,6 +21,8 @@
 extern	"C" {
 #endif
 
+typedef struct TupleSpill_ TupleSpill;
+
 typedef
 enum	QueryResultCode_
 {
@@ -72,6 +74,12 @@ struct QResultClass_
 	SQLLEN		recent_processed_row_count;
 	SQLULEN		cache_size;
 	SQLULEN		cmd_fetch_size;
+	Int4		readahead_size;	/* size of the FETCH sent ahead, 0 if none */
+	PGresult	*readahead;	/* result of the FETCH sent ahead */
+	Int4		adapt_fetch_size;	/* adaptive FETCH size, 0 if not yet */
+	Int4		row_bytes;	/* average memory per row in the cache */
+	Int4		portal_rows;	/* rows to read from the open portal, 0 if none */
+	PGresult	*portal_error;	/* error met while reading the rest of the portal */
 
 	QueryResultCode	rstatus;	/* result status */
 
@@ -84,6 +92,7 @@ struct QResultClass_
 
 	TupleField *backend_tuples;	/* data from the backend (the tuple cache) */
 	TupleField *tupleField;		/* current backend tuple being retrieved */
+	TupleSpill *spill;		/* the rows spilled to a file (TupleCacheLimit) */
 
 	char	pstatus;		/* processing status */
 	char	aborted;		/* was aborted ? */
@@ -95,21 +104,21 @@ struct QResultClass_
 	KeySet		*keyset;
 	SQLLEN		key_base;	/* relative position of rowset start in the current keyset cache */
 	UInt2		reload_count;
-	UInt2		rb_alloc;	/* count of allocated rollback info */
-	UInt2		rb_count;	/* count of rollback info */
+	UInt4		rb_alloc;	/* count of allocated rollback info */
+	UInt4		rb_count;	/* count of rollback info */
 	char		dataFilled;	/* Cache is filled with data ? */
 	Rollback	*rollback;
 	UInt4		ad_alloc;	/* count of allocated added info */
 	UInt4		ad_count;	/* count of newly added rows */
 	KeySet		*added_keyset;	/* added keyset info */
 	TupleField	*added_tuples;	/* added data by myself */
-	UInt2		dl_alloc;	/* count of allocated deleted info */
-	UInt2		dl_count;	/* count of deleted info */
-	SQLLEN		*deleted;	/* deleted index info */
+	UInt4		dl_alloc;	/* count of allocated deleted info */
+	UInt4		dl_count;	/* count of deleted info */
+	SQLLEN		*deleted;	/* deleted index info, in ascending order */
 	KeySet		*deleted_keyset;	/* deleted keyset info */
-	UInt2		up_alloc;	/* count of allocated updated info */
-	UInt2		up_count;	/* count of updated info */
-	SQLLEN		*updated;	/* updated index info */
+	UInt4		up_alloc;	/* count of allocated updated info */
+	UInt4		up_count;	/* count of updated info */
+	SQLLEN		*updated;	/* updated index info, in ascending order */
 	KeySet		*updated_keyset;	/* uddated keyset info */
 	TupleField	*updated_tuples;	/* uddated data by myself */
 };
@@ -119,18 +128,23 @@ enum {
 	,FQR_WITHHOLD	= (1L << 1)
 	,FQR_HOLDPERMANENT = (1L << 2) /* the cursor is alive across transactions */
 	,FQR_SYNCHRONIZEKEYS = (1L<<3) /* synchronize the keyset range with that of cthe tuples cache */
+	,FQR_PORTAL = (1L << 4) /* the rows are read from the portal, not by FETCH */
 };
 
 #define	QR_haskeyset(self)		(0 != (self->flags & FQR_HASKEYSET))
 #define	QR_is_withhold(self)		(0 != (self->flags & FQR_WITHHOLD))
 #define	QR_is_permanent(self)		(0 != (self->flags & FQR_HOLDPERMANENT))
 #define	QR_synchronize_keys(self)	(0 != (self->flags & FQR_SYNCHRONIZEKEYS))
+#define	QR_is_portal(self)		(0 != (self->flags & FQR_PORTAL))
 #define QR_get_fields(self)		(self->fields)
 
 
 /*	These functions are for retrieving data from the qresult */
 #define QR_get_value_backend(self, fieldno)	(self->tupleField[fieldno].value)
-#define QR_get_value_backend_row(self, tupleno, fieldno) ((self->backend_tuples + (tupleno * self->num_fields))[fieldno].value)
+/*	QR_get_tuple_row() returns NULL if a spilled row couldn't be read back.
+	The other macros are for results which don't spill (not application's) */
+#define QR_get_tuple_row(self, tupleno)	(NULL != (self)->spill ? QR_page_in((QResultClass *) (self), tupleno) : (self)->backend_tuples + (tupleno) * (self)->num_fields)
+#define QR_get_value_backend_row(self, tupleno, fieldno) (QR_get_tuple_row(self, tupleno)[fieldno].value)
 #define QR_get_value_backend_text(self, tupleno, fieldno) QR_get_value_backend_row(self, tupleno, fieldno)
 #define QR_get_value_backend_int(self, tupleno, fieldno, isNull) atoi(QR_get_value_backend_row(self, tupleno, fieldno))
 
@@ -163,9 +177,10 @@ enum {
 #define QR_set_aborted(self, aborted_)		( self->aborted = aborted_)
 #define QR_set_haskeyset(self)		(self->flags |= FQR_HASKEYSET)
 #define QR_set_synchronize_keys(self)	(self->flags |= FQR_SYNCHRONIZEKEYS)
-#define QR_set_no_cursor(self)		((self)->flags &= ~(FQR_WITHHOLD | FQR_HOLDPERMANENT), (self)->pstatus &= ~FQR_NEEDS_SURVIVAL_CHECK)
+#define QR_set_no_cursor(self)		((self)->flags &= ~(FQR_WITHHOLD | FQR_HOLDPERMANENT | FQR_PORTAL), (self)->pstatus &= ~FQR_NEEDS_SURVIVAL_CHECK)
 #define QR_set_withhold(self)		(self->flags |= FQR_WITHHOLD)
 #define QR_set_permanent(self)		(self->flags |= FQR_HOLDPERMANENT)
+#define QR_set_portal(self)		(self->flags |= FQR_PORTAL)
 #define	QR_set_reached_eof(self)	(self->pstatus |= FQR_REACHED_EOF)
 #define QR_set_has_valid_base(self)	(self->pstatus |= FQR_HAS_VALID_BASE)
 #define QR_set_no_valid_base(self)	(self->pstatus &= ~FQR_HAS_VALID_BASE)
@@ -230,6 +245,7 @@ void		QR_close_result(QResultClass *self, BOOL destroy);
 void		QR_reset_for_re_execute(QResultClass *self);
 BOOL		QR_from_PGresult(QResultClass *self, StatementClass *stmt, ConnectionClass *conn, const char *cursor, PGresult **pgres);
 void		QR_free_memory(QResultClass *self);
+void		QR_read_portal_rest(QResultClass *self);
 void		QR_set_command(QResultClass *self, const char *msg);
 void		QR_set_message(QResultClass *self, const char *msg);
 void		QR_add_message(QResultClass *self, const char *msg);
@@ -245,6 +261,8 @@ void		QR_inc_rowstart_in_cache(QResultClass *self, SQLLEN base_inc);
 void		QR_set_cache_size(QResultClass *self, SQLLEN cache_size);
 void		QR_set_reqsize(QResultClass *self, Int4 reqsize);
 void		QR_set_position(QResultClass *self, SQLLEN pos);
+void		QR_finish_readahead(QResultClass *self);
+TupleField	*QR_page_in(QResultClass *self, SQLLEN row);
 void		QR_set_cursor(QResultClass *self, const char *name);
 SQLLEN		getNthValid(const QResultClass *self, SQLLEN sta, UWORD orientation, SQLULEN nth, SQLLEN *nearest);
 SQLLEN		QR_move_cursor_to_last(QResultClass *self, StatementClass *stmt);
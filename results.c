@@ -85,6 +85,25 @@ PGAPI_RowCount(HSTMT hstmt,
 	return SQL_SUCCESS;
 }
 
+/*
+ *	The functions describing the result columns run with only the
+ *	statement lock held (see DiscardStatementSvpOnRead()). The parse
+ *	and the table info read and fill the column info cache of the
+ *	connection, so they take the connection lock, and may query the
+ *	server.
+ */
+static void
+parse_statement_locked(StatementClass *stmt)
+{
+	ConnectionClass	*conn = SC_get_conn(stmt);
+	int		func_cs_count = 0;
+
+	stmt->accessed_db_on_read = TRUE;
+	ENTER_INNER_CONN_CS(conn, func_cs_count);
+	parse_statement(stmt, FALSE);
+	CLEANUP_FUNC_CONN_CS(func_cs_count, conn);
+}
+
 static BOOL
 SC_describe_ok(StatementClass *stmt, BOOL build_fi, int col_idx, const char *func)
 {
@@ -92,6 +111,9 @@ SC_describe_ok(StatementClass *stmt, BOOL build_fi, int col_idx, const char *fun
 	QResultClass *result;
 	BOOL		exec_ok = TRUE;
 
+	/* a statement not executed yet is described by the server */
+	if (STMT_READY == stmt->status)
+		stmt->accessed_db_on_read = TRUE;
 	num_fields = SC_describe(stmt);
 	result = SC_get_ExecdOrParsed(stmt);
 
@@ -112,7 +134,15 @@ SC_describe_ok(StatementClass *stmt, BOOL build_fi, int col_idx, const char *fun
 
 MYLOG(DETAIL_LOG_LEVEL, "build_fi=%d reloid=%u\n", build_fi, reloid);
 		if (build_fi && 0 != QR_get_attid(result, col_idx))
+		{
+			ConnectionClass	*conn = SC_get_conn(stmt);
+			int		func_cs_count = 0;
+
+			stmt->accessed_db_on_read = TRUE;
+			ENTER_INNER_CONN_CS(conn, func_cs_count);
 			getCOLIfromTI(func, NULL, stmt, reloid, &ti);
+			CLEANUP_FUNC_CONN_CS(func_cs_count, conn);
+		}
 MYLOG(DETAIL_LOG_LEVEL, "nfields=%d\n", irdflds->nfields);
 		if (irdflds->fi && col_idx < (int) irdflds->nfields)
 		{
@@ -158,6 +188,8 @@ PGAPI_NumResultCols(HSTMT hstmt,
 	}
 
 	SC_clear_error(stmt);
+	if (SC_asynccheck(stmt, func))
+		return SQL_ERROR;
 #define	return	DONT_CALL_RETURN_FROM_HERE???
 	/* StartRollbackState(stmt); */
 
@@ -172,7 +204,7 @@ PGAPI_NumResultCols(HSTMT hstmt,
 		if (SC_parsed_status(stmt) == STMT_PARSE_NONE)
 		{
 			MYLOG(0, "calling parse_statement on stmt=%p\n", stmt);
-			parse_statement(stmt, FALSE);
+			parse_statement_locked(stmt);
 		}
 
 		if (SC_parsed_status(stmt) != STMT_PARSE_FATAL)
@@ -248,6 +280,8 @@ PGAPI_DescribeCol(HSTMT hstmt,
 	unknown_sizes = ci->drivers.unknown_sizes;
 
 	SC_clear_error(stmt);
+	if (SC_asynccheck(stmt, func))
+		return SQL_ERROR;
 
 #define	return	DONT_CALL_RETURN_FROM_HERE???
 	irdflds = SC_get_IRDF(stmt);
@@ -287,7 +321,7 @@ MYLOG(DETAIL_LOG_LEVEL, "answering bookmark info\n");
 		if (SC_parsed_status(stmt) == STMT_PARSE_NONE)
 		{
 			MYLOG(0, "calling parse_statement on stmt=%p\n", stmt);
-			parse_statement(stmt, FALSE);
+			parse_statement_locked(stmt);
 		}
 
 		MYLOG(0, "PARSE: icol=%d, stmt=%p, stmt->nfld=%d, stmt->fi=%p\n", icol, stmt, irdflds->nfields, irdflds->fi);
@@ -495,6 +529,8 @@ PGAPI_ColAttributes(HSTMT hstmt,
 		SC_log_error(func, NULL_STRING, NULL);
 		return SQL_INVALID_HANDLE;
 	}
+	if (SC_asynccheck(stmt, func))
+		return SQL_ERROR;
 	stmt_updatable = SC_is_updatable(stmt)
 		/* The following doesn't seem appropriate for client side cursors
 		  && stmt->options.scroll_concurrency != SQL_CONCUR_READ_ONLY
@@ -546,7 +582,7 @@ MYLOG(DETAIL_LOG_LEVEL, "answering bookmark info\n");
 		if (SC_parsed_status(stmt) == STMT_PARSE_NONE)
 		{
 			MYLOG(0, "calling parse_statement\n");
-			parse_statement(stmt, FALSE);
+			parse_statement_locked(stmt);
 		}
 
 		cols = irdflds->nfields;
@@ -1037,7 +1073,15 @@ MYLOG(DETAIL_LOG_LEVEL, "GetData Column 0 is type %d not of type SQL_C_BOOKMARK\
 		if (!get_bookmark)
 		{
 			SQLLEN	curt = GIdx2CacheIdx(stmt->currTuple, stmt, res);
-			value = QR_get_value_backend_row(res, curt, icol);
+			TupleField	*tuple = QR_get_tuple_row(res, curt);
+
+			if (NULL == tuple)
+			{
+				SC_set_error(stmt, STMT_NO_MEMORY_ERROR, QR_get_message(res), func);
+				result = SQL_ERROR;
+				goto cleanup;
+			}
+			value = tuple[icol].value;
 MYLOG(DETAIL_LOG_LEVEL, "currT=" FORMAT_LEN " base=" FORMAT_LEN " rowset=" FORMAT_LEN "\n", stmt->currTuple, QR_get_rowstart_in_cache(res), SC_get_rowset_start(stmt));
 			MYLOG(0, "     value = '%s'\n", NULL_IF_NULL(value));
 		}
@@ -1056,7 +1100,15 @@ MYLOG(DETAIL_LOG_LEVEL, "currT=" FORMAT_LEN " base=" FORMAT_LEN " rowset=" FORMA
 		{
 			/** value = QR_get_value_backend(res, icol); maybe thiw doesn't work */
 			SQLLEN	curt = GIdx2CacheIdx(stmt->currTuple, stmt, res);
-			value = QR_get_value_backend_row(res, curt, icol);
+			TupleField	*tuple = QR_get_tuple_row(res, curt);
+
+			if (NULL == tuple)
+			{
+				SC_set_error(stmt, STMT_NO_MEMORY_ERROR, QR_get_message(res), func);
+				result = SQL_ERROR;
+				goto cleanup;
+			}
+			value = tuple[icol].value;
 		}
 		MYLOG(0, "  socket: value = '%s'\n", NULL_IF_NULL(value));
 	}
@@ -1221,6 +1273,28 @@ PGAPI_Fetch(HSTMT hstmt)
 static RETCODE SQL_API
 SC_pos_reload_needed(StatementClass *stmt, SQLULEN req_size, UDWORD flag);
 
+/*
+ *	Get the first position in [low, high) of the ascending row indexes
+ *	(res->deleted or res->updated) where the index, minus the position
+ *	if minus_pos, is greater than value.  For the deleted indexes, which
+ *	are distinct, the index minus the position doesn't decrease either.
+ */
+static SQLLEN
+SortedIndexBound(const SQLLEN *indexes, SQLLEN low, SQLLEN high, SQLLEN value, BOOL minus_pos)
+{
+	SQLLEN	mid;
+
+	while (low < high)
+	{
+		mid = (low + high) / 2;
+		if (indexes[mid] - (minus_pos ? mid : 0) > value)
+			high = mid;
+		else
+			low = mid + 1;
+	}
+	return low;
+}
+
 SQLLEN
 getNthValid(const QResultClass *res, SQLLEN sta, UWORD orientation,
 			SQLULEN nth, SQLLEN *nearest)
@@ -1262,24 +1336,23 @@ MYLOG(DETAIL_LOG_LEVEL, "get " FORMAT_ULEN "th Valid data from " FORMAT_LEN " to
 	if (QR_get_cursor(res))
 	{
 		SQLLEN	*deleted = res->deleted;
+		SQLLEN	dl_count = res->dl_count;
 		SQLLEN	delsta;
 
+		/*
+		 * The deleted indexes are in ascending order, so the rows which
+		 * shift the nearest position are found by binary searches.
+		 */
 		if (SQL_FETCH_PRIOR == orientation)
 		{
-			*nearest = sta + 1 - nth;
-			delsta = (-1);
-			MYPRINTF(DETAIL_LOG_LEVEL, "deleted ");
-			for (i = res->dl_count - 1; i >=0 && *nearest <= deleted[i]; i--)
-			{
-				MYPRINTF(DETAIL_LOG_LEVEL, "[" FORMAT_LEN "]=" FORMAT_LEN " ", i, deleted[i]);
-				if (sta >= deleted[i])
-				{
-					(*nearest)--;
-					if (i > delsta)
-						delsta = i;
-				}
-			}
-			MYPRINTF(DETAIL_LOG_LEVEL, "nearest=" FORMAT_LEN "\n", *nearest);
+			/* the deleted rows at or before sta */
+			delsta = SortedIndexBound(deleted, 0, dl_count, sta, FALSE) - 1;
+			/* of them, the ones at or after the nearest position */
+			i = SortedIndexBound(deleted, 0, delsta + 1, sta - (SQLLEN) nth - delsta, TRUE);
+			*nearest = sta + 1 - (SQLLEN) nth - (delsta + 1 - i);
+			if (i > delsta)
+				delsta = -1;
+			MYPRINTF(DETAIL_LOG_LEVEL, "deleted " FORMAT_LEN "-" FORMAT_LEN " nearest=" FORMAT_LEN "\n", i, delsta, *nearest);
 			if (*nearest < 0)
 			{
 				*nearest = -1;
@@ -1290,24 +1363,22 @@ MYLOG(DETAIL_LOG_LEVEL, "get " FORMAT_ULEN "th Valid data from " FORMAT_LEN " to
 		}
 		else
 		{
-			MYPRINTF(DETAIL_LOG_LEVEL, "\n");
-			*nearest = sta - 1 + nth;
-			delsta = res->dl_count;
+			SQLLEN	delend;
+
+			/* the deleted rows at or after sta */
+			delsta = SortedIndexBound(deleted, 0, dl_count, sta - 1, FALSE);
+			/* of them, the ones at or before the nearest position */
+			delend = SortedIndexBound(deleted, delsta, dl_count, sta - 1 + (SQLLEN) nth - delsta, TRUE);
+			*nearest = sta - 1 + (SQLLEN) nth + (delend - delsta);
+			if (delend == delsta)
+				delsta = dl_count;
+			MYPRINTF(DETAIL_LOG_LEVEL, "deleted " FORMAT_LEN "-" FORMAT_LEN " nearest=" FORMAT_LEN "\n", delsta, delend, *nearest);
 			if (!QR_once_reached_eof(res))
 				num_tuples = INT_MAX;
-			for (i = 0; i < res->dl_count && *nearest >= deleted[i]; i++)
-			{
-				if (sta <= deleted[i])
-				{
-					(*nearest)++;
-					if (i < delsta)
-						delsta = i;
-				}
-			}
 			if (*nearest >= num_tuples)
 			{
 				*nearest = num_tuples;
-				count = *nearest - sta + delsta - res->dl_count;
+				count = *nearest - sta + delsta - dl_count;
 			}
 			else
 				return nth;
@@ -1457,6 +1528,8 @@ PGAPI_ExtendedFetch(HSTMT hstmt,
 		SC_set_error(stmt, STMT_INVALID_CURSOR_STATE_ERROR, "Null statement result in PGAPI_ExtendedFetch.", func);
 		return SQL_ERROR;
 	}
+	if (SQL_FETCH_NEXT != fFetchType)
+		QR_finish_readahead(res);
 
 	opts = SC_get_ARDF(stmt);
 	/*
@@ -1980,11 +2053,14 @@ cleanup:
 RETCODE		SQL_API
 PGAPI_MoreResults(HSTMT hstmt)
 {
+	CSTR func = "PGAPI_MoreResults";
 	StatementClass	*stmt = (StatementClass *) hstmt;
 	QResultClass	*res;
 	RETCODE		ret = SQL_SUCCESS;
 
 	MYLOG(0, "entering...\n");
+	if (SC_asynccheck(stmt, func))
+		return SQL_ERROR;
 	res = SC_get_Curres(stmt);
 	if (res)
 	{
@@ -2397,8 +2473,8 @@ MYLOG(DETAIL_LOG_LEVEL, "!!Commit Added=" FORMAT_ULEN "(%d)\n", QR_get_num_total
 static int
 AddDeleted(QResultClass *res, SQLULEN index, const KeySet *keyset)
 {
-	int	i;
-	Int2	dl_count, new_alloc;
+	SQLLEN	i;
+	UInt4	dl_count, new_alloc;
 	SQLLEN	*deleted;
 	KeySet	*deleted_keyset;
 	UWORD	status;
@@ -2425,17 +2501,13 @@ MYLOG(DETAIL_LOG_LEVEL, "entering " FORMAT_ULEN "\n", index);
 			new_alloc = res->dl_alloc * 2;
 			res->dl_alloc = 0;
 			QR_REALLOC_return_with_error(res->deleted, SQLLEN, sizeof(SQLLEN) * new_alloc, res, "Deleted index realloc error", FALSE);
-			deleted = res->deleted;
 			QR_REALLOC_return_with_error(res->deleted_keyset, KeySet, sizeof(KeySet) * new_alloc, res, "Deleted KeySet realloc error", FALSE);
-			deleted_keyset = res->deleted_keyset;
 			res->dl_alloc = new_alloc;
 		}
-		/* sort deleted indexes in ascending order */
-		for (i = 0, deleted = res->deleted, deleted_keyset = res->deleted_keyset; i < dl_count; i++, deleted++, deleted_keyset++)
-		{
-			if (index < *deleted)
-				break;
-		}
+		/* keep the deleted indexes in ascending order */
+		i = SortedIndexBound(res->deleted, 0, dl_count, (SQLLEN) index, FALSE);
+		deleted = res->deleted + i;
+		deleted_keyset = res->deleted_keyset + i;
 		memmove(deleted + 1, deleted, sizeof(SQLLEN) * (dl_count - i));
 		memmove(deleted_keyset + 1, deleted_keyset, sizeof(KeySet) * (dl_count - i));
 	}
@@ -2460,13 +2532,32 @@ MYLOG(DETAIL_LOG_LEVEL, "entering " FORMAT_ULEN "\n", index);
 	return TRUE;
 }
 
+/* remove the entries of the index from the ascending deleted indexes */
+static int
+RemoveDeletedIndex(QResultClass *res, SQLLEN index)
+{
+	SQLLEN	sta, end, mv_count;
+
+	sta = SortedIndexBound(res->deleted, 0, res->dl_count, index - 1, FALSE);
+	end = SortedIndexBound(res->deleted, sta, res->dl_count, index, FALSE);
+	if (end <= sta)
+		return 0;
+	mv_count = res->dl_count - end;
+	if (mv_count > 0)
+	{
+		memmove(res->deleted + sta, res->deleted + end, mv_count * sizeof(SQLLEN));
+		memmove(res->deleted_keyset + sta, res->deleted_keyset + end, mv_count * sizeof(KeySet));
+	}
+	res->dl_count -= (UInt4) (end - sta);
+	return (int) (end - sta);
+}
+
 static void
 RemoveDeleted(QResultClass *res, SQLLEN index)
 {
-	int	i, mv_count, rm_count = 0;
+	int	rm_count = 0;
 	SQLLEN	pidx, midx;
-	SQLLEN	*deleted, num_read = QR_get_num_total_read(res);
-	KeySet	*deleted_keyset;
+	SQLLEN	num_read = QR_get_num_total_read(res);
 
 	MYLOG(0, "entering index=" FORMAT_LEN "\n", index);
 	if (index < 0)
@@ -2482,23 +2573,11 @@ RemoveDeleted(QResultClass *res, SQLLEN index)
 		else
 			midx = index;
 	}
-	for (i = 0; i < res->dl_count; i++)
-	{
-		if (pidx == res->deleted[i] ||
-		    midx == res->deleted[i])
-		{
-			mv_count = res->dl_count - i - 1;
-			if (mv_count > 0)
-			{
-				deleted = res->deleted + i;
-				deleted_keyset = res->deleted_keyset + i;
-				memmove(deleted, deleted + 1, mv_count * sizeof(SQLLEN));
-				memmove(deleted_keyset, deleted_keyset + 1, mv_count * sizeof(KeySet));
-			}
-			res->dl_count--;
-			rm_count++;
-		}
-	}
+	if (NULL == res->deleted)
+		return;
+	rm_count = RemoveDeletedIndex(res, pidx);
+	if (midx != pidx)
+		rm_count += RemoveDeletedIndex(res, midx);
 	MYLOG(0, "removed count=%d,%d\n", rm_count, res->dl_count);
 }
 
@@ -2540,9 +2619,9 @@ MYLOG(DETAIL_LOG_LEVEL, "Deleted=" FORMAT_LEN "(%d)\n", *deleted, i);
 }
 
 static BOOL
-enlargeUpdated(QResultClass *res, Int4 number, const StatementClass *stmt)
+enlargeUpdated(QResultClass *res, UInt4 number, const StatementClass *stmt)
 {
-	Int2	alloc;
+	UInt4	alloc;
 
 	alloc = res->up_alloc;
 	if (0 == alloc)
@@ -2572,11 +2651,11 @@ AddUpdated(StatementClass *stmt, SQLLEN index, const KeySet *keyset, const Tuple
 	KeySet	*updated_keyset;
 	TupleField	*updated_tuples = NULL,  *tuple;
 	/* SQLLEN	res_ridx; */
-	UInt2	up_count;
+	UInt4	up_count;
 	BOOL	is_in_trans;
 	SQLLEN	upd_idx, upd_add_idx;
 	Int2	num_fields;
-	int	i;
+	SQLLEN	i;
 	UWORD	status;
 
 MYLOG(DETAIL_LOG_LEVEL, "entering index=" FORMAT_LEN "\n", index);
@@ -2606,12 +2685,9 @@ MYLOG(DETAIL_LOG_LEVEL, "entering index=" FORMAT_LEN "\n", index);
 		status |= CURS_SELF_UPDATING;
 	else
 	{
-		for (i = up_count - 1; i >= 0; i--)
-		{
-			if (updated[i] == index)
-				break;
-		}
-		if (i >= 0)
+		/* the last entry of the index */
+		i = SortedIndexBound(updated, 0, up_count, index, FALSE) - 1;
+		if (i >= 0 && updated[i] == index)
 			upd_idx = i;
 		else
 		{
@@ -2639,7 +2715,7 @@ MYLOG(DETAIL_LOG_LEVEL, "entering index=" FORMAT_LEN "\n", index);
 		res->updated_keyset[upd_idx].status = status;
 		if (res->updated_tuples)
 		{
-			tuple = res->added_tuples + num_fields * upd_add_idx;
+			tuple = res->updated_tuples + num_fields * upd_idx;
 			ClearCachedRows(tuple, num_fields, 1);
 		}
 	}
@@ -2650,13 +2726,21 @@ MYLOG(DETAIL_LOG_LEVEL, "entering index=" FORMAT_LEN "\n", index);
 		updated = res->updated;
 		updated_keyset = res->updated_keyset;
 		updated_tuples = res->updated_tuples;
-		upd_idx = up_count;
-		updated[up_count] = index;
-		updated_keyset[up_count] = *keyset;
-		updated_keyset[up_count].status = status;
+		/* keep the updated indexes in ascending order */
+		upd_idx = SortedIndexBound(updated, 0, up_count, index, FALSE);
+		if (upd_idx < up_count)
+		{
+			memmove(updated + upd_idx + 1, updated + upd_idx, sizeof(SQLLEN) * (up_count - upd_idx));
+			memmove(updated_keyset + upd_idx + 1, updated_keyset + upd_idx, sizeof(KeySet) * (up_count - upd_idx));
+			if (updated_tuples)
+				memmove(updated_tuples + num_fields * (upd_idx + 1), updated_tuples + num_fields * upd_idx, sizeof(TupleField) * num_fields * (up_count - upd_idx));
+		}
+		updated[upd_idx] = index;
+		updated_keyset[upd_idx] = *keyset;
+		updated_keyset[upd_idx].status = status;
 		if (updated_tuples)
 		{
-			tuple = updated_tuples + num_fields * up_count;
+			tuple = updated_tuples + num_fields * upd_idx;
 			memset(tuple, 0, sizeof(TupleField) * num_fields);
 		}
 		res->up_count++;
@@ -2676,14 +2760,53 @@ RemoveUpdated(QResultClass *res, SQLLEN index)
 	RemoveUpdatedAfterTheKey(res, index, NULL);
 }
 
+/*
+ *	Remove the updated entries of the index, in the order they were
+ *	added, up to the one of the key.
+ */
+static BOOL
+RemoveUpdatedIndex(QResultClass *res, SQLLEN index, const KeySet *keyset, int *rm_count)
+{
+	SQLLEN	sta, end, i, mv_count;
+	int	num_fields = res->num_fields;
+	BOOL	found = FALSE;
+
+	sta = SortedIndexBound(res->updated, 0, res->up_count, index - 1, FALSE);
+	end = SortedIndexBound(res->updated, sta, res->up_count, index, FALSE);
+	for (i = sta; i < end; i++)
+	{
+		if (keyset &&
+		    res->updated_keyset[i].blocknum == keyset->blocknum &&
+		    res->updated_keyset[i].offset == keyset->offset)
+		{
+			found = TRUE;
+			break;
+		}
+		if (res->updated_tuples)
+			ClearCachedRows(res->updated_tuples + i * num_fields, num_fields, 1);
+	}
+	if (i > sta)
+	{
+		mv_count = res->up_count - i;
+		if (mv_count > 0)
+		{
+			memmove(res->updated + sta, res->updated + i, sizeof(SQLLEN) * mv_count);
+			memmove(res->updated_keyset + sta, res->updated_keyset + i, sizeof(KeySet) * mv_count);
+			if (res->updated_tuples)
+				memmove(res->updated_tuples + sta * num_fields, res->updated_tuples + i * num_fields, sizeof(TupleField) * num_fields * mv_count);
+		}
+		res->up_count -= (UInt4) (i - sta);
+		*rm_count += (int) (i - sta);
+	}
+	return found;
+}
+
 static void
 RemoveUpdatedAfterTheKey(QResultClass *res, SQLLEN index, const KeySet *keyset)
 {
-	SQLLEN	*updated, num_read = QR_get_num_total_read(res);
-	KeySet	*updated_keyset;
-	TupleField	*updated_tuples = NULL;
-	SQLLEN	pidx, midx, mv_count;
-	int	i, num_fields = res->num_fields, rm_count = 0;
+	SQLLEN	num_read = QR_get_num_total_read(res);
+	SQLLEN	pidx, midx;
+	int	rm_count = 0;
 
 	MYLOG(0, "entering " FORMAT_LEN ",(%u,%u)\n", index, keyset ? keyset->blocknum : 0, keyset ? keyset->offset : 0);
 	if (index < 0)
@@ -2699,35 +2822,11 @@ RemoveUpdatedAfterTheKey(QResultClass *res, SQLLEN index, const KeySet *keyset)
 		else
 			midx = index;
 	}
-	for (i = 0; i < res->up_count; i++)
-	{
-		updated = res->updated + i;
-		if (pidx == *updated ||
-		    midx == *updated)
-		{
-			updated_keyset = res->updated_keyset + i;
-			if (keyset &&
-			    updated_keyset->blocknum == keyset->blocknum &&
-			    updated_keyset->offset == keyset->offset)
-				break;
-			updated_tuples = NULL;
-			if (res->updated_tuples)
-			{
-				updated_tuples = res->updated_tuples + i * num_fields;
-				ClearCachedRows(updated_tuples, num_fields, 1);
-			}
-			mv_count = res->up_count - i -1;
-			if (mv_count > 0)
-			{
-				memmove(updated, updated + 1, sizeof(SQLLEN) * mv_count);
-				memmove(updated_keyset, updated_keyset + 1, sizeof(KeySet) * mv_count);
-				if (updated_tuples)
-					memmove(updated_tuples, updated_tuples + num_fields, sizeof(TupleField) * num_fields * mv_count);
-			}
-			res->up_count--;
-			rm_count++;
-		}
-	}
+	if (0 == res->up_count || NULL == res->updated)
+		return;
+	if (!RemoveUpdatedIndex(res, pidx, keyset, &rm_count) &&
+	    midx != pidx)
+		RemoveUpdatedIndex(res, midx, keyset, &rm_count);
 	MYLOG(0, "removed count=%d,%d\n", rm_count, res->up_count);
 }
 
@@ -3145,30 +3244,25 @@ cleanup:
 
 BOOL QR_get_last_bookmark(const QResultClass *res, Int4 index, KeySet *keyset)
 {
-	int	i;
+	SQLLEN	i;
 
 	if (res->dl_count > 0 && res->deleted)
 	{
-		for (i = 0; i < res->dl_count; i++)
+		i = SortedIndexBound(res->deleted, 0, res->dl_count, index - 1, FALSE);
+		if (i < res->dl_count && res->deleted[i] == index)
 		{
-			if (res->deleted[i] == index)
-			{
-				*keyset = res->deleted_keyset[i];
-				return TRUE;
-			}
-			if (res->deleted[i] > index)
-				break;
+			*keyset = res->deleted_keyset[i];
+			return TRUE;
 		}
 	}
 	if (res->up_count > 0 && res->updated)
 	{
-		for (i = res->up_count - 1; i >= 0; i--)
+		/* the last entry of the index */
+		i = SortedIndexBound(res->updated, 0, res->up_count, index, FALSE) - 1;
+		if (i >= 0 && res->updated[i] == index)
 		{
-			if (res->updated[i] == index)
-			{
-				*keyset = res->updated_keyset[i];
-				return TRUE;
-			}
+			*keyset = res->updated_keyset[i];
+			return TRUE;
 		}
 	}
 	return FALSE;
@@ -3331,180 +3425,135 @@ SC_pos_reload(StatementClass *stmt, SQLULEN global_ridx, UInt2 *count, Int4 logK
 }
 
 static	const int	pre_fetch_count = 32;
-static SQLLEN LoadFromKeyset(StatementClass *stmt, QResultClass * res, int rows_per_fetch, SQLLEN limitrow)
+/*
+ *	Reload the rows of the window which need rereading with one execution
+ *	of "<load_statement> where ctid = any($1)", prepared once per result.
+ */
+static SQLLEN LoadFromKeyset(StatementClass *stmt, QResultClass * res, SQLLEN limitrow)
 {
 	CSTR	func = "LoadFromKeyset";
 	ConnectionClass	*conn = SC_get_conn(stmt);
-	SQLLEN	i;
-	int	j, rowc, rcnt = 0;
+	QResultClass	*qres;
+	SQLLEN	i, j, k, l, kres_ridx, start;
+	int	rcnt = 0;
+	Int2	m;
 	OID	oid;
-	UInt4	blocknum;
-	SQLLEN	kres_ridx;
-	UInt2	offset;
+	UInt4	blocknum, bln;
+	UInt2	offset, off;
+	UInt4	*blocks = NULL;
+	UInt2	*offsets = NULL;
+	TupleField	*tuple, *tuplew;
+	char	planname[32];
+	BOOL	prepared;
+	UDWORD	qflag;
 	PQExpBufferData	qval = {0};
-	int	keys_per_fetch = 10;
 
 #define	return	DONT_CALL_RETURN_FROM_HERE???
-	for (i = SC_get_rowset_start(stmt), kres_ridx = GIdx2KResIdx(i, stmt, res), rowc = 0;; i++, kres_ridx++)
+	start = SC_get_rowset_start(stmt);
+	if (limitrow <= start)
+		goto cleanup;
+	blocks = malloc(sizeof(UInt4) * (limitrow - start));
+	offsets = malloc(sizeof(UInt2) * (limitrow - start));
+	if (!blocks || !offsets)
 	{
-		if (i >= limitrow)
+		rcnt = -1;
+		SC_set_error(stmt, STMT_NO_MEMORY_ERROR, "Out of memory in LoadFromKeyset()", func);
+		goto cleanup;
+	}
+	for (i = start, kres_ridx = GIdx2KResIdx(i, stmt, res); i < limitrow; i++, kres_ridx++)
+	{
+		if (0 != (res->keyset[kres_ridx].status & CURS_NEEDS_REREAD))
 		{
-			if (!rowc)
-				break;
-			if (res->reload_count > 0)
-			{
-				for (j = rowc; j < keys_per_fetch; j++)
-				{
-					appendPQExpBufferStr(&qval, j ? ",NULL" : "NULL");
-				}
-			}
-			rowc = -1; /* end of loop */
+			getTid(res, kres_ridx, &blocks[rcnt], &offsets[rcnt]);
+			rcnt++;
 		}
-		if (rowc < 0 || rowc >= keys_per_fetch)
+	}
+	if (!rcnt)
+		goto cleanup;
+
+	SPRINTF_FIXED(planname, "_KEYSET_%p", res);
+	prepared = (res->reload_count > 0);
+	if (!prepared)
+	{
+		initPQExpBuffer(&qval);
+		printfPQExpBuffer(&qval, "%s where ctid = any($1)", stmt->load_statement);
+		if (PQExpBufferDataBroken(qval))
 		{
-			QResultClass	*qres;
+			rcnt = -1;
+			SC_set_error(stmt, STMT_NO_MEMORY_ERROR, "Out of memory in LoadFromKeyset()", func);
+			goto cleanup;
+		}
+	}
+	qflag = READ_ONLY_QUERY;
+	if (stmt->external && !CC_is_in_trans(conn) &&
+	    !CC_does_autocommit(conn))
+		qflag |= GO_INTO_TRANSACTION;
+	qres = CC_send_tid_lookup(conn, stmt, qflag, planname, prepared ? NULL : qval.data, &prepared, blocks, offsets, rcnt);
+	/* QR_free_memory() deallocates the plan */
+	if (prepared)
+		res->reload_count = 1;
+	if (!QR_command_maybe_successful(qres))
+	{
+		SC_set_error(stmt, STMT_EXEC_ERROR, prepared ? "Data Load Error" : "Prepare for Data Load Error", func);
+		rcnt = -1;
+		QR_Destructor(qres);
+		goto cleanup;
+	}
 
-			appendPQExpBufferStr(&qval, ")");
-			if (PQExpBufferDataBroken(qval))
-			{
-				rcnt = -1;
-				SC_set_error(stmt, STMT_NO_MEMORY_ERROR, "Out of memory in LoadFromKeyset()", func);
-				goto cleanup;
-			}
-			qres = CC_send_query(conn, qval.data, NULL, CREATE_KEYSET | READ_ONLY_QUERY, stmt);
-			if (QR_command_maybe_successful(qres))
+	/*
+	 *	The rows usually come back in the order of the keys, so start
+	 *	looking for the next row where the previous one was found.
+	 */
+	k = start;
+	for (j = 0; j < QR_get_num_total_read(qres); j++)
+	{
+		oid = getOid(qres, j);
+		getTid(qres, j, &blocknum, &offset);
+		for (l = 0; l < limitrow - start; l++, k++)
+		{
+			if (k >= limitrow)
+				k = start;
+			getTid(res, k, &bln, &off);
+			if (oid == getOid(res, k) &&
+			    bln == blocknum &&
+			    off == offset)
 			{
-				SQLLEN		j, k, l;
-				Int2		m;
-				TupleField	*tuple, *tuplew;
-				UInt4		bln;
-				UInt2		off;
-
-				for (j = 0; j < QR_get_num_total_read(qres); j++)
+				i = GIdx2CacheIdx(k, stmt, res);
+				tuple = res->backend_tuples + res->num_fields * i;
+				tuplew = qres->backend_tuples + qres->num_fields * j;
+				for (m = 0; m < res->num_fields; m++, tuple++, tuplew++)
 				{
-					oid = getOid(qres, j);
-					getTid(qres, j, &blocknum, &offset);
-					for (k = SC_get_rowset_start(stmt); k < limitrow; k++)
-					{
-						getTid(res, k, &bln, &off);
-						if (oid == getOid(res, k) &&
-						    bln == blocknum &&
-						    off == offset)
-						{
-							l = GIdx2CacheIdx(k, stmt, res);
-							tuple = res->backend_tuples + res->num_fields * l;
-							tuplew = qres->backend_tuples + qres->num_fields * j;
-							for (m = 0; m < res->num_fields; m++, tuple++, tuplew++)
-							{
-								if (tuple->len > 0 && tuple->value)
-									free(tuple->value);
-								tuple->value = tuplew->value;
-								tuple->len = tuplew->len;
-								tuplew->value = NULL;
-								tuplew->len = -1;
-							}
-							res->keyset[k].status &= ~CURS_NEEDS_REREAD;
-							break;
-						}
-					}
+					if (tuple->len > 0 && tuple->value)
+						free(tuple->value);
+					tuple->value = tuplew->value;
+					tuple->len = tuplew->len;
+					tuplew->value = NULL;
+					tuplew->len = -1;
 				}
-			}
-			else
-			{
-				SC_set_error(stmt, STMT_EXEC_ERROR, "Data Load Error", func);
-				rcnt = -1;
-				QR_Destructor(qres);
+				res->keyset[k].status &= ~CURS_NEEDS_REREAD;
+				k++;
 				break;
 			}
-			QR_Destructor(qres);
-			if (rowc < 0)
-				break;
-			rowc = 0;
-		}
-		if (!rowc)
-		{
-			if (PQExpBufferDataBroken(qval))
-			{
-				initPQExpBuffer(&qval);
-
-				if (res->reload_count > 0)
-					keys_per_fetch = res->reload_count;
-				else
-				{
-					char	planname[32];
-					int	j;
-					QResultClass	*qres;
-
-					if (rows_per_fetch >= pre_fetch_count * 2)
-						keys_per_fetch = pre_fetch_count;
-					else
-						keys_per_fetch = rows_per_fetch;
-					if (!keys_per_fetch)
-						keys_per_fetch = 2;
-					SPRINTF_FIXED(planname, "_KEYSET_%p", res);
-					printfPQExpBuffer(&qval, "PREPARE \"%s\"", planname);
-					for (j = 0; j < keys_per_fetch; j++)
-					{
-						appendPQExpBufferStr(&qval, j ? ",tid" : "(tid");
-					}
-					appendPQExpBuffer(&qval, ") as %s where ctid in ", stmt->load_statement);
-					for (j = 0; j < keys_per_fetch; j++)
-					{
-						if (j == 0)
-							appendPQExpBufferStr(&qval, "($1");
-						else
-							appendPQExpBuffer(&qval, ",$%d", j + 1);
-					}
-					appendPQExpBufferStr(&qval, ")");
-					if (PQExpBufferDataBroken(qval))
-					{
-						rcnt = -1;
-						SC_set_error(stmt, STMT_NO_MEMORY_ERROR, "Out of memory in LoadFromKeyset()", func);
-						goto cleanup;
-					}
-					qres = CC_send_query(conn, qval.data, NULL, READ_ONLY_QUERY, stmt);
-					if (QR_command_maybe_successful(qres))
-					{
-						res->reload_count = keys_per_fetch;
-					}
-					else
-					{
-						SC_set_error(stmt, STMT_EXEC_ERROR, "Prepare for Data Load Error", func);
-						rcnt = -1;
-						SC_set_Result(stmt, qres);
-						break;
-					}
-					QR_Destructor(qres);
-				}
-			}
-			if (res->reload_count > 0)
-			{
-				printfPQExpBuffer(&qval, "EXECUTE \"_KEYSET_%p\"(", res);
-			}
-			else
-			{
-				printfPQExpBuffer(&qval, "%s where ctid in (", stmt->load_statement);
-			}
-		}
-		if (rcnt >= 0 &&
-		    0 != (res->keyset[kres_ridx].status & CURS_NEEDS_REREAD))
-		{
-			getTid(res, kres_ridx, &blocknum, &offset);
-			if (rowc)
-				appendPQExpBuffer(&qval, ",'(%u,%u)'", blocknum, offset);
-			else
-				appendPQExpBuffer(&qval, "'(%u,%u)'", blocknum, offset);
-			rowc++;
-			rcnt++;
 		}
 	}
+	QR_Destructor(qres);
 cleanup:
 #undef	return
 	if (!PQExpBufferDataBroken(qval))
 		termPQExpBuffer(&qval);
+	if (blocks)
+		free(blocks);
+	if (offsets)
+		free(offsets);
 	return rcnt;
 }
 
+/*
+ *	The same for the tables with inheritance. The rows are looked up in
+ *	the table of each row's tableoid, which is named in the FROM clause,
+ *	so this keeps sending "ctid in (...)" per table rather than
+ *	preparing a plan per table and result.
+ */
 static SQLLEN LoadFromKeyset_inh(StatementClass *stmt, QResultClass * res, int rows_per_fetch, SQLLEN limitrow)
 {
 	ConnectionClass	*conn = SC_get_conn(stmt);
@@ -3711,7 +3760,7 @@ SC_pos_reload_needed(StatementClass *stmt, SQLULEN req_size, UDWORD flag)
 			goto cleanup;
 		}
 	}
-	else if (rowc = LoadFromKeyset(stmt, res, rows_per_fetch, limitrow), rowc < 0)
+	else if (rowc = LoadFromKeyset(stmt, res, limitrow), rowc < 0)
 	{
 		goto cleanup;
 	}
@@ -4363,6 +4412,196 @@ cleanup:
 	return ret;
 }
 
+/*
+ *	Delete the rows of a rowset with one statement.
+ *
+ *	irows[i] is the rowset index of the i-th row, global_ridxs[i] its index
+ *	in the result and keysets[i] its keys if the row may be out of the
+ *	keyset (keysets may be NULL).  The deleted rows are known from the
+ *	returned ctids, and the keyset and the row status array are updated
+ *	as SC_pos_delete() does for each of them.
+ *
+ *	Returns SQL_NO_DATA_FOUND without deleting anything if the rows can't
+ *	be deleted at once, and the caller should call SC_pos_delete() for
+ *	each row.
+ */
+RETCODE
+SC_pos_delete_rows(StatementClass *stmt, SQLSETPOSIROW nrows,
+		  const SQLSETPOSIROW *irows, const SQLULEN *global_ridxs, const KeySet *keysets)
+{
+	CSTR	func = "SC_pos_delete_rows";
+	QResultClass *res, *qres;
+	ConnectionClass	*conn = SC_get_conn(stmt);
+	IRDFields	*irdflds = SC_get_IRDF(stmt);
+	PQExpBufferData		dltstr = {0};
+	RETCODE		ret = SQL_NO_DATA_FOUND;
+	SQLSETPOSIROW	i, j, k;
+	SQLLEN		kres_ridx, *kres_ridxs = NULL;
+	KeySet		*keys = NULL;
+	char		*deleted = NULL;
+	UInt4		blocknum, qflag;
+	UInt2		offset;
+	TABLE_INFO	*ti;
+	const char	*bestitem;
+	const char	*bestqual;
+	char		table_fqn[256];
+
+	MYLOG(0, "entering nrows=" FORMAT_POSIROW "\n", nrows);
+	if (nrows < 2 || !(res = SC_get_Curres(stmt)))
+		return ret;
+	if (SC_update_not_ready(stmt))
+		parse_statement(stmt, TRUE);	/* not preferable */
+	if (!SC_is_updatable(stmt) ||
+	    TI_has_subclass(stmt->ti[0]) ||
+	    !PG_VERSION_GE(conn, 8.2))
+		return ret;
+	ti = stmt->ti[0];
+	bestitem = GET_NAME(ti->bestitem);
+	bestqual = GET_NAME(ti->bestqual);
+
+#define	return	DONT_CALL_RETURN_FROM_HERE???
+	kres_ridxs = malloc(sizeof(SQLLEN) * nrows);
+	keys = malloc(sizeof(KeySet) * nrows);
+	deleted = calloc(nrows, sizeof(char));
+	if (!kres_ridxs || !keys || !deleted)
+	{
+		ret = SQL_ERROR;
+		SC_set_error(stmt, STMT_NO_MEMORY_ERROR, "Out of memory in SC_pos_delete_rows()", func);
+		goto cleanup;
+	}
+	for (i = 0; i < nrows; i++)
+	{
+		kres_ridx = GIdx2KResIdx(global_ridxs[i], stmt, res);
+		if (kres_ridx >= 0 && kres_ridx < res->num_cached_keys)
+		{
+			keys[i] = res->keyset[kres_ridx];
+			if (!keys[i].oid && bestitem && !strcmp(bestitem, OID_NAME))
+				goto cleanup;	/* SC_pos_delete() reports it */
+		}
+		else if (keysets && keysets[i].offset != 0)
+		{
+			kres_ridx = -1;
+			keys[i] = keysets[i];
+		}
+		else
+			goto cleanup;
+		kres_ridxs[i] = kres_ridx;
+	}
+
+	initPQExpBuffer(&dltstr);
+	printfPQExpBuffer(&dltstr, "delete from %s where ",
+			 ti_quote(stmt, 0, table_fqn, sizeof(table_fqn)));
+	for (i = 0; i < nrows; i++)
+	{
+		if (bestqual)
+		{
+			appendPQExpBuffer(&dltstr, "%s(ctid = '(%u,%u)' and ",
+					 i ? " or " : "", keys[i].blocknum, keys[i].offset);
+			appendPQExpBuffer(&dltstr, bestqual, keys[i].oid);
+			appendPQExpBufferStr(&dltstr, ")");
+		}
+		else
+			appendPQExpBuffer(&dltstr, "%s\"(%u,%u)\"",
+					 i ? "," : "ctid = any('{", keys[i].blocknum, keys[i].offset);
+	}
+	if (!bestqual)
+		appendPQExpBufferStr(&dltstr, "}'::tid[])");
+	appendPQExpBufferStr(&dltstr, " returning ctid");
+	if (PQExpBufferDataBroken(dltstr))
+	{
+		ret = SQL_ERROR;
+		SC_set_error(stmt, STMT_NO_MEMORY_ERROR, "Out of memory in SC_pos_delete_rows()", func);
+		goto cleanup;
+	}
+	MYLOG(0, "dltstr=%s\n", dltstr.data);
+	qflag = 0;
+	if (stmt->external && !CC_is_in_trans(conn) &&
+	    (!CC_does_autocommit(conn)))
+		qflag |= GO_INTO_TRANSACTION;
+	qres = CC_send_query(conn, dltstr.data, NULL, qflag, stmt);
+	if (QR_command_maybe_successful(qres))
+	{
+		ret = SQL_SUCCESS;
+		/* the ctids come back in the order of the keys, usually */
+		for (j = 0, k = 0; j < QR_get_num_cached_tuples(qres); j++)
+		{
+			if (sscanf(QR_get_value_backend_text(qres, j, 0), "(%u,%hu)", &blocknum, &offset) != 2)
+				continue;
+			for (i = 0; i < nrows; i++, k++)
+			{
+				if (k >= nrows)
+					k = 0;
+				if (!deleted[k] &&
+				    keys[k].blocknum == blocknum &&
+				    keys[k].offset == offset)
+				{
+					deleted[k] = TRUE;
+					break;
+				}
+			}
+		}
+	}
+	else
+	{
+		ret = SQL_ERROR;
+		if (qres)
+		{
+			STRCPY_FIXED(res->sqlstate, qres->sqlstate);
+			res->message = qres->message;
+			qres->message = NULL;
+		}
+		if (SC_get_errornumber(stmt) == 0)
+			SC_set_error(stmt, STMT_ERROR_TAKEN_FROM_BACKEND, "SetPos delete return error", func);
+	}
+	if (qres)
+		QR_Destructor(qres);
+
+	for (i = 0; i < nrows; i++)
+	{
+		UWORD	rowstatus = SQL_ROW_DELETED;
+
+		kres_ridx = kres_ridxs[i];
+		if (SQL_ERROR == ret)
+			rowstatus = SQL_ROW_ERROR;
+		else if (deleted[i])
+		{
+			const KeySet	*keyset = kres_ridx >= 0 ? res->keyset + kres_ridx : keys + i;
+
+			AddRollback(stmt, res, global_ridxs[i], keyset, SQL_DELETE);
+			AddDeleted(res, global_ridxs[i], keyset);
+			if (kres_ridx >= 0)
+			{
+				res->keyset[kres_ridx].status &= (~KEYSET_INFO_PUBLIC);
+				if (CC_is_in_trans(conn))
+					res->keyset[kres_ridx].status |= (SQL_ROW_DELETED | CURS_SELF_DELETING);
+				else
+					res->keyset[kres_ridx].status |= (SQL_ROW_DELETED | CURS_SELF_DELETED);
+			}
+		}
+		else
+		{
+			SC_set_error(stmt, STMT_ROW_VERSION_CHANGED, "the content was changed before deletes", func);
+			ret = SQL_SUCCESS_WITH_INFO;
+			if (kres_ridx >= 0 && stmt->options.cursor_type == SQL_CURSOR_KEYSET_DRIVEN)
+				SC_pos_reload(stmt, global_ridxs[i], (UInt2 *) 0, 0);
+		}
+		if (irdflds->rowStatusArray)
+			irdflds->rowStatusArray[irows[i]] = rowstatus;
+	}
+
+cleanup:
+#undef return
+	if (!PQExpBufferDataBroken(dltstr))
+		termPQExpBuffer(&dltstr);
+	if (kres_ridxs)
+		free(kres_ridxs);
+	if (keys)
+		free(keys);
+	if (deleted)
+		free(deleted);
+	return ret;
+}
+
 static RETCODE SQL_API
 irow_insert(RETCODE ret, StatementClass *stmt, StatementClass *istmt,
 			SQLLEN addpos)
@@ -4745,6 +4984,72 @@ typedef struct
 	UWORD	fOption;
 	SQLSETPOSIROW	irow, nrow, processed;
 }	spos_cdata;
+
+/*
+ *	SQLSetPos(0, SQL_DELETE) deletes the rows of the rowset to be
+ *	processed with one statement.  The rows are chosen as spos_callback()
+ *	does.  Returns SQL_NO_DATA_FOUND if they are to be deleted one by one.
+ */
+static RETCODE
+spos_delete_rows(spos_cdata *s)
+{
+	CSTR	func = "spos_delete_rows";
+	QResultClass	*res = s->res;
+	ARDFields	*opts = s->opts;
+	SQLSETPOSIROW	*irows, nrow, nrows = 0;
+	SQLULEN		*global_ridxs, global_ridx;
+	SQLLEN		idx, kres_ridx;
+	RETCODE		ret;
+
+	if (s->end_row < 1)
+		return SQL_NO_DATA_FOUND;
+	irows = malloc(sizeof(SQLSETPOSIROW) * (s->end_row + 1));
+	global_ridxs = malloc(sizeof(SQLULEN) * (s->end_row + 1));
+	if (!irows || !global_ridxs)
+	{
+		if (irows)
+			free(irows);
+		if (global_ridxs)
+			free(global_ridxs);
+		SC_set_error(s->stmt, STMT_NO_MEMORY_ERROR, "Could not allocate memory for the rows to delete", func);
+		return SQL_ERROR;
+	}
+	for (idx = 0, nrow = 0; nrow <= s->end_row; idx++)
+	{
+		global_ridx = RowIdx2GIdx(idx, s->stmt);
+		if ((int) global_ridx >= QR_get_num_total_tuples(res))
+			break;
+		if (res->keyset)
+		{
+			kres_ridx = GIdx2KResIdx(global_ridx, s->stmt, res);
+			if (kres_ridx >= res->num_cached_keys)
+				break;
+			if (kres_ridx >= 0) /* the row may be deleted and not in the rowset */
+			{
+				if (0 == (res->keyset[kres_ridx].status & CURS_IN_ROWSET))
+					continue;
+			}
+		}
+		if (!opts->row_operation_ptr || opts->row_operation_ptr[nrow] == SQL_ROW_PROCEED)
+		{
+			irows[nrows] = nrow;
+			global_ridxs[nrows] = global_ridx;
+			nrows++;
+		}
+		nrow++;
+	}
+	ret = SC_pos_delete_rows(s->stmt, nrows, irows, global_ridxs, NULL);
+	if (SQL_NO_DATA_FOUND != ret)
+	{
+		s->nrow = nrow;
+		s->idx = idx;
+		s->processed = nrows;
+	}
+	free(irows);
+	free(global_ridxs);
+	return ret;
+}
+
 static
 RETCODE spos_callback(RETCODE retcode, void *para)
 {
@@ -4780,6 +5085,13 @@ RETCODE spos_callback(RETCODE retcode, void *para)
 		SC_set_error(s->stmt, STMT_SEQUENCE_ERROR, "Passed res or opts for spos_callback is NULL", func);
 		return SQL_ERROR;
 	}
+	if (SQL_DELETE == s->fOption && 0 == s->irow && !s->need_data_callback)
+	{
+		RETCODE	tret = spos_delete_rows(s);
+
+		if (SQL_NO_DATA_FOUND != tret)
+			ret = tret;
+	}
 	s->need_data_callback = FALSE;
 	for (; SQL_ERROR != ret && s->nrow <= s->end_row; s->idx++)
 	{
@@ -4893,6 +5205,8 @@ PGAPI_SetPos(HSTMT hstmt,
 		SC_log_error(func, NULL_STRING, NULL);
 		return SQL_INVALID_HANDLE;
 	}
+	if (SC_asynccheck(s.stmt, func))
+		return SQL_ERROR;
 
 	s.irow = irow;
 	s.fOption = fOption;
@@ -4914,6 +5228,7 @@ PGAPI_SetPos(HSTMT hstmt,
 		SC_set_error(s.stmt, STMT_INVALID_CURSOR_STATE_ERROR, "Null statement result in PGAPI_SetPos.", func);
 		return SQL_ERROR;
 	}
+	QR_finish_readahead(s.res);
 
 	rowsetSize = (s.stmt->transition_status == STMT_TRANSITION_EXTENDED_FETCH ? s.opts->size_of_rowset_odbc2 : s.opts->size_of_rowset);
 	if (s.irow == 0) /* bulk operation */
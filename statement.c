@@ -32,6 +32,16 @@
 #include <stdio.h>
 #include <string.h>
 #include <ctype.h>
+#ifdef	ASYNC_NOTIFICATION
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#ifdef	HAVE_SYS_EPOLL_H
+#include <sys/epoll.h>
+#else
+#include <poll.h>
+#endif /* HAVE_SYS_EPOLL_H */
+#endif /* ASYNC_NOTIFICATION */
 
 #include "pgapifunc.h"
 
@@ -172,9 +182,36 @@ static const struct
 	}
 };
 
+/*
+ * An execution sent with PQsendQueryParams() or PQsendQueryPrepared() in
+ * SQL_ASYNC_ENABLE_ON mode, kept while the calls return SQL_STILL_EXECUTING.
+ */
+typedef struct AsyncExec_
+{
+	PGresult	*pgres;		/* the result received so far */
+	QResultClass	*newres;
+	notice_receiver_arg	nrarg;
+	int		nParams;
+	const char	*qtrace_query;
+	Int8		send_time;
+	PerfCounters	perf_before;
+	BOOL		wait;		/* block until the response is complete */
+	SQLUBIGINT		watch_key;	/* registered with the completion thread */
+	/* the state of SC_execute() to resume with */
+	Int2		conn_status;
+	BOOL		is_in_trans;
+	BOOL		use_cursor;
+	BOOL		query_timer;
+} AsyncExec;
+
+#ifdef	ASYNC_NOTIFICATION
+static void SC_async_watch(StatementClass *stmt);
+static void SC_async_unwatch(StatementClass *stmt);
+#endif /* ASYNC_NOTIFICATION */
 static QResultClass *libpq_bind_and_exec(StatementClass *stmt);
 static void SC_set_errorinfo(StatementClass *self, QResultClass *res, int errkind);
 static void SC_set_error_if_not_set(StatementClass *self, int errornumber, const char *errmsg, const char *func);
+static BOOL SC_put_to_pool(StatementClass *self);
 
 
 RETCODE		SQL_API
@@ -185,6 +222,7 @@ PGAPI_AllocStmt(HDBC hdbc,
 	ConnectionClass *conn = (ConnectionClass *) hdbc;
 	StatementClass *stmt;
 	ARDFields	*ardopts;
+	BindInfoClass	*bindings;
 
 	MYLOG(0, "entering...\n");
 
@@ -216,6 +254,8 @@ PGAPI_AllocStmt(HDBC hdbc,
 	*phstmt = (HSTMT) stmt;
 
 	stmt->iflag = flag;
+	/* the array kept by a pooled statement */
+	bindings = stmt->ardi.ardf.bindings;
 	/* Copy default statement options based from Connection options */
 	if (0 != (PODBC_INHERIT_CONNECT_OPTIONS & flag))
 	{
@@ -228,6 +268,7 @@ PGAPI_AllocStmt(HDBC hdbc,
 		stmt->options = stmt->options_orig;
 		InitializeARDFields(&stmt->ardi.ardf);
 	}
+	stmt->ardi.ardf.bindings = bindings;
 	ardopts = SC_get_ARDF(stmt);
 	ARD_AllocBookmark(ardopts);
 
@@ -252,6 +293,8 @@ PGAPI_FreeStmt(HSTMT hstmt,
 		SC_log_error(func, "", NULL);
 		return SQL_INVALID_HANDLE;
 	}
+	if (SQL_DROP == fOption || SQL_CLOSE == fOption)
+		SC_async_discard(stmt);
 	SC_clear_error(stmt);
 
 	if (fOption == SQL_DROP)
@@ -296,7 +339,8 @@ PGAPI_FreeStmt(HSTMT hstmt,
 		if (stmt->execute_parent)
 			stmt->execute_parent->execute_delegate = NULL;
 		/* Destroy the statement and free any results, cursors, etc. */
-		SC_Destructor(stmt);
+		if (!SC_put_to_pool(stmt))
+			SC_Destructor(stmt);
 	}
 	else if (fOption == SQL_UNBIND)
 		SC_unbind_cols(stmt);
@@ -342,6 +386,7 @@ InitializeStatementOptions(StatementOptions *opt)
 	opt->retrieve_data = SQL_RD_ON;
 	opt->use_bookmarks = SQL_UB_OFF;
 	opt->metadata_id = SQL_FALSE;
+	opt->async_enable = SQL_ASYNC_ENABLE_OFF;
 }
 
 static void SC_clear_parse_status(StatementClass *self, ConnectionClass *conn)
@@ -371,104 +416,257 @@ static void SC_init_parse_method(StatementClass *self)
 		SC_set_parse_forced(self);
 }
 
+/*
+ *	Initialize the members of a new statement, or of one taken from the
+ *	statement pool of the connection.
+ */
+static void
+SC_init(StatementClass *rv, ConnectionClass *conn)
+{
+	rv->hdbc = conn;
+	rv->phstmt = NULL;
+	rv->rhold.first = rv->rhold.last = NULL;
+	rv->curres = NULL;
+	rv->parsed = NULL;
+	rv->catalog_result = FALSE;
+	rv->prepare = NON_PREPARE_STATEMENT;
+	rv->prepared = NOT_YET_PREPARED;
+	rv->status = STMT_ALLOCATED;
+	rv->external = FALSE;
+	rv->iflag = 0;
+	rv->plan_name = NULL;
+	rv->transition_status = STMT_TRANSITION_UNALLOCATED;
+	rv->multi_statement = -1; /* unknown */
+	rv->num_params = -1; /* unknown */
+	rv->processed_statements = NULL;
+
+	rv->__error_message = NULL;
+	rv->__error_number = 0;
+	rv->pgerror = NULL;
+
+	rv->statement = NULL;
+	rv->tokens = NULL;
+	rv->num_tokens = 0;
+	rv->query_template = NULL;
+	rv->stmt_with_params = NULL;
+	rv->load_statement = NULL;
+	rv->statement_type = STMT_TYPE_UNKNOWN;
+
+	rv->currTuple = -1;
+	rv->rowset_start = 0;
+	SC_set_rowset_start(rv, -1, FALSE);
+	rv->current_col = -1;
+	rv->bind_row = 0;
+	rv->from_pos = rv->load_from_pos = rv->where_pos = -1;
+	rv->last_fetch_count = rv->last_fetch_count_include_ommitted = 0;
+	rv->save_rowset_size = -1;
+
+	rv->data_at_exec = -1;
+	rv->current_exec_param = -1;
+	rv->exec_start_row = -1;
+	rv->exec_end_row = -1;
+	rv->exec_current_row = -1;
+	rv->put_data = FALSE;
+	rv->ref_CC_error = FALSE;
+	rv->join_info = 0;
+	SC_init_parse_method(rv);
+
+	rv->lobj_fd = -1;
+	INIT_NAME(rv->cursor_name);
+
+	/* Parse Stuff */
+	rv->ti = NULL;
+	rv->ntab = 0;
+	rv->num_key_fields = -1; /* unknown */
+	SC_clear_parse_status(rv, conn);
+	rv->proc_return = -1;
+	SC_init_discard_output_params(rv);
+	rv->cancel_info = 0;
+
+	/* Clear Statement Options -- defaults will be set in AllocStmt */
+	memset(&rv->options, 0, sizeof(StatementOptions));
+	InitializeEmbeddedDescriptor((DescriptorClass *)&(rv->ardi),
+			rv, SQL_ATTR_APP_ROW_DESC);
+	InitializeEmbeddedDescriptor((DescriptorClass *)&(rv->apdi),
+			rv, SQL_ATTR_APP_PARAM_DESC);
+	InitializeEmbeddedDescriptor((DescriptorClass *)&(rv->irdi),
+			rv, SQL_ATTR_IMP_ROW_DESC);
+	InitializeEmbeddedDescriptor((DescriptorClass *)&(rv->ipdi),
+			rv, SQL_ATTR_IMP_PARAM_DESC);
+
+	rv->miscinfo = 0;
+	rv->execinfo = 0;
+	rv->rb_or_tc = 0;
+	SC_reset_updatable(rv);
+	rv->diag_row_count = 0;
+	rv->stmt_time = 0;
+	rv->execute_delegate = NULL;
+	rv->execute_parent = NULL;
+	rv->allocated_callbacks = 0;
+	rv->num_callbacks = 0;
+	rv->callbacks = NULL;
+	rv->async_exec = NULL;
+	rv->async_callback = NULL;
+	rv->async_context = NULL;
+	rv->async_event = NULL;
+	GetDataInfoInitialize(SC_get_GDTI(rv));
+	PutDataInfoInitialize(SC_get_PDTI(rv));
+	rv->use_server_side_prepare = conn->connInfo.use_server_side_prepare;
+	rv->lock_CC_for_rb = FALSE;
+	rv->relock_CC_for_rb = FALSE;
+	rv->accessed_db_on_read = FALSE;
+	// for batch execution
+	memset(&rv->stmt_deffered, 0, sizeof(rv->stmt_deffered));
+	if ((rv->batch_size = conn->connInfo.batch_size) < 1)
+		rv->batch_size = 1;
+	rv->exec_type = DIRECT_EXEC;
+	rv->count_of_deffered = 0;
+	rv->multirow_insert = FALSE;
+	rv->has_notice = 0;
+	memset(&rv->perf, 0, sizeof(rv->perf));
+	rv->convert_usec_unfolded = 0;
+	rv->next_pooled = NULL;
+}
+
+/*
+ *	The statement pool of a connection.
+ *
+ *	PGAPI_FreeStmt(SQL_DROP) puts the statement back to the pool of its
+ *	connection, up to StatementPoolSize statements, rather than freeing
+ *	it, and SC_Constructor() takes the statements from there first. A
+ *	pooled statement has released everything but the arrays of the
+ *	column and parameter bindings, the getdata and putdata info and the
+ *	need-data callbacks, which are reused after they were reset to the
+ *	state of a new statement.
+ */
+static StatementClass *
+SC_take_from_pool(ConnectionClass *conn)
+{
+	StatementClass	*rv;
+	BindInfoClass	*bindings;
+	ParameterInfoClass	*parameters;
+	ParameterImplClass	*iparameters;
+	GetDataInfo	gdata_info;
+	PutDataInfo	pdata_info;
+	NeedDataCallback	*callbacks;
+	UInt2		allocated_callbacks;
+
+	if (!conn)
+		return NULL;
+	CONNLOCK_ACQUIRE(conn);
+	if (rv = conn->stmt_pool, NULL != rv)
+	{
+		conn->stmt_pool = rv->next_pooled;
+		conn->num_pooled_stmts--;
+	}
+	CONNLOCK_RELEASE(conn);
+	if (!rv)
+		return NULL;
+
+	MYLOG(0, "reusing the pooled statement %p\n", rv);
+	bindings = rv->ardi.ardf.bindings;
+	parameters = rv->apdi.apdf.parameters;
+	iparameters = rv->ipdi.ipdf.parameters;
+	gdata_info = rv->gdata_info;
+	pdata_info = rv->pdata_info;
+	callbacks = rv->callbacks;
+	allocated_callbacks = rv->allocated_callbacks;
+	SC_init(rv, conn);
+	/* allocated remains 0 so that nothing looks bound */
+	rv->ardi.ardf.bindings = bindings;
+	rv->apdi.apdf.parameters = parameters;
+	rv->ipdi.ipdf.parameters = iparameters;
+	rv->gdata_info = gdata_info;
+	rv->pdata_info = pdata_info;
+	rv->callbacks = callbacks;
+	rv->allocated_callbacks = allocated_callbacks;
+
+	return rv;
+}
+
+static BOOL
+SC_put_to_pool(StatementClass *self)
+{
+	ConnectionClass	*conn = SC_get_conn(self);
+	QResultClass	*res;
+	ARDFields	*ardopts = &(self->ardi.ardf);
+	APDFields	*apdopts = &(self->apdi.apdf);
+	IPDFields	*ipdopts = &(self->ipdi.ipdf);
+	PutDataInfo	*pdata = SC_get_PDTI(self);
+	BindInfoClass	*bindings;
+	ParameterInfoClass	*parameters;
+	ParameterImplClass	*iparameters;
+	int		i;
+	BOOL		ret = FALSE;
+
+	if (!conn || STMT_EXECUTING == self->status ||
+	    conn->num_pooled_stmts >= conn->connInfo.stmt_pool_size)
+		return FALSE;
+
+	SC_clear_error(self);
+	if (res = SC_get_Result(self), NULL != res)
+	{
+		QR_Destructor(res);
+		SC_init_Result(self);
+	}
+	SC_initialize_stmts(self, TRUE);
+	SC_initialize_cols_info(self, FALSE, TRUE);
+	NULL_THE_NAME(self->cursor_name);
+	cancelNeedDataState(self);
+	if (!PQExpBufferDataBroken(self->stmt_deffered))
+		termPQExpBuffer(&self->stmt_deffered);
+
+	/* unbind everything, keeping the arrays out of the descriptors */
+	ARD_unbind_cols(ardopts, FALSE);
+	bindings = ardopts->bindings;
+	ardopts->bindings = NULL;
+	ardopts->allocated = 0;
+	parameters = apdopts->parameters;
+	apdopts->parameters = NULL;
+	apdopts->allocated = 0;
+	for (i = 1; i <= ipdopts->allocated; i++)
+		reset_a_iparameter_binding(ipdopts, i);
+	iparameters = ipdopts->parameters;
+	ipdopts->parameters = NULL;
+	ipdopts->allocated = 0;
+	DC_Destructor((DescriptorClass *) SC_get_ARDi(self));
+	DC_Destructor((DescriptorClass *) SC_get_APDi(self));
+	DC_Destructor((DescriptorClass *) SC_get_IRDi(self));
+	DC_Destructor((DescriptorClass *) SC_get_IPDi(self));
+	ardopts->bindings = bindings;
+	apdopts->parameters = parameters;
+	ipdopts->parameters = iparameters;
+	GDATA_unbind_cols(SC_get_GDTI(self), FALSE);
+	drop_putdata_streams(self);
+	SC_fold_convert_time(self);
+	for (i = 1; i <= pdata->allocated; i++)
+		reset_a_putdata_info(pdata, i);
+
+	CONNLOCK_ACQUIRE(conn);
+	if (conn->num_pooled_stmts < conn->connInfo.stmt_pool_size)
+	{
+		self->next_pooled = conn->stmt_pool;
+		conn->stmt_pool = self;
+		conn->num_pooled_stmts++;
+		ret = TRUE;
+	}
+	CONNLOCK_RELEASE(conn);
+	MYLOG(0, "statement %p %s\n", self, ret ? "pooled" : "not pooled");
+
+	return ret;
+}
+
 StatementClass *
 SC_Constructor(ConnectionClass *conn)
 {
 	StatementClass *rv;
 
+	if (rv = SC_take_from_pool(conn), NULL != rv)
+		return rv;
 	rv = (StatementClass *) malloc(sizeof(StatementClass));
 	if (rv)
 	{
-		rv->hdbc = conn;
-		rv->phstmt = NULL;
-		rv->rhold.first = rv->rhold.last = NULL;
-		rv->curres = NULL;
-		rv->parsed = NULL;
-		rv->catalog_result = FALSE;
-		rv->prepare = NON_PREPARE_STATEMENT;
-		rv->prepared = NOT_YET_PREPARED;
-		rv->status = STMT_ALLOCATED;
-		rv->external = FALSE;
-		rv->iflag = 0;
-		rv->plan_name = NULL;
-		rv->transition_status = STMT_TRANSITION_UNALLOCATED;
-		rv->multi_statement = -1; /* unknown */
-		rv->num_params = -1; /* unknown */
-		rv->processed_statements = NULL;
-
-		rv->__error_message = NULL;
-		rv->__error_number = 0;
-		rv->pgerror = NULL;
-
-		rv->statement = NULL;
-		rv->stmt_with_params = NULL;
-		rv->load_statement = NULL;
-		rv->statement_type = STMT_TYPE_UNKNOWN;
-
-		rv->currTuple = -1;
-		rv->rowset_start = 0;
-		SC_set_rowset_start(rv, -1, FALSE);
-		rv->current_col = -1;
-		rv->bind_row = 0;
-		rv->from_pos = rv->load_from_pos = rv->where_pos = -1;
-		rv->last_fetch_count = rv->last_fetch_count_include_ommitted = 0;
-		rv->save_rowset_size = -1;
-
-		rv->data_at_exec = -1;
-		rv->current_exec_param = -1;
-		rv->exec_start_row = -1;
-		rv->exec_end_row = -1;
-		rv->exec_current_row = -1;
-		rv->put_data = FALSE;
-		rv->ref_CC_error = FALSE;
-		rv->join_info = 0;
-		SC_init_parse_method(rv);
-
-		rv->lobj_fd = -1;
-		INIT_NAME(rv->cursor_name);
-
-		/* Parse Stuff */
-		rv->ti = NULL;
-		rv->ntab = 0;
-		rv->num_key_fields = -1; /* unknown */
-		SC_clear_parse_status(rv, conn);
-		rv->proc_return = -1;
-		SC_init_discard_output_params(rv);
-		rv->cancel_info = 0;
-
-		/* Clear Statement Options -- defaults will be set in AllocStmt */
-		memset(&rv->options, 0, sizeof(StatementOptions));
-		InitializeEmbeddedDescriptor((DescriptorClass *)&(rv->ardi),
-				rv, SQL_ATTR_APP_ROW_DESC);
-		InitializeEmbeddedDescriptor((DescriptorClass *)&(rv->apdi),
-				rv, SQL_ATTR_APP_PARAM_DESC);
-		InitializeEmbeddedDescriptor((DescriptorClass *)&(rv->irdi),
-				rv, SQL_ATTR_IMP_ROW_DESC);
-		InitializeEmbeddedDescriptor((DescriptorClass *)&(rv->ipdi),
-				rv, SQL_ATTR_IMP_PARAM_DESC);
-
-		rv->miscinfo = 0;
-		rv->execinfo = 0;
-		rv->rb_or_tc = 0;
-		SC_reset_updatable(rv);
-		rv->diag_row_count = 0;
-		rv->stmt_time = 0;
-		rv->execute_delegate = NULL;
-		rv->execute_parent = NULL;
-		rv->allocated_callbacks = 0;
-		rv->num_callbacks = 0;
-		rv->callbacks = NULL;
-		GetDataInfoInitialize(SC_get_GDTI(rv));
-		PutDataInfoInitialize(SC_get_PDTI(rv));
-		rv->use_server_side_prepare = conn->connInfo.use_server_side_prepare;
-		rv->lock_CC_for_rb = FALSE;
-		// for batch execution
-		memset(&rv->stmt_deffered, 0, sizeof(rv->stmt_deffered));
-		if ((rv->batch_size = conn->connInfo.batch_size) < 1)
-			rv->batch_size = 1;
-		rv->exec_type = DIRECT_EXEC;
-		rv->count_of_deffered = 0;
-		rv->has_notice = 0;
+		SC_init(rv, conn);
 		INIT_STMT_CS(rv);
 	}
 	return rv;
@@ -508,6 +706,8 @@ SC_Destructor(StatementClass *self)
 	DC_Destructor((DescriptorClass *) SC_get_IRDi(self));
 	DC_Destructor((DescriptorClass *) SC_get_IPDi(self));
 	GDATA_unbind_cols(SC_get_GDTI(self), TRUE);
+	drop_putdata_streams(self);
+	SC_fold_convert_time(self);
 	PDATA_free_params(SC_get_PDTI(self), STMT_FREE_PARAMS_ALL);
 
 	if (self->__error_message)
@@ -588,6 +788,8 @@ SC_free_params(StatementClass *self, char option)
 		APD_free_params(SC_get_APDF(self), option);
 		IPD_free_params(SC_get_IPDF(self), option);
 	}
+	/* the large objects of abandoned streamed data */
+	drop_putdata_streams(self);
 	PDATA_free_params(SC_get_PDTI(self), option);
 	self->data_at_exec = -1;
 	self->current_exec_param = -1;
@@ -735,6 +937,7 @@ SC_initialize_stmts(StatementClass *self, BOOL initializeOriginal)
 			LEAVE_CONN_CS(conn);
 		self->lock_CC_for_rb = FALSE;
 	}
+	self->relock_CC_for_rb = FALSE;
 	if (initializeOriginal)
 	{
 		if (self->statement)
@@ -742,6 +945,8 @@ SC_initialize_stmts(StatementClass *self, BOOL initializeOriginal)
 			free(self->statement);
 			self->statement = NULL;
 		}
+		SC_forget_tokens(self);
+		SC_forget_query_template(self);
 
 		pstmt = self->processed_statements;
 		while (pstmt)
@@ -812,6 +1017,19 @@ BOOL	SC_opencheck(StatementClass *self, const char *func)
 	return	FALSE;
 }
 
+/*
+ *	While an execution in SQL_ASYNC_ENABLE_ON mode is in progress, only
+ *	SQLExecute/SQLExecDirect (to poll it), SQLCancel, SQLFreeStmt and the
+ *	diagnostics functions may be called for the statement.
+ */
+BOOL	SC_asynccheck(StatementClass *self, const char *func)
+{
+	if (!self || !SC_is_async_executing(self))
+		return FALSE;
+	SC_set_error(self, STMT_SEQUENCE_ERROR, "An asynchronous execution is still in progress on the statement.", func);
+	return TRUE;
+}
+
 RETCODE
 SC_initialize_and_recycle(StatementClass *self)
 {
@@ -924,9 +1142,9 @@ MYLOG(DETAIL_LOG_LEVEL, "statement=%p ommitted=0\n", self);
 	self->__error_message = NULL;
 	self->__error_number = 0;
 
-	self->lobj_fd = -1;
-
 	SC_free_params(self, STMT_FREE_PARAMS_DATA_AT_EXEC_ONLY);
+	self->lobj_fd = -1;
+	SC_fold_convert_time(self);
 	SC_initialize_stmts(self, FALSE);
 	cancelNeedDataState(self);
 	self->cancel_info = 0;
@@ -943,272 +1161,553 @@ MYLOG(DETAIL_LOG_LEVEL, "statement=%p ommitted=0\n", self);
 }
 
 /*
- *	Scan the query wholly or partially (if the next_cmd param specified).
- *	Also count the number of parameters respectviely.
+ *	The lexer of SQL queries.
+ *
+ *	It splits a query into the tokens which matter to the driver (see
+ *	QueryToken), skipping white space. The characters of a literal, a
+ *	quoted identifier or a comment belong to one token.
+ *
+ *	The parameter counting, the splitting into commands and
+ *	SC_find_insert_values() scan the tokens. copy_statement_with_parameters()
+ *	and parse_statement() only take the ends of comments and dollar quoted
+ *	strings from them.
  */
-void
-SC_scanQueryAndCountParams(const char *query, const ConnectionClass *conn,
-		ssize_t *next_cmd, SQLSMALLINT * pcpar,
-		po_ind_t *multi_st, po_ind_t *proc_return)
+typedef struct
 {
-	const	char *tstr, *tag = NULL;
-	size_t	taglen = 0;
-	char	tchar, bchar, escape_in_literal = '\0';
-	char	in_literal = FALSE, in_ident_keyword = FALSE,
-		in_dquote_identifier = FALSE,
-		in_dollar_quote = FALSE, in_escape = FALSE,
-		in_line_comment = FALSE, del_found = FALSE;
-	int	comment_level = 0;
-	po_ind_t multi = FALSE;
-	SQLSMALLINT	num_p;
 	encoded_str	encstr;
+	const ConnectionClass	*conn;
+	BOOL		reread;		/* the current char begins the next token */
+} QueryLexer;
 
-	MYLOG(0, "entering...\n");
-	num_p = 0;
-	if (proc_return)
-		*proc_return = 0;
-	if (next_cmd)
-		*next_cmd = -1;
-	tstr = query;
-	make_encoded_str(&encstr, conn, tstr);
-	for (bchar = '\0', tchar = encoded_nextchar(&encstr); tchar; tchar = encoded_nextchar(&encstr))
-	{
-		if (MBCS_NON_ASCII(encstr)) /* multibyte char */
-		{
-			if ((UCHAR) tchar >= 0x80)
-				bchar = tchar;
-			if (in_dquote_identifier ||
-			    in_literal ||
-			    in_dollar_quote ||
-			    in_escape ||
-			    in_line_comment ||
-			    comment_level > 0)
-				;
-			else
-				in_ident_keyword = TRUE;
+static void
+QL_initialize(QueryLexer *lx, const char *query, const ConnectionClass *conn)
+{
+	make_encoded_str(&lx->encstr, conn, query);
+	lx->conn = conn;
+	lx->reread = FALSE;
+}
 
-			continue;
-		}
-		if (!multi && del_found)
-		{
-			if (IS_NOT_SPACE(tchar))
-			{
-				multi = TRUE;
-				if (next_cmd)
-					break;
-			}
-		}
-		if (in_ident_keyword)
-		{
-			if (isalnum(tchar) ||
-			    DOLLAR_QUOTE == tchar ||
-			    '_' == tchar)
-			{
-				bchar = tchar;
-				continue;
-			}
-			in_ident_keyword = FALSE;
-		}
+static BOOL
+QL_next_token(QueryLexer *lx, QueryToken *tok)
+{
+	encoded_str	*encstr = &lx->encstr;
+	const char	*tag;
+	size_t		taglen;
+	int		tchar, comment_level;
+	char		escape_in_literal;
+	BOOL		in_escape;
+
+	if (lx->reread)
+	{
+		lx->reread = FALSE;
+		tchar = *ENCODE_PTR(*encstr);
+	}
+	else
+		tchar = encoded_nextchar(encstr);
+	while (tchar && !MBCS_NON_ASCII(*encstr) && !IS_NOT_SPACE(tchar))
+		tchar = encoded_nextchar(encstr);
+	if (!tchar)
+		return FALSE;
+	tok->pos = (Int4) encstr->pos;
 
-		if (in_dollar_quote)
-		{
-			if (tchar == DOLLAR_QUOTE)
-			{
-				if (strncmp((const char *) ENCODE_PTR(encstr), tag, taglen) == 0)
-				{
-					in_dollar_quote = FALSE;
-					tag = NULL;
-					encoded_position_shift(&encstr, taglen - 1);
-				}
-			}
-		}
-		else if (in_literal)
-		{
-			if (in_escape)
-				in_escape = FALSE;
-			else if (tchar == escape_in_literal)
-				in_escape = TRUE;
-			else if (tchar == LITERAL_QUOTE)
-				in_literal = FALSE;
-		}
-		else if (in_dquote_identifier)
-		{
-			if (tchar == IDENTIFIER_QUOTE)
-				in_dquote_identifier = FALSE;
-		}
-		else if (in_line_comment)
-		{
-			if (PG_LINEFEED == tchar)
-				in_line_comment = FALSE;
-		}
-		else if (comment_level > 0)
+	/* identifier, keyword or number */
+	if (MBCS_NON_ASCII(*encstr) || isalnum(tchar))
+	{
+		tok->type = QTOKEN_WORD;
+		for (tchar = encoded_nextchar(encstr); tchar; tchar = encoded_nextchar(encstr))
 		{
-			if ('/' == tchar && '*' == ENCODE_PTR(encstr)[1])
-			{
-				tchar = encoded_nextchar(&encstr);
-				comment_level++;
-			}
-			else if ('*' == tchar && '/' == ENCODE_PTR(encstr)[1])
+			if (!MBCS_NON_ASCII(*encstr) &&
+			    !isalnum(tchar) &&
+			    DOLLAR_QUOTE != tchar &&
+			    '_' != tchar)
 			{
-				tchar = encoded_nextchar(&encstr);
-				comment_level--;
+				lx->reread = TRUE;
+				break;
 			}
 		}
-		else if (isalnum(tchar))
-			in_ident_keyword = TRUE;
-		else
-		{
-			if (tchar == '?')
+		tok->len = (Int4) encstr->pos - tok->pos;
+		return TRUE;
+	}
+
+	tok->type = QTOKEN_OTHER;
+	switch (tchar)
+	{
+		case '?':
+			tok->type = QTOKEN_PARAM;
+			break;
+		case ODBC_ESCAPE_START:
+			tok->type = QTOKEN_ESCAPE_START;
+			break;
+		case ODBC_ESCAPE_END:
+			tok->type = QTOKEN_ESCAPE_END;
+			break;
+		case ';':
+			tok->type = QTOKEN_DELIMITER;
+			break;
+		case DOLLAR_QUOTE:
+			tag = (const char *) ENCODE_PTR(*encstr);
+			if ((taglen = findTag(tag, encstr->ccsc)) == 0)
+				break;
+			tok->type = QTOKEN_DOLLAR_QUOTED;
+			encoded_position_shift(encstr, taglen - 1);
+			for (tchar = encoded_nextchar(encstr); tchar; tchar = encoded_nextchar(encstr))
 			{
-				if (0 == num_p && bchar == '{')
+				if (!MBCS_NON_ASCII(*encstr) &&
+				    DOLLAR_QUOTE == tchar &&
+				    strncmp((const char *) ENCODE_PTR(*encstr), tag, taglen) == 0)
 				{
-					if (proc_return)
-						*proc_return = 1;
+					encoded_position_shift(encstr, taglen - 1);
+					break;
 				}
-				num_p++;
 			}
-			else if (tchar == ';')
+			break;
+		case LITERAL_QUOTE:
+			tok->type = QTOKEN_LITERAL;
+			escape_in_literal = CC_get_escape(lx->conn);
+			if (!escape_in_literal &&
+			    tok->pos > 0 &&
+			    LITERAL_EXT == ENCODE_PTR(*encstr)[-1])
+				escape_in_literal = ESCAPE_IN_LITERAL;
+			in_escape = FALSE;
+			for (tchar = encoded_nextchar(encstr); tchar; tchar = encoded_nextchar(encstr))
 			{
-				del_found = TRUE;
-				if (next_cmd)
-					*next_cmd = encstr.pos;
+				if (MBCS_NON_ASCII(*encstr))
+					continue;
+				if (in_escape)
+					in_escape = FALSE;
+				else if (tchar == escape_in_literal)
+					in_escape = TRUE;
+				else if (LITERAL_QUOTE == tchar)
+					break;
 			}
-			else if (tchar == DOLLAR_QUOTE)
+			break;
+		case IDENTIFIER_QUOTE:
+			tok->type = QTOKEN_DQUOTED;
+			for (tchar = encoded_nextchar(encstr); tchar; tchar = encoded_nextchar(encstr))
 			{
-				const char *ptr = (const char *) ENCODE_PTR(encstr);
-				taglen = findTag(ptr, encstr.ccsc);
-				if (taglen > 0)
-				{
-					in_dollar_quote = TRUE;
-					tag = ptr;
-					encoded_position_shift(&encstr, taglen - 1);
-				}
+				if (!MBCS_NON_ASCII(*encstr) && IDENTIFIER_QUOTE == tchar)
+					break;
 			}
-			else if (tchar == LITERAL_QUOTE)
+			break;
+		case '-':
+			if ('-' != ENCODE_PTR(*encstr)[1])
+				break;
+			tok->type = QTOKEN_COMMENT;
+			encoded_nextchar(encstr);
+			for (tchar = encoded_nextchar(encstr); tchar; tchar = encoded_nextchar(encstr))
 			{
-				in_literal = TRUE;
-				escape_in_literal = CC_get_escape(conn);
-				if (!escape_in_literal)
-				{
-					if (LITERAL_EXT == ENCODE_PTR(encstr)[-1])
-						escape_in_literal = ESCAPE_IN_LITERAL;
-				}
+				if (!MBCS_NON_ASCII(*encstr) && PG_LINEFEED == tchar)
+					break;
 			}
-			else if (tchar == IDENTIFIER_QUOTE)
-				in_dquote_identifier = TRUE;
-			else if ('-' == tchar)
+			break;
+		case '/':
+			if ('*' != ENCODE_PTR(*encstr)[1])
+				break;
+			tok->type = QTOKEN_COMMENT;
+			encoded_nextchar(encstr);
+			comment_level = 1;
+			for (tchar = encoded_nextchar(encstr); tchar; tchar = encoded_nextchar(encstr))
 			{
-				if ('-' == ENCODE_PTR(encstr)[1])
+				if (MBCS_NON_ASCII(*encstr))
+					continue;
+				if ('/' == tchar && '*' == ENCODE_PTR(*encstr)[1])
 				{
-					tchar = encoded_nextchar(&encstr);
-					in_line_comment = TRUE;
+					tchar = encoded_nextchar(encstr);
+					comment_level++;
 				}
-			}
-			else if ('/' == tchar)
-			{
-				if ('*' == ENCODE_PTR(encstr)[1])
+				else if ('*' == tchar && '/' == ENCODE_PTR(*encstr)[1])
 				{
-					tchar = encoded_nextchar(&encstr);
-					comment_level++;
+					tchar = encoded_nextchar(encstr);
+					if (--comment_level <= 0)
+						break;
 				}
 			}
-			if (IS_NOT_SPACE(tchar))
-				bchar = tchar;
-		}
+			break;
 	}
-	if (pcpar)
-		*pcpar = num_p;
-	if (multi_st)
-		*multi_st = multi;
+	/* the token ends at the current char unless the query ended */
+	tok->len = (Int4) encstr->pos - tok->pos + (tchar ? 1 : 0);
 
-	MYLOG(0, "leaving...num_p=%d multi=%d\n", num_p, multi);
+	return TRUE;
 }
 
 /*
- * Describe the result set a statement will produce (for
- * SQLPrepare/SQLDescribeCol)
- *
- * returns # of fields if successful, -1 on error.
+ *	The state of a scan counting the parameters of a query.
  */
-Int4
-SC_describe(StatementClass *self)
+typedef struct
 {
-	Int4		num_fields = -1;
-	QResultClass	*res;
-	MYLOG(0, "entering status = %d\n", self->status);
+	SQLSMALLINT	num_p;
+	po_ind_t	multi;
+	po_ind_t	proc_return;
+	BOOL		del_found;
+	char		prev_type;
+	ssize_t		next_cmd;
+} QueryScan;
 
-	res = SC_get_ExecdOrParsed(self);
-	if (NULL != res)
+/*
+ * Returns FALSE if 'tok' begins the next command and stop_at_next_cmd is
+ * specified.
+ */
+static BOOL
+QS_add_token(QueryScan *qs, const QueryToken *tok, BOOL stop_at_next_cmd)
+{
+	if (qs->del_found && !qs->multi)
 	{
-		num_fields = QR_NumResultCols(res);
-		if (num_fields > 0 ||
-		    NULL != QR_get_command(res))
-			return num_fields;
+		qs->multi = TRUE;
+		if (stop_at_next_cmd)
+			return FALSE;
 	}
-	if (self->status == STMT_READY)
+	switch (tok->type)
 	{
-MYLOG(0, "              preprocess: status = READY\n");
+		case QTOKEN_PARAM:
+			if (0 == qs->num_p && QTOKEN_ESCAPE_START == qs->prev_type)
+				qs->proc_return = 1;
+			qs->num_p++;
+			break;
+		case QTOKEN_DELIMITER:
+			qs->del_found = TRUE;
+			if (stop_at_next_cmd)
+				qs->next_cmd = tok->pos;
+			break;
+	}
+	qs->prev_type = tok->type;
 
-		self->miscinfo = 0;
-		self->execinfo = 0;
+	return TRUE;
+}
 
-		decideHowToPrepare(self, FALSE);
-		switch (SC_get_prepare_method(self))
-		{
-			case NAMED_PARSE_REQUEST:
-			case PARSE_TO_EXEC_ONCE:
-				if (SQL_SUCCESS != prepareParameters(self, FALSE))
-					return num_fields;
-				break;
-			case PARSE_REQ_FOR_INFO:
-				if (SQL_SUCCESS != prepareParameters(self, FALSE))
-					return num_fields;
-				self->status = STMT_DESCRIBED;
-				break;
-			default:
-				if (SQL_SUCCESS != prepareParameters(self, TRUE))
-					return num_fields;
-				self->status = STMT_DESCRIBED;
-				break;
-		}
-		if (res = SC_get_ExecdOrParsed(self), NULL != res)
-		{
-			num_fields = QR_NumResultCols(res);
-			return num_fields;
-		}
+/*
+ *	Scan the query wholly or partially (if the next_cmd param specified).
+ *	Also count the number of parameters respectviely.
+ */
+void
+SC_scanQueryAndCountParams(const char *query, const ConnectionClass *conn,
+		ssize_t *next_cmd, SQLSMALLINT * pcpar,
+		po_ind_t *multi_st, po_ind_t *proc_return)
+{
+	QueryLexer	lx;
+	QueryToken	tok;
+	QueryScan	qs;
+
+	MYLOG(0, "entering...\n");
+	memset(&qs, 0, sizeof(qs));
+	qs.next_cmd = -1;
+	QL_initialize(&lx, query, conn);
+	while (QL_next_token(&lx, &tok))
+	{
+		if (!QS_add_token(&qs, &tok, NULL != next_cmd))
+			break;
 	}
-	return num_fields;
-}
+	if (next_cmd)
+		*next_cmd = qs.next_cmd;
+	if (pcpar)
+		*pcpar = qs.num_p;
+	if (multi_st)
+		*multi_st = qs.multi;
+	if (proc_return)
+		*proc_return = qs.proc_return;
 
+	MYLOG(0, "leaving...num_p=%d multi=%d\n", qs.num_p, qs.multi);
+}
 
-/* This is only called from SQLFreeStmt(SQL_UNBIND) */
-char
-SC_unbind_cols(StatementClass *self)
+/*
+ *	Lex stmt->statement into self->tokens unless done already. The tokens
+ *	are kept until the statement text changes, so the scans of the
+ *	re-executions don't lex the statement again.
+ */
+BOOL
+SC_lex_statement(StatementClass *self)
 {
-	ARDFields	*opts = SC_get_ARDF(self);
-	GetDataInfo	*gdata = SC_get_GDTI(self);
-	BindInfoClass	*bookmark;
+	QueryLexer	lx;
+	QueryToken	tok, *tokens = NULL, *newtokens;
+	Int4		num_tokens = 0, alloc_tokens = 0;
 
-	ARD_unbind_cols(opts, FALSE);
-	GDATA_unbind_cols(gdata, FALSE);
-	if (bookmark = opts->bookmark, bookmark != NULL)
+	if (NULL != self->tokens)
+		return TRUE;
+	if (NULL == self->statement)
+		return FALSE;
+	QL_initialize(&lx, self->statement, SC_get_conn(self));
+	while (QL_next_token(&lx, &tok))
 	{
-		bookmark->buffer = NULL;
-		bookmark->used = NULL;
+		if (num_tokens >= alloc_tokens)
+		{
+			alloc_tokens = alloc_tokens > 0 ? alloc_tokens * 2 : 32;
+			if (newtokens = (QueryToken *) realloc(tokens, sizeof(QueryToken) * alloc_tokens), NULL == newtokens)
+			{
+				free(tokens);
+				return FALSE;
+			}
+			tokens = newtokens;
+		}
+		tokens[num_tokens++] = tok;
 	}
+	/* an empty statement still needs a (dummy) array */
+	if (NULL == tokens &&
+	    NULL == (tokens = (QueryToken *) malloc(sizeof(QueryToken))))
+		return FALSE;
+	self->tokens = tokens;
+	self->num_tokens = num_tokens;
+	MYLOG(DETAIL_LOG_LEVEL, "%d tokens\n", num_tokens);
 
-	return 1;
+	return TRUE;
 }
 
+void
+SC_forget_tokens(StatementClass *self)
+{
+	if (self->tokens)
+		free(self->tokens);
+	self->tokens = NULL;
+	self->num_tokens = 0;
+}
 
+/*
+ *	Add the conversion time measured by copy_and_convert_field() to the
+ *	counters of the connection. The conversions run with only the
+ *	statement lock held, so they are counted in the statement first and
+ *	added here, when the statement is executed, closed or freed.
+ */
 void
-SC_clear_error(StatementClass *self)
+SC_fold_convert_time(StatementClass *self)
 {
-	QResultClass	*res;
+	ConnectionClass	*conn = SC_get_conn(self);
 
-	self->__error_number = 0;
-	if (self->__error_message)
-	{
+	if (0 == self->convert_usec_unfolded || NULL == conn)
+		return;
+	CONNLOCK_ACQUIRE(conn);
+	conn->perf.convert_usec += self->convert_usec_unfolded;
+	CONNLOCK_RELEASE(conn);
+	self->convert_usec_unfolded = 0;
+}
+
+void
+QT_free(QueryTemplate *tmpl)
+{
+	if (tmpl->text)
+		free(tmpl->text);
+	if (tmpl->slots)
+		free(tmpl->slots);
+	free(tmpl);
+}
+
+void
+SC_forget_query_template(StatementClass *self)
+{
+	if (NULL == self->query_template)
+		return;
+	QT_free(self->query_template);
+	self->query_template = NULL;
+}
+
+/*
+ *	Check if the query is a simple single-row INSERT, i.e.
+ *
+ *		INSERT INTO table [(columns)] VALUES (values) [;]
+ *
+ *	and return the position of the parenthesized values, so that the
+ *	values of other rows can be appended to the VALUES list.
+ */
+BOOL
+SC_find_insert_values(const char *query, const ConnectionClass *conn,
+		ssize_t *values_start, ssize_t *values_end)
+{
+	QueryLexer	lx;
+	QueryToken	tok;
+	int		nth = 0, level = 0;
+	BOOL		values_found = FALSE, del_found = FALSE;
+
+	*values_start = *values_end = -1;
+	QL_initialize(&lx, query, conn);
+	while (QL_next_token(&lx, &tok))
+	{
+		const char *tstr = query + tok.pos;
+
+		if (QTOKEN_COMMENT == tok.type)
+			continue;
+		nth++;
+		if (del_found)	/* multiple statements */
+			return FALSE;
+		if (QTOKEN_PARAM == tok.type && !values_found)
+			return FALSE;
+		if (QTOKEN_ESCAPE_START == tok.type ||
+		    QTOKEN_ESCAPE_END == tok.type)
+			return FALSE;
+		switch (nth)
+		{
+			case 1:
+				if (QTOKEN_WORD != tok.type ||
+				    6 != tok.len ||
+				    strnicmp(tstr, "insert", 6) != 0)
+					return FALSE;
+				continue;
+			case 2:
+				if (QTOKEN_WORD != tok.type ||
+				    4 != tok.len ||
+				    strnicmp(tstr, "into", 4) != 0)
+					return FALSE;
+				continue;
+		}
+		if (*values_end >= 0)
+		{
+			/* only the end of the statement may follow */
+			if (QTOKEN_DELIMITER != tok.type)
+				return FALSE;
+			del_found = TRUE;
+			continue;
+		}
+		if (QTOKEN_OTHER == tok.type && '(' == *tstr)
+		{
+			if (0 == level++ && values_found)
+				*values_start = tok.pos;
+		}
+		else if (QTOKEN_OTHER == tok.type && ')' == *tstr)
+		{
+			if (--level < 0)
+				return FALSE;
+			if (0 == level && *values_start >= 0)
+				*values_end = tok.pos + 1;
+		}
+		else if (values_found)
+		{
+			if (*values_start < 0)	/* e.g. DEFAULT VALUES */
+				return FALSE;
+		}
+		else if (0 == level &&
+			 QTOKEN_WORD == tok.type)
+		{
+			if (6 == tok.len &&
+			    strnicmp(tstr, "values", 6) == 0)
+				values_found = TRUE;
+			else if ((6 == tok.len &&
+				  strnicmp(tstr, "select", 6) == 0) ||
+				 (7 == tok.len &&
+				  strnicmp(tstr, "default", 7) == 0))
+				return FALSE;
+		}
+	}
+
+	return *values_end >= 0;
+}
+
+/*
+ *	Scan the tokens of stmt->statement like SC_scanQueryAndCountParams().
+ *	If token_idx is specified, only the command from the *token_idx'th
+ *	token is scanned, and *token_idx is set to the first token of the
+ *	next command.
+ *
+ *	Returns FALSE if out of memory.
+ */
+BOOL
+SC_scan_statement_tokens(StatementClass *self, Int4 *token_idx,
+		SQLSMALLINT *pcpar, po_ind_t *multi_st, po_ind_t *proc_return)
+{
+	QueryScan	qs;
+	Int4		i;
+
+	if (!SC_lex_statement(self))
+		return FALSE;
+	memset(&qs, 0, sizeof(qs));
+	qs.next_cmd = -1;
+	for (i = (token_idx ? *token_idx : 0); i < self->num_tokens; i++)
+	{
+		if (!QS_add_token(&qs, self->tokens + i, NULL != token_idx))
+			break;
+	}
+	if (token_idx)
+		*token_idx = i;
+	if (pcpar)
+		*pcpar = qs.num_p;
+	if (multi_st)
+		*multi_st = qs.multi;
+	if (proc_return)
+		*proc_return = qs.proc_return;
+
+	return TRUE;
+}
+
+/*
+ * Describe the result set a statement will produce (for
+ * SQLPrepare/SQLDescribeCol)
+ *
+ * returns # of fields if successful, -1 on error.
+ */
+Int4
+SC_describe(StatementClass *self)
+{
+	Int4		num_fields = -1;
+	QResultClass	*res;
+	MYLOG(0, "entering status = %d\n", self->status);
+
+	res = SC_get_ExecdOrParsed(self);
+	if (NULL != res)
+	{
+		num_fields = QR_NumResultCols(res);
+		if (num_fields > 0 ||
+		    NULL != QR_get_command(res))
+			return num_fields;
+	}
+	if (self->status == STMT_READY)
+	{
+MYLOG(0, "              preprocess: status = READY\n");
+
+		self->miscinfo = 0;
+		self->execinfo = 0;
+
+		decideHowToPrepare(self, FALSE);
+		switch (SC_get_prepare_method(self))
+		{
+			case NAMED_PARSE_REQUEST:
+			case PARSE_TO_EXEC_ONCE:
+				if (SQL_SUCCESS != prepareParameters(self, FALSE))
+					return num_fields;
+				break;
+			case PARSE_REQ_FOR_INFO:
+				if (SQL_SUCCESS != prepareParameters(self, FALSE))
+					return num_fields;
+				self->status = STMT_DESCRIBED;
+				break;
+			default:
+				if (SQL_SUCCESS != prepareParameters(self, TRUE))
+					return num_fields;
+				self->status = STMT_DESCRIBED;
+				break;
+		}
+		if (res = SC_get_ExecdOrParsed(self), NULL != res)
+		{
+			num_fields = QR_NumResultCols(res);
+			return num_fields;
+		}
+	}
+	return num_fields;
+}
+
+
+/* This is only called from SQLFreeStmt(SQL_UNBIND) */
+char
+SC_unbind_cols(StatementClass *self)
+{
+	ARDFields	*opts = SC_get_ARDF(self);
+	GetDataInfo	*gdata = SC_get_GDTI(self);
+	BindInfoClass	*bookmark;
+
+	ARD_unbind_cols(opts, FALSE);
+	GDATA_unbind_cols(gdata, FALSE);
+	if (bookmark = opts->bookmark, bookmark != NULL)
+	{
+		bookmark->buffer = NULL;
+		bookmark->used = NULL;
+	}
+
+	return 1;
+}
+
+
+void
+SC_clear_error(StatementClass *self)
+{
+	QResultClass	*res;
+
+	self->__error_number = 0;
+	if (self->__error_message)
+	{
 		free(self->__error_message);
 		self->__error_message = NULL;
 	}
@@ -1288,7 +1787,9 @@ static const struct
 	{ STMT_COUNT_FIELD_INCORRECT, "07002", "07002" },
 	{ STMT_INVALID_NULL_ARG, "HY009", "S1009" },
 	{ STMT_NO_RESPONSE, "08S01", "08S01" },
-	{ STMT_COMMUNICATION_ERROR, "08S01", "08S01" }
+	{ STMT_COMMUNICATION_ERROR, "08S01", "08S01" },
+	{ STMT_STRING_CONVERSION_ERROR, "HY000", "S1000" }, /* general error */
+	{ STMT_INVALID_BUFFER_LENGTH, "HY090", "S1090" }
 };
 
 static PG_ErrorInfo *
@@ -1675,8 +2176,7 @@ SC_fetch(StatementClass *self)
 	BindInfoClass	*bookmark;
 	BOOL		useCursor;
 	KeySet		*keyset = NULL;
-
-	/* TupleField *tupleField; */
+	TupleField	*tuple = NULL;
 
 MYLOG(DETAIL_LOG_LEVEL, "entering statement=%p res=%p ommitted=0\n", self, res);
 	self->last_fetch_count = self->last_fetch_count_include_ommitted = 0;
@@ -1781,6 +2281,19 @@ MYLOG(DETAIL_LOG_LEVEL, "stmt=%p ommitted++\n", self);
 	gdata = SC_get_GDTI(self);
 	if (gdata->allocated != opts->allocated)
 		extend_getdata_info(gdata, opts->allocated, TRUE);
+	if (!useCursor)
+	{
+		SQLLEN	curt = GIdx2CacheIdx(self->currTuple, self, res);
+
+MYLOG(DETAIL_LOG_LEVEL, "%p->base=" FORMAT_LEN " curr=" FORMAT_LEN " st=" FORMAT_LEN " valid=%d\n", res, QR_get_rowstart_in_cache(res), self->currTuple, SC_get_rowset_start(self), QR_has_valid_base(res));
+MYLOG(DETAIL_LOG_LEVEL, "curt=" FORMAT_LEN "\n", curt);
+		/* the row may have to be read back from the spill file */
+		if (NULL == (tuple = QR_get_tuple_row(res, curt)))
+		{
+			SC_set_error(self, STMT_NO_MEMORY_ERROR, QR_get_message(res), func);
+			return SQL_ERROR;
+		}
+	}
 	for (lf = 0; lf < num_cols; lf++)
 	{
 		MYLOG(0, "fetch: cols=%d, lf=%d, opts = %p, opts->bindings = %p, buffer[] = %p\n", num_cols, lf, opts, opts->bindings, opts->bindings[lf].buffer);
@@ -1803,12 +2316,7 @@ MYLOG(DETAIL_LOG_LEVEL, "stmt=%p ommitted++\n", self);
 			if (useCursor)
 				value = QR_get_value_backend(res, lf);
 			else
-			{
-				SQLLEN	curt = GIdx2CacheIdx(self->currTuple, self, res);
-MYLOG(DETAIL_LOG_LEVEL, "%p->base=" FORMAT_LEN " curr=" FORMAT_LEN " st=" FORMAT_LEN " valid=%d\n", res, QR_get_rowstart_in_cache(res), self->currTuple, SC_get_rowset_start(self), QR_has_valid_base(res));
-MYLOG(DETAIL_LOG_LEVEL, "curt=" FORMAT_LEN "\n", curt);
-				value = QR_get_value_backend_row(res, curt, lf);
-			}
+				value = tuple[lf].value;
 
 			MYLOG(0, "value = '%s'\n", (value == NULL) ? "<NULL>" : value);
 
@@ -1885,6 +2393,7 @@ SC_execute(StatementClass *self)
 	int		errnum_sav = STMT_OK, errnum;
 	char		*errmsg_sav = NULL;
 	SQLULEN		stmt_timeout;
+	BOOL		query_timer = FALSE;
 	QResultHold	rhold = {0};
 
 	conn = SC_get_conn(self);
@@ -1895,6 +2404,7 @@ SC_execute(StatementClass *self)
 	if (NULL != errmsg_sav)
 		errmsg_sav = strdup(errmsg_sav);
 	SC_set_error(self, STMT_OK, NULL, __FUNCTION__);
+	SC_fold_convert_time(self);
 
 	/* Begin a transaction if one is not already in progress */
 
@@ -1908,6 +2418,18 @@ SC_execute(StatementClass *self)
 	 */
 #define	return	DONT_CALL_RETURN_FROM_HERE???
 	ENTER_INNER_CONN_CS(conn, func_cs_count);
+	if (SC_is_async_executing(self))
+	{
+		/* poll the execution sent in SQL_ASYNC_ENABLE_ON mode */
+		oldstatus = self->async_exec->conn_status;
+		is_in_trans = self->async_exec->is_in_trans;
+		useCursor = self->async_exec->use_cursor;
+		query_timer = self->async_exec->query_timer;
+		issue_begin = FALSE;
+		use_extended_protocol = TRUE;
+		isSelectType = (SC_may_use_cursor(self) || self->statement_type == STMT_TYPE_PROCCALL);
+		goto resume_async;
+	}
 	oldstatus = conn->status;
 	if (CONN_EXECUTING == conn->status)
 	{
@@ -1923,6 +2445,9 @@ SC_execute(StatementClass *self)
 		if (NULL != curres &&
 		    curres->dataFilled)
 			useCursor = (NULL != QR_get_cursor(curres));
+		/* a portal doesn't need a transaction block */
+		if (SC_is_portalfetch(self))
+			useCursor = FALSE;
 	}
 	/* issue BEGIN ? */
 	issue_begin = TRUE;
@@ -1967,10 +2492,14 @@ SC_execute(StatementClass *self)
 	}
 
 	/*
-	 * If the session query timeout setting differs from the statement one,
-	 * change it.
+	 * Arm the timer of the query timeout. If there's no timer, use the
+	 * session query timeout setting instead and change it if it differs
+	 * from the statement one.
 	 */
 	stmt_timeout = conn->connInfo.ignore_timeout ? 0 : self->options.stmt_timeout;
+	if (stmt_timeout > 0 &&
+	    (query_timer = CC_start_query_timer(conn, stmt_timeout)))
+		stmt_timeout = 0;
 	if (conn->stmt_timeout_in_effect != stmt_timeout)
 	{
 		char query[64];
@@ -2012,9 +2541,12 @@ SC_execute(StatementClass *self)
 		if (issue_begin)
 			CC_begin(conn);
 
+resume_async:
 		first = libpq_bind_and_exec(self);
 		if (!first)
 		{
+			if (SC_is_async_executing(self))
+				goto cleanup;	/* SQL_STILL_EXECUTING */
 			if (SC_get_errornumber(self) <= 0)
 			{
 				SC_set_error(self, STMT_NO_RESPONSE, "Could not receive the response, communication down ??", func);
@@ -2126,6 +2658,17 @@ SC_execute(StatementClass *self)
 		conn->status = oldstatus;
 	self->status = STMT_FINISHED;
 MYLOG(0, "set %p STMT_FINISHED\n", self);
+	/*
+	 * The timer mustn't outlive the exclusive use of the connection.
+	 * If it has expired, the error of the cancelled query (57014) is
+	 * reported, the same as with statement_timeout.
+	 */
+	if (query_timer)
+	{
+		query_timer = FALSE;
+		if (CC_stop_query_timer(conn))
+			MYLOG(0, "the query timeout of %p expired\n", self);
+	}
 	LEAVE_INNER_CONN_CS(func_cs_count, conn);
 
 	/* Check the status of the result */
@@ -2366,6 +2909,20 @@ MYLOG(DETAIL_LOG_LEVEL, "!!SC_fetch return =%d\n", ret);
 	}
 cleanup:
 #undef	return
+	if (SC_is_async_executing(self))
+	{
+		/* the statement and the connection stay busy until it completes */
+		self->async_exec->conn_status = oldstatus;
+		self->async_exec->is_in_trans = is_in_trans;
+		self->async_exec->use_cursor = useCursor;
+		self->async_exec->query_timer = query_timer;
+		CLEANUP_FUNC_CONN_CS(func_cs_count, conn);
+		if (NULL != errmsg_sav)
+			free(errmsg_sav);
+		return SQL_STILL_EXECUTING;
+	}
+	if (query_timer)
+		CC_stop_query_timer(conn);
 	SC_SetExecuting(self, FALSE);
 	CLEANUP_FUNC_CONN_CS(func_cs_count, conn);
 	if (CONN_DOWN != conn->status)
@@ -2514,10 +3071,9 @@ SC_log_error(const char *func, const char *desc, const StatementClass *self)
  */
 
 static BOOL
-RequestStart(StatementClass *stmt, ConnectionClass *conn, const char *func)
+RequestStart(StatementClass *stmt, ConnectionClass *conn, const char *func, unsigned int svpopt)
 {
 	BOOL	ret = TRUE;
-	unsigned int	svpopt = 0;
 
 #ifdef	_HANDLE_ENLIST_IN_DTC_
 	if (conn->asdum)
@@ -2528,6 +3084,9 @@ RequestStart(StatementClass *stmt, ConnectionClass *conn, const char *func)
 		SC_set_error(stmt, STMT_COMMUNICATION_ERROR, "The connection has been lost", __FUNCTION__);
 		return SQL_ERROR;
 	}
+	/* a read-ahead FETCH or a portal of another cursor may be in progress */
+	CC_finish_readahead(conn);
+	CC_finish_portal(conn);
 	if (CC_started_rbpoint(conn))
 		return TRUE;
 	if (SC_is_readonly(stmt))
@@ -2576,6 +3135,43 @@ static void log_params(int nParams, const Oid *paramTypes, const UCHAR * const *
 	}
 }
 
+/* the bytes of the parameter values to be sent */
+static size_t param_bytes(int nParams, char **paramValues, const int *paramLengths, const int *paramFormats)
+{
+	int	i;
+	size_t	bytes = 0;
+
+	for (i = 0; i < nParams; i++)
+	{
+		if (!paramValues[i])
+			continue;
+		if (paramFormats && paramFormats[i])
+			bytes += paramLengths[i];
+		else
+			bytes += strlen(paramValues[i]);
+	}
+	return bytes;
+}
+
+/*
+ *	count a request other than executions, which was sent at send_time
+ *	(0 unless timed) and returned pgres
+ */
+static void perf_add_request(ConnectionClass *conn, StatementClass *stmt, size_t bytes_sent, Int8 send_time, const PGresult *pgres)
+{
+	Int8	elapsed = (0 != send_time) ? qtrace_clock() - send_time : 0;
+	int	results = (NULL != pgres) ? 1 : 0;
+
+	conn->perf.round_trips++;
+	conn->perf.results += results;
+	conn->perf.bytes_sent += bytes_sent;
+	conn->perf.roundtrip_usec += elapsed;
+	stmt->perf.round_trips++;
+	stmt->perf.results += results;
+	stmt->perf.bytes_sent += bytes_sent;
+	stmt->perf.roundtrip_usec += elapsed;
+}
+
 static
 QResultClass *add_libpq_notice_receiver(StatementClass *stmt, notice_receiver_arg *nrarg)
 {
@@ -2591,6 +3187,178 @@ QResultClass *add_libpq_notice_receiver(StatementClass *stmt, notice_receiver_ar
 	return newres;
 }
 
+/*
+ * Get the first result of the execution sent for PortalFetch, reading
+ * the rows one by one so that the rest can be left in the portal.
+ */
+static PGresult *
+get_portal_result(ConnectionClass *conn, int sent)
+{
+	if (!sent)
+		return NULL;
+	PQsetSingleRowMode(conn->pqconn);
+	return PQgetResult(conn->pqconn);
+}
+
+/*
+ * Read what has arrived for the execution sent in SQL_ASYNC_ENABLE_ON mode,
+ * without blocking unless the rest is to be waited for. Returns TRUE when
+ * the response is complete. Like PQexecParams(), an error result replaces
+ * the one received before it.
+ */
+static BOOL
+SC_async_poll(StatementClass *stmt)
+{
+	AsyncExec	*ae = stmt->async_exec;
+	PGconn		*pqconn = SC_get_conn(stmt)->pqconn;
+	PGresult	*pgres;
+	BOOL		wait = ae->wait, done = FALSE;
+
+	PQsetNoticeReceiver(pqconn, receive_libpq_notice, &ae->nrarg);
+	/* let PQgetResult() report a broken connection */
+	if (!wait && !PQconsumeInput(pqconn))
+		wait = TRUE;
+	while (wait || !PQisBusy(pqconn))
+	{
+		if (pgres = PQgetResult(pqconn), NULL == pgres)
+		{
+			done = TRUE;
+			break;
+		}
+		if (NULL == ae->pgres)
+			ae->pgres = pgres;
+		else if (PGRES_FATAL_ERROR == PQresultStatus(pgres))
+		{
+			PQclear(ae->pgres);
+			ae->pgres = pgres;
+		}
+		else
+			PQclear(pgres);
+	}
+	PQsetNoticeReceiver(pqconn, receive_libpq_notice, NULL);
+	MYLOG(DETAIL_LOG_LEVEL, "stmt=%p done=%d\n", stmt, done);
+
+	return done;
+}
+
+#ifdef	HAVE_PQENTERPIPELINEMODE
+/*
+ * Execute the statement in a pipeline after the internal savepoint which
+ * SetStatementSvp() has left to be sent with it (PREPEND_IN_PROGRESS),
+ * so that the savepoint costs no round trip of its own. If the savepoint
+ * fails, the server skips the execution and the error of the savepoint
+ * is returned instead. Executes plan_name, or query if it's NULL.
+ */
+static PGresult *
+exec_with_savepoint(StatementClass *stmt, const char *query, const char *plan_name, int nParams, const Oid *paramTypes, const char * const *paramValues, const int *paramLengths, const int *paramFormats, int resultFormat)
+{
+	CSTR		func = "exec_with_savepoint";
+	ConnectionClass	*conn = SC_get_conn(stmt);
+	PGconn		*pqconn = conn->pqconn;
+	PGresult	*pgres = NULL, *svpres = NULL, *r;
+	char		esavepoint[50], cmd[2][64];
+	int		i, ncmd = 0, nend = 0;
+	BOOL		sent, synced;
+
+	conn->internal_op = 0;
+	if (!PQenterPipelineMode(pqconn))
+	{
+		/* send the savepoint by itself */
+		if (SQL_ERROR == SetStatementSvp(stmt, SC_is_readonly(stmt) ? SVPOPT_RDONLY : 0))
+			return NULL;
+		if (plan_name)
+			return PQexecPrepared(pqconn, plan_name, nParams, paramValues, paramLengths, paramFormats, resultFormat);
+		return PQexecParams(pqconn, query, nParams, paramTypes, paramValues, paramLengths, paramFormats, resultFormat);
+	}
+	GetSvpName(conn, esavepoint, sizeof(esavepoint));
+#ifdef	_RELEASE_INTERNAL_SAVEPOINT
+	if (conn->internal_svp)
+		SPRINTF_FIXED(cmd[ncmd++], "RELEASE %s", esavepoint);
+#endif /* _RELEASE_INTERNAL_SAVEPOINT */
+	SPRINTF_FIXED(cmd[ncmd++], "SAVEPOINT %s", esavepoint);
+	sent = TRUE;
+	for (i = 0; i < ncmd && sent; i++)
+	{
+		QLOG(0, "PQsendQueryParams: %p '%s' (pipelined)\n", pqconn, cmd[i]);
+		conn->perf.bytes_sent += strlen(cmd[i]);
+		sent = PQsendQueryParams(pqconn, cmd[i], 0, NULL, NULL, NULL, NULL, 0);
+	}
+	if (sent)
+		sent = plan_name ?
+			PQsendQueryPrepared(pqconn, plan_name, nParams, paramValues, paramLengths, paramFormats, resultFormat) :
+			PQsendQueryParams(pqconn, query, nParams, paramTypes, paramValues, paramLengths, paramFormats, resultFormat);
+	if (!sent)
+		MYLOG(0, "could not send the pipeline:%s\n", PQerrorMessage(pqconn));
+	/*
+	 * Even if a send failed, the queries already queued have to be ended
+	 * by a sync and read before the pipeline mode can be left.
+	 */
+	synced = PQpipelineSync(pqconn);
+	/*
+	 * Read the results up to the sync. Each query's results end with a
+	 * NULL, and a query after an error is reported as PGRES_PIPELINE_ABORTED.
+	 */
+	while (synced && nend <= ncmd + 1)
+	{
+		if (r = PQgetResult(pqconn), NULL == r)
+		{
+			nend++;
+			continue;
+		}
+		if (PGRES_PIPELINE_SYNC == PQresultStatus(r))
+		{
+			PQclear(r);
+			break;
+		}
+		if (nend < ncmd)
+		{
+			if (PGRES_COMMAND_OK != PQresultStatus(r))
+			{
+				if (NULL == svpres)
+					svpres = r;
+				else
+					PQclear(r);
+				continue;
+			}
+			if (nend + 1 < ncmd)	/* RELEASE */
+				conn->internal_svp = 0;
+			else
+				CC_start_rbpoint(conn);
+			PQclear(r);
+		}
+		else if (NULL == pgres)
+			pgres = r;
+		else if (PGRES_FATAL_ERROR == PQresultStatus(r))
+		{
+			PQclear(pgres);
+			pgres = r;
+		}
+		else
+			PQclear(r);
+	}
+	if (!PQexitPipelineMode(pqconn))
+	{
+		/* results are left unread, the connection can't be used any more */
+		MYLOG(0, "PQexitPipelineMode failed:%s\n", PQerrorMessage(pqconn));
+		CC_on_abort(conn, CONN_DEAD);
+		SC_set_error(stmt, STMT_COMMUNICATION_ERROR, "could not leave the pipeline mode", func);
+		PQclear(svpres);
+		svpres = NULL;
+		PQclear(pgres);
+		pgres = NULL;
+	}
+	if (NULL != svpres)
+	{
+		SC_set_error(stmt, STMT_INTERNAL_ERROR, "internal SAVEPOINT failed", func);
+		PQclear(pgres);
+		pgres = svpres;
+	}
+	MYLOG(DETAIL_LOG_LEVEL, "stmt=%p sent=%d synced=%d status=%d\n", stmt, sent, synced, pgres ? PQresultStatus(pgres) : -1);
+
+	return pgres;
+}
+#endif /* HAVE_PQENTERPIPELINEMODE */
+
 static QResultClass *
 libpq_bind_and_exec(StatementClass *stmt)
 {
@@ -2609,8 +3377,44 @@ libpq_bind_and_exec(StatementClass *stmt)
 	char	   *cmdtag;
 	char	   *rowcount;
 	notice_receiver_arg	nrarg;
+	const char *qtrace_query = stmt->statement;
+	Int8		send_time = 0;
+	BOOL		executed = FALSE;
+	PerfCounters	perf_before;
+	BOOL		use_portal = SC_is_portalfetch(stmt);
+	AsyncExec	*ae;
+	int			sent = 0;
+	BOOL		try_async;
+	unsigned int	svpopt = 0;
+
+	/* polling the execution sent in SQL_ASYNC_ENABLE_ON mode ? */
+	if (NULL != (ae = stmt->async_exec))
+		goto poll_async;
 
-	if (!RequestStart(stmt, conn, func))
+	/*
+	 * Send the execution without waiting for the response in
+	 * SQL_ASYNC_ENABLE_ON mode, unless the statement is read through a
+	 * portal or executed for an array or data-at-execution parameters.
+	 */
+	try_async = (SQL_ASYNC_ENABLE_ON == stmt->options.async_enable &&
+		     stmt->external &&
+		     !use_portal &&
+		     SC_get_APDF(stmt)->paramset_size <= 1 &&
+		     stmt->data_at_exec < 0);
+#ifdef	HAVE_PQENTERPIPELINEMODE
+	/*
+	 * With PipelineSavepoint, a synchronous execution can carry the
+	 * internal savepoint with it unless a Parse request has to be sent
+	 * before it.
+	 */
+	if (conn->connInfo.pipeline_savepoint > 0 &&
+	    !try_async &&
+	    !use_portal &&
+	    PREPARING_PERMANENTLY != stmt->prepared &&
+	    0 == (conn->connInfo.extra_opts & BIT_IGNORE_ROUND_TRIP_TIME))
+		svpopt |= SVPOPT_REDUCE_ROUNDTRIP;
+#endif /* HAVE_PQENTERPIPELINEMODE */
+	if (!RequestStart(stmt, conn, func, svpopt))
 		return NULL;
 
 #ifdef	NOT_USED
@@ -2650,6 +3454,9 @@ libpq_bind_and_exec(StatementClass *stmt)
 		}
 	}
 
+	if (try_async)
+		ae = (AsyncExec *) calloc(1, sizeof(AsyncExec));
+
 	/* 2.5 Prepare and Describe if needed */
 	if (stmt->prepared == PREPARING_TEMPORARILY ||
 		(stmt->prepared == PREPARED_TEMPORARILY && conn->unnamed_prepared_stmt != stmt))
@@ -2667,7 +3474,44 @@ libpq_bind_and_exec(StatementClass *stmt)
 		log_params(nParams, paramTypes, (const UCHAR * const *) paramValues, paramLengths, paramFormats, resultFormat);
 		/* set notice receiver */
 		newres = add_libpq_notice_receiver(stmt, &nrarg);
-		pgres = PQexecParams(conn->pqconn,
+		qtrace_query = pstmt->query;
+		perf_before = conn->perf;
+		conn->perf.bytes_sent += strlen(pstmt->query) + param_bytes(nParams, paramValues, paramLengths, paramFormats);
+		send_time = CC_perf_clock(conn);
+		executed = TRUE;
+		if (use_portal)
+			pgres = get_portal_result(conn,
+							PQsendQueryParams(conn->pqconn,
+							 pstmt->query,
+							 nParams,
+							 paramTypes,
+							 (const char **) paramValues,
+							 paramLengths,
+							 paramFormats,
+							 resultFormat));
+		else if (ae)
+			sent = PQsendQueryParams(conn->pqconn,
+							 pstmt->query,
+							 nParams,
+							 paramTypes,
+							 (const char **) paramValues,
+							 paramLengths,
+							 paramFormats,
+							 resultFormat);
+#ifdef	HAVE_PQENTERPIPELINEMODE
+		else if (PREPEND_IN_PROGRESS == conn->internal_op)
+			pgres = exec_with_savepoint(stmt,
+							 pstmt->query,
+							 NULL,
+							 nParams,
+							 paramTypes,
+							 (const char **) paramValues,
+							 paramLengths,
+							 paramFormats,
+							 resultFormat);
+#endif /* HAVE_PQENTERPIPELINEMODE */
+		else
+			pgres = PQexecParams(conn->pqconn,
 							 pstmt->query,
 							 nParams,
 							 paramTypes,
@@ -2679,11 +3523,13 @@ libpq_bind_and_exec(StatementClass *stmt)
 	else
 	{
 		const char *plan_name;
+		BOOL		plan_hit = TRUE;
 
 		if (stmt->prepared == PREPARING_PERMANENTLY)
 		{
 			if (prepareParameters(stmt, FALSE) == SQL_ERROR)
 				goto cleanup;
+			plan_hit = FALSE;
 		}
 
 		/* prepareParameters() set plan name, so don't fetch this earlier */
@@ -2694,12 +3540,89 @@ libpq_bind_and_exec(StatementClass *stmt)
 		log_params(nParams, paramTypes, (const UCHAR * const *) paramValues, paramLengths, paramFormats, resultFormat);
 		/* set notice receiver */
 		newres = add_libpq_notice_receiver(stmt, &nrarg);
-		pgres = PQexecPrepared(conn->pqconn,
+		perf_before = conn->perf;
+		if (plan_hit)
+			conn->perf.plan_hits++;
+		conn->perf.bytes_sent += param_bytes(nParams, paramValues, paramLengths, paramFormats);
+		send_time = CC_perf_clock(conn);
+		executed = TRUE;
+		if (use_portal)
+			pgres = get_portal_result(conn,
+							PQsendQueryPrepared(conn->pqconn,
+							   plan_name,
+							   nParams,
+							   (const char **) paramValues, paramLengths, paramFormats,
+							   resultFormat));
+		else if (ae)
+			sent = PQsendQueryPrepared(conn->pqconn,
+							   plan_name,
+							   nParams,
+							   (const char **) paramValues, paramLengths, paramFormats,
+							   resultFormat);
+#ifdef	HAVE_PQENTERPIPELINEMODE
+		else if (PREPEND_IN_PROGRESS == conn->internal_op)
+			pgres = exec_with_savepoint(stmt,
+							   NULL,
+							   plan_name,
+							   nParams,
+							   paramTypes,
+							   (const char **) paramValues, paramLengths, paramFormats,
+							   resultFormat);
+#endif /* HAVE_PQENTERPIPELINEMODE */
+		else
+			pgres = PQexecPrepared(conn->pqconn,
 							   plan_name, 	/* portal name == plan name */
 							   nParams,
 							   (const char **) paramValues, paramLengths, paramFormats,
 							   resultFormat);
 	}
+	if (ae)
+	{
+		if (!sent)
+		{
+			/* PQresultStatus(NULL) reports the error of the connection */
+			free(ae);
+			ae = NULL;
+		}
+		else
+		{
+			ae->newres = newres;
+			ae->nrarg = nrarg;
+			ae->nParams = nParams;
+			ae->qtrace_query = qtrace_query;
+			ae->send_time = send_time;
+			ae->perf_before = perf_before;
+			stmt->async_exec = ae;
+poll_async:
+#ifdef	ASYNC_NOTIFICATION
+			SC_async_unwatch(stmt);
+#endif /* ASYNC_NOTIFICATION */
+			if (!SC_async_poll(stmt))
+			{
+				/* SQL_STILL_EXECUTING */
+				MYLOG(0, "stmt=%p is still executing\n", stmt);
+#ifdef	ASYNC_NOTIFICATION
+				if (NULL != stmt->async_callback)
+					SC_async_watch(stmt);
+#endif /* ASYNC_NOTIFICATION */
+				goto cleanup;
+			}
+			pgres = ae->pgres;
+			newres = ae->newres;
+			nrarg = ae->nrarg;
+			nParams = ae->nParams;
+			qtrace_query = ae->qtrace_query;
+			send_time = ae->send_time;
+			executed = TRUE;
+			perf_before = ae->perf_before;
+			stmt->async_exec = NULL;
+			free(ae);
+			ae = NULL;
+		}
+	}
+	conn->perf.round_trips++;
+	if (pgres)
+		conn->perf.results++;
 	/* reset notice receiver */
 	PQsetNoticeReceiver(conn->pqconn, receive_libpq_notice, NULL);
 	if (!(res = nrarg.res))
@@ -2710,6 +3633,9 @@ libpq_bind_and_exec(StatementClass *stmt)
 
 	/* 3. Receive results */
 MYLOG(DETAIL_LOG_LEVEL, "get_Result=%p %p\n", res, SC_get_Result(stmt));
+	/* read the first block, QR_next_tuple() reads the rest */
+	if (use_portal)
+		CC_start_portal(conn, res, conn->connInfo.drivers.fetch_max);
 	pgresstatus = PQresultStatus(pgres);
 	switch (pgresstatus)
 	{
@@ -2721,6 +3647,22 @@ MYLOG(DETAIL_LOG_LEVEL, "get_Result=%p %p\n", res, SC_get_Result(stmt));
 			QR_set_command(res, cmdtag);
 			if (QR_command_successful(res))
 				QR_set_rstatus(res, PORES_COMMAND_OK);
+			/*
+			 * As in the simple query path, DDL or ROLLBACK discards the
+			 * catalog snapshots and the cached descriptions, and so does
+			 * a SET search_path unless the server reports search_path.
+			 */
+			if (cmdtag_invalidates_catalog(cmdtag))
+			{
+				if (NULL != conn->cat_snapshot)
+					CC_clear_cat_snapshot(conn);
+				if (NULL != conn->desc_cache)
+					CC_clear_desc_cache(conn);
+			}
+			else if (NULL != conn->desc_cache &&
+				 strnicmp(cmdtag, "SET", 3) == 0 &&
+				 NULL == PQparameterStatus(conn->pqconn, "search_path"))
+				CC_clear_desc_cache(conn);
 
 			/* get rowcount */
 			rowcount = PQcmdTuples(pgres);
@@ -2742,9 +3684,16 @@ MYLOG(DETAIL_LOG_LEVEL, "get_Result=%p %p\n", res, SC_get_Result(stmt));
 		case PGRES_FATAL_ERROR:
 			handle_pgres_error(conn, pgres, "libpq_bind_and_exec", res, TRUE);
 			break;
+		case PGRES_SINGLE_TUPLE:
 		case PGRES_TUPLES_OK:
-			if (!QR_from_PGresult(res, stmt, conn, NULL, &pgres))
+			if (!QR_from_PGresult(res, stmt, conn, use_portal ? SC_cursor_name(stmt) : NULL, &pgres))
+			{
+				if (use_portal)
+					CC_discard_portal(conn);
 				goto cleanup;
+			}
+			if (use_portal)
+				QR_set_portal(res);
 			if (res->rstatus == PORES_TUPLES_OK && res->notice)
 				QR_set_rstatus(res, PORES_NONFATAL_ERROR);
 			break;
@@ -2760,11 +3709,27 @@ MYLOG(DETAIL_LOG_LEVEL, "get_Result=%p %p\n", res, SC_get_Result(stmt));
 			QLOG(0, "PQexecXxxx error: - (%d) - %s\n", pgresstatus, CC_get_errormsg(conn));
 			break;
 	}
+	if (use_portal)
+		CC_end_portal_block(conn, pgres);
+	else if (SC_AcceptedCancelRequest(stmt) &&
+		 !QR_command_maybe_successful(res))
+		SC_set_error(stmt, STMT_OPERATION_CANCELLED, "The execution was cancelled", func);
 
 	if (res != newres && NULL != newres)
 		QR_Destructor(newres);
 
 cleanup:
+	/* Parse and Describe requests have been counted separately */
+	if (executed && !SC_is_async_executing(stmt))
+	{
+		if (0 != send_time)
+			conn->perf.roundtrip_usec += qtrace_clock() - send_time;
+		/* failed executions are traced too */
+		QTRACE_EVENT(QTRACE_EXECUTE, NULL == res || !QR_command_maybe_successful(res), conn, send_time, qtrace_query, nParams, conn->perf.rows_fetched - perf_before.rows_fetched, conn->perf.bytes_received - perf_before.bytes_received);
+		perf_add_delta(&stmt->perf, &conn->perf, &perf_before);
+	}
+	if (NULL != ae && ae != stmt->async_exec)
+		free(ae);
 	if (pgres)
 		PQclear(pgres);
 	if (paramValues)
@@ -2788,28 +3753,21 @@ cleanup:
 }
 
 /*
- * Parse a query using libpq.
+ * Get the parameter types to send with the Parse request of a query.
  *
- * 'res' is only passed here for error reporting purposes. If an error is
- * encountered, it is set in 'res', and the function returns FALSE.
+ * Returns FALSE if out of memory. Otherwise *num_params_io is set to the
+ * number of the types, and *paramTypes_out to a malloc'd array of them or
+ * NULL.
  */
 static BOOL
-ParseWithLibpq(StatementClass *stmt, const char *plan_name,
-			   const char *query,
-			   Int2 num_params, const char *comment, QResultClass *res)
+GetParseParamTypes(StatementClass *stmt, Int2 *num_params_io, Oid **paramTypes_out)
 {
-	CSTR	func = "ParseWithLibpq";
 	ConnectionClass	*conn = SC_get_conn(stmt);
+	Int2		num_params = *num_params_io;
 	Int4		sta_pidx = -1, end_pidx = -1;
-	const char	*cstatus;
 	Oid		   *paramTypes = NULL;
-	BOOL		retval = FALSE;
-	PGresult   *pgres = NULL;
-
-	MYLOG(0, "entering plan_name=%s query=%s\n", plan_name, query);
-	if (!RequestStart(stmt, conn, func))
-		return FALSE;
 
+	*paramTypes_out = NULL;
 	if (stmt->discard_output_params)
 		num_params = 0;
 	else if (num_params != 0)
@@ -2859,10 +3817,7 @@ MYLOG(0, "sta_pidx=%d end_pidx=%d num_p=%d\n", sta_pidx, end_pidx, num_params);
 
 		paramTypes = malloc(sizeof(Oid) * num_params);
 		if (paramTypes == NULL)
-		{
-			SC_set_errornumber(stmt, STMT_NO_MEMORY_ERROR);
-			goto cleanup;
-		}
+			return FALSE;
 
 		MYLOG(0, "ipdopts->allocated: %d\n", ipdopts->allocated);
 		j = 0;
@@ -2883,13 +3838,50 @@ MYLOG(0, "sta_pidx=%d end_pidx=%d num_p=%d\n", sta_pidx, end_pidx, num_params);
 			}
 		}
 	}
+	*num_params_io = num_params;
+	*paramTypes_out = paramTypes;
+
+	return TRUE;
+}
+
+/*
+ * Parse a query using libpq.
+ *
+ * 'res' is only passed here for error reporting purposes. If an error is
+ * encountered, it is set in 'res', and the function returns FALSE.
+ */
+static BOOL
+ParseWithLibpq(StatementClass *stmt, const char *plan_name,
+			   const char *query,
+			   Int2 num_params, const char *comment, QResultClass *res)
+{
+	CSTR	func = "ParseWithLibpq";
+	ConnectionClass	*conn = SC_get_conn(stmt);
+	const char	*cstatus;
+	Oid		   *paramTypes = NULL;
+	BOOL		retval = FALSE;
+	PGresult   *pgres = NULL;
+	Int8		send_time;
+
+	MYLOG(0, "entering plan_name=%s query=%s\n", plan_name, query);
+	if (!RequestStart(stmt, conn, func, 0))
+		return FALSE;
+
+	if (!GetParseParamTypes(stmt, &num_params, &paramTypes))
+	{
+		SC_set_errornumber(stmt, STMT_NO_MEMORY_ERROR);
+		goto cleanup;
+	}
 
 	if (plan_name == NULL || plan_name[0] == '\0')
 		conn->unnamed_prepared_stmt = NULL;
 
 	/* Prepare */
 	QLOG(0, "PQprepare: %p '%s' plan=%s nParams=%d\n", conn->pqconn, query, plan_name, num_params);
+	send_time = CC_perf_clock(conn);
 	pgres = PQprepare(conn->pqconn, plan_name, query, num_params, paramTypes);
+	perf_add_request(conn, stmt, strlen(query), send_time, pgres);
+	QTRACE_EVENT(QTRACE_PREPARE, PQresultStatus(pgres) != PGRES_COMMAND_OK, conn, send_time, query, num_params, -1, 0);
 	if (PQresultStatus(pgres) != PGRES_COMMAND_OK)
 	{
 		handle_pgres_error(conn, pgres, "ParseWithlibpq", res, TRUE);
@@ -2927,6 +3919,12 @@ cleanup:
  *
  * NB: The caller must set stmt->current_exec_param before calling this
  * function!
+ *
+ * With the DescribeCache option, the description of an unnamed statement
+ * is taken from the connection's cache if the same query was described
+ * with the same parameter types and search_path. The statement is then
+ * left PREPARED_TEMPORARILY without an unnamed plan, so the execution
+ * parses it again as it does anyway for one-shot statements.
  */
 QResultClass *
 ParseAndDescribeWithLibpq(StatementClass *stmt, const char *plan_name,
@@ -2944,19 +3942,51 @@ ParseAndDescribeWithLibpq(StatementClass *stmt, const char *plan_name,
 	int			i;
 	Oid			oid;
 	SQLSMALLINT paramType;
+	Int8		send_time;
+	Int2		num_types = num_params;
+	Oid		   *types = NULL;
+	const DESC_CACHE *desc = NULL;
+	BOOL		fields_ok;
 
 	MYLOG(0, "entering plan_name=%s query=%s\n", plan_name, query_param);
-	if (!RequestStart(stmt, conn, func))
+	if (conn->connInfo.describe_cache > 0 &&
+	    (plan_name == NULL || plan_name[0] == '\0'))
+	{
+		if (!GetParseParamTypes(stmt, &num_types, &types))
+		{
+			SC_set_error(stmt, STMT_NO_MEMORY_ERROR, "Couldn't allocate memory for parameter types", func);
+			return NULL;
+		}
+		desc = CC_lookup_desc_cache(conn, query_param, num_types, types);
+	}
+	if (NULL == desc &&
+	    !RequestStart(stmt, conn, func, 0))
+	{
+		if (types)
+			free(types);
 		return NULL;
+	}
 
 	if (!res)
 		res = QR_Constructor();
 	if (!res)
 	{
 		SC_set_error(stmt, STMT_NO_MEMORY_ERROR, "Couldn't allocate memory for query", func);
+		if (types)
+			free(types);
 		return NULL;
 	}
 
+	if (NULL != desc)
+	{
+		QLOG(0, "\tdescription of '%s' found in the cache\n", query_param);
+		if (conn->unnamed_prepared_stmt == stmt)
+			conn->unnamed_prepared_stmt = NULL;
+		SC_set_prepared(stmt, PREPARED_TEMPORARILY);
+		num_p = desc->num_params;
+		goto describe_params;
+	}
+
 	/*
 	 * We need to do Prepare + Describe as two different round-trips to the
 	 * server, while before we switched to use libpq, we used to send a Parse
@@ -2968,7 +3998,10 @@ ParseAndDescribeWithLibpq(StatementClass *stmt, const char *plan_name,
 	/* Describe */
 	QLOG(0, "\tPQdescribePrepared: %p plan_name=%s\n", conn->pqconn, plan_name);
 
+	send_time = CC_perf_clock(conn);
 	pgres = PQdescribePrepared(conn->pqconn, plan_name);
+	perf_add_request(conn, stmt, 0, send_time, pgres);
+	QTRACE_EVENT(QTRACE_DESCRIBE, PQresultStatus(pgres) != PGRES_COMMAND_OK, conn, send_time, query_param, PQnparams(pgres), -1, 0);
 	switch (PQresultStatus(pgres))
 	{
 		case PGRES_COMMAND_OK:
@@ -2992,6 +4025,7 @@ ParseAndDescribeWithLibpq(StatementClass *stmt, const char *plan_name,
 
 	/* Extract parameter information from the result set */
 	num_p = PQnparams(pgres);
+describe_params:
 MYLOG(DETAIL_LOG_LEVEL, "num_params=%d info=%d\n", stmt->num_params, num_p);
 	if (get_qlog() > 0 || get_mylog() > 0)
 	{
@@ -2999,7 +4033,7 @@ MYLOG(DETAIL_LOG_LEVEL, "num_params=%d info=%d\n", stmt->num_params, num_p);
 
 		QLOG(0, "\tnParams=%d", num_p);
 		for (i = 0; i < num_p; i++)
-			QPRINTF(0, " %u", PQparamtype(pgres, i));
+			QPRINTF(0, " %u", desc ? desc->param_types[i] : PQparamtype(pgres, i));
 		QPRINTF(0, "\n");
 	}
 	num_discard_params = 0;
@@ -3025,7 +4059,7 @@ MYLOG(DETAIL_LOG_LEVEL, "num_params=%d info=%d\n", stmt->num_params, num_p);
 			MYLOG(0, "%dth parameter's position(%d) is out of bound[%d]\n", i, pidx, stmt->num_params);
 			break;
 		}
-		oid = PQparamtype(pgres, i);
+		oid = desc ? desc->param_types[i] : PQparamtype(pgres, i);
 		paramType = ipdopts->parameters[pidx].paramType;
 		if (SQL_PARAM_OUTPUT != paramType ||
 			PG_TYPE_VOID != oid)
@@ -3035,7 +4069,13 @@ MYLOG(DETAIL_LOG_LEVEL, "num_params=%d info=%d\n", stmt->num_params, num_p);
 	/* Extract Portal information */
 	QR_set_conn(res, conn);
 
-	if (CI_read_fields_from_pgres(QR_get_fields(res), pgres))
+	if (NULL != desc)
+		fields_ok = CI_copy_fields(QR_get_fields(res), desc->fields);
+	else if (fields_ok = CI_read_fields_from_pgres(QR_get_fields(res), pgres), fields_ok &&
+		 conn->connInfo.describe_cache > 0 &&
+		 (plan_name == NULL || plan_name[0] == '\0'))
+		CC_add_desc_cache(conn, query_param, num_types, types, pgres, QR_get_fields(res));
+	if (fields_ok)
 	{
 		Int2	dummy1, dummy2;
 		int	cidx;
@@ -3083,6 +4123,8 @@ MYLOG(DETAIL_LOG_LEVEL, "num_params=%d info=%d\n", stmt->num_params, num_p);
 cleanup:
 	if (pgres)
 		PQclear(pgres);
+	if (types)
+		free(types);
 
 	return res;
 }
@@ -3164,6 +4206,403 @@ BOOL	SC_AcceptedCancelRequest(const StatementClass *self)
 	return shouldCancel;
 }
 
+/*
+ * SQLCancel() for a statement which returned SQL_STILL_EXECUTING. The
+ * cancel is reported when the application polls the execution next time.
+ */
+BOOL
+SC_async_cancel(StatementClass *self)
+{
+	ENTER_COMMON_CS;
+	self->cancel_info |= CancelRequestSet;
+	LEAVE_COMMON_CS;
+	return CC_send_cancel_request(SC_get_conn(self));
+}
+
+/*
+ * Cancel the execution which returned SQL_STILL_EXECUTING and wait for it
+ * to end, so that the statement can be closed or freed.
+ */
+void
+SC_async_discard(StatementClass *self)
+{
+	if (!SC_is_async_executing(self))
+		return;
+	MYLOG(0, "discarding the execution of %p\n", self);
+	SC_async_cancel(self);
+	self->async_exec->wait = TRUE;
+	SC_execute(self);
+}
+
+#ifdef	ASYNC_NOTIFICATION
+/*
+ *	Notification of the asynchronous completion.
+ *
+ *	When the driver manager has set SQL_ATTR_ASYNC_STMT_NOTIFICATION_CALLBACK,
+ *	a statement which returns SQL_STILL_EXECUTING registers the socket of
+ *	its connection with the completion thread. The thread waits for all
+ *	the registered sockets at once (with epoll where available), and when
+ *	one becomes readable it unregisters it and calls the callback, upon
+ *	which the driver manager signals the event of the application. The
+ *	application then calls the function again, which reads the response in
+ *	its own thread and registers the socket again if the response is still
+ *	incomplete. The thread never touches libpq, so it needs no lock of the
+ *	connection, and the callback is called without holding anotify_cs.
+ *
+ *	A registration is identified by its slot and the generation of the
+ *	slot, so that an event which the thread received for a registration
+ *	cancelled in the meantime is ignored.
+ *
+ *	FinalizeAsyncNotification() stops the thread, writing to the wakeup
+ *	pipe, and waits for it when the driver is unloaded.
+ */
+typedef struct
+{
+	StatementClass	*stmt;		/* NULL if the slot is free */
+	UInt4		gen;
+	int		sock;
+	UInt4		next_free;
+	PG_ASYNC_NOTIFICATION_CALLBACK	callback;
+	SQLPOINTER	context;
+} ASYNC_WATCH;
+
+#define	ANOTIFY_KEY(slot, gen)	(((SQLUBIGINT) (gen) << 32) | (UInt4) (slot))
+#define	ANOTIFY_SLOT(key)	((UInt4) ((key) & 0xffffffff))
+#define	ANOTIFY_GEN(key)	((UInt4) ((key) >> 32))
+#define	ANOTIFY_NONE	((UInt4) -1)
+#define	ANOTIFY_EVENTS	64
+#define	ANOTIFY_WAKEUP	((SQLUBIGINT) 0)	/* the key of the wakeup pipe */
+
+static pthread_mutex_t	anotify_cs = PTHREAD_MUTEX_INITIALIZER;
+static BOOL	anotify_started = FALSE;
+static BOOL	anotify_stopping = FALSE;
+static pthread_t	anotify_thread;
+static ASYNC_WATCH	*anotify_watches = NULL;
+static UInt4	anotify_alloc = 0, anotify_free = ANOTIFY_NONE;
+#ifdef	HAVE_SYS_EPOLL_H
+static int	anotify_epfd = -1;
+#endif /* HAVE_SYS_EPOLL_H */
+static int	anotify_pipe[2] = {-1, -1};	/* wakes up the thread */
+
+/*
+ *	Wait until some of the registered sockets become readable and
+ *	return their keys.
+ */
+static int
+anotify_wait(SQLUBIGINT *keys)
+{
+#ifdef	HAVE_SYS_EPOLL_H
+	struct epoll_event	events[ANOTIFY_EVENTS];
+	int	i, nevents;
+
+	if (nevents = epoll_wait(anotify_epfd, events, ANOTIFY_EVENTS, -1), nevents < 0)
+		return 0;
+	for (i = 0; i < nevents; i++)
+		keys[i] = events[i].data.u64;
+	return nevents;
+#else
+	static struct pollfd	*fds = NULL;
+	static SQLUBIGINT	*fdkeys = NULL;
+	static UInt4	fds_alloc = 0;
+	UInt4	i, nfds = 1;
+	int	nkeys = 0;
+
+	pthread_mutex_lock(&anotify_cs);
+	if (fds_alloc < anotify_alloc + 1 || 0 == fds_alloc)
+	{
+		struct pollfd	*newfds = realloc(fds, sizeof(struct pollfd) * (anotify_alloc + 1));
+		SQLUBIGINT	*newkeys = newfds ? realloc(fdkeys, sizeof(SQLUBIGINT) * (anotify_alloc + 1)) : NULL;
+
+		if (newfds)
+			fds = newfds;
+		if (newkeys)
+		{
+			fdkeys = newkeys;
+			fds_alloc = anotify_alloc + 1;
+		}
+		else if (0 == fds_alloc)
+		{
+			pthread_mutex_unlock(&anotify_cs);
+			return 0;
+		}
+	}
+	fds[0].fd = anotify_pipe[0];
+	fds[0].events = POLLIN;
+	fdkeys[0] = ANOTIFY_WAKEUP;
+	for (i = 0; i < anotify_alloc && nfds < fds_alloc; i++)
+	{
+		if (NULL == anotify_watches[i].stmt)
+			continue;
+		fds[nfds].fd = anotify_watches[i].sock;
+		fds[nfds].events = POLLIN;
+		fdkeys[nfds++] = ANOTIFY_KEY(i, anotify_watches[i].gen);
+	}
+	pthread_mutex_unlock(&anotify_cs);
+	if (poll(fds, nfds, -1) <= 0)
+		return 0;
+	for (i = 0; i < nfds && nkeys < ANOTIFY_EVENTS; i++)
+	{
+		if (0 != fds[i].revents)
+			keys[nkeys++] = fdkeys[i];
+	}
+	return nkeys;
+#endif /* HAVE_SYS_EPOLL_H */
+}
+
+/*
+ *	Unregister the slot. anotify_cs must be held.
+ */
+static void
+anotify_release(UInt4 slot)
+{
+	ASYNC_WATCH	*aw = anotify_watches + slot;
+
+#ifdef	HAVE_SYS_EPOLL_H
+	epoll_ctl(anotify_epfd, EPOLL_CTL_DEL, aw->sock, NULL);
+#endif /* HAVE_SYS_EPOLL_H */
+	aw->stmt = NULL;
+	aw->gen++;
+	aw->next_free = anotify_free;
+	anotify_free = slot;
+}
+
+static void *
+anotify_main(void *arg)
+{
+	SQLUBIGINT	keys[ANOTIFY_EVENTS];
+	PG_ASYNC_NOTIFICATION_CALLBACK	callbacks[ANOTIFY_EVENTS];
+	SQLPOINTER	contexts[ANOTIFY_EVENTS];
+	int	i, nkeys, ncalls;
+	char	buf[64];
+
+	for (;;)
+	{
+		nkeys = anotify_wait(keys);
+		ncalls = 0;
+		pthread_mutex_lock(&anotify_cs);
+		if (anotify_stopping)
+			break;
+		for (i = 0; i < nkeys; i++)
+		{
+			UInt4	slot = ANOTIFY_SLOT(keys[i]);
+			ASYNC_WATCH	*aw = anotify_watches + slot;
+
+			if (ANOTIFY_WAKEUP == keys[i])
+			{
+				while (read(anotify_pipe[0], buf, sizeof(buf)) == sizeof(buf))
+					;
+				continue;
+			}
+			if (slot >= anotify_alloc ||
+			    NULL == aw->stmt ||
+			    aw->gen != ANOTIFY_GEN(keys[i]))
+				continue;	/* unregistered in the meantime */
+			callbacks[ncalls] = aw->callback;
+			contexts[ncalls++] = aw->context;
+			anotify_release(slot);
+		}
+		pthread_mutex_unlock(&anotify_cs);
+		for (i = 0; i < ncalls; i++)
+			(*callbacks[i])(contexts[i], FALSE);
+	}
+	pthread_mutex_unlock(&anotify_cs);
+
+	return NULL;
+}
+
+/*
+ *	Close the descriptors of the thread. anotify_cs must be held, or the
+ *	thread must not exist.
+ */
+static void
+anotify_close(void)
+{
+#ifdef	HAVE_SYS_EPOLL_H
+	if (anotify_epfd >= 0)
+		close(anotify_epfd);
+	anotify_epfd = -1;
+#endif /* HAVE_SYS_EPOLL_H */
+	if (anotify_pipe[0] >= 0)
+	{
+		close(anotify_pipe[0]);
+		close(anotify_pipe[1]);
+	}
+	anotify_pipe[0] = anotify_pipe[1] = -1;
+}
+
+static void
+anotify_atfork_child(void)
+{
+	/*
+	 * The thread doesn't exist in the child, and the epoll instance is
+	 * shared with the parent.
+	 */
+	pthread_mutex_init(&anotify_cs, NULL);
+	anotify_close();
+	anotify_started = FALSE;
+}
+
+/*
+ *	Start the thread. anotify_cs must be held.
+ */
+static BOOL
+anotify_start(void)
+{
+	static BOOL	atfork_set = FALSE;
+
+	if (anotify_stopping)
+		return FALSE;
+	if (anotify_pipe[0] < 0)
+	{
+		if (pipe(anotify_pipe) < 0)
+			return FALSE;
+		fcntl(anotify_pipe[0], F_SETFD, FD_CLOEXEC);
+		fcntl(anotify_pipe[1], F_SETFD, FD_CLOEXEC);
+		fcntl(anotify_pipe[0], F_SETFL, O_NONBLOCK);
+		fcntl(anotify_pipe[1], F_SETFL, O_NONBLOCK);
+	}
+#ifdef	HAVE_SYS_EPOLL_H
+	if (anotify_epfd < 0)
+	{
+		struct epoll_event	ev;
+
+		if ((anotify_epfd = epoll_create1(EPOLL_CLOEXEC)) < 0)
+			return FALSE;
+		ev.events = EPOLLIN;
+		ev.data.u64 = ANOTIFY_WAKEUP;
+		if (epoll_ctl(anotify_epfd, EPOLL_CTL_ADD, anotify_pipe[0], &ev) < 0)
+		{
+			anotify_close();
+			return FALSE;
+		}
+	}
+#endif /* HAVE_SYS_EPOLL_H */
+	if (!atfork_set)
+	{
+		pthread_atfork(NULL, NULL, anotify_atfork_child);
+		atfork_set = TRUE;
+	}
+	if (0 != pthread_create(&anotify_thread, NULL, anotify_main, NULL))
+		return FALSE;
+	anotify_started = TRUE;
+
+	return TRUE;
+}
+
+/*
+ *	Stop the thread and wait for it. Called when the driver is unloaded.
+ */
+void
+FinalizeAsyncNotification(void)
+{
+	BOOL	started;
+
+	pthread_mutex_lock(&anotify_cs);
+	started = anotify_started;
+	anotify_stopping = TRUE;
+	if (started &&
+	    write(anotify_pipe[1], "", 1) < 0)
+		;	/* the pipe is full, so the thread will wake up anyway */
+	pthread_mutex_unlock(&anotify_cs);
+	if (started)
+		pthread_join(anotify_thread, NULL);
+	anotify_started = FALSE;
+	anotify_close();
+	free(anotify_watches);
+	anotify_watches = NULL;
+	anotify_alloc = 0;
+	anotify_free = ANOTIFY_NONE;
+}
+
+/*
+ *	Register the socket of the statement which returns
+ *	SQL_STILL_EXECUTING. If it can't be, call the callback at once so
+ *	that the application polls the execution.
+ */
+static void
+SC_async_watch(StatementClass *stmt)
+{
+	AsyncExec	*ae = stmt->async_exec;
+	int		sock = PQsocket(SC_get_conn(stmt)->pqconn);
+	UInt4	slot;
+	ASYNC_WATCH	*aw;
+	BOOL	registered = FALSE;
+
+	pthread_mutex_lock(&anotify_cs);
+	if (sock < 0 ||
+	    (!anotify_started && !anotify_start()))
+		goto cleanup;
+	if (ANOTIFY_NONE == anotify_free)
+	{
+		UInt4	new_alloc = anotify_alloc > 0 ? anotify_alloc * 2 : 32, i;
+		ASYNC_WATCH	*watches = realloc(anotify_watches, sizeof(ASYNC_WATCH) * new_alloc);
+
+		if (NULL == watches)
+			goto cleanup;
+		for (i = new_alloc; i > anotify_alloc; i--)
+		{
+			watches[i - 1].stmt = NULL;
+			watches[i - 1].gen = 1;
+			watches[i - 1].next_free = anotify_free;
+			anotify_free = i - 1;
+		}
+		anotify_watches = watches;
+		anotify_alloc = new_alloc;
+	}
+	slot = anotify_free;
+	aw = anotify_watches + slot;
+	aw->sock = sock;
+	aw->callback = stmt->async_callback;
+	aw->context = stmt->async_context;
+#ifdef	HAVE_SYS_EPOLL_H
+	{
+		struct epoll_event	ev;
+
+		ev.events = EPOLLIN | EPOLLONESHOT;
+		ev.data.u64 = ANOTIFY_KEY(slot, aw->gen);
+		if (epoll_ctl(anotify_epfd, EPOLL_CTL_ADD, sock, &ev) < 0 &&
+		    (EEXIST != errno ||
+		     epoll_ctl(anotify_epfd, EPOLL_CTL_MOD, sock, &ev) < 0))
+			goto cleanup;
+	}
+#else
+	if (write(anotify_pipe[1], "", 1) < 0)
+		;	/* the pipe is full, so the thread will wake up anyway */
+#endif /* HAVE_SYS_EPOLL_H */
+	anotify_free = aw->next_free;
+	aw->stmt = stmt;
+	ae->watch_key = ANOTIFY_KEY(slot, aw->gen);
+	registered = TRUE;
+	MYLOG(DETAIL_LOG_LEVEL, "stmt=%p sock=%d slot=%u\n", stmt, sock, slot);
+cleanup:
+	pthread_mutex_unlock(&anotify_cs);
+	if (!registered)
+		(*stmt->async_callback)(stmt->async_context, FALSE);
+}
+
+/*
+ *	Cancel the registration of the statement if the thread hasn't
+ *	notified it yet.
+ */
+static void
+SC_async_unwatch(StatementClass *stmt)
+{
+	AsyncExec	*ae = stmt->async_exec;
+	UInt4	slot;
+
+	if (0 == ae->watch_key)
+		return;
+	pthread_mutex_lock(&anotify_cs);
+	slot = ANOTIFY_SLOT(ae->watch_key);
+	if (slot < anotify_alloc &&
+	    stmt == anotify_watches[slot].stmt &&
+	    ANOTIFY_GEN(ae->watch_key) == anotify_watches[slot].gen)
+		anotify_release(slot);
+	ae->watch_key = 0;
+	pthread_mutex_unlock(&anotify_cs);
+}
+#endif /* ASYNC_NOTIFICATION */
+
 static void
 SC_set_error_if_not_set(StatementClass *self, int errornumber, const char *errmsg, const char *func)
 {
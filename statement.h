@@ -98,6 +98,7 @@ enum {
 	,STMT_NO_RESPONSE
 	,STMT_COMMUNICATION_ERROR
 	,STMT_STRING_CONVERSION_ERROR
+	,STMT_INVALID_BUFFER_LENGTH
 };
 
 /* statement types */
@@ -200,6 +201,61 @@ struct ProcessedStmt
 };
 typedef struct ProcessedStmt ProcessedStmt;
 
+/*
+ * QueryToken is a token of the original SQL query found by the lexer in
+ * statement.c. The tokens of stmt->statement are lexed once and kept
+ * until the statement text changes, see SC_lex_statement().
+ *
+ * Only the parameter counting and the splitting into commands work on the
+ * tokens wholly. The converter and the parser still scan the characters
+ * themselves and use the tokens just to skip over comments and dollar
+ * quoted strings.
+ */
+enum {
+	QTOKEN_WORD = 1		/* identifier, keyword or number */
+	,QTOKEN_LITERAL		/* '...' */
+	,QTOKEN_DQUOTED		/* "..." */
+	,QTOKEN_DOLLAR_QUOTED	/* $tag$...$tag$ */
+	,QTOKEN_COMMENT		/* -- or slash-asterisk comment */
+	,QTOKEN_PARAM		/* ? */
+	,QTOKEN_ESCAPE_START	/* { */
+	,QTOKEN_ESCAPE_END	/* } */
+	,QTOKEN_DELIMITER	/* ; */
+	,QTOKEN_OTHER		/* any other character */
+};
+typedef struct
+{
+	Int4	pos;	/* byte offset in the query */
+	Int4	len;
+	char	type;
+} QueryToken;
+
+/*
+ * QueryTemplate is the statement converted by copy_statement_with_parameters()
+ * with the parameter values cut out. The re-executions only format the
+ * parameters and put them between the pieces of the text.
+ */
+typedef struct
+{
+	size_t	pos;	/* where the parameter goes in the text */
+	size_t	opos;	/* the marker in the original statement */
+	size_t	len;	/* the length of the value last formatted */
+} QueryTemplateSlot;
+struct QueryTemplate
+{
+	char	   *text;
+	size_t		textlen;
+	QueryTemplateSlot	*slots;
+	Int2		num_slots;
+	Int2		alloc_slots;
+	BOOL		valid;		/* FALSE while building if the text depends
+							 * on the values */
+	UInt4		qb_flags;	/* the state it was built in */
+	UInt4		qp_flags;
+	Int2		statement_type;
+};
+typedef struct QueryTemplate QueryTemplate;
+
 /********	Statement Handle	***********/
 struct StatementClass_
 {
@@ -251,6 +307,13 @@ struct StatementClass_
 	 */
 	ProcessedStmt *processed_statements;
 
+	/* the tokens of the statement, or NULL if not lexed yet */
+	QueryToken	*tokens;
+	Int4		num_tokens;
+
+	/* see QueryTemplate, or NULL if not built (yet) */
+	QueryTemplate	*query_template;
+
 	TABLE_INFO	**ti;
 	Int2		ntab;
 	Int2		num_key_fields;
@@ -276,6 +339,8 @@ struct StatementClass_
 	po_ind_t	cancel_info;	/* cancel information */
 	po_ind_t	ref_CC_error;	/* refer to CC_error ? */
 	po_ind_t	lock_CC_for_rb;	/* lock CC for statement rollback ? */
+	po_ind_t	relock_CC_for_rb;	/* lock_CC_for_rb released while SQL_STILL_EXECUTING ? */
+	po_ind_t	accessed_db_on_read;	/* a function reading the result accessed the server ? */
 	po_ind_t	join_info;	/* have joins ? */
 	po_ind_t	parse_method;	/* parse_statement is forced or ? */
 	po_ind_t	has_notice; /* exec result contains notice messages ? */
@@ -305,12 +370,22 @@ struct StatementClass_
 	EXEC_TYPE	exec_type;
 	int		count_of_deffered;
 	PQExpBufferData	stmt_deffered;
+	BOOL		multirow_insert;	/* the rows are deferred into one INSERT */
 	/* SQL_NEED_DATA Callback list */
 	StatementClass	*execute_delegate;
 	StatementClass	*execute_parent;
 	UInt2		allocated_callbacks;
 	UInt2		num_callbacks;
 	NeedDataCallback	*callbacks;
+	PerfCounters	perf;
+	Int8		convert_usec_unfolded;	/* not added to conn->perf yet */
+	/* the execution in progress in SQL_ASYNC_ENABLE_ON mode */
+	struct AsyncExec_	*async_exec;
+	/* set by the driver manager for SQL_ATTR_ASYNC_STMT_EVENT */
+	PG_ASYNC_NOTIFICATION_CALLBACK	async_callback;
+	SQLPOINTER	async_context;
+	SQLPOINTER	async_event;
+	StatementClass	*next_pooled;	/* in the statement pool of the connection */
 #if defined(WIN_MULTITHREAD_SUPPORT)
 	CRITICAL_SECTION	cs;
 #elif defined(POSIX_THREADMUTEX_SUPPORT)
@@ -442,7 +517,20 @@ enum
 #define SC_set_fetchcursor(a)	((a)->miscinfo |= (1L << 1))
 #define SC_no_fetchcursor(a)	((a)->miscinfo &= ~(1L << 1))
 #define SC_is_fetchcursor(a)	(((a)->miscinfo & (1L << 1)) != 0)
+#define SC_set_portalfetch(a)	((a)->miscinfo |= (1L << 2))
+#define SC_is_portalfetch(a)	(((a)->miscinfo & (1L << 2)) != 0)
 #define SC_miscinfo_clear(a)	((a)->miscinfo = 0)
+#define SC_is_async_executing(a)	(NULL != (a)->async_exec)
+/*
+ * The completion thread which tells the driver manager when to call
+ * again the function which returned SQL_STILL_EXECUTING.
+ */
+#ifdef	POSIX_MULTITHREAD_SUPPORT
+#define	ASYNC_NOTIFICATION
+#endif /* POSIX_MULTITHREAD_SUPPORT */
+#ifdef	ASYNC_NOTIFICATION
+void	FinalizeAsyncNotification(void);
+#endif /* ASYNC_NOTIFICATION */
 #define SC_set_with_hold(a)	((a)->execinfo |= 1L)
 #define SC_set_without_hold(a)	((a)->execinfo &= (~1L))
 #define SC_is_with_hold(a)	(((a)->execinfo & 1L) != 0)
@@ -473,6 +561,21 @@ enum
 #define SC_may_use_cursor(a) \
 	(SC_get_APDF(a)->paramset_size <= 1 &&	\
 	 (STMT_TYPE_SELECT == (a)->statement_type || STMT_TYPE_WITH == (a)->statement_type) )
+/*
+ * With PortalFetch, forward-only read-only cursors are read from the
+ * portal of the extended query protocol instead, outside a transaction
+ * block and until a portal had to be read through for another request.
+ */
+#define SC_may_use_portal(a) \
+	(SC_may_use_cursor(a) && (a)->external &&	\
+	 0 == (a)->multi_statement && !SC_is_with_hold(a) &&	\
+	 SQL_CURSOR_FORWARD_ONLY == (a)->options.cursor_type &&	\
+	 SQL_CONCUR_READ_ONLY == (a)->options.scroll_concurrency &&	\
+	 SC_get_conn(a)->connInfo.drivers.use_declarefetch &&	\
+	 SC_get_conn(a)->connInfo.portal_fetch &&	\
+	 !SC_get_conn(a)->portal_interrupted &&	\
+	 CC_does_autocommit(SC_get_conn(a)) &&	\
+	 !CC_is_in_trans(SC_get_conn(a)))
 #define SC_may_fetch_rows(a) (STMT_TYPE_SELECT == (a)->statement_type || STMT_TYPE_WITH == (a)->statement_type)
 
 
@@ -501,6 +604,7 @@ StatementClass *SC_Constructor(ConnectionClass *);
 void		InitializeStatementOptions(StatementOptions *opt);
 char		SC_Destructor(StatementClass *self);
 BOOL		SC_opencheck(StatementClass *self, const char *func);
+BOOL		SC_asynccheck(StatementClass *self, const char *func);
 RETCODE		SC_initialize_and_recycle(StatementClass *self);
 void		SC_initialize_cols_info(StatementClass *self, BOOL DCdestroy, BOOL parseReset);
 void		SC_reset_result_for_rerun(StatementClass *self);
@@ -533,6 +637,7 @@ SQLLEN		SC_get_int4_bookmark(StatementClass *self);
 RETCODE		SC_pos_reload(StatementClass *self, SQLULEN index, UInt2 *, Int4);
 RETCODE		SC_pos_update(StatementClass *self, SQLSETPOSIROW irow, SQLULEN index, const KeySet *keyset);
 RETCODE		SC_pos_delete(StatementClass *self, SQLSETPOSIROW irow, SQLULEN index, const KeySet *keyset);
+RETCODE		SC_pos_delete_rows(StatementClass *self, SQLSETPOSIROW nrows, const SQLSETPOSIROW *irows, const SQLULEN *indexes, const KeySet *keysets);
 RETCODE		SC_pos_refresh(StatementClass *self, SQLSETPOSIROW irow, SQLULEN index);
 RETCODE		SC_pos_fetch(StatementClass *self, const PG_BM *pg_bm);
 RETCODE		SC_pos_add(StatementClass *self, SQLSETPOSIROW irow);
@@ -544,11 +649,23 @@ void		SC_setInsertedTable(StatementClass *, RETCODE);
 void		SC_scanQueryAndCountParams(const char *, const ConnectionClass *,
 			ssize_t *next_cmd, SQLSMALLINT *num_params,
 			po_ind_t *multi, po_ind_t *proc_return);
+BOOL		SC_lex_statement(StatementClass *self);
+void		SC_forget_tokens(StatementClass *self);
+void		SC_forget_query_template(StatementClass *self);
+void		SC_fold_convert_time(StatementClass *self);
+void		QT_free(QueryTemplate *tmpl);
+BOOL		SC_find_insert_values(const char *query, const ConnectionClass *conn,
+			ssize_t *values_start, ssize_t *values_end);
+BOOL		SC_scan_statement_tokens(StatementClass *self, Int4 *token_idx,
+			SQLSMALLINT *num_params,
+			po_ind_t *multi, po_ind_t *proc_return);
 
 BOOL	SC_IsExecuting(const StatementClass *self);
 BOOL	SC_SetExecuting(StatementClass *self, BOOL on);
 BOOL	SC_SetCancelRequest(StatementClass *self);
 BOOL	SC_AcceptedCancelRequest(const StatementClass *self);
+BOOL	SC_async_cancel(StatementClass *self);
+void	SC_async_discard(StatementClass *self);
 
 BOOL	SC_connection_lost_check(StatementClass *stmt, const char *funcname);
 
@@ -558,6 +675,9 @@ void		cancelNeedDataState(StatementClass *self);
 int		StartRollbackState(StatementClass *self);
 RETCODE		SetStatementSvp(StatementClass *self, unsigned int option);
 RETCODE		DiscardStatementSvp(StatementClass *self, RETCODE, BOOL errorOnly);
+void		ResumeStatementSvp(StatementClass *self);
+RETCODE		DiscardStatementSvpOnRead(StatementClass *self, RETCODE);
+void		drop_putdata_streams(StatementClass *self);
 
 QResultClass *ParseAndDescribeWithLibpq(StatementClass *stmt, const char *plan_name, const char *query_p, Int2 num_params, const char *comment, QResultClass *res);
 BOOL	CheckPgClassInfo(StatementClass *);
@@ -0,0 +1,110 @@
+/*
+ * A benchmark of fetching a wide result set.
+ *
+ * Fetches the given number of rows of 10 columns, 5 integers and 5
+ * strings, bound with SQLBindCol, a few times and prints the best
+ * throughput. Build the driver with and without --with-max-log-level to
+ * compare the cost of the log level checks in the fetch and conversion
+ * loops.
+ *
+ * This uses the same psqlodbc_test_dsn datasource as the regression tests.
+ *
+ * Usage: fetch-bench [rows]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <sys/time.h>
+#endif
+
+#include "src/common.h"
+
+#define NUM_INT_COLS	5
+#define NUM_STR_COLS	5
+#define NUM_RUNS		3
+
+static double
+now_msec(void)
+{
+#ifdef WIN32
+	return (double) GetTickCount();
+#else
+	struct timeval	tv;
+
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+#endif
+}
+
+int
+main(int argc, char **argv)
+{
+	SQLRETURN	rc;
+	HSTMT		hstmt = SQL_NULL_HSTMT;
+	SQLINTEGER	ints[NUM_INT_COLS];
+	char		strs[NUM_STR_COLS][20];
+	SQLLEN		inds[NUM_INT_COLS + NUM_STR_COLS];
+	char		sql[200];
+	double		start, elapsed, best = 0;
+	int			count = 1000000;
+	int			run, i, nrows;
+
+	if (argc > 1)
+		count = atoi(argv[1]);
+	if (count <= 0)
+	{
+		fprintf(stderr, "Usage: %s [rows]\n", argv[0]);
+		exit(1);
+	}
+
+	test_connect();
+
+	rc = SQLAllocHandle(SQL_HANDLE_STMT, conn, &hstmt);
+	if (!SQL_SUCCEEDED(rc))
+	{
+		print_diag("failed to allocate stmt handle", SQL_HANDLE_DBC, conn);
+		exit(1);
+	}
+	for (i = 0; i < NUM_INT_COLS; i++)
+	{
+		rc = SQLBindCol(hstmt, i + 1, SQL_C_SLONG, &ints[i], 0, &inds[i]);
+		CHECK_STMT_RESULT(rc, "SQLBindCol failed", hstmt);
+	}
+	for (i = 0; i < NUM_STR_COLS; i++)
+	{
+		rc = SQLBindCol(hstmt, NUM_INT_COLS + i + 1, SQL_C_CHAR, strs[i], sizeof(strs[i]), &inds[NUM_INT_COLS + i]);
+		CHECK_STMT_RESULT(rc, "SQLBindCol failed", hstmt);
+	}
+	snprintf(sql, sizeof(sql),
+			 "SELECT g, g+1, g+2, g+3, g+4, 'a'||g, 'b'||g, 'c'||g, 'd'||g, 'e'||g"
+			 " FROM generate_series(1, %d) g", count);
+
+	for (run = 0; run < NUM_RUNS; run++)
+	{
+		start = now_msec();
+		rc = SQLExecDirect(hstmt, (SQLCHAR *) sql, SQL_NTS);
+		CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+		for (nrows = 0; SQL_SUCCEEDED(rc = SQLFetch(hstmt)); nrows++)
+			;
+		if (rc != SQL_NO_DATA)
+			CHECK_STMT_RESULT(rc, "SQLFetch failed", hstmt);
+		rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+		CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+		elapsed = now_msec() - start;
+		printf("run %d: %d rows in %.0f ms\n", run + 1, nrows, elapsed);
+		if (0 == run || elapsed < best)
+			best = elapsed;
+	}
+	printf("best: %.0f rows per second, %.1f ns per field\n",
+		   best > 0 ? count * 1000.0 / best : 0.0,
+		   count > 0 ? best * 1000000.0 / count / (NUM_INT_COLS + NUM_STR_COLS) : 0.0);
+
+	rc = SQLFreeHandle(SQL_HANDLE_STMT, hstmt);
+	CHECK_STMT_RESULT(rc, "SQLFreeHandle failed", hstmt);
+	test_disconnect();
+
+	return 0;
+}
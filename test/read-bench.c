@@ -0,0 +1,170 @@
+/*
+ * A benchmark of reading results from several threads on one connection.
+ *
+ * Each thread executes a query on its own statement handle and then reads
+ * the fetched row over and over with SQLGetData, SQLDescribeCol and
+ * SQLColAttribute, which don't talk to the server. The throughput with one
+ * thread is printed first, and then with the given number of threads, all
+ * sharing the same connection.
+ *
+ * This uses the same psqlodbc_test_dsn datasource as the regression tests.
+ *
+ * Usage: read-bench [threads [iterations]]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <sys/time.h>
+#include <pthread.h>
+#endif
+
+#include "src/common.h"
+
+#define MAX_THREADS	64
+
+static int	iterations = 100000;
+
+static double
+now_msec(void)
+{
+#ifdef WIN32
+	return (double) GetTickCount();
+#else
+	struct timeval	tv;
+
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+#endif
+}
+
+static void
+read_loop(HSTMT hstmt)
+{
+	SQLRETURN	rc;
+	SQLINTEGER	id;
+	char		buf[100];
+	SQLCHAR		colname[64];
+	SQLSMALLINT	namelen, coltype, decdigits, nullable;
+	SQLULEN		colsize;
+	SQLLEN		ind, numattr;
+	int			i;
+
+	for (i = 0; i < iterations; i++)
+	{
+		rc = SQLGetData(hstmt, 1, SQL_C_SLONG, &id, 0, &ind);
+		CHECK_STMT_RESULT(rc, "SQLGetData failed", hstmt);
+		rc = SQLGetData(hstmt, 2, SQL_C_CHAR, buf, sizeof(buf), &ind);
+		CHECK_STMT_RESULT(rc, "SQLGetData failed", hstmt);
+		rc = SQLDescribeCol(hstmt, 2, colname, sizeof(colname), &namelen,
+							&coltype, &colsize, &decdigits, &nullable);
+		CHECK_STMT_RESULT(rc, "SQLDescribeCol failed", hstmt);
+		rc = SQLColAttribute(hstmt, 1, SQL_DESC_DISPLAY_SIZE, NULL, 0, NULL, &numattr);
+		CHECK_STMT_RESULT(rc, "SQLColAttribute failed", hstmt);
+	}
+}
+
+#ifdef WIN32
+static DWORD WINAPI
+read_thread(LPVOID arg)
+{
+	read_loop((HSTMT) arg);
+	return 0;
+}
+#else
+static void *
+read_thread(void *arg)
+{
+	read_loop((HSTMT) arg);
+	return NULL;
+}
+#endif
+
+static void
+run_bench(int nthreads)
+{
+	SQLRETURN	rc;
+	HSTMT		hstmts[MAX_THREADS];
+#ifdef WIN32
+	HANDLE		threads[MAX_THREADS];
+#else
+	pthread_t	threads[MAX_THREADS];
+#endif
+	double		start, elapsed;
+	int			i;
+
+	for (i = 0; i < nthreads; i++)
+	{
+		rc = SQLAllocHandle(SQL_HANDLE_STMT, conn, &hstmts[i]);
+		if (!SQL_SUCCEEDED(rc))
+		{
+			print_diag("failed to allocate stmt handle", SQL_HANDLE_DBC, conn);
+			exit(1);
+		}
+		rc = SQLExecDirect(hstmts[i], (SQLCHAR *) "SELECT 1::int4 AS id, 'foo'::text AS t", SQL_NTS);
+		CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmts[i]);
+		rc = SQLFetch(hstmts[i]);
+		CHECK_STMT_RESULT(rc, "SQLFetch failed", hstmts[i]);
+	}
+
+	start = now_msec();
+	for (i = 0; i < nthreads; i++)
+	{
+#ifdef WIN32
+		threads[i] = CreateThread(NULL, 0, read_thread, hstmts[i], 0, NULL);
+		if (NULL == threads[i])
+#else
+		if (0 != pthread_create(&threads[i], NULL, read_thread, hstmts[i]))
+#endif
+		{
+			fprintf(stderr, "could not create thread\n");
+			exit(1);
+		}
+	}
+	for (i = 0; i < nthreads; i++)
+	{
+#ifdef WIN32
+		WaitForSingleObject(threads[i], INFINITE);
+		CloseHandle(threads[i]);
+#else
+		pthread_join(threads[i], NULL);
+#endif
+	}
+	elapsed = now_msec() - start;
+
+	printf("%d thread(s): %d reads in %.0f ms, %.0f per second\n",
+		   nthreads, nthreads * iterations, elapsed,
+		   elapsed > 0 ? nthreads * iterations * 1000.0 / elapsed : 0.0);
+
+	for (i = 0; i < nthreads; i++)
+	{
+		rc = SQLFreeHandle(SQL_HANDLE_STMT, hstmts[i]);
+		CHECK_STMT_RESULT(rc, "SQLFreeHandle failed", hstmts[i]);
+	}
+}
+
+int
+main(int argc, char **argv)
+{
+	int			nthreads = 8;
+
+	if (argc > 1)
+		nthreads = atoi(argv[1]);
+	if (argc > 2)
+		iterations = atoi(argv[2]);
+	if (nthreads <= 0 || nthreads > MAX_THREADS || iterations <= 0)
+	{
+		fprintf(stderr, "Usage: %s [threads [iterations]]\n", argv[0]);
+		exit(1);
+	}
+
+	test_connect();
+	run_bench(1);
+	if (nthreads > 1)
+		run_bench(nthreads);
+	test_disconnect();
+
+	return 0;
+}
@@ -0,0 +1,147 @@
+/*
+ * Test the adaptive fetch size of declare/fetch cursors (FetchBytes,
+ * FetchLatency and FetchMaxRows).
+ *
+ * The size of the blocks changes while a cursor is read, but the rows
+ * returned must be the same, also with a rowset size which is larger
+ * than the FETCH size would be, and with read-ahead.  The round trips
+ * counted by SQL_ATTR_PGOPT_PERFCOUNTERS show that the size did change.
+ */
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/* Must come before sql.h (declared in common.h) to suppress a warning */
+#include "../../pgapifunc.h"
+
+#include "common.h"
+
+#define NUM_PERF_COUNTERS	9
+
+static void
+set_adaptive(int fetch_bytes, int fetch_latency)
+{
+	int			rc;
+
+	rc = SQLSetConnectAttr(conn, SQL_ATTR_PGOPT_FETCHBYTES, (SQLPOINTER) (SQLLEN) fetch_bytes, 0);
+	CHECK_CONN_RESULT(rc, "SQLSetConnectAttr failed", conn);
+	rc = SQLSetConnectAttr(conn, SQL_ATTR_PGOPT_FETCHLATENCY, (SQLPOINTER) (SQLLEN) fetch_latency, 0);
+	CHECK_CONN_RESULT(rc, "SQLSetConnectAttr failed", conn);
+}
+
+/*
+ * Returns the round trips to the server it took, counting the DECLARE
+ * and the CLOSE of the cursor as well as the FETCHes.
+ */
+static long
+stream_rows(HSTMT hstmt, const char *sql)
+{
+	int			rc;
+	SQLBIGINT	counters[NUM_PERF_COUNTERS];
+	SQLINTEGER	cntlen;
+	SQLINTEGER	id;
+	SQLCHAR		buf[300];
+	SQLLEN		ind, bufind;
+	int			count = 0;
+	long		sum = 0;
+	long		len = 0;
+
+	rc = SQLSetConnectAttr(conn, SQL_ATTR_PGOPT_PERFCOUNTERS, (SQLPOINTER) 0, 0);
+	CHECK_CONN_RESULT(rc, "SQLSetConnectAttr failed", conn);
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) sql, SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	rc = SQLBindCol(hstmt, 1, SQL_C_SLONG, &id, 0, &ind);
+	CHECK_STMT_RESULT(rc, "SQLBindCol failed", hstmt);
+	rc = SQLBindCol(hstmt, 2, SQL_C_CHAR, buf, sizeof(buf), &bufind);
+	CHECK_STMT_RESULT(rc, "SQLBindCol failed", hstmt);
+	while (rc = SQLFetch(hstmt), SQL_SUCCEEDED(rc))
+	{
+		count++;
+		sum += id;
+		len += (long) bufind;
+	}
+	if (SQL_NO_DATA != rc)
+		CHECK_STMT_RESULT(rc, "SQLFetch failed", hstmt);
+	printf("streamed %d rows, sum %ld, length %ld\n", count, sum, len);
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+	rc = SQLFreeStmt(hstmt, SQL_UNBIND);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+
+	rc = SQLGetConnectAttr(conn, SQL_ATTR_PGOPT_PERFCOUNTERS, counters, sizeof(counters), &cntlen);
+	CHECK_CONN_RESULT(rc, "SQLGetConnectAttr failed", conn);
+	return (long) counters[0];
+}
+
+int
+main(int argc, char **argv)
+{
+	int			rc;
+	HSTMT		hstmt = SQL_NULL_HSTMT;
+	SQLINTEGER	ids[40];
+	SQLLEN		inds[40];
+	SQLULEN		rowsFetched;
+	int			count;
+	int			blocks;
+	long		fixed_trips, narrow_trips, wide_trips;
+
+	test_connect_ext("UseDeclareFetch=1;Fetch=10;FetchBytes=4000;FetchLatency=50;FetchMaxRows=64");
+
+	rc = SQLAllocHandle(SQL_HANDLE_STMT, conn, &hstmt);
+	if (!SQL_SUCCEEDED(rc))
+	{
+		print_diag("failed to allocate stmt handle", SQL_HANDLE_DBC, conn);
+		exit(1);
+	}
+
+	/* The blocks of Fetch=10 rows, for comparison */
+	set_adaptive(0, 0);
+	fixed_trips = stream_rows(hstmt, "SELECT g, 'x' FROM generate_series(1, 1000) g");
+	set_adaptive(4000, 50);
+
+	/* Narrow rows grow the blocks up to FetchMaxRows */
+	narrow_trips = stream_rows(hstmt, "SELECT g, 'x' FROM generate_series(1, 1000) g");
+	printf("round trips %s than with fixed blocks\n",
+		   narrow_trips < fixed_trips ? "fewer" : "NOT fewer");
+
+	/* Wide rows shrink them */
+	wide_trips = stream_rows(hstmt, "SELECT g, repeat('x', 200) FROM generate_series(1, 300) g");
+	printf("round trips per row %s than with narrow rows\n",
+		   wide_trips * 1000 > narrow_trips * 300 ? "more" : "NOT more");
+
+	/* A rowset size larger than the FETCH size for wide rows */
+	rc = SQLSetStmtAttr(hstmt, SQL_ATTR_ROW_ARRAY_SIZE, (SQLPOINTER) 40, 0);
+	CHECK_STMT_RESULT(rc, "SQLSetStmtAttr ROW_ARRAY_SIZE failed", hstmt);
+	rc = SQLSetStmtAttr(hstmt, SQL_ATTR_ROWS_FETCHED_PTR, (SQLPOINTER) &rowsFetched, 0);
+	CHECK_STMT_RESULT(rc, "SQLSetStmtAttr ROWS_FETCHED_PTR failed", hstmt);
+	rc = SQLBindCol(hstmt, 1, SQL_C_SLONG, ids, 0, inds);
+	CHECK_STMT_RESULT(rc, "SQLBindCol failed", hstmt);
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) "SELECT g, repeat('x', 200) FROM generate_series(1, 150) g", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	blocks = count = 0;
+	while (rc = SQLFetch(hstmt), SQL_SUCCEEDED(rc))
+	{
+		blocks++;
+		count += (int) rowsFetched;
+		printf("rowset %d: %d rows from %d to %d\n", blocks, (int) rowsFetched, (int) ids[0], (int) ids[rowsFetched - 1]);
+	}
+	if (SQL_NO_DATA != rc)
+		CHECK_STMT_RESULT(rc, "SQLFetch failed", hstmt);
+	printf("fetched %d rows in %d rowsets\n", count, blocks);
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+	rc = SQLFreeStmt(hstmt, SQL_UNBIND);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+	rc = SQLSetStmtAttr(hstmt, SQL_ATTR_ROW_ARRAY_SIZE, (SQLPOINTER) 1, 0);
+	CHECK_STMT_RESULT(rc, "SQLSetStmtAttr ROW_ARRAY_SIZE failed", hstmt);
+
+	/* Together with read-ahead */
+	rc = SQLSetConnectAttr(conn, SQL_ATTR_PGOPT_FETCHREADAHEAD, (SQLPOINTER) 1, 0);
+	CHECK_CONN_RESULT(rc, "SQLSetConnectAttr failed", conn);
+	stream_rows(hstmt, "SELECT g, repeat('x', g % 250) FROM generate_series(1, 700) g");
+
+	/* Clean up */
+	test_disconnect();
+
+	return 0;
+}
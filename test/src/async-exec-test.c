@@ -0,0 +1,162 @@
+/*
+ * Test asynchronous execution with SQL_ATTR_ASYNC_ENABLE.
+ *
+ * SQLExecDirect/SQLExecute return SQL_STILL_EXECUTING until the result
+ * has arrived, and must then be called again with the same arguments to
+ * get it. SQLCancel cancels an execution in progress. Other calls on the
+ * statement or transaction calls on the connection are function sequence
+ * errors meanwhile.
+ */
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "common.h"
+
+static void
+print_sqlstate(const char *msg, SQLSMALLINT handle_type, SQLHANDLE handle)
+{
+	SQLCHAR		sqlstate[32];
+	SQLCHAR		message[1000];
+	SQLINTEGER	nativeerror;
+	SQLSMALLINT textlen;
+
+	if (SQL_SUCCEEDED(SQLGetDiagRec(handle_type, handle, 1, sqlstate, &nativeerror, message, sizeof(message), &textlen)))
+		printf("%s: %s\n", msg, sqlstate);
+	else
+		printf("%s: no error information\n", msg);
+}
+
+int
+main(int argc, char **argv)
+{
+	int			rc;
+	HSTMT		hstmt = SQL_NULL_HSTMT;
+	SQLCHAR	   *sql;
+	SQLINTEGER	param;
+	SQLLEN		ind;
+	SQLULEN		async;
+	SQLSMALLINT	ncols;
+	int			polls;
+
+	test_connect();
+
+	rc = SQLAllocHandle(SQL_HANDLE_STMT, conn, &hstmt);
+	if (!SQL_SUCCEEDED(rc))
+	{
+		print_diag("failed to allocate stmt handle", SQL_HANDLE_DBC, conn);
+		exit(1);
+	}
+
+	rc = SQLSetStmtAttr(hstmt, SQL_ATTR_ASYNC_ENABLE, (SQLPOINTER) SQL_ASYNC_ENABLE_ON, 0);
+	CHECK_STMT_RESULT(rc, "SQLSetStmtAttr ASYNC_ENABLE failed", hstmt);
+	rc = SQLGetStmtAttr(hstmt, SQL_ATTR_ASYNC_ENABLE, &async, 0, NULL);
+	CHECK_STMT_RESULT(rc, "SQLGetStmtAttr ASYNC_ENABLE failed", hstmt);
+	printf("async enabled: %d\n", SQL_ASYNC_ENABLE_ON == async);
+
+	/* Poll a slow query until it completes */
+	sql = (SQLCHAR *) "SELECT pg_sleep(0.5), 'slow'";
+	polls = 0;
+	while (rc = SQLExecDirect(hstmt, sql, SQL_NTS), SQL_STILL_EXECUTING == rc)
+		polls++;
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	printf("still executing returned: %s\n", polls > 0 ? "yes" : "no");
+	print_result(hstmt);
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+
+	/* A prepared statement with a parameter */
+	rc = SQLPrepare(hstmt, (SQLCHAR *) "SELECT g * ? FROM generate_series(1, 3) g", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLPrepare failed", hstmt);
+	rc = SQLBindParameter(hstmt, 1, SQL_PARAM_INPUT, SQL_C_SLONG, SQL_INTEGER, 0, 0, &param, 0, &ind);
+	CHECK_STMT_RESULT(rc, "SQLBindParameter failed", hstmt);
+	ind = sizeof(param);
+	for (param = 10; param <= 20; param += 10)
+	{
+		while (rc = SQLExecute(hstmt), SQL_STILL_EXECUTING == rc)
+			;
+		CHECK_STMT_RESULT(rc, "SQLExecute failed", hstmt);
+		print_result(hstmt);
+		rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+		CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+	}
+	rc = SQLFreeStmt(hstmt, SQL_RESET_PARAMS);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+
+	/* An error is reported when the execution completes */
+	sql = (SQLCHAR *) "SELECT 1 / 0";
+	while (rc = SQLExecDirect(hstmt, sql, SQL_NTS), SQL_STILL_EXECUTING == rc)
+		;
+	if (SQL_SUCCEEDED(rc))
+		printf("SQLExecDirect unexpectedly succeeded\n");
+	else
+		print_sqlstate("SQLExecDirect failed", SQL_HANDLE_STMT, hstmt);
+
+	/* Other calls are sequence errors until the execution completes */
+	sql = (SQLCHAR *) "SELECT pg_sleep(0.5), 'done'";
+	rc = SQLExecDirect(hstmt, sql, SQL_NTS);
+	if (SQL_STILL_EXECUTING != rc)
+	{
+		printf("SQLExecDirect didn't return SQL_STILL_EXECUTING: %d\n", rc);
+		exit(1);
+	}
+	rc = SQLNumResultCols(hstmt, &ncols);
+	if (SQL_SUCCEEDED(rc))
+		printf("SQLNumResultCols unexpectedly succeeded\n");
+	else
+		print_sqlstate("SQLNumResultCols while executing", SQL_HANDLE_STMT, hstmt);
+	rc = SQLEndTran(SQL_HANDLE_DBC, conn, SQL_COMMIT);
+	if (SQL_SUCCEEDED(rc))
+		printf("SQLEndTran unexpectedly succeeded\n");
+	else
+		print_sqlstate("SQLEndTran while executing", SQL_HANDLE_DBC, conn);
+	while (rc = SQLExecDirect(hstmt, sql, SQL_NTS), SQL_STILL_EXECUTING == rc)
+		;
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	print_result(hstmt);
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+	rc = SQLEndTran(SQL_HANDLE_DBC, conn, SQL_COMMIT);
+	CHECK_CONN_RESULT(rc, "SQLEndTran failed", conn);
+
+	/* Cancel a slow query */
+	sql = (SQLCHAR *) "SELECT pg_sleep(10)";
+	rc = SQLExecDirect(hstmt, sql, SQL_NTS);
+	if (SQL_STILL_EXECUTING != rc)
+	{
+		printf("SQLExecDirect didn't return SQL_STILL_EXECUTING: %d\n", rc);
+		exit(1);
+	}
+	rc = SQLCancel(hstmt);
+	CHECK_STMT_RESULT(rc, "SQLCancel failed", hstmt);
+	while (rc = SQLExecDirect(hstmt, sql, SQL_NTS), SQL_STILL_EXECUTING == rc)
+		;
+	if (SQL_SUCCEEDED(rc))
+		printf("SQLExecDirect unexpectedly succeeded\n");
+	else
+		print_sqlstate("cancelled", SQL_HANDLE_STMT, hstmt);
+
+	/* Free a statement while it is still executing */
+	rc = SQLExecDirect(hstmt, sql, SQL_NTS);
+	if (SQL_STILL_EXECUTING != rc)
+	{
+		printf("SQLExecDirect didn't return SQL_STILL_EXECUTING: %d\n", rc);
+		exit(1);
+	}
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+
+	/* The connection can be used again */
+	rc = SQLSetStmtAttr(hstmt, SQL_ATTR_ASYNC_ENABLE, (SQLPOINTER) SQL_ASYNC_ENABLE_OFF, 0);
+	CHECK_STMT_RESULT(rc, "SQLSetStmtAttr ASYNC_ENABLE failed", hstmt);
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) "SELECT 'synchronous'", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	print_result(hstmt);
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+
+	/* Clean up */
+	test_disconnect();
+
+	return 0;
+}
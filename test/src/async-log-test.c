@@ -0,0 +1,224 @@
+/*
+ * Test the logging from several threads with LogBufferSize set, in which
+ * case the lines are written to the MyLog file by a background thread.
+ * (On platforms without the asynchronous logging, the setting is ignored
+ * and this checks the synchronous logging.)
+ *
+ * Each thread executes queries which contain a marker on its own
+ * statement. All the markers must show up intact in the log.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common.h"
+
+#ifdef WIN32
+#include <process.h>
+#include <odbcinst.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#include <pwd.h>
+#include <pthread.h>
+#include <odbcinst.h>
+#endif
+
+#define NUM_THREADS	4
+#define NUM_QUERIES	20
+#define LOG_DIR		"results"
+
+static const char *drivers[] = {"PostgreSQL Unicode", "PostgreSQL ANSI"};
+
+static void
+set_driver_options(const char *logbuffersize, const char *logdir)
+{
+	int			i;
+
+	for (i = 0; i < sizeof(drivers) / sizeof(drivers[0]); i++)
+	{
+		SQLWritePrivateProfileString(drivers[i], "LogBufferSize", logbuffersize, "odbcinst.ini");
+		SQLWritePrivateProfileString(drivers[i], "Logdir", logdir, "odbcinst.ini");
+	}
+}
+
+static void
+run_queries(HSTMT hstmt, int thread_no)
+{
+	SQLRETURN	rc;
+	char		sql[100];
+	int			i;
+
+	for (i = 0; i < NUM_QUERIES; i++)
+	{
+		snprintf(sql, sizeof(sql), "SELECT 'alog-%d-%d-mark'", thread_no, i);
+		rc = SQLExecDirect(hstmt, (SQLCHAR *) sql, SQL_NTS);
+		CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+		rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+		CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+	}
+}
+
+static HSTMT	hstmts[NUM_THREADS];
+
+#ifdef WIN32
+static DWORD WINAPI
+query_thread(LPVOID arg)
+{
+	int			thread_no = (int) (SQLLEN) arg;
+
+	run_queries(hstmts[thread_no], thread_no);
+	return 0;
+}
+#else
+static void *
+query_thread(void *arg)
+{
+	int			thread_no = (int) (SQLLEN) arg;
+
+	run_queries(hstmts[thread_no], thread_no);
+	return NULL;
+}
+#endif
+
+/* The name of the MyLog file, as the driver generates it */
+static void
+log_filename(char *filename, size_t size)
+{
+#ifdef WIN32
+	snprintf(filename, size, "%s\\mylog_async-log-test_%u.log",
+			 LOG_DIR, (unsigned int) getpid());
+#else
+	struct passwd *pw = getpwuid(getuid());
+
+	snprintf(filename, size, "%s/mylog_async-log-test_%s%u.log",
+			 LOG_DIR, pw ? pw->pw_name : "", (unsigned int) getpid());
+#endif
+}
+
+static char *
+read_file(const char *filename)
+{
+	FILE	   *fp;
+	char	   *buf;
+	long		len;
+
+	if (fp = fopen(filename, "rb"), NULL == fp)
+		return NULL;
+	fseek(fp, 0, SEEK_END);
+	len = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+	if (buf = malloc(len + 1), NULL != buf)
+	{
+		len = (long) fread(buf, 1, len, fp);
+		buf[len] = '\0';
+	}
+	fclose(fp);
+
+	return buf;
+}
+
+/*
+ * Count the markers found in the log. The lines are written by the
+ * background thread, so wait a while for them.
+ */
+static int
+count_markers(void)
+{
+	char		filename[256], marker[64];
+	char	   *log;
+	int			found = 0, i, j, retry;
+
+	log_filename(filename, sizeof(filename));
+	for (retry = 0; retry < 50; retry++)
+	{
+		found = 0;
+		if (log = read_file(filename), NULL != log)
+		{
+			for (i = 0; i < NUM_THREADS; i++)
+			{
+				for (j = 0; j < NUM_QUERIES; j++)
+				{
+					snprintf(marker, sizeof(marker), "'alog-%d-%d-mark'", i, j);
+					if (NULL != strstr(log, marker))
+						found++;
+				}
+			}
+			free(log);
+		}
+		if (found == NUM_THREADS * NUM_QUERIES)
+			break;
+#ifdef WIN32
+		Sleep(100);
+#else
+		usleep(100000);
+#endif
+	}
+	remove(filename);
+
+	return found;
+}
+
+int
+main(int argc, char **argv)
+{
+	SQLRETURN	rc;
+#ifdef WIN32
+	HANDLE		threads[NUM_THREADS];
+#else
+	pthread_t	threads[NUM_THREADS];
+#endif
+	int			i;
+
+	/* the settings are read when the driver is loaded */
+	set_driver_options("4096", LOG_DIR);
+	test_connect_ext("Debug=1");
+
+	for (i = 0; i < NUM_THREADS; i++)
+	{
+		rc = SQLAllocHandle(SQL_HANDLE_STMT, conn, &hstmts[i]);
+		if (!SQL_SUCCEEDED(rc))
+		{
+			print_diag("failed to allocate stmt handle", SQL_HANDLE_DBC, conn);
+			exit(1);
+		}
+	}
+	for (i = 0; i < NUM_THREADS; i++)
+	{
+#ifdef WIN32
+		threads[i] = CreateThread(NULL, 0, query_thread, (LPVOID) (SQLLEN) i, 0, NULL);
+		if (NULL == threads[i])
+#else
+		if (0 != pthread_create(&threads[i], NULL, query_thread, (void *) (SQLLEN) i))
+#endif
+		{
+			printf("could not create thread\n");
+			exit(1);
+		}
+	}
+	for (i = 0; i < NUM_THREADS; i++)
+	{
+#ifdef WIN32
+		WaitForSingleObject(threads[i], INFINITE);
+		CloseHandle(threads[i]);
+#else
+		pthread_join(threads[i], NULL);
+#endif
+	}
+	printf("%d threads executed %d queries each\n", NUM_THREADS, NUM_QUERIES);
+
+	for (i = 0; i < NUM_THREADS; i++)
+	{
+		rc = SQLFreeHandle(SQL_HANDLE_STMT, hstmts[i]);
+		CHECK_STMT_RESULT(rc, "SQLFreeHandle failed", hstmts[i]);
+	}
+	test_disconnect();
+
+	/* don't let the other tests use the settings */
+	set_driver_options(NULL, NULL);
+
+	printf("%d of %d markers found in the log\n",
+		   count_markers(), NUM_THREADS * NUM_QUERIES);
+
+	return 0;
+}
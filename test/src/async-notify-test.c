@@ -0,0 +1,159 @@
+/*
+ * Test the notification of asynchronous completion, which the driver
+ * manager uses for SQL_ATTR_ASYNC_STMT_EVENT.
+ *
+ * Many connections run a slow query each at the same time. The driver
+ * calls the notification callback of a statement when its connection has
+ * something to read, and only then is the statement polled again.
+ */
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "common.h"
+
+#ifndef SQL_ATTR_ASYNC_STMT_NOTIFICATION_CALLBACK
+#define SQL_ATTR_ASYNC_STMT_NOTIFICATION_CALLBACK	30
+#define SQL_ATTR_ASYNC_STMT_NOTIFICATION_CONTEXT	31
+#endif
+#ifndef SQL_ASYNC_NOTIFICATION
+#define SQL_ASYNC_NOTIFICATION	10025
+#define SQL_ASYNC_NOTIFICATION_CAPABLE	1
+#endif
+
+#define NUM_CONNS	20
+
+static volatile int notified[NUM_CONNS];
+
+static SQLRETURN SQL_API
+notification_callback(SQLPOINTER context, BOOL last)
+{
+	notified[(int) (SQLLEN) context] = 1;
+	return SQL_SUCCESS;
+}
+
+static void
+sleep_a_while(void)
+{
+#ifdef WIN32
+	Sleep(1);
+#else
+	usleep(1000);
+#endif
+}
+
+int
+main(int argc, char **argv)
+{
+	int			rc;
+	HDBC		conns[NUM_CONNS];
+	HSTMT		hstmts[NUM_CONNS];
+	SQLCHAR		queries[NUM_CONNS][100];
+	int			pending[NUM_CONNS];
+	char		dsn[1024];
+	SQLUINTEGER	capable = 0;
+	SQLINTEGER	val;
+	SQLLEN		ind;
+	int			i, remaining, progress, waits;
+	int			completed = 0, sum = 0, early = 0;
+
+	test_connect();
+	rc = SQLGetInfo(conn, SQL_ASYNC_NOTIFICATION, &capable, sizeof(capable), NULL);
+	CHECK_CONN_RESULT(rc, "SQLGetInfo failed", conn);
+	printf("notification capable: %d\n", SQL_ASYNC_NOTIFICATION_CAPABLE == capable);
+	if (SQL_ASYNC_NOTIFICATION_CAPABLE != capable)
+		exit(0);
+
+	snprintf(dsn, sizeof(dsn), "DSN=%s", get_test_dsn());
+	for (i = 0; i < NUM_CONNS; i++)
+	{
+		rc = SQLAllocHandle(SQL_HANDLE_DBC, env, &conns[i]);
+		CHECK_CONN_RESULT(rc, "SQLAllocHandle failed", conn);
+		rc = SQLDriverConnect(conns[i], NULL, (SQLCHAR *) dsn, SQL_NTS,
+							  NULL, 0, NULL, SQL_DRIVER_NOPROMPT);
+		CHECK_CONN_RESULT(rc, "SQLDriverConnect failed", conns[i]);
+		rc = SQLAllocHandle(SQL_HANDLE_STMT, conns[i], &hstmts[i]);
+		CHECK_CONN_RESULT(rc, "SQLAllocHandle failed", conns[i]);
+		rc = SQLSetStmtAttr(hstmts[i], SQL_ATTR_ASYNC_ENABLE, (SQLPOINTER) SQL_ASYNC_ENABLE_ON, 0);
+		CHECK_STMT_RESULT(rc, "SQLSetStmtAttr ASYNC_ENABLE failed", hstmts[i]);
+		rc = SQLSetStmtAttr(hstmts[i], SQL_ATTR_ASYNC_STMT_NOTIFICATION_CALLBACK, (SQLPOINTER) notification_callback, 0);
+		CHECK_STMT_RESULT(rc, "SQLSetStmtAttr NOTIFICATION_CALLBACK failed", hstmts[i]);
+		rc = SQLSetStmtAttr(hstmts[i], SQL_ATTR_ASYNC_STMT_NOTIFICATION_CONTEXT, (SQLPOINTER) (SQLLEN) i, 0);
+		CHECK_STMT_RESULT(rc, "SQLSetStmtAttr NOTIFICATION_CONTEXT failed", hstmts[i]);
+	}
+
+	/* Start all the queries */
+	remaining = 0;
+	for (i = 0; i < NUM_CONNS; i++)
+	{
+		snprintf((char *) queries[i], sizeof(queries[i]),
+				 "SELECT %d FROM pg_sleep(%d * 0.05)", i, i % 5 + 1);
+		notified[i] = 0;
+		rc = SQLExecDirect(hstmts[i], queries[i], SQL_NTS);
+		pending[i] = (SQL_STILL_EXECUTING == rc);
+		if (pending[i])
+			remaining++;
+		else
+		{
+			CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmts[i]);
+			early++;
+		}
+	}
+	printf("all queries still executing: %s\n", 0 == early ? "yes" : "no");
+
+	/* Poll only the statements which were notified */
+	waits = 0;
+	while (remaining > 0)
+	{
+		progress = 0;
+		for (i = 0; i < NUM_CONNS; i++)
+		{
+			if (!pending[i] || !notified[i])
+				continue;
+			notified[i] = 0;
+			progress = 1;
+			rc = SQLExecDirect(hstmts[i], queries[i], SQL_NTS);
+			if (SQL_STILL_EXECUTING == rc)
+				continue;
+			CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmts[i]);
+			pending[i] = 0;
+			remaining--;
+		}
+		if (!progress)
+		{
+			if (++waits > 30000)
+			{
+				printf("%d statements were not notified\n", remaining);
+				exit(1);
+			}
+			sleep_a_while();
+		}
+	}
+
+	for (i = 0; i < NUM_CONNS; i++)
+	{
+		rc = SQLFetch(hstmts[i]);
+		CHECK_STMT_RESULT(rc, "SQLFetch failed", hstmts[i]);
+		rc = SQLGetData(hstmts[i], 1, SQL_C_SLONG, &val, 0, &ind);
+		CHECK_STMT_RESULT(rc, "SQLGetData failed", hstmts[i]);
+		completed++;
+		sum += val;
+		rc = SQLFreeHandle(SQL_HANDLE_STMT, hstmts[i]);
+		CHECK_STMT_RESULT(rc, "SQLFreeHandle failed", hstmts[i]);
+		rc = SQLDisconnect(conns[i]);
+		CHECK_CONN_RESULT(rc, "SQLDisconnect failed", conns[i]);
+		rc = SQLFreeHandle(SQL_HANDLE_DBC, conns[i]);
+		CHECK_CONN_RESULT(rc, "SQLFreeHandle failed", conns[i]);
+	}
+	printf("%d statements completed, sum %d\n", completed, sum);
+
+	/* Clean up */
+	test_disconnect();
+
+	return 0;
+}
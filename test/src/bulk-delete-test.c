@@ -0,0 +1,132 @@
+/*
+ * Test deleting all the rows of a rowset with SQLSetPos(0, SQL_DELETE)
+ * and SQLBulkOperations(SQL_DELETE_BY_BOOKMARK), which delete them with
+ * one statement.
+ */
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "common.h"
+
+#define	ROWSET		5
+#define	BOOKMARK_SIZE	14
+
+static void
+print_row_status(const char *label, SQLUSMALLINT *rowStatus)
+{
+	int		i;
+
+	printf("%s:", label);
+	for (i = 0; i < ROWSET; i++)
+		printf(" %d", rowStatus[i]);
+	printf("\n");
+}
+
+static void
+test_table(HSTMT hstmt, const char *create, BOOL bookmarks)
+{
+	int			rc;
+	SQLINTEGER	vals[ROWSET];
+	SQLLEN		inds[ROWSET];
+	char		bookmark[ROWSET][BOOKMARK_SIZE];
+	SQLLEN		bookmark_inds[ROWSET];
+	SQLUSMALLINT	rowStatus[ROWSET];
+	SQLULEN		rowsFetched;
+
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) "DROP TABLE IF EXISTS bulkdelete_test", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) create, SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) "INSERT INTO bulkdelete_test(i) SELECT g FROM generate_series(1, 20) g", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+
+	rc = SQLSetStmtAttr(hstmt, SQL_ATTR_CONCURRENCY, (SQLPOINTER) SQL_CONCUR_ROWVER, 0);
+	CHECK_STMT_RESULT(rc, "SQLSetStmtAttr failed", hstmt);
+	rc = SQLSetStmtAttr(hstmt, SQL_ATTR_CURSOR_TYPE, (SQLPOINTER) SQL_CURSOR_KEYSET_DRIVEN, 0);
+	CHECK_STMT_RESULT(rc, "SQLSetStmtAttr failed", hstmt);
+	rc = SQLSetStmtAttr(hstmt, SQL_ATTR_USE_BOOKMARKS, (SQLPOINTER) (bookmarks ? SQL_UB_VARIABLE : SQL_UB_OFF), SQL_IS_UINTEGER);
+	CHECK_STMT_RESULT(rc, "SQLSetStmtAttr failed", hstmt);
+	rc = SQLSetStmtAttr(hstmt, SQL_ATTR_ROW_ARRAY_SIZE, (SQLPOINTER) ROWSET, 0);
+	CHECK_STMT_RESULT(rc, "SQLSetStmtAttr failed", hstmt);
+	rc = SQLSetStmtAttr(hstmt, SQL_ATTR_ROW_STATUS_PTR, (SQLPOINTER) rowStatus, 0);
+	CHECK_STMT_RESULT(rc, "SQLSetStmtAttr failed", hstmt);
+	rc = SQLSetStmtAttr(hstmt, SQL_ATTR_ROWS_FETCHED_PTR, (SQLPOINTER) &rowsFetched, 0);
+	CHECK_STMT_RESULT(rc, "SQLSetStmtAttr failed", hstmt);
+	if (bookmarks)
+	{
+		rc = SQLBindCol(hstmt, 0, SQL_C_VARBOOKMARK, bookmark, sizeof(bookmark[0]), bookmark_inds);
+		CHECK_STMT_RESULT(rc, "SQLBindCol failed", hstmt);
+	}
+	rc = SQLBindCol(hstmt, 1, SQL_C_LONG, vals, 0, inds);
+	CHECK_STMT_RESULT(rc, "SQLBindCol failed", hstmt);
+
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) "SELECT i FROM bulkdelete_test ORDER BY i", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+
+	/* delete the first rowset */
+	rc = SQLFetchScroll(hstmt, SQL_FETCH_ABSOLUTE, 1);
+	CHECK_STMT_RESULT(rc, "SQLFetchScroll failed", hstmt);
+	printf("fetched %d rows from %d to %d\n", (int) rowsFetched, (int) vals[0], (int) vals[rowsFetched - 1]);
+	rc = SQLSetPos(hstmt, 0, SQL_DELETE, SQL_LOCK_NO_CHANGE);
+	CHECK_STMT_RESULT(rc, "SQLSetPos delete failed", hstmt);
+	print_row_status("SQLSetPos delete", rowStatus);
+
+	/* and the third by bookmarks */
+	if (bookmarks)
+	{
+		rc = SQLFetchScroll(hstmt, SQL_FETCH_ABSOLUTE, 11);
+		CHECK_STMT_RESULT(rc, "SQLFetchScroll failed", hstmt);
+		printf("fetched %d rows from %d to %d\n", (int) rowsFetched, (int) vals[0], (int) vals[rowsFetched - 1]);
+		rc = SQLBulkOperations(hstmt, SQL_DELETE_BY_BOOKMARK);
+		CHECK_STMT_RESULT(rc, "SQLBulkOperations delete failed", hstmt);
+		print_row_status("SQLBulkOperations delete", rowStatus);
+	}
+
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+	rc = SQLFreeStmt(hstmt, SQL_UNBIND);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+	rc = SQLSetStmtAttr(hstmt, SQL_ATTR_ROW_ARRAY_SIZE, (SQLPOINTER) 1, 0);
+	CHECK_STMT_RESULT(rc, "SQLSetStmtAttr failed", hstmt);
+	rc = SQLSetStmtAttr(hstmt, SQL_ATTR_ROW_STATUS_PTR, NULL, 0);
+	CHECK_STMT_RESULT(rc, "SQLSetStmtAttr failed", hstmt);
+	rc = SQLSetStmtAttr(hstmt, SQL_ATTR_ROWS_FETCHED_PTR, NULL, 0);
+	CHECK_STMT_RESULT(rc, "SQLSetStmtAttr failed", hstmt);
+
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) "SELECT count(*), sum(i) FROM bulkdelete_test", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	print_result(hstmt);
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+}
+
+int main(int argc, char **argv)
+{
+	int			rc;
+	HSTMT		hstmt = SQL_NULL_HSTMT;
+
+	test_connect_ext("UpdatableCursors=1");
+
+	rc = SQLAllocHandle(SQL_HANDLE_STMT, conn, &hstmt);
+	if (!SQL_SUCCEEDED(rc))
+	{
+		print_diag("failed to allocate stmt handle", SQL_HANDLE_DBC, conn);
+		exit(1);
+	}
+
+	/* The rows are identified by the ctid and a serial column */
+	printf("Table with a serial column\n");
+	test_table(hstmt, "CREATE TEMPORARY TABLE bulkdelete_test(i int4, orig serial)", TRUE);
+
+	/* The rows are identified by the ctid only */
+	printf("\nTable without a serial column\n");
+	test_table(hstmt, "CREATE TEMPORARY TABLE bulkdelete_test(i int4)", FALSE);
+
+	/* Clean up */
+	test_disconnect();
+
+	return 0;
+}
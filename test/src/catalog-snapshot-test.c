@@ -0,0 +1,189 @@
+/*
+ * Test the PrefetchCatalog setting. The catalog functions should return
+ * the same results from the snapshot of the schema, and the snapshot
+ * should be refreshed after DDL, also when the DDL is executed with the
+ * extended protocol (UseServerSidePrepare=1), and after SQLEndTran so
+ * that the DDL of other sessions is seen.
+ */
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/* Must come before sql.h (declared in common.h) to suppress a warning */
+#include "../../pgapifunc.h"
+
+#include "common.h"
+
+/* define a macro to simplify function calls */
+#define PRINT_RESULT_SERIES(hstmt, idarray, rowcount) print_result_series(hstmt, idarray, sizeof(idarray)/sizeof(idarray[0]), rowcount, FALSE)
+
+static SQLSMALLINT sql_column_ids[6] = {1, 2, 3, 4, 5, 6};
+
+static void
+print_columns(HSTMT hstmt, char *tablename, char *columnname)
+{
+	int			rc;
+
+	printf("Check for SQLColumns %s.%s\n", tablename, columnname ? columnname : "");
+	rc = SQLColumns(hstmt,
+					NULL, 0,
+					(SQLCHAR *) "public", SQL_NTS,
+					(SQLCHAR *) tablename, SQL_NTS,
+					(SQLCHAR *) columnname, columnname ? SQL_NTS : 0);
+	CHECK_STMT_RESULT(rc, "SQLColumns failed", hstmt);
+	PRINT_RESULT_SERIES(hstmt, sql_column_ids, -1);
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+}
+
+static void
+exec_ddl(HSTMT hstmt, char *sql)
+{
+	int			rc;
+
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) sql, SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+}
+
+/* Execute DDL prepared on the server */
+static void
+exec_prepared_ddl(HSTMT hstmt, char *sql)
+{
+	int			rc;
+
+	rc = SQLPrepare(hstmt, (SQLCHAR *) sql, SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLPrepare failed", hstmt);
+	rc = SQLExecute(hstmt);
+	CHECK_STMT_RESULT(rc, "SQLExecute failed", hstmt);
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+}
+
+int
+main(int argc, char **argv)
+{
+	int			rc;
+	HSTMT		hstmt = SQL_NULL_HSTMT;
+	HDBC		conn2 = SQL_NULL_HDBC;
+	HSTMT		hstmt2 = SQL_NULL_HSTMT;
+	SQLINTEGER	prefetch;
+	char		dsn[1024];
+
+	test_connect_ext("PrefetchCatalog=1");
+
+	rc = SQLAllocHandle(SQL_HANDLE_STMT, conn, &hstmt);
+	if (!SQL_SUCCEEDED(rc))
+	{
+		print_diag("failed to allocate stmt handle", SQL_HANDLE_DBC, conn);
+		exit(1);
+	}
+
+	rc = SQLGetConnectAttr(conn, SQL_ATTR_PGOPT_PREFETCHCATALOG, &prefetch, 0, NULL);
+	CHECK_CONN_RESULT(rc, "SQLGetConnectAttr failed", conn);
+	printf("PrefetchCatalog is %d\n", (int) prefetch);
+
+	exec_ddl(hstmt, "drop table if exists snapshottab");
+
+	print_columns(hstmt, "testtab1", NULL);
+	print_columns(hstmt, "testtab1", "i%");
+
+	/* Check for SQLSpecialColumns */
+	printf("Check for SQLSpecialColumns\n");
+	rc = SQLSpecialColumns(hstmt, SQL_ROWVER,
+						   NULL, 0,
+						   (SQLCHAR *) "public", SQL_NTS,
+						   (SQLCHAR *) "testtab1", SQL_NTS,
+						   SQL_SCOPE_SESSION,
+						   SQL_NO_NULLS);
+	CHECK_STMT_RESULT(rc, "SQLSpecialColumns failed", hstmt);
+	print_result(hstmt);
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+
+	/* Check for SQLStatistics */
+	printf("Check for SQLStatistics\n");
+	rc = SQLStatistics(hstmt,
+					   NULL, 0,
+					   (SQLCHAR *) "public", SQL_NTS,
+					   (SQLCHAR *) "testtab1", SQL_NTS,
+					   0, 0);
+	CHECK_STMT_RESULT(rc, "SQLStatistics failed", hstmt);
+	print_result(hstmt);
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+
+	/* Check for SQLPrimaryKeys */
+	printf("Check for SQLPrimaryKeys\n");
+	rc = SQLPrimaryKeys(hstmt,
+						NULL, 0,
+						(SQLCHAR *) "public", SQL_NTS,
+						(SQLCHAR *) "testtab1", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLPrimaryKeys failed", hstmt);
+	print_result(hstmt);
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+
+	/* DDL should discard the snapshot */
+	exec_ddl(hstmt, "create table snapshottab (a int4)");
+	print_columns(hstmt, "snapshottab", NULL);
+	exec_ddl(hstmt, "alter table snapshottab add column b varchar(10)");
+	print_columns(hstmt, "snapshottab", NULL);
+	exec_ddl(hstmt, "drop table snapshottab");
+	print_columns(hstmt, "snapshottab", NULL);
+
+	rc = SQLFreeHandle(SQL_HANDLE_STMT, hstmt);
+	CHECK_STMT_RESULT(rc, "SQLFreeHandle failed", hstmt);
+	test_disconnect();
+
+	/* The same with the DDL executed by the extended protocol */
+	test_connect_ext("PrefetchCatalog=1;UseServerSidePrepare=1");
+
+	rc = SQLAllocHandle(SQL_HANDLE_STMT, conn, &hstmt);
+	if (!SQL_SUCCEEDED(rc))
+	{
+		print_diag("failed to allocate stmt handle", SQL_HANDLE_DBC, conn);
+		exit(1);
+	}
+
+	print_columns(hstmt, "snapshottab", NULL);
+	exec_prepared_ddl(hstmt, "create table snapshottab (a int4)");
+	print_columns(hstmt, "snapshottab", NULL);
+	exec_prepared_ddl(hstmt, "alter table snapshottab add column b varchar(10)");
+	print_columns(hstmt, "snapshottab", NULL);
+	exec_prepared_ddl(hstmt, "drop table snapshottab");
+	print_columns(hstmt, "snapshottab", NULL);
+
+	/*
+	 * DDL of another session isn't seen until SQLEndTran discards the
+	 * snapshot.
+	 */
+	snprintf(dsn, sizeof(dsn), "DSN=%s", get_test_dsn());
+	rc = SQLAllocHandle(SQL_HANDLE_DBC, env, &conn2);
+	CHECK_CONN_RESULT(rc, "SQLAllocHandle failed", conn);
+	rc = SQLDriverConnect(conn2, NULL, (SQLCHAR *) dsn, SQL_NTS,
+						  NULL, 0, NULL, SQL_DRIVER_NOPROMPT);
+	CHECK_CONN_RESULT(rc, "SQLDriverConnect failed", conn2);
+	rc = SQLAllocHandle(SQL_HANDLE_STMT, conn2, &hstmt2);
+	CHECK_CONN_RESULT(rc, "SQLAllocHandle failed", conn2);
+
+	exec_ddl(hstmt2, "create table snapshottab (a int4)");
+	print_columns(hstmt, "snapshottab", NULL);
+	rc = SQLEndTran(SQL_HANDLE_DBC, conn, SQL_COMMIT);
+	CHECK_CONN_RESULT(rc, "SQLEndTran failed", conn);
+	print_columns(hstmt, "snapshottab", NULL);
+	exec_ddl(hstmt2, "drop table snapshottab");
+
+	rc = SQLFreeHandle(SQL_HANDLE_STMT, hstmt2);
+	CHECK_STMT_RESULT(rc, "SQLFreeHandle failed", hstmt2);
+	rc = SQLDisconnect(conn2);
+	CHECK_CONN_RESULT(rc, "SQLDisconnect failed", conn2);
+	rc = SQLFreeHandle(SQL_HANDLE_DBC, conn2);
+	CHECK_CONN_RESULT(rc, "SQLFreeHandle failed", conn2);
+
+	/* Clean up */
+	test_disconnect();
+
+	return 0;
+}
@@ -0,0 +1,148 @@
+/*
+ * Test the registry of the connections of an environment.
+ *
+ * Many connection handles are allocated and freed in mixed order, and
+ * SQLEndTran on the environment must commit the transactions of the
+ * connected ones among them, and only those.
+ */
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "common.h"
+
+#define NUM_HANDLES	200
+#define NUM_CONNECTED	3
+
+static void
+connect_handle(HDBC hdbc)
+{
+	SQLRETURN	rc;
+	SQLCHAR		dsn[1024];
+
+	snprintf((char *) dsn, sizeof(dsn), "DSN=%s", get_test_dsn());
+	rc = SQLDriverConnect(hdbc, NULL, dsn, SQL_NTS, NULL, 0, NULL,
+						  SQL_DRIVER_NOPROMPT);
+	if (!SQL_SUCCEEDED(rc))
+	{
+		print_diag("SQLDriverConnect failed", SQL_HANDLE_DBC, hdbc);
+		exit(1);
+	}
+	rc = SQLSetConnectAttr(hdbc, SQL_ATTR_AUTOCOMMIT, (SQLPOINTER) SQL_AUTOCOMMIT_OFF, SQL_IS_UINTEGER);
+	CHECK_CONN_RESULT(rc, "SQLSetConnectAttr failed", hdbc);
+}
+
+static void
+exec_sql(HDBC hdbc, char *sql)
+{
+	SQLRETURN	rc;
+	HSTMT		hstmt = SQL_NULL_HSTMT;
+
+	rc = SQLAllocHandle(SQL_HANDLE_STMT, hdbc, &hstmt);
+	CHECK_CONN_RESULT(rc, "failed to allocate stmt handle", hdbc);
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) sql, SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	rc = SQLFreeHandle(SQL_HANDLE_STMT, hstmt);
+	CHECK_STMT_RESULT(rc, "SQLFreeHandle failed", hstmt);
+}
+
+int
+main(int argc, char **argv)
+{
+	SQLRETURN	rc;
+	HENV		henv;
+	HDBC		hdbcs[NUM_HANDLES];
+	HSTMT		hstmt = SQL_NULL_HSTMT;
+	char		sql[100];
+	int			i;
+
+	test_connect();
+
+	rc = SQLAllocHandle(SQL_HANDLE_STMT, conn, &hstmt);
+	if (!SQL_SUCCEEDED(rc))
+	{
+		print_diag("failed to allocate stmt handle", SQL_HANDLE_DBC, conn);
+		exit(1);
+	}
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) "DROP TABLE IF EXISTS test_conn_registry", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) "CREATE TABLE test_conn_registry (id int4)", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+
+	SQLAllocHandle(SQL_HANDLE_ENV, SQL_NULL_HANDLE, &henv);
+	SQLSetEnvAttr(henv, SQL_ATTR_ODBC_VERSION, (void *) SQL_OV_ODBC3, 0);
+
+	for (i = 0; i < NUM_HANDLES; i++)
+	{
+		rc = SQLAllocHandle(SQL_HANDLE_DBC, henv, &hdbcs[i]);
+		if (!SQL_SUCCEEDED(rc))
+		{
+			print_diag("SQLAllocHandle failed", SQL_HANDLE_ENV, henv);
+			exit(1);
+		}
+	}
+	/* Free every other handle, and allocate them again */
+	for (i = 0; i < NUM_HANDLES; i += 2)
+	{
+		rc = SQLFreeHandle(SQL_HANDLE_DBC, hdbcs[i]);
+		CHECK_CONN_RESULT(rc, "SQLFreeHandle failed", hdbcs[i]);
+	}
+	for (i = NUM_HANDLES - 2; i >= 0; i -= 2)
+	{
+		rc = SQLAllocHandle(SQL_HANDLE_DBC, henv, &hdbcs[i]);
+		if (!SQL_SUCCEEDED(rc))
+		{
+			print_diag("SQLAllocHandle failed", SQL_HANDLE_ENV, henv);
+			exit(1);
+		}
+	}
+
+	/* Insert a row in a transaction on a few of them */
+	for (i = 0; i < NUM_CONNECTED; i++)
+	{
+		connect_handle(hdbcs[i * 50]);
+		sprintf(sql, "INSERT INTO test_conn_registry VALUES (%d)", i);
+		exec_sql(hdbcs[i * 50], sql);
+	}
+
+	/* Commit them all at once */
+	rc = SQLEndTran(SQL_HANDLE_ENV, henv, SQL_COMMIT);
+	if (!SQL_SUCCEEDED(rc))
+	{
+		print_diag("SQLEndTran failed", SQL_HANDLE_ENV, henv);
+		exit(1);
+	}
+	printf("committed on the environment\n");
+
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) "SELECT id FROM test_conn_registry ORDER BY id", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	print_result(hstmt);
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+
+	for (i = 0; i < NUM_HANDLES; i++)
+	{
+		if (0 == i % 50 && i / 50 < NUM_CONNECTED)
+		{
+			rc = SQLDisconnect(hdbcs[i]);
+			CHECK_CONN_RESULT(rc, "SQLDisconnect failed", hdbcs[i]);
+		}
+		rc = SQLFreeHandle(SQL_HANDLE_DBC, hdbcs[i]);
+		CHECK_CONN_RESULT(rc, "SQLFreeHandle failed", hdbcs[i]);
+	}
+	rc = SQLFreeHandle(SQL_HANDLE_ENV, henv);
+	if (!SQL_SUCCEEDED(rc))
+	{
+		print_diag("SQLFreeHandle failed", SQL_HANDLE_ENV, henv);
+		exit(1);
+	}
+	printf("freed %d connection handles\n", NUM_HANDLES);
+
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) "DROP TABLE test_conn_registry", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+
+	/* Clean up */
+	test_disconnect();
+
+	return 0;
+}
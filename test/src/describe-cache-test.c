@@ -0,0 +1,147 @@
+/*
+ * Test the DescribeCache option, with which the description of a prepared
+ * statement asked before SQLExecute is cached on the connection.
+ *
+ * A repeated description must be answered without contacting the server,
+ * and the cache must not be used after DDL or a ROLLBACK, nor for another
+ * search_path.
+ */
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/* Must come before sql.h (declared in common.h) to suppress a warning */
+#include "../../pgapifunc.h"
+
+#include "common.h"
+
+#define PERF_ROUND_TRIPS	0
+#define NUM_PERF_COUNTERS	9
+
+static SQLBIGINT
+get_round_trips(void)
+{
+	SQLBIGINT	counters[NUM_PERF_COUNTERS];
+	SQLINTEGER	len;
+	int			rc;
+
+	rc = SQLGetConnectAttr(conn, SQL_ATTR_PGOPT_PERFCOUNTERS, counters, sizeof(counters), &len);
+	CHECK_CONN_RESULT(rc, "SQLGetConnectAttr failed", conn);
+	return counters[PERF_ROUND_TRIPS];
+}
+
+static void
+exec_sql(HSTMT hstmt, char *sql)
+{
+	int			rc;
+
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) sql, SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+}
+
+/*
+ * Prepare a query, describe its result columns, and execute it. Prints
+ * whether the description needed the server if 'print_cached' is set.
+ */
+static void
+describe_and_execute(HSTMT hstmt, char *sql, int print_cached)
+{
+	int			rc;
+	SQLINTEGER	param = 1;
+	SQLLEN		cbParam = 0;
+	SQLSMALLINT colcount, i;
+	SQLCHAR		colname[64];
+	SQLSMALLINT namelen, datatype, decdigits, nullable;
+	SQLULEN		colsize;
+	SQLBIGINT	before;
+
+	printf("Describing %s\n", sql);
+	rc = SQLPrepare(hstmt, (SQLCHAR *) sql, SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLPrepare failed", hstmt);
+	if (strchr(sql, '?'))
+	{
+		rc = SQLBindParameter(hstmt, 1, SQL_PARAM_INPUT,
+							  SQL_C_SLONG, SQL_INTEGER, 0, 0,
+							  &param, 0, &cbParam);
+		CHECK_STMT_RESULT(rc, "SQLBindParameter failed", hstmt);
+	}
+
+	before = get_round_trips();
+	rc = SQLNumResultCols(hstmt, &colcount);
+	CHECK_STMT_RESULT(rc, "SQLNumResultCols failed", hstmt);
+	printf("# of result cols: %d\n", colcount);
+	for (i = 1; i <= colcount; i++)
+	{
+		rc = SQLDescribeCol(hstmt, i, colname, sizeof(colname), &namelen,
+							&datatype, &colsize, &decdigits, &nullable);
+		CHECK_STMT_RESULT(rc, "SQLDescribeCol failed", hstmt);
+		printf("column %d: %s\n", i, colname);
+	}
+	if (print_cached)
+		printf("described %s\n", get_round_trips() == before ? "from the cache" : "by the server");
+
+	rc = SQLExecute(hstmt);
+	CHECK_STMT_RESULT(rc, "SQLExecute failed", hstmt);
+	print_result(hstmt);
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+	rc = SQLFreeStmt(hstmt, SQL_RESET_PARAMS);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+}
+
+int
+main(int argc, char **argv)
+{
+	int			rc;
+	HSTMT		hstmt = SQL_NULL_HSTMT;
+
+	test_connect_ext("DescribeCache=8");
+
+	rc = SQLAllocHandle(SQL_HANDLE_STMT, conn, &hstmt);
+	if (!SQL_SUCCEEDED(rc))
+	{
+		print_diag("failed to allocate stmt handle", SQL_HANDLE_DBC, conn);
+		exit(1);
+	}
+
+	/* The second description comes from the cache */
+	describe_and_execute(hstmt, "SELECT id, t FROM testtab1 WHERE id = ?", 1);
+	describe_and_execute(hstmt, "SELECT id, t FROM testtab1 WHERE id = ?", 1);
+
+	/* DDL discards the cached descriptions */
+	exec_sql(hstmt, "CREATE TEMPORARY TABLE desccachetab (a int4)");
+	exec_sql(hstmt, "INSERT INTO desccachetab VALUES (10)");
+	describe_and_execute(hstmt, "SELECT * FROM desccachetab", 1);
+	describe_and_execute(hstmt, "SELECT * FROM desccachetab", 1);
+	exec_sql(hstmt, "ALTER TABLE desccachetab ADD COLUMN b varchar(10) DEFAULT 'foo'");
+	describe_and_execute(hstmt, "SELECT * FROM desccachetab", 1);
+
+	/* So does a ROLLBACK, which may undo DDL */
+	exec_sql(hstmt, "BEGIN");
+	exec_sql(hstmt, "ALTER TABLE desccachetab DROP COLUMN b");
+	describe_and_execute(hstmt, "SELECT * FROM desccachetab", 1);
+	exec_sql(hstmt, "ROLLBACK");
+	describe_and_execute(hstmt, "SELECT * FROM desccachetab", 1);
+
+	/* The same query text in another search_path */
+	exec_sql(hstmt, "DROP SCHEMA IF EXISTS desccache_a, desccache_b CASCADE");
+	exec_sql(hstmt, "CREATE SCHEMA desccache_a");
+	exec_sql(hstmt, "CREATE SCHEMA desccache_b");
+	exec_sql(hstmt, "CREATE TABLE desccache_a.desccache_s AS SELECT 1 AS a");
+	exec_sql(hstmt, "CREATE TABLE desccache_b.desccache_s AS SELECT 'x'::text AS b, 2 AS c");
+	exec_sql(hstmt, "SET search_path = desccache_a, public");
+	describe_and_execute(hstmt, "SELECT * FROM desccache_s", 0);
+	exec_sql(hstmt, "SET search_path = desccache_b, public");
+	describe_and_execute(hstmt, "SELECT * FROM desccache_s", 0);
+	exec_sql(hstmt, "SET search_path = desccache_a, public");
+	describe_and_execute(hstmt, "SELECT * FROM desccache_s", 0);
+	exec_sql(hstmt, "RESET search_path");
+	exec_sql(hstmt, "DROP SCHEMA desccache_a, desccache_b CASCADE");
+
+	/* Clean up */
+	test_disconnect();
+
+	return 0;
+}
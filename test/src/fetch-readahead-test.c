@@ -0,0 +1,189 @@
+/*
+ * Test the FetchReadAhead option, with which the driver sends the FETCH
+ * for the next block of a declare/fetch cursor in advance.
+ *
+ * The results must be the same as without read-ahead, also when the
+ * connection is used by another statement between the blocks, when the
+ * rowset size isn't a multiple of the fetch size, when the rowsets are
+ * positioned with SQLSetPos, and when a later block fails.
+ */
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "common.h"
+
+static void
+print_sqlstate(const char *msg, HSTMT hstmt)
+{
+	SQLCHAR		sqlstate[32];
+	SQLCHAR		message[1000];
+	SQLINTEGER	nativeerror;
+	SQLSMALLINT textlen;
+
+	if (SQL_SUCCEEDED(SQLGetDiagRec(SQL_HANDLE_STMT, hstmt, 1, sqlstate, &nativeerror, message, sizeof(message), &textlen)))
+		printf("%s: %s\n", msg, sqlstate);
+	else
+		printf("%s: no error information\n", msg);
+}
+
+int
+main(int argc, char **argv)
+{
+	int			rc;
+	HSTMT		hstmt = SQL_NULL_HSTMT;
+	HSTMT		hstmt2 = SQL_NULL_HSTMT;
+	SQLINTEGER	id;
+	SQLINTEGER	ids[15];
+	SQLLEN		ind;
+	SQLLEN		inds[15];
+	SQLULEN		rowsFetched;
+	int			count;
+	int			sum;
+	int			blocks;
+
+	test_connect_ext("UseDeclareFetch=1;Fetch=10;FetchReadAhead=1");
+
+	rc = SQLAllocHandle(SQL_HANDLE_STMT, conn, &hstmt);
+	if (!SQL_SUCCEEDED(rc))
+	{
+		print_diag("failed to allocate stmt handle", SQL_HANDLE_DBC, conn);
+		exit(1);
+	}
+	rc = SQLAllocHandle(SQL_HANDLE_STMT, conn, &hstmt2);
+	if (!SQL_SUCCEEDED(rc))
+	{
+		print_diag("failed to allocate stmt handle", SQL_HANDLE_DBC, conn);
+		exit(1);
+	}
+
+	/* Stream through a cursor */
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) "SELECT g FROM generate_series(1, 95) g", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	rc = SQLBindCol(hstmt, 1, SQL_C_SLONG, &id, 0, &ind);
+	CHECK_STMT_RESULT(rc, "SQLBindCol failed", hstmt);
+	count = sum = 0;
+	while (rc = SQLFetch(hstmt), SQL_SUCCEEDED(rc))
+	{
+		count++;
+		sum += id;
+	}
+	if (SQL_NO_DATA != rc)
+		CHECK_STMT_RESULT(rc, "SQLFetch failed", hstmt);
+	printf("streamed %d rows, sum %d\n", count, sum);
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+
+	/* Use the connection for another statement while the cursor is read */
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) "SELECT g FROM generate_series(1, 50) g", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	count = sum = 0;
+	while (rc = SQLFetch(hstmt), SQL_SUCCEEDED(rc))
+	{
+		count++;
+		sum += id;
+		if (count % 7 == 0)
+		{
+			SQLINTEGER	val;
+
+			rc = SQLExecDirect(hstmt2, (SQLCHAR *) "SELECT 1000 + 1", SQL_NTS);
+			CHECK_STMT_RESULT(rc, "SQLExecDirect on the 2nd stmt failed", hstmt2);
+			rc = SQLFetch(hstmt2);
+			CHECK_STMT_RESULT(rc, "SQLFetch on the 2nd stmt failed", hstmt2);
+			rc = SQLGetData(hstmt2, 1, SQL_C_SLONG, &val, 0, &ind);
+			CHECK_STMT_RESULT(rc, "SQLGetData failed", hstmt2);
+			sum += val - 1001;
+			rc = SQLFreeStmt(hstmt2, SQL_CLOSE);
+			CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt2);
+		}
+	}
+	if (SQL_NO_DATA != rc)
+		CHECK_STMT_RESULT(rc, "SQLFetch failed", hstmt);
+	printf("interleaved %d rows, sum %d\n", count, sum);
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+	rc = SQLFreeStmt(hstmt, SQL_UNBIND);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+
+	/* A rowset size which isn't a multiple of the fetch size */
+	rc = SQLSetStmtAttr(hstmt, SQL_ATTR_ROW_ARRAY_SIZE, (SQLPOINTER) 15, 0);
+	CHECK_STMT_RESULT(rc, "SQLSetStmtAttr ROW_ARRAY_SIZE failed", hstmt);
+	rc = SQLSetStmtAttr(hstmt, SQL_ATTR_ROWS_FETCHED_PTR, (SQLPOINTER) &rowsFetched, 0);
+	CHECK_STMT_RESULT(rc, "SQLSetStmtAttr ROWS_FETCHED_PTR failed", hstmt);
+	rc = SQLBindCol(hstmt, 1, SQL_C_SLONG, ids, 0, inds);
+	CHECK_STMT_RESULT(rc, "SQLBindCol failed", hstmt);
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) "SELECT g FROM generate_series(1, 100) g", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	blocks = count = 0;
+	while (rc = SQLFetch(hstmt), SQL_SUCCEEDED(rc))
+	{
+		blocks++;
+		count += (int) rowsFetched;
+		printf("rowset %d: %d rows from %d to %d\n", blocks, (int) rowsFetched, (int) ids[0], (int) ids[rowsFetched - 1]);
+	}
+	if (SQL_NO_DATA != rc)
+		CHECK_STMT_RESULT(rc, "SQLFetch failed", hstmt);
+	printf("fetched %d rows in %d rowsets\n", count, blocks);
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+
+	/*
+	 * Position within each rowset with SQLSetPos while the next block is
+	 * read ahead, and try to scroll backwards, which a forward-only
+	 * cursor doesn't allow.
+	 */
+	rc = SQLSetStmtAttr(hstmt, SQL_ATTR_ROW_ARRAY_SIZE, (SQLPOINTER) 4, 0);
+	CHECK_STMT_RESULT(rc, "SQLSetStmtAttr ROW_ARRAY_SIZE failed", hstmt);
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) "SELECT g, g * 10 FROM generate_series(1, 30) g", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	blocks = 0;
+	while (rc = SQLFetchScroll(hstmt, SQL_FETCH_NEXT, 0), SQL_SUCCEEDED(rc))
+	{
+		SQLINTEGER	val;
+
+		blocks++;
+		rc = SQLSetPos(hstmt, (SQLSETPOSIROW) rowsFetched, SQL_POSITION, SQL_LOCK_NO_CHANGE);
+		CHECK_STMT_RESULT(rc, "SQLSetPos failed", hstmt);
+		rc = SQLGetData(hstmt, 2, SQL_C_SLONG, &val, 0, &ind);
+		CHECK_STMT_RESULT(rc, "SQLGetData failed", hstmt);
+		printf("rowset %d: %d rows from %d to %d, last row has %d\n", blocks, (int) rowsFetched, (int) ids[0], (int) ids[rowsFetched - 1], (int) val);
+		if (1 == blocks)
+		{
+			rc = SQLFetchScroll(hstmt, SQL_FETCH_FIRST, 0);
+			if (SQL_SUCCEEDED(rc))
+				printf("SQLFetchScroll FIRST unexpectedly succeeded\n");
+			else
+				print_sqlstate("SQLFetchScroll FIRST failed", hstmt);
+		}
+	}
+	if (SQL_NO_DATA != rc)
+		CHECK_STMT_RESULT(rc, "SQLFetchScroll failed", hstmt);
+	printf("fetched %d rowsets\n", blocks);
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+	rc = SQLFreeStmt(hstmt, SQL_UNBIND);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+	rc = SQLSetStmtAttr(hstmt, SQL_ATTR_ROW_ARRAY_SIZE, (SQLPOINTER) 1, 0);
+	CHECK_STMT_RESULT(rc, "SQLSetStmtAttr ROW_ARRAY_SIZE failed", hstmt);
+
+	/* An error in a block read ahead is reported when the block is reached */
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) "SELECT 100 / (35 - g) FROM generate_series(1, 50) g", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	rc = SQLBindCol(hstmt, 1, SQL_C_SLONG, &id, 0, &ind);
+	CHECK_STMT_RESULT(rc, "SQLBindCol failed", hstmt);
+	count = 0;
+	while (rc = SQLFetch(hstmt), SQL_SUCCEEDED(rc))
+		count++;
+	printf("fetched %d rows before the error\n", count);
+	if (SQL_NO_DATA == rc)
+		printf("unexpected end of data\n");
+	else
+		print_sqlstate("SQLFetch failed", hstmt);
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+
+	/* Clean up */
+	test_disconnect();
+
+	return 0;
+}
@@ -0,0 +1,132 @@
+/*
+ * Test reading long text and bytea values with SQLGetData in small pieces.
+ *
+ * The driver converts such values piece by piece, resuming from where the
+ * previous piece ended, so the pieces put together must be the same as the
+ * value read at once. That includes the LF -> CR/LF conversion, multibyte
+ * characters and surrogate pairs split at the end of a piece, and bytea in
+ * hex format.
+ */
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "common.h"
+
+#define VALUE_SIZE	100000
+
+static void
+test_pieces(HSTMT hstmt, SQLSMALLINT ctype, int termlen, const char *name)
+{
+	int			rc;
+	char	   *whole = malloc(VALUE_SIZE);
+	char	   *pieces = malloc(VALUE_SIZE);
+	char		buf[1000];
+	SQLLEN		wholelen, ind, firstind = 0, bufsize, got;
+	SQLLEN		total = 0;
+	int			npieces = 0;
+
+	/* Read the 1st column at once */
+	rc = SQLGetData(hstmt, 1, ctype, whole, VALUE_SIZE, &wholelen);
+	CHECK_STMT_RESULT(rc, "SQLGetData failed", hstmt);
+
+	/* and the 2nd one, which has the same value, in pieces */
+	for (;;)
+	{
+		/* a few tiny pieces first to split the characters */
+		bufsize = (npieces < 20) ? (npieces % 4 + 1) * 2 + termlen : sizeof(buf);
+		rc = SQLGetData(hstmt, 2, ctype, buf, bufsize, &ind);
+		if (SQL_NO_DATA == rc)
+			break;
+		CHECK_STMT_RESULT(rc, "SQLGetData failed", hstmt);
+		if (0 == npieces)
+			firstind = ind;
+		if (SQL_SUCCESS_WITH_INFO == rc)
+			got = bufsize - termlen;
+		else
+			got = ind;
+		if (total + got > VALUE_SIZE)
+		{
+			printf("%s: too much data\n", name);
+			break;
+		}
+		memcpy(pieces + total, buf, got);
+		total += got;
+		npieces++;
+	}
+
+	printf("%s: length %d, 1st piece claims %d, %s\n", name,
+		   (int) wholelen, (int) firstind,
+		   (total == wholelen && 0 == memcmp(whole, pieces, total)) ? "pieces match" : "pieces DIFFER");
+
+	free(whole);
+	free(pieces);
+}
+
+int
+main(int argc, char **argv)
+{
+	int			rc;
+	HSTMT		hstmt = SQL_NULL_HSTMT;
+	char	   *sql;
+
+	/* Enable LF -> CR+LF conversion */
+	test_connect_ext("CX=1");
+
+	rc = SQLAllocHandle(SQL_HANDLE_STMT, conn, &hstmt);
+	if (!SQL_SUCCEEDED(rc))
+	{
+		print_diag("failed to allocate stmt handle", SQL_HANDLE_DBC, conn);
+		exit(1);
+	}
+
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) "SET bytea_output = 'hex'", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+
+	/* text to char */
+	sql = "SELECT t, t FROM (SELECT repeat(E'line\\n\\r\\nx\\n', 1000) AS t) s";
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) sql, SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	rc = SQLFetch(hstmt);
+	CHECK_STMT_RESULT(rc, "SQLFetch failed", hstmt);
+	test_pieces(hstmt, SQL_C_CHAR, 1, "text as SQL_C_CHAR");
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+
+	/* text with multibyte characters and surrogate pairs to wide char */
+	sql = "SELECT t, t FROM (SELECT repeat(E'line\\n\\r\\nx' || U&'\\00E9\\+01F600' || E'\\n', 1000) AS t) s";
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) sql, SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	rc = SQLFetch(hstmt);
+	CHECK_STMT_RESULT(rc, "SQLFetch failed", hstmt);
+	test_pieces(hstmt, SQL_C_WCHAR, sizeof(SQLWCHAR), "text as SQL_C_WCHAR");
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+
+	sql = "SELECT b, b FROM (SELECT decode(repeat('00ff0a0d7e', 5000), 'hex') AS b) s";
+
+	/* bytea to binary */
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) sql, SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	rc = SQLFetch(hstmt);
+	CHECK_STMT_RESULT(rc, "SQLFetch failed", hstmt);
+	test_pieces(hstmt, SQL_C_BINARY, 0, "bytea as SQL_C_BINARY");
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+
+	/* bytea to char */
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) sql, SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	rc = SQLFetch(hstmt);
+	CHECK_STMT_RESULT(rc, "SQLFetch failed", hstmt);
+	test_pieces(hstmt, SQL_C_CHAR, 1, "bytea as SQL_C_CHAR");
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+
+	/* Clean up */
+	test_disconnect();
+
+	return 0;
+}
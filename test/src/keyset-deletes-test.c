@@ -0,0 +1,171 @@
+/*
+ * Test scrolling a keyset-driven cursor over many deleted and updated
+ * rows, and rolling the changes back.
+ *
+ * With UseDeclareFetch=1, the deleted and updated rows are kept in
+ * sorted index arrays, and SQLFetchScroll skips the deleted rows by
+ * searching them.  A savepoint rollback brings the rows back.
+ */
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "common.h"
+
+#define	TOTAL	300
+
+static void
+fetch_at(HSTMT hstmt, SQLSMALLINT orientation, SQLLEN offset, const char *label)
+{
+	int			rc;
+	SQLINTEGER	id;
+	SQLLEN		ind;
+	char		val[32];
+	SQLLEN		ind2;
+
+	rc = SQLFetchScroll(hstmt, orientation, offset);
+	if (SQL_NO_DATA == rc)
+	{
+		printf("%s: no data\n", label);
+		return;
+	}
+	CHECK_STMT_RESULT(rc, "SQLFetchScroll failed", hstmt);
+	rc = SQLGetData(hstmt, 1, SQL_C_SLONG, &id, 0, &ind);
+	CHECK_STMT_RESULT(rc, "SQLGetData failed", hstmt);
+	rc = SQLGetData(hstmt, 2, SQL_C_CHAR, val, sizeof(val), &ind2);
+	CHECK_STMT_RESULT(rc, "SQLGetData failed", hstmt);
+	printf("%s: %d %s\n", label, (int) id, val);
+}
+
+static void
+count_rows(HSTMT hstmt, const char *label)
+{
+	int			rc;
+	int			count = 0;
+	SQLINTEGER	id;
+	SQLLEN		ind;
+	long		sum = 0;
+
+	rc = SQLFetchScroll(hstmt, SQL_FETCH_FIRST, 0);
+	while (SQL_SUCCEEDED(rc))
+	{
+		rc = SQLGetData(hstmt, 1, SQL_C_SLONG, &id, 0, &ind);
+		CHECK_STMT_RESULT(rc, "SQLGetData failed", hstmt);
+		count++;
+		sum += id;
+		rc = SQLFetchScroll(hstmt, SQL_FETCH_NEXT, 0);
+	}
+	if (SQL_NO_DATA != rc)
+		CHECK_STMT_RESULT(rc, "SQLFetchScroll failed", hstmt);
+	printf("%s: %d rows, sum %ld\n", label, count, sum);
+}
+
+int
+main(int argc, char **argv)
+{
+	int			rc;
+	HSTMT		hstmt = SQL_NULL_HSTMT;
+	HSTMT		hstmte = SQL_NULL_HSTMT;
+	char		query[100];
+	int			i;
+	SQLINTEGER	id;
+	SQLLEN		ind;
+	char		val[32];
+	SQLLEN		ind2;
+
+	test_connect_ext("UpdatableCursors=1;UseDeclareFetch=1;Fetch=17");
+
+	rc = SQLAllocHandle(SQL_HANDLE_STMT, conn, &hstmt);
+	if (!SQL_SUCCEEDED(rc))
+	{
+		print_diag("failed to allocate stmt handle", SQL_HANDLE_DBC, conn);
+		exit(1);
+	}
+	rc = SQLAllocHandle(SQL_HANDLE_STMT, conn, &hstmte);
+	if (!SQL_SUCCEEDED(rc))
+	{
+		print_diag("failed to allocate stmt handle", SQL_HANDLE_DBC, conn);
+		exit(1);
+	}
+
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) "create temporary table tmptable(id int4 primary key, t varchar(20))", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect create table failed", hstmt);
+	snprintf(query, sizeof(query), "insert into tmptable select g, 'v' || g from generate_series(1, %d) g", TOTAL);
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) query, SQL_NTS);
+	CHECK_STMT_RESULT(rc, "insert into table failed", hstmt);
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+
+	rc = SQLSetConnectAttr(conn, SQL_AUTOCOMMIT, (SQLPOINTER) SQL_AUTOCOMMIT_OFF, 0);
+	CHECK_CONN_RESULT(rc, "SQLSetConnectAttr AUTOCOMMIT failed", conn);
+	rc = SQLSetStmtAttr(hstmt, SQL_ATTR_CONCURRENCY, (SQLPOINTER) SQL_CONCUR_ROWVER, 0);
+	CHECK_STMT_RESULT(rc, "SQLSetStmtAttr CONCURRENCY failed", hstmt);
+	rc = SQLSetStmtAttr(hstmt, SQL_ATTR_CURSOR_TYPE, (SQLPOINTER) SQL_CURSOR_KEYSET_DRIVEN, 0);
+	CHECK_STMT_RESULT(rc, "SQLSetStmtAttr CURSOR_TYPE failed", hstmt);
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) "select id, t from tmptable order by id", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "select failed", hstmt);
+	rc = SQLExecDirect(hstmte, (SQLCHAR *) "savepoint keyset", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "savepoint failed", hstmte);
+
+	/* Delete every 3rd row, from the end so that the indexes are unordered */
+	for (i = TOTAL; i > 0; i--)
+	{
+		if (i % 3 != 0)
+			continue;
+		rc = SQLFetchScroll(hstmt, SQL_FETCH_ABSOLUTE, i);
+		CHECK_STMT_RESULT(rc, "SQLFetchScroll failed", hstmt);
+		rc = SQLSetPos(hstmt, 1, SQL_DELETE, SQL_LCK_NO_CHANGE);
+		CHECK_STMT_RESULT(rc, "SQLSetPos delete failed", hstmt);
+	}
+	/* Update every 5th row which isn't deleted */
+	rc = SQLBindCol(hstmt, 1, SQL_C_SLONG, &id, 0, &ind);
+	CHECK_STMT_RESULT(rc, "SQLBindCol failed", hstmt);
+	rc = SQLBindCol(hstmt, 2, SQL_C_CHAR, val, sizeof(val), &ind2);
+	CHECK_STMT_RESULT(rc, "SQLBindCol failed", hstmt);
+	for (i = 5; i <= TOTAL; i += 5)
+	{
+		if (i % 3 == 0)
+			continue;
+		/* the i-th row is the (i - i / 3)-th one not deleted */
+		rc = SQLFetchScroll(hstmt, SQL_FETCH_ABSOLUTE, i - i / 3);
+		CHECK_STMT_RESULT(rc, "SQLFetchScroll failed", hstmt);
+		if (id != i)
+			printf("row %d found at %d\n", (int) id, i);
+		snprintf(val, sizeof(val), "updated %d", i);
+		ind2 = SQL_NTS;
+		rc = SQLSetPos(hstmt, 1, SQL_UPDATE, SQL_LCK_NO_CHANGE);
+		CHECK_STMT_RESULT(rc, "SQLSetPos update failed", hstmt);
+	}
+	rc = SQLFreeStmt(hstmt, SQL_UNBIND);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+
+	/* Scroll over the deleted rows */
+	fetch_at(hstmt, SQL_FETCH_FIRST, 0, "first");
+	fetch_at(hstmt, SQL_FETCH_ABSOLUTE, 3, "absolute 3");
+	fetch_at(hstmt, SQL_FETCH_RELATIVE, 10, "relative 10");
+	fetch_at(hstmt, SQL_FETCH_RELATIVE, -7, "relative -7");
+	fetch_at(hstmt, SQL_FETCH_ABSOLUTE, 200, "absolute 200");
+	fetch_at(hstmt, SQL_FETCH_ABSOLUTE, 201, "absolute 201");
+	fetch_at(hstmt, SQL_FETCH_LAST, 0, "last");
+	fetch_at(hstmt, SQL_FETCH_ABSOLUTE, -2, "absolute -2");
+	fetch_at(hstmt, SQL_FETCH_PRIOR, 0, "prior");
+	count_rows(hstmt, "after the changes");
+
+	/* Roll the changes back */
+	rc = SQLExecDirect(hstmte, (SQLCHAR *) "rollback to keyset;release keyset", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "rollback failed", hstmte);
+	fetch_at(hstmt, SQL_FETCH_ABSOLUTE, 3, "absolute 3");
+	fetch_at(hstmt, SQL_FETCH_ABSOLUTE, 200, "absolute 200");
+	fetch_at(hstmt, SQL_FETCH_LAST, 0, "last");
+	count_rows(hstmt, "after the rollback");
+
+	rc = SQLEndTran(SQL_HANDLE_DBC, conn, SQL_ROLLBACK);
+	CHECK_STMT_RESULT(rc, "SQLEndTran failed", hstmt);
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+
+	/* Clean up */
+	test_disconnect();
+
+	return 0;
+}
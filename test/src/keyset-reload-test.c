@@ -0,0 +1,116 @@
+/*
+ * Test reloading the rows of a keyset-driven cursor.
+ *
+ * The rows of each rowset are reloaded by their ctids with a single
+ * execution of a prepared statement. Scroll back and forth with rowsets
+ * of different sizes, and check that every row comes back complete.
+ */
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "common.h"
+
+#define	TOTAL	300
+#define	BLOCK	70
+
+static int
+check_rowset(const char *label, SQLULEN rowsFetched, SQLINTEGER *ids, SQLCHAR vals[][20])
+{
+	SQLULEN		i;
+	char		expected[20];
+	int			sum = 0;
+
+	for (i = 0; i < rowsFetched; i++)
+	{
+		snprintf(expected, sizeof(expected), "val %d", (int) ids[i]);
+		if (strcmp((char *) vals[i], expected) != 0)
+			printf("%s: row %d has \"%s\", expected \"%s\"\n", label, (int) i, vals[i], expected);
+		sum += ids[i];
+	}
+	printf("%s: %d rows from %d to %d, sum %d\n", label, (int) rowsFetched,
+		   rowsFetched > 0 ? (int) ids[0] : 0,
+		   rowsFetched > 0 ? (int) ids[rowsFetched - 1] : 0, sum);
+	return sum;
+}
+
+int main(int argc, char **argv)
+{
+	int			rc;
+	HSTMT		hstmt = SQL_NULL_HSTMT;
+	SQLULEN		rowsFetched;
+	SQLINTEGER	ids[BLOCK];
+	SQLLEN		idinds[BLOCK];
+	SQLCHAR		vals[BLOCK][20];
+	SQLLEN		valinds[BLOCK];
+	int			total;
+
+	test_connect_ext("UpdatableCursors=1");
+
+	rc = SQLAllocHandle(SQL_HANDLE_STMT, conn, &hstmt);
+	if (!SQL_SUCCEEDED(rc))
+	{
+		print_diag("failed to allocate stmt handle", SQL_HANDLE_DBC, conn);
+		exit(1);
+	}
+
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) "create temporary table keysettbl (id int4 primary key, val text)", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect create table failed", hstmt);
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) "insert into keysettbl select g, 'val ' || g from generate_series(1, 300) g", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "insert into table failed", hstmt);
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+
+	rc = SQLSetStmtAttr(hstmt, SQL_ATTR_ROWS_FETCHED_PTR, (SQLPOINTER) &rowsFetched, 0);
+	CHECK_STMT_RESULT(rc, "SQLSetStmtAttr ROWS_FETCHED_PTR failed", hstmt);
+	rc = SQLSetStmtAttr(hstmt, SQL_ATTR_ROW_ARRAY_SIZE, (SQLPOINTER) BLOCK, 0);
+	CHECK_STMT_RESULT(rc, "SQLSetStmtAttr ROW_ARRAY_SIZE failed", hstmt);
+	rc = SQLSetStmtAttr(hstmt, SQL_ATTR_CONCURRENCY, (SQLPOINTER) SQL_CONCUR_ROWVER, 0);
+	CHECK_STMT_RESULT(rc, "SQLSetStmtAttr CONCURRENCY failed", hstmt);
+	rc = SQLSetStmtAttr(hstmt, SQL_ATTR_CURSOR_TYPE, (SQLPOINTER) SQL_CURSOR_KEYSET_DRIVEN, 0);
+	CHECK_STMT_RESULT(rc, "SQLSetStmtAttr CURSOR_TYPE failed", hstmt);
+	rc = SQLBindCol(hstmt, 1, SQL_C_SLONG, ids, 0, idinds);
+	CHECK_STMT_RESULT(rc, "SQLBindCol failed", hstmt);
+	rc = SQLBindCol(hstmt, 2, SQL_C_CHAR, vals, sizeof(vals[0]), valinds);
+	CHECK_STMT_RESULT(rc, "SQLBindCol failed", hstmt);
+
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) "select id, val from keysettbl order by id", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "select failed", hstmt);
+
+	/* forward to the end */
+	total = 0;
+	while (rc = SQLFetchScroll(hstmt, SQL_FETCH_NEXT, 0), SQL_SUCCEEDED(rc))
+		total += check_rowset("next", rowsFetched, ids, vals);
+	if (SQL_NO_DATA != rc)
+		CHECK_STMT_RESULT(rc, "SQLFetchScroll failed", hstmt);
+	printf("forward sum %d\n", total);
+
+	/* and back to the beginning */
+	total = 0;
+	while (rc = SQLFetchScroll(hstmt, SQL_FETCH_PRIOR, 0), SQL_SUCCEEDED(rc))
+		total += check_rowset("prior", rowsFetched, ids, vals);
+	if (SQL_NO_DATA != rc)
+		CHECK_STMT_RESULT(rc, "SQLFetchScroll failed", hstmt);
+	printf("backward sum %d\n", total);
+
+	/* jump around with a smaller rowset */
+	rc = SQLSetStmtAttr(hstmt, SQL_ATTR_ROW_ARRAY_SIZE, (SQLPOINTER) 7, 0);
+	CHECK_STMT_RESULT(rc, "SQLSetStmtAttr ROW_ARRAY_SIZE failed", hstmt);
+	rc = SQLFetchScroll(hstmt, SQL_FETCH_ABSOLUTE, 250);
+	CHECK_STMT_RESULT(rc, "SQLFetchScroll failed", hstmt);
+	check_rowset("absolute 250", rowsFetched, ids, vals);
+	rc = SQLFetchScroll(hstmt, SQL_FETCH_ABSOLUTE, 3);
+	CHECK_STMT_RESULT(rc, "SQLFetchScroll failed", hstmt);
+	check_rowset("absolute 3", rowsFetched, ids, vals);
+	rc = SQLFetchScroll(hstmt, SQL_FETCH_LAST, 0);
+	CHECK_STMT_RESULT(rc, "SQLFetchScroll failed", hstmt);
+	check_rowset("last", rowsFetched, ids, vals);
+
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+
+	/* Clean up */
+	test_disconnect();
+
+	return 0;
+}
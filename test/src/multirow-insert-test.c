@@ -0,0 +1,135 @@
+/*
+ * Test the MultiRowInsert option, with which the rows of a parameter array
+ * batched by BatchSize are sent as one multi-row INSERT.
+ *
+ * A statement level trigger counts the INSERT statements the server ran.
+ * The status of each row and the number of processed rows must be the
+ * same as without the option, also when a batch fails.
+ */
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "common.h"
+
+#define BATCHCNT	10
+
+static void
+exec_sql(HSTMT hstmt, char *sql)
+{
+	int			rc;
+
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) sql, SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+}
+
+static void
+print_counts(HSTMT hstmt)
+{
+	int			rc;
+
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) "SELECT (SELECT count(*) FROM test_multirow), (SELECT count(*) FROM test_multirow_log)", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	printf("rows, statements:\n");
+	print_result(hstmt);
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+	exec_sql(hstmt, "TRUNCATE test_multirow, test_multirow_log");
+}
+
+static void
+insert_rows(HSTMT hstmt, char *sql, SQLCHAR strs[][10])
+{
+	int			rc;
+	int			i;
+	SQLINTEGER	vals[BATCHCNT];
+	SQLUSMALLINT status[BATCHCNT];
+	SQLULEN		processed;
+
+	for (i = 0; i < BATCHCNT; i++)
+		vals[i] = i;
+	rc = SQLSetStmtAttr(hstmt, SQL_ATTR_PARAMSET_SIZE, (SQLPOINTER) BATCHCNT, 0);
+	CHECK_STMT_RESULT(rc, "SQLSetStmtAttr PARAMSET_SIZE failed", hstmt);
+	rc = SQLSetStmtAttr(hstmt, SQL_ATTR_PARAM_STATUS_PTR, status, 0);
+	CHECK_STMT_RESULT(rc, "SQLSetStmtAttr PARAM_STATUS_PTR failed", hstmt);
+	rc = SQLSetStmtAttr(hstmt, SQL_ATTR_PARAMS_PROCESSED_PTR, &processed, 0);
+	CHECK_STMT_RESULT(rc, "SQLSetStmtAttr PARAMS_PROCESSED_PTR failed", hstmt);
+	rc = SQLBindParameter(hstmt, 1, SQL_PARAM_INPUT, SQL_C_SLONG, SQL_INTEGER, 0, 0, vals, 0, NULL);
+	CHECK_STMT_RESULT(rc, "SQLBindParameter 1 failed", hstmt);
+	rc = SQLBindParameter(hstmt, 2, SQL_PARAM_INPUT, SQL_C_CHAR, SQL_CHAR, sizeof(strs[0]), 0, strs, sizeof(strs[0]), NULL);
+	CHECK_STMT_RESULT(rc, "SQLBindParameter 2 failed", hstmt);
+
+	printf("executing %s\n", sql);
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) sql, SQL_NTS);
+	printf("returns %d\n", rc);
+	if (!SQL_SUCCEEDED(rc))
+		print_diag("", SQL_HANDLE_STMT, hstmt);
+	printf("%d rows processed\n", (int) processed);
+	for (i = 0; i < BATCHCNT; i++)
+	{
+		printf("row %d status=%s\n", i,
+			   (status[i] == SQL_PARAM_SUCCESS ? "success" :
+				(status[i] == SQL_PARAM_UNUSED ? "unused" :
+				 (status[i] == SQL_PARAM_ERROR ? "error" :
+				  (status[i] == SQL_PARAM_SUCCESS_WITH_INFO ? "success_with_info" : "????")))));
+	}
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+	rc = SQLFreeStmt(hstmt, SQL_RESET_PARAMS);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+	rc = SQLSetStmtAttr(hstmt, SQL_ATTR_PARAMSET_SIZE, (SQLPOINTER) 1, 0);
+	CHECK_STMT_RESULT(rc, "SQLSetStmtAttr PARAMSET_SIZE failed", hstmt);
+	rc = SQLSetStmtAttr(hstmt, SQL_ATTR_PARAM_STATUS_PTR, NULL, 0);
+	CHECK_STMT_RESULT(rc, "SQLSetStmtAttr PARAM_STATUS_PTR failed", hstmt);
+	rc = SQLSetStmtAttr(hstmt, SQL_ATTR_PARAMS_PROCESSED_PTR, NULL, 0);
+	CHECK_STMT_RESULT(rc, "SQLSetStmtAttr PARAMS_PROCESSED_PTR failed", hstmt);
+
+	print_counts(hstmt);
+}
+
+int
+main(int argc, char **argv)
+{
+	int			rc;
+	HSTMT		hstmt = SQL_NULL_HSTMT;
+	SQLCHAR		strs[BATCHCNT][10] = {"a", "b", "c(", "d)", "e'", "f", "g", "h", "i", "j"};
+
+	test_connect_ext("BatchSize=4;MultiRowInsert=1");
+
+	rc = SQLAllocHandle(SQL_HANDLE_STMT, conn, &hstmt);
+	if (!SQL_SUCCEEDED(rc))
+	{
+		print_diag("failed to allocate stmt handle", SQL_HANDLE_DBC, conn);
+		exit(1);
+	}
+
+	exec_sql(hstmt, "CREATE TEMPORARY TABLE test_multirow (id int4 PRIMARY KEY, dt varchar(4))");
+	exec_sql(hstmt, "CREATE TEMPORARY TABLE test_multirow_log (n int4)");
+	exec_sql(hstmt,
+			 "CREATE OR REPLACE FUNCTION test_multirow_count() RETURNS TRIGGER"
+			 " AS $$ BEGIN INSERT INTO test_multirow_log VALUES (1); RETURN NULL; END; $$"
+			 " LANGUAGE plpgsql");
+	exec_sql(hstmt,
+			 "CREATE TRIGGER test_multirow_count AFTER INSERT ON test_multirow"
+			 " FOR EACH STATEMENT EXECUTE PROCEDURE test_multirow_count()");
+
+	/* One INSERT for each batch */
+	insert_rows(hstmt, "INSERT INTO test_multirow (id, dt) VALUES (?, ?)", strs);
+
+	/* Comments and a trailing semicolon */
+	insert_rows(hstmt, "/* the rows */ INSERT INTO test_multirow VALUES (? + 0, /* dt */ ?);", strs);
+
+	/* Not a simple INSERT, the rows are sent as separate statements */
+	insert_rows(hstmt, "INSERT INTO test_multirow VALUES (?, ?) ON CONFLICT DO NOTHING", strs);
+
+	/* The 2nd batch fails */
+	strcpy((char *) strs[6], "too long");
+	insert_rows(hstmt, "INSERT INTO test_multirow VALUES (?, ?)", strs);
+
+	/* Clean up */
+	test_disconnect();
+
+	return 0;
+}
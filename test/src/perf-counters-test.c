@@ -0,0 +1,111 @@
+/*
+ * Test the driver-specific SQL_ATTR_PGOPT_PERFCOUNTERS attribute.
+ *
+ * The counters depend on the connection options (e.g. UseDeclareFetch
+ * issues additional round trips), so only the stable ones are printed.
+ */
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/* Must come before sql.h (declared in common.h) to suppress a warning */
+#include "../../pgapifunc.h"
+
+#include "common.h"
+
+/* the order of the counters returned */
+enum {
+	PERF_ROUND_TRIPS = 0,
+	PERF_BYTES_SENT,
+	PERF_BYTES_RECEIVED,
+	PERF_ROWS_FETCHED,
+	PERF_RESULTS,
+	PERF_ROUNDTRIP_USEC,
+	PERF_CONVERT_USEC,
+	PERF_TUPLE_MALLOCS,
+	PERF_PLAN_HITS,
+	NUM_PERF_COUNTERS
+};
+
+static void
+print_counters(const char *label, SQLBIGINT *counters)
+{
+	printf("%s: round trips %s, bytes sent %s, bytes received %d, rows fetched %d, results %s, tuple mallocs %d\n",
+		   label,
+		   counters[PERF_ROUND_TRIPS] > 0 ? "> 0" : "= 0",
+		   counters[PERF_BYTES_SENT] > 0 ? "> 0" : "= 0",
+		   (int) counters[PERF_BYTES_RECEIVED],
+		   (int) counters[PERF_ROWS_FETCHED],
+		   counters[PERF_RESULTS] > 0 ? "> 0" : "= 0",
+		   (int) counters[PERF_TUPLE_MALLOCS]);
+}
+
+int
+main(int argc, char **argv)
+{
+	int			rc;
+	HSTMT		hstmt = SQL_NULL_HSTMT;
+	SQLBIGINT	counters[NUM_PERF_COUNTERS];
+	SQLINTEGER	len;
+	SQLINTEGER	id;
+
+	test_connect();
+
+	rc = SQLAllocHandle(SQL_HANDLE_STMT, conn, &hstmt);
+	if (!SQL_SUCCEEDED(rc))
+	{
+		print_diag("failed to allocate stmt handle", SQL_HANDLE_DBC, conn);
+		exit(1);
+	}
+
+	/* Reset the connection counters and enable the conversion timing */
+	rc = SQLSetConnectAttr(conn, SQL_ATTR_PGOPT_PERFCOUNTERS, (SQLPOINTER) 0, 0);
+	CHECK_CONN_RESULT(rc, "SQLSetConnectAttr failed", conn);
+	rc = SQLSetConnectAttr(conn, SQL_ATTR_PGOPT_PERFTIMING, (SQLPOINTER) 1, 0);
+	CHECK_CONN_RESULT(rc, "SQLSetConnectAttr failed", conn);
+
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) "SELECT g, 'x' || g FROM generate_series(1, 10) g", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	while (SQL_SUCCEEDED(rc = SQLFetch(hstmt)))
+	{
+		rc = SQLGetData(hstmt, 1, SQL_C_SLONG, &id, sizeof(id), NULL);
+		CHECK_STMT_RESULT(rc, "SQLGetData failed", hstmt);
+	}
+	if (rc != SQL_NO_DATA)
+		CHECK_STMT_RESULT(rc, "SQLFetch failed", hstmt);
+	printf("last id %d\n", (int) id);
+
+	memset(counters, 0, sizeof(counters));
+	rc = SQLGetStmtAttr(hstmt, SQL_ATTR_PGOPT_PERFCOUNTERS, counters, sizeof(counters), &len);
+	CHECK_STMT_RESULT(rc, "SQLGetStmtAttr failed", hstmt);
+	printf("length %d\n", (int) len);
+	print_counters("statement", counters);
+
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+
+	/* Resetting the statement counters doesn't affect the connection */
+	rc = SQLSetStmtAttr(hstmt, SQL_ATTR_PGOPT_PERFCOUNTERS, (SQLPOINTER) 0, 0);
+	CHECK_STMT_RESULT(rc, "SQLSetStmtAttr failed", hstmt);
+	rc = SQLGetStmtAttr(hstmt, SQL_ATTR_PGOPT_PERFCOUNTERS, counters, sizeof(counters), &len);
+	CHECK_STMT_RESULT(rc, "SQLGetStmtAttr failed", hstmt);
+	print_counters("statement after reset", counters);
+
+	rc = SQLGetConnectAttr(conn, SQL_ATTR_PGOPT_PERFCOUNTERS, counters, sizeof(counters), &len);
+	CHECK_CONN_RESULT(rc, "SQLGetConnectAttr failed", conn);
+	printf("connection: rows fetched %s\n", counters[PERF_ROWS_FETCHED] >= 10 ? ">= 10" : "< 10");
+
+	/* A small buffer gets the first counters and the length needed */
+	len = 0;
+	rc = SQLGetConnectAttr(conn, SQL_ATTR_PGOPT_PERFCOUNTERS, counters, 2 * sizeof(SQLBIGINT), &len);
+	printf("2 counters: %s, length %d\n", rc == SQL_SUCCESS_WITH_INFO ? "SQL_SUCCESS_WITH_INFO" : "unexpected result", (int) len);
+	print_diag(NULL, SQL_HANDLE_DBC, conn);
+	rc = SQLGetStmtAttr(hstmt, SQL_ATTR_PGOPT_PERFCOUNTERS, counters, 0, &len);
+	printf("no buffer: %s\n", rc == SQL_ERROR ? "SQL_ERROR" : "unexpected result");
+	print_diag(NULL, SQL_HANDLE_STMT, hstmt);
+
+	/* Clean up */
+	test_disconnect();
+
+	return 0;
+}
@@ -0,0 +1,227 @@
+/*
+ * Test the PortalFetch option, with which the driver reads forward-only
+ * cursors from the portal of the extended query protocol instead of
+ * DECLARE CURSOR and FETCH.
+ *
+ * The results must be the same as with DECLARE/FETCH, also when the
+ * connection is used by another statement while a portal is being read,
+ * when the statement is closed before all the rows are read, also within
+ * a transaction block, and when the query fails in a later block.
+ */
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "common.h"
+
+static void
+print_sqlstate(const char *msg, HSTMT hstmt)
+{
+	SQLCHAR		sqlstate[32];
+	SQLCHAR		message[1000];
+	SQLINTEGER	nativeerror;
+	SQLSMALLINT textlen;
+
+	if (SQL_SUCCEEDED(SQLGetDiagRec(SQL_HANDLE_STMT, hstmt, 1, sqlstate, &nativeerror, message, sizeof(message), &textlen)))
+		printf("%s: %s\n", msg, sqlstate);
+	else
+		printf("%s: no error information\n", msg);
+}
+
+int
+main(int argc, char **argv)
+{
+	int			rc;
+	HSTMT		hstmt = SQL_NULL_HSTMT;
+	HSTMT		hstmt2 = SQL_NULL_HSTMT;
+	SQLINTEGER	id;
+	SQLINTEGER	param;
+	SQLINTEGER	ids[15];
+	SQLLEN		ind;
+	SQLLEN		inds[15];
+	SQLULEN		rowsFetched;
+	int			count;
+	int			sum;
+	int			blocks;
+
+	test_connect_ext("UseDeclareFetch=1;Fetch=10;PortalFetch=1");
+
+	rc = SQLAllocHandle(SQL_HANDLE_STMT, conn, &hstmt);
+	if (!SQL_SUCCEEDED(rc))
+	{
+		print_diag("failed to allocate stmt handle", SQL_HANDLE_DBC, conn);
+		exit(1);
+	}
+	rc = SQLAllocHandle(SQL_HANDLE_STMT, conn, &hstmt2);
+	if (!SQL_SUCCEEDED(rc))
+	{
+		print_diag("failed to allocate stmt handle", SQL_HANDLE_DBC, conn);
+		exit(1);
+	}
+
+	/* Stream through a portal */
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) "SELECT g FROM generate_series(1, 95) g", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	rc = SQLBindCol(hstmt, 1, SQL_C_SLONG, &id, 0, &ind);
+	CHECK_STMT_RESULT(rc, "SQLBindCol failed", hstmt);
+	count = sum = 0;
+	while (rc = SQLFetch(hstmt), SQL_SUCCEEDED(rc))
+	{
+		count++;
+		sum += id;
+	}
+	if (SQL_NO_DATA != rc)
+		CHECK_STMT_RESULT(rc, "SQLFetch failed", hstmt);
+	printf("streamed %d rows, sum %d\n", count, sum);
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+
+	/* A prepared statement with a parameter, executed twice */
+	rc = SQLPrepare(hstmt, (SQLCHAR *) "SELECT g FROM generate_series(1, ?) g", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLPrepare failed", hstmt);
+	rc = SQLBindParameter(hstmt, 1, SQL_PARAM_INPUT, SQL_C_SLONG, SQL_INTEGER, 0, 0, &param, 0, NULL);
+	CHECK_STMT_RESULT(rc, "SQLBindParameter failed", hstmt);
+	for (param = 25; param <= 30; param += 5)
+	{
+		rc = SQLExecute(hstmt);
+		CHECK_STMT_RESULT(rc, "SQLExecute failed", hstmt);
+		count = sum = 0;
+		while (rc = SQLFetch(hstmt), SQL_SUCCEEDED(rc))
+		{
+			count++;
+			sum += id;
+		}
+		if (SQL_NO_DATA != rc)
+			CHECK_STMT_RESULT(rc, "SQLFetch failed", hstmt);
+		printf("executed with %d: %d rows, sum %d\n", (int) param, count, sum);
+		rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+		CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+	}
+	rc = SQLFreeStmt(hstmt, SQL_RESET_PARAMS);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+
+	/* Close the statement before all the rows are read */
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) "SELECT g FROM generate_series(1, 1000) g", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	for (count = 0; count < 15; count++)
+	{
+		rc = SQLFetch(hstmt);
+		CHECK_STMT_RESULT(rc, "SQLFetch failed", hstmt);
+	}
+	printf("closing at row %d\n", (int) id);
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) "SELECT 42", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	rc = SQLFetch(hstmt);
+	CHECK_STMT_RESULT(rc, "SQLFetch failed", hstmt);
+	printf("next query returned %d\n", (int) id);
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+	rc = SQLFreeStmt(hstmt, SQL_UNBIND);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+
+	/* A rowset size which isn't a multiple of the fetch size */
+	rc = SQLSetStmtAttr(hstmt, SQL_ATTR_ROW_ARRAY_SIZE, (SQLPOINTER) 15, 0);
+	CHECK_STMT_RESULT(rc, "SQLSetStmtAttr ROW_ARRAY_SIZE failed", hstmt);
+	rc = SQLSetStmtAttr(hstmt, SQL_ATTR_ROWS_FETCHED_PTR, (SQLPOINTER) &rowsFetched, 0);
+	CHECK_STMT_RESULT(rc, "SQLSetStmtAttr ROWS_FETCHED_PTR failed", hstmt);
+	rc = SQLBindCol(hstmt, 1, SQL_C_SLONG, ids, 0, inds);
+	CHECK_STMT_RESULT(rc, "SQLBindCol failed", hstmt);
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) "SELECT g FROM generate_series(1, 100) g", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	blocks = count = 0;
+	while (rc = SQLFetch(hstmt), SQL_SUCCEEDED(rc))
+	{
+		blocks++;
+		count += (int) rowsFetched;
+		printf("rowset %d: %d rows from %d to %d\n", blocks, (int) rowsFetched, (int) ids[0], (int) ids[rowsFetched - 1]);
+	}
+	if (SQL_NO_DATA != rc)
+		CHECK_STMT_RESULT(rc, "SQLFetch failed", hstmt);
+	printf("fetched %d rows in %d rowsets\n", count, blocks);
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+	rc = SQLFreeStmt(hstmt, SQL_UNBIND);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+	rc = SQLSetStmtAttr(hstmt, SQL_ATTR_ROW_ARRAY_SIZE, (SQLPOINTER) 1, 0);
+	CHECK_STMT_RESULT(rc, "SQLSetStmtAttr ROW_ARRAY_SIZE failed", hstmt);
+
+	/* An error in a later block is reported when the block is reached */
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) "SELECT 100 / (35 - g) FROM generate_series(1, 50) g", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	rc = SQLBindCol(hstmt, 1, SQL_C_SLONG, &id, 0, &ind);
+	CHECK_STMT_RESULT(rc, "SQLBindCol failed", hstmt);
+	count = 0;
+	while (rc = SQLFetch(hstmt), SQL_SUCCEEDED(rc))
+		count++;
+	printf("fetched %d rows before the error\n", count);
+	if (SQL_NO_DATA == rc)
+		printf("unexpected end of data\n");
+	else
+		print_sqlstate("SQLFetch failed", hstmt);
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+
+	/* Close the statement early within a transaction block, which it must not abort */
+	rc = SQLSetConnectAttr(conn, SQL_ATTR_AUTOCOMMIT, (SQLPOINTER) SQL_AUTOCOMMIT_OFF, SQL_IS_UINTEGER);
+	CHECK_CONN_RESULT(rc, "SQLSetConnectAttr failed", conn);
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) "SELECT g FROM generate_series(1, 1000) g", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	for (count = 0; count < 15; count++)
+	{
+		rc = SQLFetch(hstmt);
+		CHECK_STMT_RESULT(rc, "SQLFetch failed", hstmt);
+	}
+	printf("closing at row %d in a transaction\n", (int) id);
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) "SELECT 43", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	rc = SQLFetch(hstmt);
+	CHECK_STMT_RESULT(rc, "SQLFetch failed", hstmt);
+	printf("next query returned %d\n", (int) id);
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+	rc = SQLEndTran(SQL_HANDLE_DBC, conn, SQL_COMMIT);
+	CHECK_CONN_RESULT(rc, "SQLEndTran failed", conn);
+	rc = SQLSetConnectAttr(conn, SQL_ATTR_AUTOCOMMIT, (SQLPOINTER) SQL_AUTOCOMMIT_ON, SQL_IS_UINTEGER);
+	CHECK_CONN_RESULT(rc, "SQLSetConnectAttr failed", conn);
+
+	/*
+	 * Use the connection for another statement while the portal is read.
+	 * The connection uses DECLARE/FETCH afterwards.
+	 */
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) "SELECT g FROM generate_series(1, 50) g", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	count = sum = 0;
+	while (rc = SQLFetch(hstmt), SQL_SUCCEEDED(rc))
+	{
+		count++;
+		sum += id;
+		if (count % 7 == 0)
+		{
+			SQLINTEGER	val;
+
+			rc = SQLExecDirect(hstmt2, (SQLCHAR *) "SELECT 1000 + 1", SQL_NTS);
+			CHECK_STMT_RESULT(rc, "SQLExecDirect on the 2nd stmt failed", hstmt2);
+			rc = SQLFetch(hstmt2);
+			CHECK_STMT_RESULT(rc, "SQLFetch on the 2nd stmt failed", hstmt2);
+			rc = SQLGetData(hstmt2, 1, SQL_C_SLONG, &val, 0, &ind);
+			CHECK_STMT_RESULT(rc, "SQLGetData failed", hstmt2);
+			sum += val - 1001;
+			rc = SQLFreeStmt(hstmt2, SQL_CLOSE);
+			CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt2);
+		}
+	}
+	if (SQL_NO_DATA != rc)
+		CHECK_STMT_RESULT(rc, "SQLFetch failed", hstmt);
+	printf("interleaved %d rows, sum %d\n", count, sum);
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+
+	/* Clean up */
+	test_disconnect();
+
+	return 0;
+}
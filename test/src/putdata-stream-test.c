@@ -0,0 +1,178 @@
+/*
+ * Test the StreamPutDataSize option, with which the data-at-execution
+ * values sent by SQLPutData are streamed to a large object once they get
+ * longer than the option, instead of being kept in memory.
+ *
+ * The values must arrive the same as when buffered, also when a CR/LF
+ * pair is split between two SQLPutData calls, and no large objects may be
+ * left behind, also when the data put is abandoned halfway.
+ */
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "common.h"
+
+#define TEXT_REPEAT	2000
+#define BYTEA_SIZE	20000
+
+/*
+ * Print the number of the large objects of the current user created since
+ * the first call. The other tests leave large objects behind.
+ */
+static void
+print_lo_count(HSTMT hstmt)
+{
+	static SQLINTEGER	initial = -1;
+	int			rc;
+	SQLINTEGER	count;
+	SQLLEN		ind;
+
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) "SELECT count(*) FROM pg_largeobject_metadata WHERE lomowner = (SELECT oid FROM pg_roles WHERE rolname = current_user)", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	rc = SQLFetch(hstmt);
+	CHECK_STMT_RESULT(rc, "SQLFetch failed", hstmt);
+	rc = SQLGetData(hstmt, 1, SQL_C_SLONG, &count, 0, &ind);
+	CHECK_STMT_RESULT(rc, "SQLGetData failed", hstmt);
+	if (initial < 0)
+		initial = count;
+	printf("new large objects: %d\n", (int) (count - initial));
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+}
+
+static void
+put_and_print(HSTMT hstmt, const char *sql, SQLSMALLINT ctype, SQLSMALLINT sqltype,
+			  const char *data, SQLLEN len, SQLLEN chunk)
+{
+	int			rc;
+	SQLLEN		ind = SQL_DATA_AT_EXEC;
+	SQLLEN		pos;
+	PTR			paramid;
+
+	rc = SQLBindParameter(hstmt, 1, SQL_PARAM_INPUT, ctype, sqltype,
+						  len, 0, (void *) 1, 0, &ind);
+	CHECK_STMT_RESULT(rc, "SQLBindParameter failed", hstmt);
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) sql, SQL_NTS);
+	if (rc != SQL_NEED_DATA)
+		CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	while ((rc = SQLParamData(hstmt, &paramid)) == SQL_NEED_DATA)
+	{
+		for (pos = 0; pos < len; pos += chunk)
+		{
+			rc = SQLPutData(hstmt, (SQLPOINTER) (data + pos),
+							pos + chunk > len ? len - pos : chunk);
+			CHECK_STMT_RESULT(rc, "SQLPutData failed", hstmt);
+		}
+	}
+	CHECK_STMT_RESULT(rc, "SQLParamData failed", hstmt);
+	print_result(hstmt);
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+	rc = SQLFreeStmt(hstmt, SQL_RESET_PARAMS);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+}
+
+/*
+ * Put more than StreamPutDataSize bytes of a value, but don't finish it.
+ * The statement is then closed, or freed if free_handle is set.
+ */
+static void
+put_and_abandon(HSTMT hstmt, const char *data, SQLLEN len, BOOL free_handle)
+{
+	int			rc;
+	SQLLEN		ind = SQL_DATA_AT_EXEC;
+	PTR			paramid;
+
+	rc = SQLBindParameter(hstmt, 1, SQL_PARAM_INPUT, SQL_C_BINARY, SQL_LONGVARBINARY,
+						  len, 0, (void *) 1, 0, &ind);
+	CHECK_STMT_RESULT(rc, "SQLBindParameter failed", hstmt);
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) "SELECT length(?::bytea)", SQL_NTS);
+	if (rc != SQL_NEED_DATA)
+		CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	rc = SQLParamData(hstmt, &paramid);
+	if (rc != SQL_NEED_DATA)
+		CHECK_STMT_RESULT(rc, "SQLParamData failed", hstmt);
+	rc = SQLPutData(hstmt, (SQLPOINTER) data, len);
+	CHECK_STMT_RESULT(rc, "SQLPutData failed", hstmt);
+
+	if (free_handle)
+	{
+		rc = SQLFreeHandle(SQL_HANDLE_STMT, hstmt);
+		CHECK_STMT_RESULT(rc, "SQLFreeHandle failed", hstmt);
+		printf("abandoned by SQLFreeHandle\n");
+	}
+	else
+	{
+		rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+		CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+		rc = SQLFreeStmt(hstmt, SQL_RESET_PARAMS);
+		CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+		printf("abandoned by SQLFreeStmt\n");
+	}
+}
+
+int
+main(int argc, char **argv)
+{
+	int			rc;
+	HSTMT		hstmt = SQL_NULL_HSTMT;
+	char	   *text = malloc(TEXT_REPEAT * 7 + 1);
+	char	   *bytea = malloc(BYTEA_SIZE);
+	int			i;
+
+	/* Stream the values longer than 1000 bytes, converting CR/LF -> LF */
+	test_connect_ext("UseServerSidePrepare=0;StreamPutDataSize=1000;LFConversion=1");
+
+	rc = SQLAllocHandle(SQL_HANDLE_STMT, conn, &hstmt);
+	if (!SQL_SUCCEEDED(rc))
+	{
+		print_diag("failed to allocate stmt handle", SQL_HANDLE_DBC, conn);
+		exit(1);
+	}
+
+	for (i = 0; i < TEXT_REPEAT; i++)
+		memcpy(text + i * 7, "line\r\nx", 7);
+	text[TEXT_REPEAT * 7] = '\0';
+	for (i = 0; i < BYTEA_SIZE; i++)
+		bytea[i] = (char) (i % 256);
+
+	print_lo_count(hstmt);
+
+	/* A long text in pieces of 5 bytes, splitting some of the CR/LF pairs */
+	put_and_print(hstmt,
+				  "SELECT length(x), (x = repeat(E'line\\nx', 2000))::int FROM (SELECT ?::text AS x) s",
+				  SQL_C_CHAR, SQL_LONGVARCHAR, text, TEXT_REPEAT * 7, 5);
+
+	/* A short one stays in memory */
+	put_and_print(hstmt,
+				  "SELECT length(x), (x = repeat(E'line\\nx', 10))::int FROM (SELECT ?::text AS x) s",
+				  SQL_C_CHAR, SQL_LONGVARCHAR, text, 70, 5);
+
+	/* A long bytea */
+	put_and_print(hstmt,
+				  "SELECT length(x), (x = (SELECT string_agg(set_byte('\\x00'::bytea, 0, i % 256), ''::bytea ORDER BY i) FROM generate_series(0, 19999) i))::int FROM (SELECT ?::bytea AS x) s",
+				  SQL_C_BINARY, SQL_LONGVARBINARY, bytea, BYTEA_SIZE, 3000);
+
+	print_lo_count(hstmt);
+
+	/* The large objects of the abandoned values must be removed too */
+	put_and_abandon(hstmt, bytea, BYTEA_SIZE, FALSE);
+	print_lo_count(hstmt);
+	put_and_abandon(hstmt, bytea, BYTEA_SIZE, TRUE);
+	rc = SQLAllocHandle(SQL_HANDLE_STMT, conn, &hstmt);
+	if (!SQL_SUCCEEDED(rc))
+	{
+		print_diag("failed to allocate stmt handle", SQL_HANDLE_DBC, conn);
+		exit(1);
+	}
+	print_lo_count(hstmt);
+
+	/* Clean up */
+	test_disconnect();
+
+	free(text);
+	free(bytea);
+
+	return 0;
+}
@@ -0,0 +1,117 @@
+/*
+ * Test the lexer which splits a query into tokens.
+ *
+ * The parameter markers of each query are counted with SQLNumParams and
+ * then the query is executed, so that a mistake in finding the end of a
+ * comment, a literal or a dollar quoted string shows up either in the
+ * count or in the results. Run with standard_conforming_strings on and
+ * off.
+ */
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "common.h"
+
+#define MAX_PARAMS	3
+
+static void
+runQuery(HSTMT hstmt, char *sql)
+{
+	static char	*params[MAX_PARAMS] = {"p1", "p2", "p3"};
+	SQLLEN		cbParams[MAX_PARAMS];
+	SQLSMALLINT	nparams;
+	int			rc, i;
+
+	printf("Query: %s\n", sql);
+	rc = SQLPrepare(hstmt, (SQLCHAR *) sql, SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLPrepare failed", hstmt);
+	rc = SQLNumParams(hstmt, &nparams);
+	CHECK_STMT_RESULT(rc, "SQLNumParams failed", hstmt);
+	printf("%d parameter(s)\n", nparams);
+	if (nparams > MAX_PARAMS)
+	{
+		printf("too many parameters\n");
+		exit(1);
+	}
+	for (i = 0; i < nparams; i++)
+	{
+		cbParams[i] = SQL_NTS;
+		rc = SQLBindParameter(hstmt, i + 1, SQL_PARAM_INPUT,
+							  SQL_C_CHAR, SQL_CHAR, 20, 0,
+							  params[i], 0, &cbParams[i]);
+		CHECK_STMT_RESULT(rc, "SQLBindParameter failed", hstmt);
+	}
+	rc = SQLExecute(hstmt);
+	CHECK_STMT_RESULT(rc, "SQLExecute failed", hstmt);
+	do
+	{
+		print_result(hstmt);
+	} while (SQL_SUCCEEDED(rc = SQLMoreResults(hstmt)));
+	if (rc != SQL_NO_DATA)
+		CHECK_STMT_RESULT(rc, "SQLMoreResults failed", hstmt);
+
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+	rc = SQLFreeStmt(hstmt, SQL_RESET_PARAMS);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+}
+
+static void
+runtest(HSTMT hstmt, int scs)
+{
+	char		sql[50];
+	int			rc;
+
+	snprintf(sql, sizeof(sql), "SET standard_conforming_strings=%s",
+			 scs ? "on" : "off");
+	printf("\n%s\n", sql);
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) sql, SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+
+	/* nested comments, with question marks and quotes in them */
+	runQuery(hstmt, "SELECT /* outer /* nested ? ' */ still ? comment */ ?::text");
+	runQuery(hstmt, "SELECT ?::text -- ? ' trailing comment");
+
+	/* dollar quoted strings containing $ and ? */
+	runQuery(hstmt, "SELECT $tag$a $ b ? $x$ c '$tag$, ?::text");
+	runQuery(hstmt, "SELECT $$d $t$ ?$$, ?::text, $q$e ? $$$q$");
+
+	/* E'' literals with backslash escapes */
+	runQuery(hstmt, "SELECT E'back\\\\slash \\' ? quote', ?::text");
+
+	/* backslash escapes in plain literals */
+	if (!scs)
+		runQuery(hstmt, "SELECT 'back\\\\slash \\' ? quote', ?::text");
+	else
+		runQuery(hstmt, "SELECT 'back\\slash ?', ?::text");
+
+	/* splitting into commands */
+	runQuery(hstmt, "SELECT ?::text; SELECT 'a;?', ?::text; SELECT 3 /* ; ? */");
+	runQuery(hstmt, "SELECT $$;?$$, ?::text ; SELECT \"?column?\" FROM (SELECT ?::text) s; SELECT ?::text -- ; ?");
+}
+
+int main(int argc, char **argv)
+{
+	int rc;
+	HSTMT hstmt = SQL_NULL_HSTMT;
+
+	test_connect();
+
+	rc = SQLAllocHandle(SQL_HANDLE_STMT, conn, &hstmt);
+	if (!SQL_SUCCEEDED(rc))
+	{
+		print_diag("failed to allocate stmt handle", SQL_HANDLE_DBC, conn);
+		exit(1);
+	}
+
+	runtest(hstmt, 1);
+	runtest(hstmt, 0);
+
+	/* Clean up */
+	test_disconnect();
+
+	return 0;
+}
@@ -0,0 +1,115 @@
+/*
+ * Test the re-executions of statements whose parameters are substituted
+ * by the driver (UseServerSidePrepare=0). The statement is converted once
+ * and only the parameters are resolved again on the next executions.
+ *
+ * The results must be the same as converting the statement every time,
+ * also when the values get longer, when a parameter is bound to another
+ * type between executions, and when the statement has comments, literals
+ * and ODBC escapes around the parameter markers.
+ */
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "common.h"
+
+static void
+execute_and_print(HSTMT hstmt)
+{
+	int			rc;
+
+	rc = SQLExecute(hstmt);
+	CHECK_STMT_RESULT(rc, "SQLExecute failed", hstmt);
+	print_result(hstmt);
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+}
+
+int
+main(int argc, char **argv)
+{
+	int			rc;
+	HSTMT		hstmt = SQL_NULL_HSTMT;
+	char		param1[100];
+	SQLINTEGER	param2;
+	SQLLEN		cbParam1;
+	SQLLEN		cbParam2;
+	int			i;
+
+	test_connect_ext("UseServerSidePrepare=0");
+
+	rc = SQLAllocHandle(SQL_HANDLE_STMT, conn, &hstmt);
+	if (!SQL_SUCCEEDED(rc))
+	{
+		print_diag("failed to allocate stmt handle", SQL_HANDLE_DBC, conn);
+		exit(1);
+	}
+
+	/* Markers between comments and literals */
+	rc = SQLPrepare(hstmt, (SQLCHAR *) "SELECT ? /* not a marker: ? */ || '?' || $$?$$, -- ?\n ? + 1", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLPrepare failed", hstmt);
+	rc = SQLBindParameter(hstmt, 1, SQL_PARAM_INPUT,
+						  SQL_C_CHAR, SQL_VARCHAR, 100, 0,
+						  param1, sizeof(param1), &cbParam1);
+	CHECK_STMT_RESULT(rc, "SQLBindParameter failed", hstmt);
+	rc = SQLBindParameter(hstmt, 2, SQL_PARAM_INPUT,
+						  SQL_C_SLONG, SQL_INTEGER, 0, 0,
+						  &param2, 0, &cbParam2);
+	CHECK_STMT_RESULT(rc, "SQLBindParameter failed", hstmt);
+
+	/* The values get longer, and one of them is NULL once */
+	for (i = 0; i < 4; i++)
+	{
+		memset(param1, 'x', i * 8);
+		param1[i * 8] = '\0';
+		strcat(param1, "'quoted'");
+		cbParam1 = SQL_NTS;
+		param2 = i * 1000;
+		cbParam2 = (2 == i) ? SQL_NULL_DATA : 0;
+		execute_and_print(hstmt);
+	}
+
+	/* Bind the 2nd parameter to another type */
+	strcpy(param1, "rebound");
+	rc = SQLBindParameter(hstmt, 2, SQL_PARAM_INPUT,
+						  SQL_C_CHAR, SQL_INTEGER, 10, 0,
+						  param1, sizeof(param1), &cbParam1);
+	CHECK_STMT_RESULT(rc, "SQLBindParameter failed", hstmt);
+	strcpy(param1, "42");
+	execute_and_print(hstmt);
+	rc = SQLFreeStmt(hstmt, SQL_RESET_PARAMS);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+
+	/* A parameter in an ODBC escape */
+	rc = SQLPrepare(hstmt, (SQLCHAR *) "SELECT {fn ucase(?)}, ?::int * 2", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLPrepare failed", hstmt);
+	rc = SQLBindParameter(hstmt, 1, SQL_PARAM_INPUT,
+						  SQL_C_CHAR, SQL_VARCHAR, 100, 0,
+						  param1, sizeof(param1), &cbParam1);
+	CHECK_STMT_RESULT(rc, "SQLBindParameter failed", hstmt);
+	rc = SQLBindParameter(hstmt, 2, SQL_PARAM_INPUT,
+						  SQL_C_SLONG, SQL_INTEGER, 0, 0,
+						  &param2, 0, &cbParam2);
+	CHECK_STMT_RESULT(rc, "SQLBindParameter failed", hstmt);
+	for (i = 0; i < 2; i++)
+	{
+		strcpy(param1, i ? "second" : "first");
+		cbParam1 = SQL_NTS;
+		param2 = i + 1;
+		cbParam2 = 0;
+		execute_and_print(hstmt);
+	}
+
+	/* A new statement on the same handle, with the same bindings */
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) "SELECT 'direct', ?, ? * 3", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	print_result(hstmt);
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+
+	/* Clean up */
+	test_disconnect();
+
+	return 0;
+}
@@ -0,0 +1,110 @@
+/*
+ * Test SQL_ATTR_QUERY_TIMEOUT.
+ *
+ * A query which runs longer than the timeout is cancelled, and the next
+ * queries on the connection must not be affected by the cancellation,
+ * whether they have a timeout or not. Where the driver measures the
+ * timeout itself, the statement_timeout of the session stays untouched.
+ */
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "common.h"
+
+static void
+print_sqlstate(const char *msg, HSTMT hstmt)
+{
+	SQLCHAR		sqlstate[32];
+	SQLCHAR		message[1000];
+	SQLINTEGER	nativeerror;
+	SQLSMALLINT textlen;
+
+	if (SQL_SUCCEEDED(SQLGetDiagRec(SQL_HANDLE_STMT, hstmt, 1, sqlstate, &nativeerror, message, sizeof(message), &textlen)))
+		printf("%s: %s\n", msg, sqlstate);
+	else
+		printf("%s: no error information\n", msg);
+}
+
+static void
+set_timeout(HSTMT hstmt, SQLULEN timeout)
+{
+	int			rc;
+
+	rc = SQLSetStmtAttr(hstmt, SQL_ATTR_QUERY_TIMEOUT, (SQLPOINTER) timeout, 0);
+	CHECK_STMT_RESULT(rc, "SQLSetStmtAttr QUERY_TIMEOUT failed", hstmt);
+}
+
+static void
+run_query(HSTMT hstmt, const char *sql)
+{
+	int			rc;
+
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) sql, SQL_NTS);
+	if (!SQL_SUCCEEDED(rc))
+		print_sqlstate("SQLExecDirect failed", hstmt);
+	else
+		print_result(hstmt);
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+}
+
+int
+main(int argc, char **argv)
+{
+	int			rc;
+	HSTMT		hstmt = SQL_NULL_HSTMT;
+	SQLDOUBLE	secs;
+	SQLLEN		ind = 0;
+
+	test_connect();
+
+	rc = SQLAllocHandle(SQL_HANDLE_STMT, conn, &hstmt);
+	if (!SQL_SUCCEEDED(rc))
+	{
+		print_diag("failed to allocate stmt handle", SQL_HANDLE_DBC, conn);
+		exit(1);
+	}
+
+	/* A query which exceeds the timeout is cancelled */
+	set_timeout(hstmt, 1);
+	run_query(hstmt, "SELECT 1 FROM pg_sleep(3)");
+
+	/* The next query with the same timeout runs normally */
+	run_query(hstmt, "SELECT 2 FROM pg_sleep(0.1)");
+
+	/* The setting of the session while a timeout is in effect */
+	run_query(hstmt, "SHOW statement_timeout");
+
+	/* Alternate queries with and without a timeout */
+	set_timeout(hstmt, 0);
+	run_query(hstmt, "SELECT 3 FROM pg_sleep(0.1)");
+	set_timeout(hstmt, 5);
+	run_query(hstmt, "SELECT 4 FROM pg_sleep(0.1)");
+	set_timeout(hstmt, 0);
+	run_query(hstmt, "SHOW statement_timeout");
+
+	/* Also with a prepared statement */
+	set_timeout(hstmt, 1);
+	rc = SQLPrepare(hstmt, (SQLCHAR *) "SELECT 5 FROM pg_sleep(?)", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLPrepare failed", hstmt);
+	rc = SQLBindParameter(hstmt, 1, SQL_PARAM_INPUT, SQL_C_DOUBLE, SQL_DOUBLE, 0, 0, &secs, 0, &ind);
+	CHECK_STMT_RESULT(rc, "SQLBindParameter failed", hstmt);
+	secs = 3;
+	rc = SQLExecute(hstmt);
+	if (!SQL_SUCCEEDED(rc))
+		print_sqlstate("SQLExecute failed", hstmt);
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+	secs = 0.1;
+	rc = SQLExecute(hstmt);
+	CHECK_STMT_RESULT(rc, "SQLExecute failed", hstmt);
+	print_result(hstmt);
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+
+	/* Clean up */
+	test_disconnect();
+
+	return 0;
+}
@@ -0,0 +1,124 @@
+/*
+ * Test the statement pool (StatementPoolSize option).
+ *
+ * A dropped statement handle is kept by the connection and reused by the
+ * next SQLAllocHandle. The reused handle must look like a new one: no
+ * bound columns or parameters, the default statement attributes and no
+ * cursor name, and no leftovers of the previous statement, even though it
+ * keeps the memory of its binding arrays.
+ */
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "common.h"
+
+static void
+print_desc_count(HSTMT hstmt, SQLINTEGER attr, const char *name)
+{
+	int			rc;
+	SQLHDESC	hdesc;
+	SQLSMALLINT	count;
+
+	rc = SQLGetStmtAttr(hstmt, attr, &hdesc, 0, NULL);
+	CHECK_STMT_RESULT(rc, "SQLGetStmtAttr failed", hstmt);
+	rc = SQLGetDescField(hdesc, 0, SQL_DESC_COUNT, &count, 0, NULL);
+	if (!SQL_SUCCEEDED(rc))
+	{
+		print_diag("SQLGetDescField failed", SQL_HANDLE_DESC, hdesc);
+		exit(1);
+	}
+	printf("%s count: %d\n", name, count);
+}
+
+static void
+print_stmt_attrs(HSTMT hstmt)
+{
+	int			rc;
+	SQLULEN		maxrows, cursortype, timeout;
+	SQLCHAR		cursorname[64];
+	SQLSMALLINT	namelen;
+
+	rc = SQLGetStmtAttr(hstmt, SQL_ATTR_MAX_ROWS, &maxrows, 0, NULL);
+	CHECK_STMT_RESULT(rc, "SQLGetStmtAttr failed", hstmt);
+	rc = SQLGetStmtAttr(hstmt, SQL_ATTR_CURSOR_TYPE, &cursortype, 0, NULL);
+	CHECK_STMT_RESULT(rc, "SQLGetStmtAttr failed", hstmt);
+	rc = SQLGetStmtAttr(hstmt, SQL_ATTR_QUERY_TIMEOUT, &timeout, 0, NULL);
+	CHECK_STMT_RESULT(rc, "SQLGetStmtAttr failed", hstmt);
+	rc = SQLGetCursorName(hstmt, cursorname, sizeof(cursorname), &namelen);
+	CHECK_STMT_RESULT(rc, "SQLGetCursorName failed", hstmt);
+	printf("max rows: %d, cursor type: %s, query timeout: %d, cursor name: '%s'\n",
+		   (int) maxrows,
+		   SQL_CURSOR_FORWARD_ONLY == cursortype ? "forward only" : "other",
+		   (int) timeout, cursorname);
+}
+
+int
+main(int argc, char **argv)
+{
+	int			rc;
+	HSTMT		hstmt = SQL_NULL_HSTMT;
+	SQLINTEGER	param;
+	SQLINTEGER	col1;
+	char		col2[20];
+	SQLLEN		ind1, ind2, indp;
+	int			i;
+	static const char *sqls[] = {
+		"SELECT id, t FROM testtab1 WHERE id = ? % 3 + 1",
+		"SELECT id, id, t FROM testtab1 WHERE id = ? % 3 + 1",
+		"SELECT id, id, id, t FROM testtab1 WHERE id = ? % 3 + 1",
+		"SELECT id, id, id, id, t FROM testtab1 WHERE id = ? % 3 + 1"
+	};
+
+	test_connect_ext("StatementPoolSize=2");
+
+	for (i = 0; i < 4; i++)
+	{
+		rc = SQLAllocHandle(SQL_HANDLE_STMT, conn, &hstmt);
+		if (!SQL_SUCCEEDED(rc))
+		{
+			print_diag("failed to allocate stmt handle", SQL_HANDLE_DBC, conn);
+			exit(1);
+		}
+
+		/* nothing is bound yet */
+		print_desc_count(hstmt, SQL_ATTR_APP_ROW_DESC, "ARD");
+		print_desc_count(hstmt, SQL_ATTR_APP_PARAM_DESC, "APD");
+		print_desc_count(hstmt, SQL_ATTR_IMP_PARAM_DESC, "IPD");
+		print_stmt_attrs(hstmt);
+
+		/* change the attributes, which the next user must not see */
+		rc = SQLSetStmtAttr(hstmt, SQL_ATTR_MAX_ROWS, (SQLPOINTER) 1, 0);
+		CHECK_STMT_RESULT(rc, "SQLSetStmtAttr failed", hstmt);
+		rc = SQLSetStmtAttr(hstmt, SQL_ATTR_CURSOR_TYPE, (SQLPOINTER) SQL_CURSOR_STATIC, 0);
+		CHECK_STMT_RESULT(rc, "SQLSetStmtAttr failed", hstmt);
+		rc = SQLSetStmtAttr(hstmt, SQL_ATTR_QUERY_TIMEOUT, (SQLPOINTER) 30, 0);
+		CHECK_STMT_RESULT(rc, "SQLSetStmtAttr failed", hstmt);
+		rc = SQLSetCursorName(hstmt, (SQLCHAR *) "pooled_cursor", SQL_NTS);
+		CHECK_STMT_RESULT(rc, "SQLSetCursorName failed", hstmt);
+
+		/* bind more columns each time */
+		rc = SQLBindCol(hstmt, 1, SQL_C_SLONG, &col1, 0, &ind1);
+		CHECK_STMT_RESULT(rc, "SQLBindCol failed", hstmt);
+		rc = SQLBindCol(hstmt, 2 + i, SQL_C_CHAR, col2, sizeof(col2), &ind2);
+		CHECK_STMT_RESULT(rc, "SQLBindCol failed", hstmt);
+		param = i;
+		indp = 0;
+		rc = SQLBindParameter(hstmt, 1, SQL_PARAM_INPUT, SQL_C_SLONG, SQL_INTEGER, 0, 0, &param, 0, &indp);
+		CHECK_STMT_RESULT(rc, "SQLBindParameter failed", hstmt);
+
+		rc = SQLExecDirect(hstmt, (SQLCHAR *) sqls[i], SQL_NTS);
+		CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+		rc = SQLFetch(hstmt);
+		CHECK_STMT_RESULT(rc, "SQLFetch failed", hstmt);
+		printf("%d: %d %s\n", i, (int) col1, col2);
+
+		rc = SQLFreeHandle(SQL_HANDLE_STMT, hstmt);
+		CHECK_STMT_RESULT(rc, "SQLFreeHandle failed", hstmt);
+	}
+
+	/* Clean up */
+	test_disconnect();
+
+	return 0;
+}
@@ -0,0 +1,209 @@
+/*
+ * Test the TupleCacheLimit option, with which the rows of a big result
+ * set are spilled to a temporary file and read back when accessed.
+ *
+ * The result here is about 5 MB, with a limit of 1 MB. The rows are
+ * read one by one, and then in rowsets of ROWSET rows, some of which
+ * have NULLs, which must not be taken for rows that couldn't be read
+ * back.
+ */
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "common.h"
+
+#define ROWSET		10
+
+static void
+print_row(HSTMT hstmt, const char *label)
+{
+	int			rc;
+	SQLINTEGER	id;
+	SQLLEN		ind;
+	char		buf[600];
+	char		expected[600];
+
+	rc = SQLGetData(hstmt, 1, SQL_C_SLONG, &id, 0, &ind);
+	CHECK_STMT_RESULT(rc, "SQLGetData failed", hstmt);
+	rc = SQLGetData(hstmt, 2, SQL_C_CHAR, buf, sizeof(buf), &ind);
+	CHECK_STMT_RESULT(rc, "SQLGetData failed", hstmt);
+	memset(expected, 'x', 500);
+	sprintf(expected + 500, "%d", (int) id);
+	printf("%s: row %d, %s\n", label, (int) id,
+		   strcmp(buf, expected) == 0 ? "value ok" : "value differs");
+}
+
+/* In the second query every third value is NULL */
+static void
+fetch_rowset(HSTMT hstmt, SQLLEN start, SQLINTEGER *ids, char (*bufs)[600], SQLLEN *inds, SQLULEN *rowsFetched)
+{
+	int			rc;
+	SQLULEN		i;
+	int			nulls = 0, bad = 0;
+
+	rc = SQLFetchScroll(hstmt, SQL_FETCH_ABSOLUTE, start);
+	CHECK_STMT_RESULT(rc, "SQLFetchScroll failed", hstmt);
+	for (i = 0; i < *rowsFetched; i++)
+	{
+		if (ids[i] != start + i)
+			bad++;
+		else if (SQL_NULL_DATA == inds[i])
+		{
+			if (0 != ids[i] % 3)
+				bad++;
+			nulls++;
+		}
+		else if (0 == ids[i] % 3 || atoi(bufs[i] + 500) != ids[i])
+			bad++;
+	}
+	printf("rowset from %d: %d rows, %d NULLs, %d bad\n",
+		   (int) start, (int) *rowsFetched, nulls, bad);
+}
+
+static void
+get_data_at(HSTMT hstmt, SQLSETPOSIROW row)
+{
+	int			rc;
+	SQLINTEGER	id;
+	SQLLEN		ind;
+	char		buf[600];
+
+	rc = SQLSetPos(hstmt, row, SQL_POSITION, SQL_LOCK_NO_CHANGE);
+	CHECK_STMT_RESULT(rc, "SQLSetPos failed", hstmt);
+	rc = SQLGetData(hstmt, 1, SQL_C_SLONG, &id, 0, &ind);
+	CHECK_STMT_RESULT(rc, "SQLGetData failed", hstmt);
+	rc = SQLGetData(hstmt, 2, SQL_C_CHAR, buf, sizeof(buf), &ind);
+	CHECK_STMT_RESULT(rc, "SQLGetData failed", hstmt);
+	if (SQL_NULL_DATA == ind)
+		printf("row %d of the rowset: row %d, NULL\n", (int) row, (int) id);
+	else
+		printf("row %d of the rowset: row %d, %s\n", (int) row, (int) id,
+			   atoi(buf + 500) == id ? "value ok" : "value differs");
+}
+
+int
+main(int argc, char **argv)
+{
+	int			rc;
+	HSTMT		hstmt = SQL_NULL_HSTMT;
+	SQLINTEGER	id;
+	SQLLEN		ind;
+	char		buf[600];
+	SQLLEN		ind2;
+	int			count;
+	long		sum;
+	int			bad;
+	SQLINTEGER	ids[ROWSET];
+	SQLLEN		id_inds[ROWSET];
+	char		bufs[ROWSET][600];
+	SQLLEN		inds[ROWSET];
+	SQLULEN		rowsFetched;
+
+	test_connect_ext("TupleCacheLimit=1");
+
+	rc = SQLAllocHandle(SQL_HANDLE_STMT, conn, &hstmt);
+	if (!SQL_SUCCEEDED(rc))
+	{
+		print_diag("failed to allocate stmt handle", SQL_HANDLE_DBC, conn);
+		exit(1);
+	}
+	rc = SQLSetStmtAttr(hstmt, SQL_ATTR_CURSOR_TYPE, (SQLPOINTER) SQL_CURSOR_STATIC, 0);
+	CHECK_STMT_RESULT(rc, "SQLSetStmtAttr CURSOR_TYPE failed", hstmt);
+
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) "SELECT g, repeat('x', 500) || g FROM generate_series(1, 10000) g", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+
+	/* Read all the rows forward */
+	rc = SQLBindCol(hstmt, 1, SQL_C_SLONG, &id, 0, &ind);
+	CHECK_STMT_RESULT(rc, "SQLBindCol failed", hstmt);
+	rc = SQLBindCol(hstmt, 2, SQL_C_CHAR, buf, sizeof(buf), &ind2);
+	CHECK_STMT_RESULT(rc, "SQLBindCol failed", hstmt);
+	count = bad = 0;
+	sum = 0;
+	while (rc = SQLFetch(hstmt), SQL_SUCCEEDED(rc))
+	{
+		count++;
+		sum += id;
+		if (ind2 != 500 + (SQLLEN) strlen(buf + 500) || atoi(buf + 500) != id)
+			bad++;
+	}
+	if (SQL_NO_DATA != rc)
+		CHECK_STMT_RESULT(rc, "SQLFetch failed", hstmt);
+	printf("read %d rows, sum %ld, %d bad values\n", count, sum, bad);
+	rc = SQLFreeStmt(hstmt, SQL_UNBIND);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+
+	/* Jump around, so that spilled rows are read back */
+	rc = SQLFetchScroll(hstmt, SQL_FETCH_ABSOLUTE, 1);
+	CHECK_STMT_RESULT(rc, "SQLFetchScroll failed", hstmt);
+	print_row(hstmt, "absolute 1");
+	rc = SQLFetchScroll(hstmt, SQL_FETCH_ABSOLUTE, 5000);
+	CHECK_STMT_RESULT(rc, "SQLFetchScroll failed", hstmt);
+	print_row(hstmt, "absolute 5000");
+	rc = SQLFetchScroll(hstmt, SQL_FETCH_ABSOLUTE, 2);
+	CHECK_STMT_RESULT(rc, "SQLFetchScroll failed", hstmt);
+	print_row(hstmt, "absolute 2");
+	rc = SQLFetchScroll(hstmt, SQL_FETCH_LAST, 0);
+	CHECK_STMT_RESULT(rc, "SQLFetchScroll failed", hstmt);
+	print_row(hstmt, "last");
+	rc = SQLFetchScroll(hstmt, SQL_FETCH_RELATIVE, -7500);
+	CHECK_STMT_RESULT(rc, "SQLFetchScroll failed", hstmt);
+	print_row(hstmt, "relative -7500");
+	rc = SQLFetchScroll(hstmt, SQL_FETCH_PRIOR, 0);
+	CHECK_STMT_RESULT(rc, "SQLFetchScroll failed", hstmt);
+	print_row(hstmt, "prior");
+
+	/* Read the rows backward */
+	count = bad = 0;
+	sum = 0;
+	rc = SQLFetchScroll(hstmt, SQL_FETCH_LAST, 0);
+	while (SQL_SUCCEEDED(rc))
+	{
+		rc = SQLGetData(hstmt, 1, SQL_C_SLONG, &id, 0, &ind);
+		CHECK_STMT_RESULT(rc, "SQLGetData failed", hstmt);
+		if (id != 10000 - count)
+			bad++;
+		count++;
+		sum += id;
+		rc = SQLFetchScroll(hstmt, SQL_FETCH_PRIOR, 0);
+	}
+	if (SQL_NO_DATA != rc)
+		CHECK_STMT_RESULT(rc, "SQLFetchScroll failed", hstmt);
+	printf("read %d rows backward, sum %ld, %d out of order\n", count, sum, bad);
+
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+
+	/* Fetch rowsets with NULLs, which are spilled as well */
+	rc = SQLSetStmtAttr(hstmt, SQL_ATTR_ROW_ARRAY_SIZE, (SQLPOINTER) ROWSET, 0);
+	CHECK_STMT_RESULT(rc, "SQLSetStmtAttr ROW_ARRAY_SIZE failed", hstmt);
+	rc = SQLSetStmtAttr(hstmt, SQL_ATTR_ROWS_FETCHED_PTR, (SQLPOINTER) &rowsFetched, 0);
+	CHECK_STMT_RESULT(rc, "SQLSetStmtAttr ROWS_FETCHED_PTR failed", hstmt);
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) "SELECT g, CASE WHEN g % 3 = 0 THEN NULL ELSE repeat('y', 500) || g END FROM generate_series(1, 10000) g", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	rc = SQLBindCol(hstmt, 1, SQL_C_SLONG, ids, 0, id_inds);
+	CHECK_STMT_RESULT(rc, "SQLBindCol failed", hstmt);
+	rc = SQLBindCol(hstmt, 2, SQL_C_CHAR, bufs, sizeof(bufs[0]), inds);
+	CHECK_STMT_RESULT(rc, "SQLBindCol failed", hstmt);
+	fetch_rowset(hstmt, 5001, ids, bufs, inds, &rowsFetched);
+	fetch_rowset(hstmt, 1, ids, bufs, inds, &rowsFetched);
+	fetch_rowset(hstmt, 9991, ids, bufs, inds, &rowsFetched);
+	fetch_rowset(hstmt, 2501, ids, bufs, inds, &rowsFetched);
+
+	/* SQLGetData in a rowset which was read back */
+	rc = SQLFreeStmt(hstmt, SQL_UNBIND);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+	rc = SQLFetchScroll(hstmt, SQL_FETCH_ABSOLUTE, 1);
+	CHECK_STMT_RESULT(rc, "SQLFetchScroll failed", hstmt);
+	get_data_at(hstmt, 3);
+	get_data_at(hstmt, 4);
+
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+
+	/* Clean up */
+	test_disconnect();
+
+	return 0;
+}
@@ -0,0 +1,100 @@
+/*
+ * A benchmark of the statement handle allocation.
+ *
+ * Allocates a statement handle, binds a parameter and a column, executes
+ * a query and frees the handle repeatedly, like the frameworks which use
+ * a new statement for each query, and prints the throughput with the
+ * statement pool off (StatementPoolSize=0) and on. The time spent in
+ * SQLAllocHandle and SQLFreeHandle alone is printed too.
+ *
+ * This uses the same psqlodbc_test_dsn datasource as the regression tests.
+ *
+ * Usage: stmt-bench [iterations]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <sys/time.h>
+#endif
+
+#include "src/common.h"
+
+static double
+now_msec(void)
+{
+#ifdef WIN32
+	return (double) GetTickCount();
+#else
+	struct timeval	tv;
+
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+#endif
+}
+
+static void
+run_bench(const char *label, char *options, int count)
+{
+	SQLRETURN	rc;
+	HSTMT		hstmt = SQL_NULL_HSTMT;
+	SQLINTEGER	id, col;
+	SQLLEN		ind = 0, colind;
+	double		start, t, elapsed, handle_time = 0;
+	int			i;
+
+	test_connect_ext(options);
+
+	start = now_msec();
+	for (i = 0; i < count; i++)
+	{
+		t = now_msec();
+		rc = SQLAllocHandle(SQL_HANDLE_STMT, conn, &hstmt);
+		handle_time += now_msec() - t;
+		if (!SQL_SUCCEEDED(rc))
+		{
+			print_diag("failed to allocate stmt handle", SQL_HANDLE_DBC, conn);
+			exit(1);
+		}
+		id = i;
+		rc = SQLBindParameter(hstmt, 1, SQL_PARAM_INPUT, SQL_C_SLONG, SQL_INTEGER, 0, 0, &id, 0, &ind);
+		CHECK_STMT_RESULT(rc, "SQLBindParameter failed", hstmt);
+		rc = SQLBindCol(hstmt, 1, SQL_C_SLONG, &col, 0, &colind);
+		CHECK_STMT_RESULT(rc, "SQLBindCol failed", hstmt);
+		rc = SQLExecDirect(hstmt, (SQLCHAR *) "SELECT ?::int4 + 1", SQL_NTS);
+		CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+		rc = SQLFetch(hstmt);
+		CHECK_STMT_RESULT(rc, "SQLFetch failed", hstmt);
+		t = now_msec();
+		rc = SQLFreeHandle(SQL_HANDLE_STMT, hstmt);
+		handle_time += now_msec() - t;
+		CHECK_STMT_RESULT(rc, "SQLFreeHandle failed", hstmt);
+	}
+	elapsed = now_msec() - start;
+
+	printf("%s: %d queries in %.0f ms, %.0f per second, %.1f ms in SQLAllocHandle/SQLFreeHandle\n",
+		   label, count, elapsed, elapsed > 0 ? count * 1000.0 / elapsed : 0.0,
+		   handle_time);
+	test_disconnect();
+}
+
+int
+main(int argc, char **argv)
+{
+	int			count = 10000;
+
+	if (argc > 1)
+		count = atoi(argv[1]);
+	if (count <= 0)
+	{
+		fprintf(stderr, "Usage: %s [iterations]\n", argv[0]);
+		exit(1);
+	}
+
+	run_bench("statement pool off", "StatementPoolSize=0", count);
+	run_bench("statement pool on", "StatementPoolSize=16", count);
+
+	return 0;
+}
@@ -0,0 +1,99 @@
+/*
+ * A benchmark of the statement-level rollback (Protocol=7.4-2).
+ *
+ * Executes a prepared INSERT repeatedly in a transaction and prints the
+ * throughput with rollback on error off, on with the internal savepoint
+ * sent by itself before each execution, and on with the savepoint
+ * pipelined with the execution (PipelineSavepoint=1).
+ *
+ * This uses the same psqlodbc_test_dsn datasource as the regression tests.
+ *
+ * Usage: svp-bench [executions]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <sys/time.h>
+#endif
+
+#include "src/common.h"
+
+static double
+now_msec(void)
+{
+#ifdef WIN32
+	return (double) GetTickCount();
+#else
+	struct timeval	tv;
+
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+#endif
+}
+
+static void
+run_bench(const char *label, char *options, int count)
+{
+	SQLRETURN	rc;
+	HSTMT		hstmt = SQL_NULL_HSTMT;
+	SQLINTEGER	id;
+	SQLLEN		ind = 0;
+	double		start, elapsed;
+	int			i;
+
+	test_connect_ext(options);
+	rc = SQLAllocHandle(SQL_HANDLE_STMT, conn, &hstmt);
+	if (!SQL_SUCCEEDED(rc))
+	{
+		print_diag("failed to allocate stmt handle", SQL_HANDLE_DBC, conn);
+		exit(1);
+	}
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) "CREATE TEMPORARY TABLE svp_bench (id int4)", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	rc = SQLSetConnectAttr(conn, SQL_ATTR_AUTOCOMMIT, (SQLPOINTER) SQL_AUTOCOMMIT_OFF, 0);
+	CHECK_CONN_RESULT(rc, "SQLSetConnectAttr failed", conn);
+	rc = SQLPrepare(hstmt, (SQLCHAR *) "INSERT INTO svp_bench VALUES (?)", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLPrepare failed", hstmt);
+	rc = SQLBindParameter(hstmt, 1, SQL_PARAM_INPUT, SQL_C_SLONG, SQL_INTEGER, 0, 0, &id, 0, &ind);
+	CHECK_STMT_RESULT(rc, "SQLBindParameter failed", hstmt);
+
+	start = now_msec();
+	for (i = 0; i < count; i++)
+	{
+		id = i;
+		rc = SQLExecute(hstmt);
+		CHECK_STMT_RESULT(rc, "SQLExecute failed", hstmt);
+	}
+	rc = SQLEndTran(SQL_HANDLE_DBC, conn, SQL_COMMIT);
+	CHECK_CONN_RESULT(rc, "SQLEndTran failed", conn);
+	elapsed = now_msec() - start;
+
+	printf("%s: %d executions in %.0f ms, %.0f per second\n",
+		   label, count, elapsed, elapsed > 0 ? count * 1000.0 / elapsed : 0.0);
+	rc = SQLFreeHandle(SQL_HANDLE_STMT, hstmt);
+	CHECK_STMT_RESULT(rc, "SQLFreeHandle failed", hstmt);
+	test_disconnect();
+}
+
+int
+main(int argc, char **argv)
+{
+	int			count = 10000;
+
+	if (argc > 1)
+		count = atoi(argv[1]);
+	if (count <= 0)
+	{
+		fprintf(stderr, "Usage: %s [executions]\n", argv[0]);
+		exit(1);
+	}
+
+	run_bench("rollback on error off", "UseServerSidePrepare=1;Protocol=7.4-0", count);
+	run_bench("statement rollback", "UseServerSidePrepare=1;Protocol=7.4-2", count);
+	run_bench("statement rollback, pipelined", "UseServerSidePrepare=1;Protocol=7.4-2;PipelineSavepoint=1", count);
+
+	return 0;
+}
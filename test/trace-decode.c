@@ -0,0 +1,319 @@
+/*
+ * A decoder for the binary query trace of the driver.
+ *
+ * If QueryTrace=1 is set in the driver section of odbcinst.ini, the driver
+ * writes the timings of the prepare/describe/execute/fetch requests to
+ * pgtrace_xxxx.log in the log directory (see mylog.c for the format).
+ * This program reads such files and prints a latency summary and a
+ * histogram for each distinct statement. The names of the cursors are
+ * taken out of the statements, so that e.g. the FETCHes from all the
+ * cursors of a query are counted together.
+ *
+ * Usage: trace-decode [--events] <trace file> ...
+ *
+ * With --events, each record is also printed as a line of text.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef WIN32
+#define strdup _strdup
+#endif
+
+#define QTRACE_MAGIC		"PGQTRC02"
+#define QTRACE_MAGIC_V1		"PGQTRC01"	/* 4-byte elapsed time */
+#define QTRACE_RECORD_SIZE	48
+#define NUM_BUCKETS			40	/* 2^39 microseconds is over six days */
+
+typedef long long int64;
+typedef unsigned long long uint64;
+
+static const char * const event_names[] = {"?", "PREPARE", "DESCRIBE", "EXECUTE", "FETCH"};
+#define NUM_EVENTS (sizeof(event_names) / sizeof(event_names[0]))
+
+/* Accumulated numbers for each (event, query text) pair */
+typedef struct
+{
+	int		event;
+	char   *query;
+	long	count;
+	uint64	total_usec;
+	uint64	min_usec;
+	uint64	max_usec;
+	int64	rows;
+	uint64	bytes;
+	long	failed;
+	long	buckets[NUM_BUCKETS];
+} stmt_stats;
+
+static stmt_stats *stats = NULL;
+static int	num_stats = 0;
+static int	alloc_stats = 0;
+
+static uint64
+get_le(const unsigned char *p, int len)
+{
+	uint64	val = 0;
+	int		i;
+
+	for (i = len - 1; i >= 0; i--)
+		val = (val << 8) | p[i];
+	return val;
+}
+
+static int
+bucket_of(uint64 usec)
+{
+	int		i;
+
+	for (i = 0; i < NUM_BUCKETS - 1 && usec >= ((uint64) 1 << i); i++)
+		;
+	return i;
+}
+
+/*
+ * Replace the cursor names in the query with "?", in place. These are
+ * the quoted name after "in" of a FETCH, and the SQL_CUR<address> names
+ * which the driver generates.
+ */
+static void
+normalize_query(int event, char *query)
+{
+	char   *p, *q, *end;
+
+	if (event == 4 /* FETCH */ && (p = strstr(query, " in \"")) != NULL)
+	{
+		p += 5;
+		if ((end = strchr(p, '"')) != NULL)
+		{
+			*p = '?';
+			memmove(p + 1, end, strlen(end) + 1);
+		}
+	}
+	for (p = query; (p = strstr(p, "SQL_CUR")) != NULL;)
+	{
+		p += 7;
+		for (q = p; *q && strchr("0123456789abcdefABCDEFx", *q); q++)
+			;
+		if (q > p)
+		{
+			*p = '?';
+			memmove(p + 1, q, strlen(q) + 1);
+		}
+	}
+}
+
+static stmt_stats *
+find_stats(int event, const char *query)
+{
+	int		i;
+
+	for (i = 0; i < num_stats; i++)
+	{
+		if (stats[i].event == event && strcmp(stats[i].query, query) == 0)
+			return &stats[i];
+	}
+	if (num_stats >= alloc_stats)
+	{
+		alloc_stats = alloc_stats > 0 ? alloc_stats * 2 : 64;
+		stats = realloc(stats, alloc_stats * sizeof(stmt_stats));
+		if (!stats)
+		{
+			fprintf(stderr, "out of memory\n");
+			exit(1);
+		}
+	}
+	memset(&stats[num_stats], 0, sizeof(stmt_stats));
+	stats[num_stats].event = event;
+	stats[num_stats].query = strdup(query);
+	stats[num_stats].min_usec = (uint64) -1;
+	return &stats[num_stats++];
+}
+
+static int
+decode_file(const char *filename, int print_events)
+{
+	FILE   *fp;
+	unsigned char hdr[QTRACE_RECORD_SIZE];
+	char	magic[sizeof(QTRACE_MAGIC)];
+	char   *query;
+	long	nrecords = 0;
+	int		elapsed_size = 8;
+
+	if ((fp = fopen(filename, "rb")) == NULL)
+	{
+		fprintf(stderr, "could not open \"%s\"\n", filename);
+		return 1;
+	}
+	if (fread(magic, strlen(QTRACE_MAGIC), 1, fp) != 1)
+		magic[0] = '\0';
+	if (memcmp(magic, QTRACE_MAGIC_V1, strlen(QTRACE_MAGIC_V1)) == 0)
+		elapsed_size = 4;
+	else if (memcmp(magic, QTRACE_MAGIC, strlen(QTRACE_MAGIC)) != 0)
+	{
+		fprintf(stderr, "\"%s\" is not a query trace file\n", filename);
+		fclose(fp);
+		return 1;
+	}
+	while (fread(hdr, sizeof(hdr), 1, fp) == 1)
+	{
+		int		event = (int) hdr[0];
+		int		failed = (int) hdr[1];
+		size_t	qlen = (size_t) get_le(hdr + 2, 2);
+		int		nparams = (int) get_le(hdr + 4, 4);
+		uint64	conn = get_le(hdr + 8, 8);
+		uint64	start = get_le(hdr + 16, 8);
+		uint64	elapsed = get_le(hdr + 24, elapsed_size);
+		int64	rows = (int64) get_le(hdr + 32, 8);
+		uint64	bytes = get_le(hdr + 40, 8);
+		stmt_stats *st;
+
+		query = malloc(qlen + 1);
+		if (!query)
+		{
+			fprintf(stderr, "out of memory\n");
+			exit(1);
+		}
+		if (qlen > 0 && fread(query, qlen, 1, fp) != 1)
+		{
+			fprintf(stderr, "\"%s\": truncated record\n", filename);
+			free(query);
+			break;
+		}
+		query[qlen] = '\0';
+		if (event < 0 || event >= (int) NUM_EVENTS)
+			event = 0;
+
+		if (print_events)
+			printf("%llu.%06llu conn=%llu %-8s %8llu us params=%d rows=%lld bytes=%llu%s %s\n",
+				   start / 1000000, start % 1000000, conn,
+				   event_names[event], elapsed, nparams, rows, bytes,
+				   failed ? " FAILED" : "", query);
+
+		normalize_query(event, query);
+		st = find_stats(event, query);
+		st->count++;
+		if (failed)
+			st->failed++;
+		st->total_usec += elapsed;
+		if (elapsed < st->min_usec)
+			st->min_usec = elapsed;
+		if (elapsed > st->max_usec)
+			st->max_usec = elapsed;
+		if (rows > 0)
+			st->rows += rows;
+		st->bytes += bytes;
+		st->buckets[bucket_of(elapsed)]++;
+		nrecords++;
+		free(query);
+	}
+	fclose(fp);
+	if (print_events)
+		printf("%ld records in \"%s\"\n\n", nrecords, filename);
+
+	return 0;
+}
+
+/*
+ * Get the upper bound of the bucket that contains the given percentile.
+ * Bucket i holds the elapsed times less than 2^i microseconds.
+ */
+static uint64
+percentile(const stmt_stats *st, double pct)
+{
+	long	target = (long) (st->count * pct + 0.5);
+	long	sum = 0;
+	int		i;
+
+	if (target < 1)
+		target = 1;
+	for (i = 0; i < NUM_BUCKETS; i++)
+	{
+		sum += st->buckets[i];
+		if (sum >= target)
+			break;
+	}
+	if (i >= NUM_BUCKETS)
+		i = NUM_BUCKETS - 1;
+	return (uint64) 1 << i;
+}
+
+static int
+compare_total(const void *a, const void *b)
+{
+	const stmt_stats *sa = a, *sb = b;
+
+	if (sa->total_usec > sb->total_usec)
+		return -1;
+	if (sa->total_usec < sb->total_usec)
+		return 1;
+	return 0;
+}
+
+static void
+print_stats(void)
+{
+	int		i, j, maxb, width;
+	long	maxcount;
+
+	qsort(stats, num_stats, sizeof(stmt_stats), compare_total);
+	for (i = 0; i < num_stats; i++)
+	{
+		const stmt_stats *st = &stats[i];
+
+		printf("%s: %s\n", event_names[st->event], st->query);
+		printf("  count=%ld failed=%ld total=%llu us avg=%llu us min=%llu us max=%llu us p50<%llu us p99<%llu us rows=%lld bytes=%llu\n",
+			   st->count, st->failed, st->total_usec, st->total_usec / st->count,
+			   st->min_usec, st->max_usec,
+			   percentile(st, 0.5), percentile(st, 0.99),
+			   st->rows, st->bytes);
+
+		maxcount = 0;
+		maxb = 0;
+		for (j = 0; j < NUM_BUCKETS; j++)
+		{
+			if (st->buckets[j] > maxcount)
+				maxcount = st->buckets[j];
+			if (st->buckets[j] > 0)
+				maxb = j;
+		}
+		for (j = bucket_of(st->min_usec); j <= maxb; j++)
+		{
+			width = (int) ((st->buckets[j] * 50 + maxcount - 1) / maxcount);
+			printf("  < %10llu us | %8ld ", (uint64) 1 << j, st->buckets[j]);
+			while (width-- > 0)
+				putchar('#');
+			putchar('\n');
+		}
+		putchar('\n');
+	}
+}
+
+int
+main(int argc, char **argv)
+{
+	int		i;
+	int		print_events = 0;
+	int		nfiles = 0;
+	int		failed = 0;
+
+	for (i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--events") == 0)
+			print_events = 1;
+		else
+		{
+			failed |= decode_file(argv[i], print_events);
+			nfiles++;
+		}
+	}
+	if (nfiles == 0)
+	{
+		fprintf(stderr, "Usage: %s [--events] <trace file> ...\n", argv[0]);
+		exit(1);
+	}
+	print_stats();
+
+	return failed;
+}
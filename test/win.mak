@@ -43,7 +43,7 @@ LINKFLAGS=/link odbc32.lib odbccp32.lib /MANIFEST:EMBED
 {$(SRCDIR)\}.c{$(EXEDIR)\}.exe:
 	$(CC) /Fe.\$(EXEDIR)\ /Fo.\$(OBJDIR)\ $< $(COMOBJ) $(CLFLAGS) $(LINKFLAGS)
 
-all: $(TESTEXES) runsuite.exe
+all: $(TESTEXES) runsuite.exe trace-decode.exe svp-bench.exe stmt-bench.exe read-bench.exe fetch-bench.exe
 
 $(TESTEXES): $(OBJDIR) $(COMOBJ)
 
@@ -62,9 +62,24 @@ $(OBJDIR) :
 runsuite.exe: $(ORIGDIR)\runsuite.c
 	$(CC) $** $(CLFLAGS) $(LINKFLAGS)
 
+trace-decode.exe: $(ORIGDIR)\trace-decode.c
+	$(CC) $** $(CLFLAGS) $(LINKFLAGS)
+
 reset-db.exe: $(ORIGDIR)\reset-db.c $(COMOBJ)
 	$(CC) $** $(CLFLAGS) $(LINKFLAGS)
 
+svp-bench.exe: $(ORIGDIR)\svp-bench.c $(COMOBJ)
+	$(CC) $** $(CLFLAGS) $(LINKFLAGS)
+
+stmt-bench.exe: $(ORIGDIR)\stmt-bench.c $(COMOBJ)
+	$(CC) $** $(CLFLAGS) $(LINKFLAGS)
+
+read-bench.exe: $(ORIGDIR)\read-bench.c $(COMOBJ)
+	$(CC) $** $(CLFLAGS) $(LINKFLAGS)
+
+fetch-bench.exe: $(ORIGDIR)\fetch-bench.c $(COMOBJ)
+	$(CC) $** $(CLFLAGS) $(LINKFLAGS)
+
 # activate the above inference rule
 .SUFFIXES: .out
 
@@ -93,6 +93,9 @@ ADD_DEFINES = $(ADD_DEFINES) /D "_HANDLE_ENLIST_IN_DTC_"
 !IF "$(MEMORY_DEBUG)" == "yes"
 ADD_DEFINES = $(ADD_DEFINES) /D "_MEMORY_DEBUG_" /GS
 !ENDIF
+!IF "$(MAX_LOG_LEVEL)" != ""
+ADD_DEFINES = $(ADD_DEFINES) /D "MAX_LOG_LEVEL=$(MAX_LOG_LEVEL)"
+!ENDIF
 !IF "$(ANSI_VERSION)" == "yes"
 ADD_DEFINES = $(ADD_DEFINES) /D "DBMS_NAME=\"PostgreSQL ANSI($(TARGET_CPU))\""
 !ELSE